@@ -0,0 +1,40 @@
+#include "AliasTable.h"
+#include "Error.h"
+
+AliasTable::AliasTable(std::vector<double> const& weights)
+	: prob_(weights.size()), alias_(weights.size())
+{
+	int n = (int)weights.size();
+	double total = 0;
+	for (double w : weights)
+	{
+		if (!(w >= 0)) ERR_CRITICAL("Alias table weights must be non-negative\n");
+		total += w;
+	}
+	if (n == 0 || total <= 0) ERR_CRITICAL("Alias table needs a positive weight\n");
+
+	// Scale so the average is 1, then pair each outcome below 1 with one above,
+	// which tops it up and makes up the rest of its slot.
+	std::vector<int> small, large;
+	for (int i = 0; i < n; i++)
+	{
+		prob_[i] = weights[i] * n / total;
+		alias_[i] = i;
+		(prob_[i] < 1.0 ? small : large).push_back(i);
+	}
+	while (!small.empty() && !large.empty())
+	{
+		int s = small.back(), l = large.back();
+		small.pop_back();
+		alias_[s] = l;
+		prob_[l] -= 1.0 - prob_[s];
+		if (prob_[l] < 1.0)
+		{
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+	// Whatever is left is 1 up to rounding.
+	for (int i : large) prob_[i] = 1.0;
+	for (int i : small) prob_[i] = 1.0;
+}
@@ -0,0 +1,41 @@
+/** \file  AliasTable.h
+ *  \brief Draw from a discrete distribution in constant time
+ */
+
+#ifndef COVIDSIM_ALIASTABLE_H_INCLUDED_
+#define COVIDSIM_ALIASTABLE_H_INCLUDED_
+
+#include <vector>
+
+/// Walker's alias method, as set up by Vose ("A linear algorithm for generating
+/// random numbers with a given distribution", IEEE Trans. Softw. Eng. 17, 1991).
+/// Each outcome has a slot, which holds its own probability of being chosen from
+/// that slot and an alias chosen otherwise; a draw picks a slot at random and
+/// then one of the two.
+class AliasTable
+{
+	std::vector<double> prob_;
+	std::vector<int> alias_;
+
+public:
+
+	AliasTable() = default;
+
+	/// \param weights  Relative probability of each outcome; non-negative, and not all zero
+	explicit AliasTable(std::vector<double> const& weights);
+
+	/// \return Number of outcomes
+	int size() const { return (int)prob_.size(); }
+
+	/// \param u  Uniform random number in [0, 1)
+	/// \return   The outcome chosen
+	int choose(double u) const
+	{
+		double x = u * prob_.size();
+		int i = (int)x;
+		if (i >= size()) i = size() - 1;
+		return (x - i < prob_[i]) ? i : alias_[i];
+	}
+};
+
+#endif // COVIDSIM_ALIASTABLE_H_INCLUDED_
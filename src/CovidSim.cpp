@@ -8,8 +8,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,6 +34,14 @@
 #include "Memory.h"
 #include "CLI.h"
 #include "ReadParams.h"
+#include "InterventionFile.h"
+#include "ScenarioMatrix.h"
+#include "RealisationCheckpoint.h"
+#include "RealisationPool.h"
+#include "ResultsFile.h"
+#include "RunningStats.h"
+#include "OutputQueue.h"
+#include "EventLog.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -45,26 +58,35 @@
 
 void parse_bmp_option(std::string const&);
 void parse_intervention_file_option(std::string const&);
-void ReadInterventions(std::string const&);
-int GetXMLNode(FILE*, const char*, const char*, char*, int);
+void ReadInterventions(std::vector<InterventionFile::Spec> const&);
 void ReadAirTravel(std::string const&, std::string const&);
 void InitModel(int); //adding run number as a parameter for event log: ggilani - 15/10/2014
 void SeedInfection(double, int*, int, int); //adding run number as a parameter for event log: ggilani - 15/10/2014
-int RunModel(int, std::string const&, std::string const&, std::string const&);
+int RunModel(int, std::string const&, std::string const&, std::string const&, RealisationCheckpoint::RunPoint const*);
 
 void SaveDistribs(std::string const&);
 void SaveOriginDestMatrix(std::string const&); //added function to save origin destination matrix so it can be done separately to the main results: ggilani - 13/02/15
-void SaveResults(std::string const&);
+void SaveResults(std::string const&, Results const*, int const*);
+Results* AcquireTimeSeries(void);
+void ReleaseTimeSeries(Results*);
+void CopyTimeSeries(Results*, Results const*);
+void PackRealisation(std::vector<char>&);
+void UnpackRealisation(std::vector<char> const&);
+void SaveBinaryResults(std::string const&, std::vector<ResultsFile::TableSource> const&, bool);
 void SaveSummaryResults(std::string const&);
+std::vector<ResultsFile::Field> const& QuantileFields(void);
+void SaveQuantiles(std::string const&);
 void SaveRandomSeeds(std::string const&); //added this function to save random seeds for each run: ggilani - 09/03/17
-void SaveEvents(std::string const&); //added this function to save infection events from all realisations: ggilani - 15/10/14
+void SaveEvents(std::string const&, Events const*, int); //added this function to save infection events from all realisations: ggilani - 15/10/14
+void SaveBinaryEvents(std::string const&, Events const*, std::size_t, bool);
 void LoadSnapshot(std::string const&);
 void SaveSnapshot(std::string const&);
-void RecordInfTypes(void);
+void RecordInfTypes(bool);
+void AccumulateRealisation(void);
 
 void RecordSample(double, int, std::string const&);
 void CalibrationThresholdCheck(double, int);
-void CalcLikelihood(int, std::string const&, std::string const&);
+void CalcLikelihood(int, std::string const&, std::string const&, bool);
 void CalcOriginDestMatrix_adunit(void); //added function to calculate origin destination matrix: ggilani 28/01/15
 
 ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** ///// ***** /////
@@ -73,6 +95,7 @@ void CalcOriginDestMatrix_adunit(void); //added function to calculate origin des
 
 Param P;
 Person* Hosts;
+std::vector<PersonState> HostsState;
 std::vector<PersonQuarantine> HostsQuarantine;
 Household* Households;
 PopVar State, StateT[MAX_NUM_THREADS];
@@ -81,16 +104,23 @@ Cell ** CellLookup; // CellLookup[i] is a pointer to the i'th populated cell
 Microcell* Mcells, ** McellLookup;
 std::vector<uint16_t> mcell_country;
 Place** Places;
+PlaceMembership PlaceMembers[MAX_NUM_PLACE_TYPES];
 AdminUnit AdUnits[MAX_ADUNITS];
 //// Time Series defs:
 //// TimeSeries is an array of type results, used to store (unsurprisingly) a time series of every quantity in results. Mostly used in RecordSample.
 //// TSMeanNE and TSVarNE are the mean and variance of non-extinct time series. TSMeanE and TSVarE are the mean and variance of extinct time series. TSMean and TSVar are pointers that point to either extinct or non-extinct.
 Results* TimeSeries, * TSMean, * TSVar, * TSMeanNE, * TSVarNE, * TSMeanE, * TSVarE; //// TimeSeries used in RecordSample, RecordInfTypes, SaveResults. TSMean and TSVar
+std::vector<QuantileSketch> TSQuantilesE, TSQuantilesNE;
 Airport* Airports;
 BitmapHeader* bmh;
 //added declaration of pointer to events log: ggilani - 10/10/2014
-Events* InfEventLog;
-int nEvents;
+//// InfEventLogT are per-thread buffers of events recorded since they were last collected into InfEventLog.
+std::vector<Events> InfEventLog, InfEventLogT[MAX_NUM_THREADS];
+//// Spare TimeSeries buffers, for realisations whose results are being written in the background.
+std::vector<Results*> TimeSeriesPool;
+std::mutex TimeSeriesPoolMutex;
+//// Realisation taken at P.ExtinctRestartTime, to restart realisations that go extinct after it from.
+RealisationCheckpoint ExtinctionCheckpoint;
 
 double inftype[INFECT_TYPE_MASK], inftype_av[INFECT_TYPE_MASK], infcountry[MAX_COUNTRIES], infcountry_av[MAX_COUNTRIES], infcountry_num[MAX_COUNTRIES];
 double indivR0[MAX_SEC_REC][MAX_GEN_REC], indivR0_av[MAX_SEC_REC][MAX_GEN_REC];
@@ -118,13 +148,17 @@ std::vector<std::string> InterventionFiles;
 
 int main(int argc, char* argv[])
 {
+	// Under MPI, every process sets up the model, then rank 0 hands out realisations to the others.
+	int NumMpiProcesses = RealisationPool::start_mpi(&argc, &argv);
+	bool MpiWorker = (RealisationPool::mpi_rank() != 0);
+
 	Params::alloc_params(&P);
 
 	///// Flags to ensure various parameters have been read; set to false as default.
 	std::string pre_param_file, param_file, density_file, load_network_file, save_network_file, air_travel_file, school_file;
 	std::string reg_demog_file, fit_file, data_file;
-	std::string ad_unit_file, out_density_file, output_file_base;
-	std::string snapshot_load_file, snapshot_save_file;
+	std::string ad_unit_file, density_cache_file, out_density_file, output_file_base;
+	std::string snapshot_load_file, snapshot_save_file, setup_checkpoint_file, intervention_cache_file, scenario_file;
 
 	int StopFit = 0;
 	///// Flags to ensure various parameters have been read; set to false as default.
@@ -163,6 +197,9 @@ int main(int argc, char* argv[])
 	// the command line: ggilani - 15/10/2014
 	P.KernelOffsetScale = P.KernelPowerScale = 1.0;
 	P.DoLoadSnapshot = 0;
+	P.OutputDensityFileVersion = 1;
+	P.OutputQueueLength = 0;
+	P.NumRealisationProcesses = 0;
 
 	//// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 	//// **** PARSE COMMAND-LINE ARGS
@@ -196,10 +233,12 @@ int main(int argc, char* argv[])
 
 	args.add_string_option("d", parse_read_file, reg_demog_file, "Regional demography file");
 	args.add_string_option("D", parse_read_file, density_file, "Population density file");
+	args.add_string_option("DC", parse_string, density_cache_file, "Binary cache of the text population density file (read if present, otherwise written)");
 	args.add_string_option("DT", parse_read_file, data_file, "Likelihood data file");
-	args.add_string_option("F", parse_string, fit_file, "Fitting file");
+	args.add_string_option("F", parse_string, fit_file, "Fitting file path prefix, or - to read fitting iterations from stdin");
 	args.add_integer_option("FI", GotFI, "Initial MCMC iteration");
 	args.add_custom_option("I", parse_intervention_file_option, "Intervention file");
+	args.add_string_option("IC", parse_string, intervention_cache_file, "Binary cache of the parsed intervention files (read if present, otherwise written)");
 	// added Kernel Power and Offset scaling so that it can easily
 	// be altered from the command line in order to vary the kernel
 	// quickly: ggilani - 15/10/14
@@ -208,13 +247,18 @@ int main(int argc, char* argv[])
 	args.add_string_option("L", parse_read_file, load_network_file, "Network file to load");
 	args.add_string_option("LS", parse_read_file, snapshot_load_file, "Snapshot file to load");
 	args.add_string_option("M", parse_write_dir, out_density_file, "Output density file");
+	args.add_integer_option("MF", P.OutputDensityFileVersion, "Output density file format version [1,2]");
 	args.add_integer_option("NR", GotNR, "Number of realisations");
 	args.add_string_option("O", parse_string, output_file_base, "Output file path prefix");
+	args.add_integer_option("OQ", P.OutputQueueLength, "Number of realisations whose outputs may be written in the background");
 	args.add_string_option("P", parse_read_file, param_file, "Parameter file");
 	args.add_string_option("PP", parse_read_file, pre_param_file, "Pre-Parameter file");
 	args.add_double_option("R", P.R0scale, "R0 scaling");
+	args.add_integer_option("RP", P.NumRealisationProcesses, "Number of realisations to run at once, each in its own single-threaded process");
 	args.add_string_option("s", parse_read_file, school_file, "School file");
 	args.add_string_option("S", parse_write_dir, save_network_file, "Network file to save");
+	args.add_string_option("SC", parse_string, setup_checkpoint_file, "Setup checkpoint file path prefix (completed setup stages are saved, and resumed by the same setup)");
+	args.add_string_option("SM", parse_read_file, scenario_file, "Scenario matrix file (a CSV of /R, /CLP and /I overrides, each row run on the same population)");
 	args.add_custom_option("SS", parse_snapshot_save_option, "Interval and file to save snapshots [double,string]");
 	args.add_integer_option("T", P.CaseOrDeathThresholdBeforeAlert_CommandLine, "Sets the P.CaseOrDeathThresholdBeforeAlert parameter");
 	args.parse(argc, argv, P);
@@ -226,6 +270,30 @@ int main(int argc, char* argv[])
 		args.print_detailed_help_and_exit();
 	}
 
+	if (P.OutputDensityFileVersion != 1 && P.OutputDensityFileVersion != 2)
+	{
+		std::cerr << "Output density file format version (/MF) must be 1 or 2" << std::endl;
+		args.print_detailed_help_and_exit();
+	}
+
+	if (fit_file == "-" && data_file.empty())
+	{
+		std::cerr << "Fitting over stdin (/F:-) needs a likelihood data file (/DT)" << std::endl;
+		args.print_detailed_help_and_exit();
+	}
+
+	if (P.NumRealisationProcesses < 0)
+	{
+		std::cerr << "Number of realisation processes (/RP) must not be negative" << std::endl;
+		args.print_detailed_help_and_exit();
+	}
+
+	if (P.OutputQueueLength < 0)
+	{
+		std::cerr << "Output queue length (/OQ) must not be negative" << std::endl;
+		args.print_detailed_help_and_exit();
+	}
+
 	// Check if P or O were not specified
 	if (param_file.empty() || output_file_base.empty())
 	{
@@ -270,25 +338,139 @@ int main(int argc, char* argv[])
 	//// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 
 	P.NumRealisations = GotNR;
-	Params::ReadParams(param_file, pre_param_file, ad_unit_file, &P, AdUnits);
+	Params::ParamFiles param_maps = Params::read_param_files(param_file, pre_param_file, ad_unit_file);
+	Params::ReadParams(param_maps, &P, AdUnits);
+	if (P.NumRealisationProcesses > 1 && (P.DoRecordInfEvents || P.DoInfectionTree || P.OutputBitmap || !snapshot_save_file.empty()))
+		ERR_CRITICAL("Realisations can't be run in worker processes (/RP) when recording infection events or the infection tree, outputting bitmaps or saving snapshots\n");
+	if ((P.ExtinctRestartTime >= 0) && (P.NumRealisationProcesses > 1 || NumMpiProcesses > 1 || P.DoAirports || P.DoRecordInfEvents || P.OutputBitmap
+		|| (P.DoAdUnits && P.DoOriginDestinationMatrix) || !snapshot_save_file.empty() || !snapshot_load_file.empty()))
+		ERR_CRITICAL("Extinct realisations can't be restarted from checkpoints with /RP, MPI, airports, infection events, bitmaps, the origin-destination matrix or snapshots\n");
+	std::vector<ScenarioMatrix::Scenario> scenarios;
+	if (!scenario_file.empty())
+	{
+		if (!fit_file.empty()) ERR_CRITICAL("Scenarios (/SM) can't be run while fitting (/F)\n");
+		scenarios = ScenarioMatrix::read(scenario_file);
+		if (scenarios.empty()) ERR_CRITICAL_FMT("Scenario file %s has no scenarios\n", scenario_file.c_str());
+	}
+	if (NumMpiProcesses > 1)
+	{
+		if (P.NumRealisationProcesses > 1 || !fit_file.empty() || !scenarios.empty())
+			ERR_CRITICAL("Realisations can't be run over MPI together with /RP, fitting (/F) or scenarios (/SM)\n");
+		if (P.DoRecordInfEvents || P.DoInfectionTree || P.OutputBitmap || !snapshot_save_file.empty())
+			ERR_CRITICAL("Realisations can't be run over MPI when recording infection events or the infection tree, outputting bitmaps or saving snapshots\n");
+		if (MpiWorker)
+		{
+			// Workers set up the same model as rank 0 but leave the files it writes to it.
+			save_network_file.clear();
+			out_density_file.clear();
+			density_cache_file.clear();
+			intervention_cache_file.clear();
+			setup_checkpoint_file.clear();
+		}
+	}
+	std::string setup_output_file_base = MpiWorker ? std::string() : output_file_base;
 	if (P.DoAirports)
 	{
 		if (air_travel_file.empty()) ERR_CRITICAL("Parameter file indicated airports should be used but '/AP' file was not given");
-		ReadAirTravel(air_travel_file, output_file_base);
+		ReadAirTravel(air_travel_file, setup_output_file_base);
 	}
 
 	//// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 	//// **** INITIALIZE
 	//// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 
+	if (!setup_checkpoint_file.empty())
+	{
+		// Setup depends on the parameter files and all arguments but those below, which don't change the population or network.
+		std::vector<std::string> setup_args;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg(argv[i]);
+			if (arg.rfind("/c:", 0) != 0 && arg.rfind("/SC:", 0) != 0 && arg.rfind("/O:", 0) != 0 && arg.rfind("/OQ:", 0) != 0 && arg.rfind("/NR:", 0) != 0 && arg.rfind("/RP:", 0) != 0
+				&& arg.rfind("/SM:", 0) != 0)
+				setup_args.push_back(arg);
+		}
+		SetupProgress.set_checkpoint(setup_checkpoint_file, SetupStages::fingerprint(setup_args,
+			{ pre_param_file, param_file, ad_unit_file, school_file, reg_demog_file, air_travel_file },
+			{ density_file, load_network_file }));
+	}
+
 	///// initialize model (for all realisations).
-	SetupModel(density_file, out_density_file, load_network_file, save_network_file, school_file, reg_demog_file, output_file_base);
+	SetupModel(density_file, density_cache_file, out_density_file, load_network_file, save_network_file, school_file, reg_demog_file, setup_output_file_base);
+	// Each scenario carries on from the random numbers as they are at the end of setup, as it would on its own.
+	std::vector<int32_t> setup_Xcg1, setup_Xcg2;
+	if (!scenarios.empty())
+	{
+		setup_Xcg1.assign(Xcg1, Xcg1 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+		setup_Xcg2.assign(Xcg2, Xcg2 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+	}
+	SetupProgress.begin("transmission coefficients");
 	InitTransmissionCoeffs();
+	SetupProgress.end((double)P.PopSize);
 	for (int i = 0; i < MAX_ADUNITS; i++) AdUnits[i].NI = 0;
-	for (auto const& int_file : InterventionFiles)
-		ReadInterventions(int_file);
+	SetupProgress.begin("interventions");
+	std::vector<InterventionFile::Contents> interventions;
+	bool interventions_cached = false;
+	if (!intervention_cache_file.empty() && !InterventionFiles.empty())
+	{
+		FILE* cache = Files::xfopen_if_exists(intervention_cache_file.c_str(), "rb");
+		if (cache != NULL)
+		{
+			Files::xfclose(cache);
+			// The cache is only used for the same intervention files, in the same order, unchanged since they were cached.
+			interventions_cached = InterventionFile::read_cache(intervention_cache_file, interventions)
+				&& (interventions.size() == InterventionFiles.size());
+			for (std::size_t i = 0; interventions_cached && (i < InterventionFiles.size()); i++)
+			{
+				uint64_t size;
+				int64_t mtime;
+				interventions_cached = (interventions[i].filename == InterventionFiles[i])
+					&& Files::stat_file(InterventionFiles[i].c_str(), size, mtime)
+					&& (interventions[i].size == size) && (interventions[i].mtime == mtime);
+			}
+			if (interventions_cached)
+				Files::xfprintf_stderr("Reading cached intervention files %s\n", intervention_cache_file.c_str());
+			else
+				Files::xfprintf_stderr("Intervention cache %s is for other or changed intervention files and will be replaced\n", intervention_cache_file.c_str());
+		}
+	}
+	if (!interventions_cached)
+	{
+		interventions.clear();
+		for (auto const& int_file : InterventionFiles)
+		{
+			Files::xfprintf_stderr("Reading intervention file.\n");
+			// Taken before reading, so that a change made while it is read invalidates the cache.
+			InterventionFile::Contents contents = { int_file, 0, 0, {} };
+			Files::stat_file(int_file.c_str(), contents.size, contents.mtime);
+			contents.specs = InterventionFile::read(int_file);
+			interventions.push_back(std::move(contents));
+		}
+		if (!intervention_cache_file.empty() && !InterventionFiles.empty())
+		{
+			Files::xfprintf_stderr("Saving parsed intervention files to %s\n", intervention_cache_file.c_str());
+			InterventionFile::write_cache(intervention_cache_file, interventions);
+		}
+	}
+	// Scenarios apply their own intervention files, read here so that any errors come before the runs.
+	std::map<std::string, std::vector<InterventionFile::Spec>> scenario_interventions;
+	if (!scenarios.empty())
+	{
+		for (auto const& int_file : interventions) scenario_interventions[int_file.filename] = int_file.specs;
+		for (auto const& scenario : scenarios)
+			for (auto const& int_file : scenario.intervention_files)
+				if (scenario_interventions.count(int_file) == 0)
+				{
+					Files::xfprintf_stderr("Reading intervention file.\n");
+					scenario_interventions[int_file] = InterventionFile::read(int_file);
+				}
+	}
+	for (auto const& int_file : interventions)
+		ReadInterventions(int_file.specs);
+	SetupProgress.end();
 
-	Files::xfprintf_stderr("Model setup in %lf seconds\n", ((double) clock() - cl) / CLOCKS_PER_SEC);
+	SetupProgress.report();
+	Files::xfprintf_stderr("Model setup in %lf seconds\n", SetupProgress.elapsed());
 
 	// Allocate memory for Efficacies array
 	P.NumInfectionSettings		= MAX_NUM_PLACE_TYPES + 2;	// Maximum number of place types, plus household, and spatial
@@ -301,9 +483,18 @@ int main(int argc, char* argv[])
 	//// **** RUN MODEL
 	//// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 
-	std::string output_file_base_f = output_file_base; // output_file_base_f remembers the original, as output_file_base changes with fitting.
+	std::string output_file_base_f = output_file_base; // output_file_base_f remembers the original, as output_file_base changes with fitting and scenarios.
+	// Command-line values that scenarios override.
+	std::vector<double> clP_base(P.clP, P.clP + 100);
+	double R0scale_base = P.R0scale;
 	std::string output_file; // Historically, this was global, and was used for all save...(void) type functions.
 
+	// Per-realisation outputs are written by a background thread while the next
+	// realisation runs, holding at most OutputQueueLength of them in memory.
+	std::unique_ptr<OutputQueue> output_queue;
+	std::size_t events_streamed = 0; // Events at the start of InfEventLog already in the .avNE event stream
+	if (P.OutputQueueLength > 0) output_queue.reset(new OutputQueue(P.OutputQueueLength));
+
 	do
 	{
 		P.FitIter++;
@@ -319,18 +510,57 @@ int main(int argc, char* argv[])
 			StopFit = ReadFitIter(fit_file);
 			if (!StopFit)
 			{
-				Params::ReadParams(param_file, pre_param_file, ad_unit_file, &P, AdUnits);
+				// Only the command-line parameters change between iterations, so the files aren't read again.
+				Params::ReadParams(param_maps, &P, AdUnits);
 				if (!P.FixLocalBeta) InitTransmissionCoeffs();
 				output_file_base = output_file_base_f + ".f" + std::to_string(P.FitIter);
 			}
 		}
+		else if (!scenarios.empty())
+		{
+			StopFit = (P.FitIter > (int)scenarios.size());
+			if (!StopFit)
+			{
+				ScenarioMatrix::Scenario const& scenario = scenarios[P.FitIter - 1];
+				Files::xfprintf_stderr("Scenario %i of %i (line %i of %s)\n", P.FitIter, (int)scenarios.size(), scenario.line, scenario_file.c_str());
+				std::copy(clP_base.begin(), clP_base.end(), P.clP);
+				for (auto const& clp : scenario.clp) P.clP[clp.first] = clp.second;
+				P.R0scale = scenario.has_r0_scale ? scenario.r0_scale : R0scale_base;
+
+				// Only the parameters change between scenarios, so the files aren't read again and the population and network are kept.
+				Params::ReadParams(param_maps, &P, AdUnits);
+				if (!(P.Kernel == P.MoveKernel))
+				{
+					P.Kernel = P.MoveKernel;
+					P.KernelLookup.init(1.0, P.Kernel);
+					P.KernelLookup.init(CellLookup, P.NumPopulatedCells);
+				}
+				std::copy(setup_Xcg1.begin(), setup_Xcg1.end(), Xcg1);
+				std::copy(setup_Xcg2.begin(), setup_Xcg2.end(), Xcg2);
+				InitTransmissionCoeffs();
+				for (int i = 0; i < MAX_ADUNITS; i++) AdUnits[i].NI = 0;
+				for (auto const& int_file : (scenario.has_interventions ? scenario.intervention_files : InterventionFiles))
+					ReadInterventions(scenario_interventions[int_file]);
+
+				// Every scenario runs from the same seeds, as it would on its own.
+				P.nextRunSeed1 = P.runSeed1;
+				P.nextRunSeed2 = P.runSeed2;
+				InfEventLog.clear();
+				events_streamed = 0;
+				output_file_base = output_file_base_f + ".s" + std::to_string(P.FitIter);
+			}
+		}
 		else StopFit = 1;
 
-		if ((fit_file.empty()) || (!StopFit))
+		if ((fit_file.empty() && scenarios.empty()) || (!StopFit))
 		{
-			P.NRactE = P.NRactNE = 0;
+			P.NRactE = P.NRactNE = P.NRactRestarted = P.NRactRestartedNE = 0;
+			ExtinctionCheckpoint.clear();
 			ResetTimeSeries();
-			for (int Realisation = 0; (Realisation < P.NumRealisations) && (P.NRactNE < P.NumNonExtinctRealisations); Realisation++)
+			if ((P.DoRecordInfEvents) && (P.RecordInfEventsPerRun == 0) && (P.OutputBinaryInfEvents))
+				SaveBinaryEvents(output_file_base + ".avNE", NULL, 0, false);
+			// Runs a realisation, up to the point where its results are added to the means and variances.
+			auto run_realisation = [&](int Realisation)
 			{
 				if (P.NumRealisations > 1)
 				{
@@ -347,6 +577,9 @@ int main(int argc, char* argv[])
 				
 				int32_t thisRunSeed1, thisRunSeed2;
 				int ContCalib, ModelCalibLoop = 0;
+				// Carry on from the checkpoint of an earlier realisation that went extinct after taking it, with new random numbers.
+				bool restart = !ExtinctionCheckpoint.empty() && (ExtinctionCheckpoint.restarts() < P.MaxExtinctRestarts);
+				RealisationCheckpoint::RunPoint resume;
 				P.StopCalibration = P.ModelCalibIteration = ModelCalibLoop = 0;
 
 				do
@@ -370,25 +603,137 @@ int main(int argc, char* argv[])
 					}
 
 					// initialize model
-					InitModel(Realisation);
+					if (restart) resume = ExtinctionCheckpoint.restore();
+					else
+					{
+						ExtinctionCheckpoint.clear();
+						InitModel(Realisation);
+					}
 
 					// load snapshot
 					if (!snapshot_load_file.empty()) LoadSnapshot(snapshot_load_file);
 
 					// Run Model - return value is a flag stating whether to keep calibrating model simulation time to calendar time based on user-specified triggers (cases/deaths).
-					ContCalib = RunModel(Realisation, snapshot_save_file, snapshot_load_file, output_file_base);
+					ContCalib = RunModel(Realisation, snapshot_save_file, snapshot_load_file, output_file_base, restart ? &resume : NULL);
 
 				} while (ContCalib);
+				// A restarted realisation shares its history with the one it was restarted from, so is
+				// counted apart and left out of the means (RunModel doesn't accumulate it).
+				if (restart)
+				{
+					P.NRactRestarted++;
+					if (!TimeSeries[P.NumOutputTimeSteps - 1].extinct) P.NRactRestartedNE++;
+				}
+				if (!TimeSeries[P.NumOutputTimeSteps - 1].extinct) ExtinctionCheckpoint.clear();
+			};
+			// Writes the outputs of a realisation once its results have been added to the means and variances.
+			auto finish_realisation = [&](int Realisation)
+			{
+				if (!data_file.empty()) CalcLikelihood(Realisation, data_file, output_file_base, fit_file == "-");
 
-				if (!data_file.empty()) CalcLikelihood(Realisation, data_file, output_file_base);
-
-				if (P.OutputNonSummaryResults)
-					if (((!TimeSeries[P.NumOutputTimeSteps - 1].extinct) || (!P.OutputOnlyNonExtinct)) && (P.OutputEveryRealisation))
-						SaveResults(output_file);
+				bool save_results = (P.OutputNonSummaryResults) && ((!TimeSeries[P.NumOutputTimeSteps - 1].extinct) || (!P.OutputOnlyNonExtinct)) && (P.OutputEveryRealisation);
+				bool save_events = false, stream_events = false;
+				std::vector<Events> events;
+				if (P.DoRecordInfEvents)
+				{
+					EventLog::collect(InfEventLogT, P.NumThreads, InfEventLog);
+					if (P.RecordInfEventsPerRun == 1)
+					{
+						save_events = true;
+						events.swap(InfEventLog);
+					}
+					else
+					{
+						// Stream this realisation's events, keeping only those the final table needs.
+						stream_events = (P.OutputBinaryInfEvents != 0);
+						if (stream_events) events.assign(InfEventLog.begin() + events_streamed, InfEventLog.end());
+						if (P.OutputBinaryInfEvents == 2) InfEventLog.clear();
+						else if ((int)InfEventLog.size() > P.MaxInfEvents) InfEventLog.resize(P.MaxInfEvents);
+						events_streamed = InfEventLog.size();
+					}
+				}
+				if (save_results || save_events || stream_events)
+				{
+					// The infection tree is written from Hosts, which the next realisation overwrites.
+					bool background = output_queue && !P.DoInfectionTree;
+					Results* time_series = TimeSeries;
+					std::vector<int> contact_dist(State.contact_dist, State.contact_dist + MAX_CONTACTS + 1);
+					std::function<void()> save = [=, contact_dist = std::move(contact_dist), events = std::move(events)]() {
+						if (save_results) SaveResults(output_file, time_series, contact_dist.data());
+						if (save_events)
+						{
+							SaveEvents(output_file, events.data(), (int)events.size());
+							SaveBinaryEvents(output_file, events.data(), events.size(), false);
+						}
+						if (stream_events) SaveBinaryEvents(output_file_base + ".avNE", events.data(), events.size(), true);
+						if (background) ReleaseTimeSeries(time_series);
+					};
+					if (background)
+					{
+						// Hand this realisation's time series to the writer and carry on with a
+						// copy, as the model expects it to persist between realisations.
+						output_queue->push(save);
+						TimeSeries = AcquireTimeSeries();
+						CopyTimeSeries(TimeSeries, time_series);
+					}
+					else save();
+				}
+			};
 
-				if ((P.DoRecordInfEvents) && (P.RecordInfEventsPerRun == 1))
-					SaveEvents(output_file);
+			if (P.NumRealisationProcesses > 1 || NumMpiProcesses > 1)
+			{
+				// Each worker starts a realisation from the seeds it would have had if the realisations were run in turn,
+				// assuming each earlier one drew new seeds once (as it does unless recalibrated or reseeded mid-run).
+				int32_t FirstRunSeed1 = (P.FitIter == 1) ? P.runSeed1 : P.nextRunSeed1;
+				int32_t FirstRunSeed2 = (P.FitIter == 1) ? P.runSeed2 : P.nextRunSeed2;
+				RealisationPool::Run run = [&](int Realisation, std::vector<char>& result)
+				{
+					P.nextRunSeed1 = FirstRunSeed1;
+					P.nextRunSeed2 = FirstRunSeed2;
+					for (int i = 0; i < Realisation; i++) setall(&P.nextRunSeed1, &P.nextRunSeed2);
+					run_realisation(Realisation);
+					PackRealisation(result);
+				};
+				RealisationPool::Merge merge = [&](int Realisation, std::vector<char> const& result)
+				{
+					if (P.NumRealisations > 1) output_file = output_file_base + "." + std::to_string(Realisation);
+					UnpackRealisation(result);
+					AccumulateRealisation();
+					finish_realisation(Realisation);
+					return P.NRactNE < P.NumNonExtinctRealisations;
+				};
+				int NumMerged;
+				if (NumMpiProcesses > 1)
+				{
+					NumMerged = RealisationPool::run_mpi(P.NumRealisations, run, merge);
+					if (MpiWorker)
+					{
+						RealisationPool::stop_mpi();
+						return 0;
+					}
+				}
+				else
+					NumMerged = RealisationPool::run(P.NumRealisationProcesses, P.NumRealisations,
+						[&](int Realisation, std::vector<char>& result)
+						{
+							P.NumThreads = 1;
+#ifdef _OPENMP
+							omp_set_num_threads(1);
+#endif
+							run(Realisation, result);
+						}, merge);
+				P.nextRunSeed1 = FirstRunSeed1;
+				P.nextRunSeed2 = FirstRunSeed2;
+				if (!(P.ResetSeeds && P.KeepSameSeeds))
+					for (int i = 0; i < NumMerged; i++) setall(&P.nextRunSeed1, &P.nextRunSeed2);
 			}
+			else
+				for (int Realisation = 0; (Realisation < P.NumRealisations) && (P.NRactNE + P.NRactRestartedNE < P.NumNonExtinctRealisations); Realisation++)
+				{
+					run_realisation(Realisation);
+					finish_realisation(Realisation);
+				}
+			if (output_queue) output_queue->flush();
 			output_file = output_file_base + ".avNE";
 			SaveSummaryResults(output_file);
 
@@ -403,7 +748,7 @@ int main(int argc, char* argv[])
 			TSMean = TSMeanNE; TSVar = TSVarNE;
 			if ((P.DoRecordInfEvents) && (P.RecordInfEventsPerRun == 0))
 			{
-				SaveEvents(output_file);
+				SaveEvents(output_file, InfEventLog.data(), (int)InfEventLog.size());
 			}
 
 			SaveSummaryResults(output_file);
@@ -415,11 +760,15 @@ int main(int argc, char* argv[])
 			Bitmap_Finalise();
 
 			Files::xfprintf_stderr("Extinction in %i out of %i runs\n", P.NRactE, P.NRactNE + P.NRactE);
+			if (P.ExtinctRestartTime >= 0)
+				Files::xfprintf_stderr("%i more runs restarted from checkpoints of earlier runs that went extinct, %i of them not extinct (not in the means)\n",
+					P.NRactRestarted, P.NRactRestartedNE);
 			Files::xfprintf_stderr("Model ran in %lf seconds\n", ((double)clock() - cl) / CLOCKS_PER_SEC);
 			Files::xfprintf_stderr("Model finished\n");
 		}
 	}
 	while (!StopFit);
+	RealisationPool::stop_mpi();
 }
 
 void parse_bmp_option(std::string const& input) {
@@ -449,237 +798,97 @@ void parse_intervention_file_option(std::string const& input)
 	InterventionFiles.emplace_back(output);
 }
 
-void ReadInterventions(std::string const& IntFile)
+void ReadInterventions(std::vector<InterventionFile::Spec> const& specs)
 {
-	FILE* dat;
 	double r, s, startt, stopt;
-	int j, k, au, ni, f, nsr;
-	char* buf = new char[65536];
-	char* txt = new char[65536];
+	int j, k, au, f, nsr;
 	Intervention CurInterv;
 
-	Files::xfprintf_stderr("Reading intervention file.\n");
-	dat = Files::xfopen(IntFile.c_str(), "rb");
-
-	Files::xfscanf(dat, 0, "%*[^<]");
-	Files::xfscanf(dat, 1, "<%[^>]", txt);
-
-	if (strcmp(txt, "\?xml version=\"1.0\" encoding=\"ISO-8859-1\"\?") != 0) ERR_CRITICAL("Intervention file not XML.\n");
-
-	Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-	if (strcmp(txt, "InterventionSettings") != 0) ERR_CRITICAL("Intervention has no top level.\n");
-	ni = 0;
-	while (!feof(dat))
+	for (InterventionFile::Spec const& spec : specs)
 	{
-		Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-		if (strcmp(txt, "intervention") == 0)
+		CurInterv = spec.interv;
+		nsr = spec.num_sequential_replicas;
+		startt = CurInterv.StartTime;
+		stopt = CurInterv.StopTime;
+		if (!spec.by_country)
 		{
-			ni++;
-			Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-			if (strcmp(txt, "parameters") != 0) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			if (!GetXMLNode(dat, "Type", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			if (strcmp(txt, "Treatment") == 0)
-				CurInterv.InterventionType = 0;
-			else if (strcmp(txt, "Vaccination") == 0)
-				CurInterv.InterventionType = 1;
-			else if (strcmp(txt, "ITN") == 0)
-				CurInterv.InterventionType = 2;
-			else if (strcmp(txt, "IRS") == 0)
-				CurInterv.InterventionType = 3;
-			else if (strcmp(txt, "GM") == 0)
-				CurInterv.InterventionType = 4;
-			else if (strcmp(txt, "MSAT") == 0)
-				CurInterv.InterventionType = 5;
-			else
-				Files::xsscanf(txt, 1, "%i", &CurInterv.InterventionType);
-			if (!GetXMLNode(dat, "AUThresh", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%i", &CurInterv.DoAUThresh);
-			if (!GetXMLNode(dat, "StartTime", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.StartTime);
-			startt = CurInterv.StartTime;
-			if (!GetXMLNode(dat, "StopTime", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.StopTime);
-			stopt = CurInterv.StopTime;
-			if (!GetXMLNode(dat, "MinDuration", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.MinDuration);
-			CurInterv.MinDuration *= DAYS_PER_YEAR;
-			if (!GetXMLNode(dat, "RepeatInterval", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.RepeatInterval);
-			CurInterv.RepeatInterval *= DAYS_PER_YEAR;
-			if (!GetXMLNode(dat, "MaxPrevAtStart", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.StartThresholdHigh);
-			if (!GetXMLNode(dat, "MinPrevAtStart", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.StartThresholdLow);
-			if (!GetXMLNode(dat, "MaxPrevAtStop", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.StopThreshold);
-			if (GetXMLNode(dat, "NoStartAfterMinDur", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%i", &CurInterv.NoStartAfterMin);
-			else
-				CurInterv.NoStartAfterMin = 0;
-			if (!GetXMLNode(dat, "Level", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%lf", &CurInterv.Level);
-			if (GetXMLNode(dat, "LevelCellVar", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.LevelCellVar);
-			else
-				CurInterv.LevelCellVar = 0;
-			if (GetXMLNode(dat, "LevelAUVar", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.LevelAUVar);
-			else
-				CurInterv.LevelCellVar = 0;
-			if (GetXMLNode(dat, "LevelCountryVar", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.LevelCountryVar);
-			else
-				CurInterv.LevelCellVar = 0;
-			if (GetXMLNode(dat, "LevelClustering", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.LevelClustering);
-			else
-				CurInterv.LevelClustering = 0;
-			if (GetXMLNode(dat, "ControlParam", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.ControlParam);
-			else
-				CurInterv.ControlParam = 0;
-			if (GetXMLNode(dat, "TimeOffset", "parameters", txt, 1))
-				Files::xsscanf(txt, 1, "%lf", &CurInterv.TimeOffset);
-			else
-				CurInterv.TimeOffset = 0;
-
-			if (!GetXMLNode(dat, "MaxRounds", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%u", &CurInterv.MaxRounds);
-			if (!GetXMLNode(dat, "MaxResource", "parameters", txt, 1)) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xsscanf(txt, 1, "%u", &CurInterv.MaxResource);
-			if (GetXMLNode(dat, "NumSequentialReplicas", "parameters", txt, 1))
-			Files::xsscanf(txt, 1, "%i", &nsr);
-			else
-				nsr = 0;
-			do {
-				Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-			} while ((strcmp(txt, "/intervention") != 0) && (strcmp(txt, "/parameters") != 0) && (!feof(dat)));
-			if (strcmp(txt, "/parameters") != 0) ERR_CRITICAL("Incomplete intervention parameter specification in intervention file\n");
-			Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-			if ((strcmp(txt, "adunits") != 0) && (strcmp(txt, "countries") != 0)) ERR_CRITICAL("Incomplete adunits/countries specification in intervention file\n");
-			if (strcmp(txt, "adunits") == 0)
+			for (std::string const& txt : spec.units)
 			{
-				while (GetXMLNode(dat, "A", "adunits", buf, 0))
+				j = atoi(txt.c_str());
+				if (j == 0)
 				{
-					Files::xsscanf(buf, 1, "%s", txt);
-					j = atoi(txt);
-					if (j == 0)
+					f = 1; au = -1;
+					do
 					{
-						f = 1; au = -1;
-						do
-						{
-							au++; f = strcmp(txt, AdUnits[au].ad_name);
-						} while ((f) && (au < P.NumAdunits));
-						if (!f)
+						au++; f = strcmp(txt.c_str(), AdUnits[au].ad_name);
+					} while ((f) && (au < P.NumAdunits));
+					if (!f)
+					{
+						r = fabs(CurInterv.Level) + (2.0 * ranf() - 1) * CurInterv.LevelAUVar;
+						if ((CurInterv.Level < 1) && (r > 1))
+							r = 1;
+						else if (r < 0)
+							r = 0;
+						for (k = 0; k <= nsr; k++)
 						{
-							r = fabs(CurInterv.Level) + (2.0 * ranf() - 1) * CurInterv.LevelAUVar;
-							if ((CurInterv.Level < 1) && (r > 1))
-								r = 1;
-							else if (r < 0)
-								r = 0;
-							for (k = 0; k <= nsr; k++)
-							{
-								AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
-								AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
-								AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
-								AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
-								AdUnits[au].NI++;
-							}
+							AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
+							AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
+							AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
+							AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
+							AdUnits[au].NI++;
 						}
 					}
-					else
+				}
+				else
+				{
+					k = (j % P.AdunitLevel1Mask) / P.AdunitLevel1Divisor;
+					au = P.AdunitLevel1Lookup[k];
+					if ((au >= 0) && (AdUnits[au].id / P.AdunitLevel1Divisor == j / P.AdunitLevel1Divisor))
 					{
-						k = (j % P.AdunitLevel1Mask) / P.AdunitLevel1Divisor;
-						au = P.AdunitLevel1Lookup[k];
-						if ((au >= 0) && (AdUnits[au].id / P.AdunitLevel1Divisor == j / P.AdunitLevel1Divisor))
+						r = CurInterv.Level + (2.0 * ranf() - 1) * CurInterv.LevelAUVar;
+						if ((CurInterv.Level < 1) && (r > 1))
+							r = 1;
+						else if (r < 0)
+							r = 0;
+						for (k = 0; k <= nsr; k++)
 						{
-							r = CurInterv.Level + (2.0 * ranf() - 1) * CurInterv.LevelAUVar;
-							if ((CurInterv.Level < 1) && (r > 1))
-								r = 1;
-							else if (r < 0)
-								r = 0;
-							for (k = 0; k <= nsr; k++)
-							{
-								AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
-								AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
-								AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
-								AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
-								AdUnits[au].NI++;
-							}
+							AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
+							AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
+							AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
+							AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
+							AdUnits[au].NI++;
 						}
 					}
 				}
 			}
-			else
+		}
+		else
+		{
+			for (std::string const& txt : spec.units)
 			{
-				while (GetXMLNode(dat, "C", "countries", buf, 0))
-				{
-					s = (2.0 * ranf() - 1) * CurInterv.LevelCountryVar;
-					Files::xsscanf(buf, 1, "%s", txt);
-					j = atoi(txt);
-					for (au = 0; au < P.NumAdunits; au++)
-						if (((j == 0) && (strcmp(txt, AdUnits[au].cnt_name) == 0)) || ((j > 0) && (j == AdUnits[au].cnt_id)))
+				s = (2.0 * ranf() - 1) * CurInterv.LevelCountryVar;
+				j = atoi(txt.c_str());
+				for (au = 0; au < P.NumAdunits; au++)
+					if (((j == 0) && (strcmp(txt.c_str(), AdUnits[au].cnt_name) == 0)) || ((j > 0) && (j == AdUnits[au].cnt_id)))
+					{
+						r = CurInterv.Level + (2.0 * ranf() - 1) * CurInterv.LevelAUVar + s;
+						if ((CurInterv.Level < 1) && (r > 1))
+							r = 1;
+						else if (r < 0)
+							r = 0;
+						for (k = 0; k <= nsr; k++)
 						{
-							r = CurInterv.Level + (2.0 * ranf() - 1) * CurInterv.LevelAUVar + s;
-							if ((CurInterv.Level < 1) && (r > 1))
-								r = 1;
-							else if (r < 0)
-								r = 0;
-							for (k = 0; k <= nsr; k++)
-							{
-								AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
-								AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
-								AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
-								AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
-								AdUnits[au].NI++;
-							}
+							AdUnits[au].InterventionList[AdUnits[au].NI] = CurInterv;
+							AdUnits[au].InterventionList[AdUnits[au].NI].Level = r;
+							AdUnits[au].InterventionList[AdUnits[au].NI].StartTime = startt + ((double)k) * (stopt - startt);
+							AdUnits[au].InterventionList[AdUnits[au].NI].StopTime = stopt + ((double)k) * (stopt - startt);
+							AdUnits[au].NI++;
 						}
-				}
+					}
 			}
-			Files::xfscanf(dat, 1, "%*[^<]<%[^>]", txt);
-			if (strcmp(txt, "/intervention") != 0) ERR_CRITICAL("Incorrect intervention specification in intervention file\n");
 		}
 	}
-	if (strcmp(txt, "/InterventionSettings") != 0) ERR_CRITICAL("Intervention has no top level closure.\n");
-	Files::xfprintf_stderr("%i interventions read\n", ni);
-	Files::xfclose(dat);
-	delete[] buf;
-	delete[] txt;
-}
-int GetXMLNode(FILE* dat, const char* NodeName, const char* ParentName, char* Value, int ResetFilePos)
-{
-	// ResetFilePos=1 leaves dat cursor in same position as when function was called. 0 leaves it at end of NodeName closure
-	// GetXMLNode returns 1 if NodeName found, 0 otherwise. If NodeName not found, ParentName closure must be
-
-	char* buf = new char[65536];
-	char* CloseNode = new char[2048];
-	char* CloseParent = new char[2048];
-	int CurPos, ret;
-
-	Files::xsprintf(CloseParent, "/%s", ParentName);
-	CurPos = ftell(dat);
-	do
-	{
-		Files::xfscanf(dat, 1, "%*[^<]<%[^>]", buf);
-	} while ((strcmp(buf, CloseParent) != 0) && (strcmp(buf, NodeName) != 0) && (!feof(dat)));
-	if (strcmp(buf, CloseParent) == 0)
-		ret = 0;
-	else
-	{
-		if (strcmp(buf, NodeName) != 0) ERR_CRITICAL("Incomplete node specification in XML file\n");
-		Files::xfscanf(dat, 1, ">%[^<]", buf);
-		if (strlen(buf) < 2048) strcpy(Value, buf);
-		//		Files::xfprintf_stderr("# %s=%s\n",NodeName,Value);
-		Files::xfscanf(dat, 1, "<%[^>]", buf);
-		Files::xsprintf(CloseNode, "/%s", NodeName);
-		if (strcmp(buf, CloseNode) != 0) ERR_CRITICAL("Incomplete node specification in XML file\n");
-		ret = 1;
-	}
-	if (ResetFilePos) fseek(dat, CurPos, 0);
-	delete[] buf;
-	delete[] CloseNode;
-	delete[] CloseParent;
-	return ret;
+	Files::xfprintf_stderr("%i interventions read\n", (int)specs.size());
 }
 
 void ReadAirTravel(std::string const& air_travel_file, std::string const& output_file_base)
@@ -814,12 +1023,15 @@ void ReadAirTravel(std::string const& air_travel_file, std::string const& output
 					AirTravelDist[l] += (double) Airports[i].total_traffic * Airports[i].prop_traffic[j];
 			}
 		}
-	outname = output_file_base + ".airdist.xls";
-	dat = Files::xfopen(outname.c_str(), "wb");
-	Files::xfprintf(dat, "dist\tfreq\n");
-	for (i = 0; i < MAX_DIST; i++)
-		Files::xfprintf(dat, "%i\t%.10f\n", i, AirTravelDist[i]);
-	Files::xfclose(dat);
+	if (!output_file_base.empty())
+	{
+		outname = output_file_base + ".airdist.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "dist\tfreq\n");
+		for (i = 0; i < MAX_DIST; i++)
+			Files::xfprintf(dat, "%i\t%.10f\n", i, AirTravelDist[i]);
+		Files::xfclose(dat);
+	}
 }
 
 void UpdateEfficacyArray()
@@ -1004,43 +1216,20 @@ void InitModel(int run) // passing run number so we can save run number in the i
 
 	std::fill(HostsQuarantine.begin(), HostsQuarantine.end(), PersonQuarantine());
 #pragma omp parallel for schedule(static,1) default(none) \
-		shared(P, Hosts)
+		shared(P, Hosts, HostsState)
 	for (int tn = 0; tn < P.NumThreads; tn++)
 		for (int k = tn; k < P.PopSize; k+= P.NumThreads)
 		{
-			Hosts[k].absent_start_time = USHRT_MAX - 1;
-			Hosts[k].absent_stop_time = 0;
+			HostsState[k] = PersonState();
 			if (P.DoAirports) Hosts[k].PlaceLinks[P.HotelPlaceType] = -1;
-			Hosts[k].vacc_start_time = Hosts[k].treat_start_time = Hosts[k].isolation_start_time = Hosts[k].absent_start_time = Hosts[k].dct_start_time = Hosts[k].dct_trigger_time = USHRT_MAX - 1;
-			Hosts[k].treat_stop_time = Hosts[k].absent_stop_time = Hosts[k].dct_end_time = 0;
-			Hosts[k].to_die = 0;
-			Hosts[k].Travelling = 0;
-			Hosts[k].detected = 0; //set detected to zero initially: ggilani - 19/02/15
-			Hosts[k].detected_time = 0;
-			Hosts[k].digitalContactTraced = 0;
-			Hosts[k].set_susceptible();
-			Hosts[k].num_treats = 0;
-			Hosts[k].latent_time = Hosts[k].recovery_or_death_time = 0; //also set hospitalisation time to zero: ggilani 28/10/2014
-			Hosts[k].infector = -1;
-			Hosts[k].infect_type = 0;
-			Hosts[k].index_case_dct = 0;
-			Hosts[k].ProbAbsent =(float) ranf_mt(tn);
-			Hosts[k].ProbCare = (float) ranf_mt(tn);
-			Hosts[k].susc = (float)((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[HOST_AGE_GROUP(k)]) : 1.0);
-			if(P.SusceptibilitySD > 0) Hosts[k].susc *= (float) gen_gamma_mt(1 / (P.SusceptibilitySD * P.SusceptibilitySD), 1 / (P.SusceptibilitySD * P.SusceptibilitySD), tn);
-			if (P.DoSeverity)
-			{
-				Hosts[k].SARI_time		= USHRT_MAX - 1; //// think better to set to initialize to maximum possible value, but keep this way for now.
-				Hosts[k].Critical_time	= USHRT_MAX - 1;
-				Hosts[k].Stepdown_time	= USHRT_MAX - 1;
-				Hosts[k].Severity_Current = Severity::Asymptomatic;
-				Hosts[k].Severity_Final = Severity::Asymptomatic;
-				Hosts[k].set_susceptible();
-			}
+			HostsState[k].ProbAbsent =(float) ranf_mt(tn);
+			HostsState[k].ProbCare = (float) ranf_mt(tn);
+			HostsState[k].susc = (float)((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[HOST_AGE_GROUP(k)]) : 1.0);
+			if(P.SusceptibilitySD > 0) HostsState[k].susc *= (float) gen_gamma_mt(1 / (P.SusceptibilitySD * P.SusceptibilitySD), 1 / (P.SusceptibilitySD * P.SusceptibilitySD), tn);
 		}
 
 #pragma omp parallel for reduction(+:nim) schedule(static,1) default(none) \
-		shared(P, Cells, Hosts, Households)
+		shared(P, Cells, Hosts, HostsState, Households)
 	for (int tn = 0; tn < P.NumThreads; tn++)
 	{
 		for (int i = tn; i < P.NumCells; i += P.NumThreads)
@@ -1051,7 +1240,7 @@ void InitModel(int run) // passing run number so we can save run number in the i
 				{
 					int k = Cells[i].members[j];
 					Cells[i].susceptible[j] = k; //added this in here instead
-					Hosts[k].listpos = j;
+					HostsState[k].listpos = j;
 				}
 				Cells[i].S = Cells[i].n;
 				Cells[i].L = Cells[i].I = Cells[i].R = Cells[i].cumTC = Cells[i].D = 0;
@@ -1090,6 +1279,11 @@ void InitModel(int run) // passing run number so we can save run number in the i
 						}
 					}
 			}
+			else
+				// Nobody in this cell was touched last realisation, so its list is as
+				// it was; the positions in it were reset with the rest of HostsState.
+				for (int j = 0; j < Cells[i].n; j++)
+					HostsState[Cells[i].susceptible[j]].listpos = j;
 		}
 	}
 
@@ -1200,14 +1394,13 @@ void InitModel(int run) // passing run number so we can save run number in the i
 	//initialise event log to zero at the beginning of every run: ggilani - 10/10/2014. UPDATE: 15/10/14 - we are now going to store all events from all realisations in one file
 	if ((P.DoRecordInfEvents) && (P.RecordInfEventsPerRun))
 	{
-		nEvents = 0;
-		for (int i = 0; i < P.MaxInfEvents; i++)
-		{
-			InfEventLog[i].t = InfEventLog[i].infectee_x = InfEventLog[i].infectee_y = InfEventLog[i].t_infector = 0.0;
-			InfEventLog[i].infectee_ind = InfEventLog[i].infector_ind = 0;
-			InfEventLog[i].infectee_adunit = InfEventLog[i].listpos = InfEventLog[i].infectee_cell = InfEventLog[i].infector_cell = InfEventLog[i].thread = 0;
-		}
+		InfEventLog.clear();
+		for (int i = 0; i < P.NumThreads; i++) InfEventLogT[i].clear();
 	}
+	// Otherwise keep the events of an earlier attempt at calibrating this run
+	// apart from this one's, as both start at time zero.
+	else if (P.DoRecordInfEvents)
+		EventLog::collect(InfEventLogT, P.NumThreads, InfEventLog);
 
 	int* NumSeedingInfections_byLocation = new int[P.NumSeedLocations];
 	for (int i = 0; i < P.NumSeedLocations; i++) NumSeedingInfections_byLocation[i] = (int) (((double) P.NumInitialInfections[i]) * P.InitialInfectionsAdminUnitWeight[i]* P.SeedingScaling +0.5);
@@ -1263,7 +1456,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 			for (int Infection = 0; (Infection < NumSeedingInfections_byLocation[SeedLocation]) && (NumMCellSeedingChoices < 10000); Infection++)
 			{
 				int Person = Mcells[mcellnum].members[(int)(ranf() * ((double)Mcells[mcellnum].n))]; //// randomly choose member of microcell mcellnum. Name this member l
-				if (Hosts[Person].is_susceptible()) //// If Host l is uninfected.
+				if (HostsState[Person].is_susceptible()) //// If Host l is uninfected.
 				{
 					if ((CalcPersonSusc(Person, 0, 0) > 0) && (Hosts[Person].age <= P.MaxAgeForInitialInfection) &&
 						(P.CareHomeAllowInitialInfections || P.CareHomePlaceType < 0 || Hosts[Person].PlaceLinks[P.CareHomePlaceType] < 0))
@@ -1274,8 +1467,8 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 							P.LocationInitialInfection[SeedLocation][0] = Households[Hosts[Person].hh].loc.x;
 							P.LocationInitialInfection[SeedLocation][1] = Households[Hosts[Person].hh].loc.y;
 						}
-						Hosts[Person].infector = -2;
-						Hosts[Person].infect_type = INFECT_TYPE_MASK - 1;
+						HostsState[Person].infector = -2;
+						HostsState[Person].infect_type = INFECT_TYPE_MASK - 1;
 						DoInfect(Person, t, 0, run); ///// guessing this updates a number of things about person l at time t in thread 0 for this run.
 						NumMCellSeedingChoices = 0;
 					}
@@ -1306,7 +1499,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 				{
 					// choose Peron within microcell
 					Person = Mcells[mcellnum].members[(int)(ranf() * ((double)Mcells[mcellnum].n))];
-					if (Hosts[Person].is_susceptible())
+					if (HostsState[Person].is_susceptible())
 					{
 						if ((CalcPersonSusc(Person, 0, 0) > 0) && // if person has non-zero susceptibility
 							(Hosts[Person].age <= P.MaxAgeForInitialInfection) && // and they're not too young
@@ -1314,7 +1507,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 						{
 							P.LocationInitialInfection[SeedLocation][0] = Households[Hosts[Person].hh].loc.x;
 							P.LocationInitialInfection[SeedLocation][1] = Households[Hosts[Person].hh].loc.y;
-							Hosts[Person].infector = -2; Hosts[Person].infect_type = INFECT_TYPE_MASK - 1;
+							HostsState[Person].infector = -2; HostsState[Person].infect_type = INFECT_TYPE_MASK - 1;
 							DoInfect(Person, t, 0, run);
 							NumMCellSeedingChoices = 0; // can move on from do-while loop
 						}
@@ -1349,7 +1542,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 
 				/// having chosen microcell, choose person to potentially infect
 				Person = Mcells[mcellnum].members[(int)(ranf() * ((double)Mcells[mcellnum].n))];
-				if (Hosts[Person].is_susceptible())
+				if (HostsState[Person].is_susceptible())
 				{
 					if ((CalcPersonSusc(Person, 0, 0) > 0) && // if person has non-zero susceptibility
 						(Hosts[Person].age <= P.MaxAgeForInitialInfection) && // and they're not too young
@@ -1357,7 +1550,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 					{
 						P.LocationInitialInfection[SeedLocation][0] = Households[Hosts[Person].hh].loc.x;
 						P.LocationInitialInfection[SeedLocation][1] = Households[Hosts[Person].hh].loc.y;
-						Hosts[Person].infector = -2; Hosts[Person].infect_type = INFECT_TYPE_MASK - 1;
+						HostsState[Person].infector = -2; HostsState[Person].infect_type = INFECT_TYPE_MASK - 1;
 						DoInfect(Person, t, 0, run);
 						NumMCellSeedingChoices = 0;
 					}
@@ -1380,7 +1573,7 @@ void SeedInfection(double t, int* NumSeedingInfections_byLocation, int AlreadyIn
 	if (NumMCellSeedingChoices > 0) Files::xfprintf_stderr("### Seeding error ###\n");
 }
 
-int RunModel(int run, std::string const& snapshot_save_file, std::string const& snapshot_load_file, std::string const& output_file_base)
+int RunModel(int run, std::string const& snapshot_save_file, std::string const& snapshot_load_file, std::string const& output_file_base, RealisationCheckpoint::RunPoint const* resume)
 {
 	//// **** Structure of function is as follows. For each timestep: 
 		// i) Seed Infections with SeedInfection function
@@ -1397,7 +1590,13 @@ int RunModel(int run, std::string const& snapshot_save_file, std::string const&
 	int continueEvents = 1;
 
 	InterruptRun = 0; // global variable set to zero at start of RunModel, and possibly modified in CalibrationThresholdCheck
-	if (snapshot_load_file.empty())
+	if (resume)
+	{
+		// P.ts_age was restored with the rest of the checkpoint.
+		CurrSimTime = resume->sim_time;
+		PreviousProportionSusceptible = resume->prop_susceptible;
+	}
+	else if (snapshot_load_file.empty())
 	{
 		CurrSimTime = 0;
 		P.ts_age = 0;
@@ -1408,8 +1607,13 @@ int RunModel(int run, std::string const& snapshot_save_file, std::string const&
 		CurrSimTime = ((double)P.ts_age) * P.ModelTimeStep;
 	}
 
-	for (OutputTimeStepNumber = 1; ((OutputTimeStepNumber < P.NumOutputTimeSteps) && (!InterruptRun)); OutputTimeStepNumber++) // OutputTimeStepNumber starts from 1 here as is zero in InitModel
+	for (OutputTimeStepNumber = (resume) ? resume->output_time_step : 1; ((OutputTimeStepNumber < P.NumOutputTimeSteps) && (!InterruptRun)); OutputTimeStepNumber++) // OutputTimeStepNumber starts from 1 here as is zero in InitModel
 	{
+		//// Checkpoint for restarting if the epidemic dies out later, once calibration (which reruns the realisation from the start) is done.
+		if ((P.ExtinctRestartTime >= 0) && (CurrSimTime >= P.ExtinctRestartTime) && ExtinctionCheckpoint.empty()
+			&& KeepRunning && (State.L + State.I > 0) && ((P.DoNoCalibration) || (P.StopCalibration)))
+			ExtinctionCheckpoint.save({ OutputTimeStepNumber, CurrSimTime, PreviousProportionSusceptible });
+
 		RecordSample				(CurrSimTime, OutputTimeStepNumber - 1, output_file_base);
 		CalibrationThresholdCheck	(CurrSimTime, OutputTimeStepNumber - 1);
 		UpdateCFRs					(CurrSimTime - P.Epidemic_StartDate_CalTime); 
@@ -1478,7 +1682,7 @@ int RunModel(int run, std::string const& snapshot_save_file, std::string const&
 								do
 								{
 									Person = (int)(((double)P.PopSize) * ranf()); //// choose person lPerson randomly from entire population. (but change person if they're dead or not a false positive)
-								} while (Hosts[Person].is_dead() || (ranf() > P.FalsePositiveAgeRate[HOST_AGE_GROUP(Person)]));
+								} while (HostsState[Person].is_dead() || (ranf() > P.FalsePositiveAgeRate[HOST_AGE_GROUP(Person)]));
 								DoFalseCase(Person, CurrSimTime, CurrTimeStep, 0);
 							}
 						}
@@ -1538,7 +1742,7 @@ int RunModel(int run, std::string const& snapshot_save_file, std::string const&
 			TravelReturnSweep(t2);
 	}
 
-	if(!InterruptRun) RecordInfTypes();
+	if(!InterruptRun) RecordInfTypes(resume == NULL);
 	return (InterruptRun);
 }
 
@@ -1654,13 +1858,160 @@ void SaveOriginDestMatrix(std::string const& output_file_base)
 	Files::xfclose(dat);
 }
 
-void SaveResults(std::string const& output_file_base)
+void SaveBinaryResults(std::string const& output_file_base, std::vector<ResultsFile::TableSource> const& tables, bool summary)
+{
+	std::vector<std::string> adunit_names;
+	if (P.DoAdUnits)
+		for (int i = 0; i < P.NumAdunits; i++) adunit_names.push_back(AdUnits[i].ad_name);
+
+	// Output switches, as used by SaveResults, so ResultsToText writes the same tables.
+	std::vector<std::pair<std::string, double>> attributes = {
+		{ "OutputNonSeverity", P.OutputNonSeverity },
+		{ "OutputAdunit", P.DoAdUnits && P.DoAdunitOutput },
+		{ "OutputDigitalContactTracing", P.DoDigitalContactTracing && P.DoAdUnits && P.OutputDigitalContactTracing },
+		{ "OutputKeyWorker", P.KeyWorkerProphTimeStartBase < P.SimulationDuration },
+		{ "KeyWorkerNum", P.KeyWorkerNum },
+		{ "KeyWorkerIncHouseNum", P.KeyWorkerIncHouseNum },
+		{ "OutputSeverity", P.DoSeverity && P.OutputSeverity },
+		{ "OutputSeverityAdminUnit", P.DoAdUnits && P.OutputSeverityAdminUnit },
+		{ "OutputAdUnitAge", P.DoAdUnits && P.OutputAdUnitAge },
+		{ "OutputTimeStep", P.OutputTimeStep }
+	};
+	// Realisation counts change as the runs go on, so are only meaningful (and
+	// only safe to read from a background writer) for the summaries.
+	if (summary)
+	{
+		attributes.push_back({ "NRactual", P.NRactual });
+		attributes.push_back({ "NRactE", P.NRactE });
+		attributes.push_back({ "NRactNE", P.NRactNE });
+		if (P.ExtinctRestartTime >= 0)
+		{
+			attributes.push_back({ "NRactRestarted", P.NRactRestarted });
+			attributes.push_back({ "NRactRestartedNE", P.NRactRestartedNE });
+		}
+	}
+	std::string outname = output_file_base + ".results.bin";
+	ResultsFile::write(outname, adunit_names, attributes, tables, P.CompressBinaryResults != 0);
+}
+
+Results* AcquireTimeSeries()
+{
+	{
+		std::lock_guard<std::mutex> lock(TimeSeriesPoolMutex);
+		if (!TimeSeriesPool.empty())
+		{
+			Results* time_series = TimeSeriesPool.back();
+			TimeSeriesPool.pop_back();
+			return time_series;
+		}
+	}
+	// Allocated as in SetupModel.
+	Results* time_series = (Results*)Memory::xcalloc(P.NumOutputTimeSteps, sizeof(Results));
+	if (P.DoAdUnits && P.OutputAdUnitAge)
+		for (int Time = 0; Time < P.NumOutputTimeSteps; Time++)
+		{
+			time_series[Time].prevInf_age_adunit = (double**)Memory::xcalloc(NUM_AGE_GROUPS, sizeof(double*));
+			time_series[Time].incInf_age_adunit = (double**)Memory::xcalloc(NUM_AGE_GROUPS, sizeof(double*));
+			time_series[Time].cumInf_age_adunit = (double**)Memory::xcalloc(NUM_AGE_GROUPS, sizeof(double*));
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				time_series[Time].prevInf_age_adunit[AgeGroup] = (double*)Memory::xcalloc(P.NumAdunits, sizeof(double));
+				time_series[Time].incInf_age_adunit[AgeGroup] = (double*)Memory::xcalloc(P.NumAdunits, sizeof(double));
+				time_series[Time].cumInf_age_adunit[AgeGroup] = (double*)Memory::xcalloc(P.NumAdunits, sizeof(double));
+			}
+		}
+	return time_series;
+}
+
+void ReleaseTimeSeries(Results* time_series)
+{
+	std::lock_guard<std::mutex> lock(TimeSeriesPoolMutex);
+	TimeSeriesPool.push_back(time_series);
+}
+
+void CopyTimeSeries(Results* dst, Results const* src)
+{
+	// Everything but the age by admin unit pointers, then what they point to.
+	for (int Time = 0; Time < P.NumOutputTimeSteps; Time++)
+	{
+		dst[Time].t = src[Time].t;
+		memcpy((double*)&dst[Time] + ResultsDoubleOffsetStart, (double const*)&src[Time] + ResultsDoubleOffsetStart,
+			sizeof(Results) - ResultsDoubleOffsetStart * sizeof(double));
+		if (P.DoAdUnits && P.OutputAdUnitAge)
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				memcpy(dst[Time].prevInf_age_adunit[AgeGroup], src[Time].prevInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				memcpy(dst[Time].incInf_age_adunit[AgeGroup], src[Time].incInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				memcpy(dst[Time].cumInf_age_adunit[AgeGroup], src[Time].cumInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+			}
+	}
+}
+
+// What AccumulateRealisation and the per-realisation outputs need of a realisation run in a worker process:
+// TimeSeries, the RecordInfTypes tables, the contact distribution and the simulation time of the trigger date.
+void PackRealisation(std::vector<char>& result)
+{
+	auto pack = [&result](void const* data, std::size_t size) { result.insert(result.end(), (char const*)data, (char const*)data + size); };
+	for (int Time = 0; Time < P.NumOutputTimeSteps; Time++)
+	{
+		pack(&TimeSeries[Time].t, sizeof(double));
+		pack((double const*)&TimeSeries[Time] + ResultsDoubleOffsetStart, sizeof(Results) - ResultsDoubleOffsetStart * sizeof(double));
+		if (P.DoAdUnits && P.OutputAdUnitAge)
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				pack(TimeSeries[Time].prevInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				pack(TimeSeries[Time].incInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				pack(TimeSeries[Time].cumInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+			}
+	}
+	pack(inftype, sizeof(inftype));
+	pack(infcountry, sizeof(infcountry));
+	pack(indivR0, sizeof(indivR0));
+	pack(inf_household, sizeof(inf_household));
+	pack(case_household, sizeof(case_household));
+	pack(State.contact_dist, (MAX_CONTACTS + 1) * sizeof(int));
+	pack(&P.DateTriggerReached_SimTime, sizeof(P.DateTriggerReached_SimTime));
+}
+
+void UnpackRealisation(std::vector<char> const& result)
+{
+	char const* next = result.data();
+	auto unpack = [&next](void* data, std::size_t size) { memcpy(data, next, size); next += size; };
+	for (int Time = 0; Time < P.NumOutputTimeSteps; Time++)
+	{
+		unpack(&TimeSeries[Time].t, sizeof(double));
+		unpack((double*)&TimeSeries[Time] + ResultsDoubleOffsetStart, sizeof(Results) - ResultsDoubleOffsetStart * sizeof(double));
+		if (P.DoAdUnits && P.OutputAdUnitAge)
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				unpack(TimeSeries[Time].prevInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				unpack(TimeSeries[Time].incInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+				unpack(TimeSeries[Time].cumInf_age_adunit[AgeGroup], P.NumAdunits * sizeof(double));
+			}
+	}
+	unpack(inftype, sizeof(inftype));
+	unpack(infcountry, sizeof(infcountry));
+	unpack(indivR0, sizeof(indivR0));
+	unpack(inf_household, sizeof(inf_household));
+	unpack(case_household, sizeof(case_household));
+	unpack(State.contact_dist, (MAX_CONTACTS + 1) * sizeof(int));
+	unpack(&P.DateTriggerReached_SimTime, sizeof(P.DateTriggerReached_SimTime));
+	if (next != result.data() + result.size()) ERR_CRITICAL("Realisation result from worker has the wrong size\n");
+}
+
+void SaveResults(std::string const& output_file_base, Results const* time_series, int const* contact_dist)
 {
 	int i, j;
 	FILE* dat;
 	std::string outname;
 
-	if (P.OutputNonSeverity)
+	// Tables that ResultsToText can regenerate from the results file are skipped
+	// when it replaces them.
+	bool text = (P.OutputBinaryResults != 2);
+	if (P.OutputBinaryResults)
+		SaveBinaryResults(output_file_base, { { "timeseries", time_series, P.NumOutputTimeSteps, P.DoAdUnits && P.OutputAdUnitAge } }, false);
+
+	if (text && P.OutputNonSeverity)
 	{
 		outname = output_file_base + ".xls";
 		dat = Files::xfopen(outname.c_str(), "wb");
@@ -1668,15 +2019,15 @@ void SaveResults(std::string const& output_file_base)
 		for(i = 0; i < P.NumOutputTimeSteps; i++)
 		{
 			Files::xfprintf(dat, "%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10ft%.10f\t%.10f\t%.10f\t%.10f\t%.10f\n",
-				TimeSeries[i].t, TimeSeries[i].S, TimeSeries[i].L, TimeSeries[i].I,
-				TimeSeries[i].R, TimeSeries[i].D, TimeSeries[i].incI,
-				TimeSeries[i].incR, TimeSeries[i].incFC, TimeSeries[i].incC, TimeSeries[i].incDC, TimeSeries[i].incTC, TimeSeries[i].incCT, TimeSeries[i].incCC,
-				TimeSeries[i].cumT, TimeSeries[i].cumTP, TimeSeries[i].cumV, TimeSeries[i].cumVG, TimeSeries[i].extinct, TimeSeries[i].rmsRad, TimeSeries[i].maxRad);
+				time_series[i].t, time_series[i].S, time_series[i].L, time_series[i].I,
+				time_series[i].R, time_series[i].D, time_series[i].incI,
+				time_series[i].incR, time_series[i].incFC, time_series[i].incC, time_series[i].incDC, time_series[i].incTC, time_series[i].incCT, time_series[i].incCC,
+				time_series[i].cumT, time_series[i].cumTP, time_series[i].cumV, time_series[i].cumVG, time_series[i].extinct, time_series[i].rmsRad, time_series[i].maxRad);
 		}
 		Files::xfclose(dat);
 	}
 
-	if ((P.DoAdUnits) && (P.DoAdunitOutput))
+	if (text && (P.DoAdUnits) && (P.DoAdunitOutput))
 	{
 		outname = output_file_base + ".adunit.xls";
 		dat = Files::xfopen(outname.c_str(), "wb");
@@ -1688,19 +2039,19 @@ void SaveResults(std::string const& output_file_base)
 		Files::xfprintf(dat, "\n");
 		for (i = 0; i < P.NumOutputTimeSteps; i++)
 		{
-			Files::xfprintf(dat, "%.10f", TimeSeries[i].t);
+			Files::xfprintf(dat, "%.10f", time_series[i].t);
 			for (j = 0; j < P.NumAdunits; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incI_adunit[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].incI_adunit[j]);
 			for (j = 0; j < P.NumAdunits; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incC_adunit[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].incC_adunit[j]);
 			for (j = 0; j < P.NumAdunits; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incDC_adunit[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].incDC_adunit[j]);
 			Files::xfprintf(dat, "\n");
 		}
 		Files::xfclose(dat);
 	}
 
-	if ((P.DoDigitalContactTracing) && (P.DoAdUnits) && (P.OutputDigitalContactTracing))
+	if (text && (P.DoDigitalContactTracing) && (P.DoAdUnits) && (P.OutputDigitalContactTracing))
 	{
 		outname = output_file_base + ".digitalcontacttracing.xls"; //modifying to csv file
 		dat = Files::xfopen(outname.c_str(), "wb");
@@ -1717,14 +2068,14 @@ void SaveResults(std::string const& output_file_base)
 		//print actual output
 		for(i=0; i<P.NumOutputTimeSteps; i++)
 		{
-			Files::xfprintf(dat, "%.10lf", TimeSeries[i].t);
+			Files::xfprintf(dat, "%.10lf", time_series[i].t);
 			for (j = 0; j < P.NumAdunits; j++)
 			{
-				Files::xfprintf(dat, "\t%.10lf", TimeSeries[i].incDCT_adunit[j]);
+				Files::xfprintf(dat, "\t%.10lf", time_series[i].incDCT_adunit[j]);
 			}
 			for (j = 0; j < P.NumAdunits; j++)
 			{
-				Files::xfprintf(dat, "\t%.10lf", TimeSeries[i].DCT_adunit[j]);
+				Files::xfprintf(dat, "\t%.10lf", time_series[i].DCT_adunit[j]);
 			}
 			Files::xfprintf(dat, "\n");
 		}
@@ -1740,12 +2091,12 @@ void SaveResults(std::string const& output_file_base)
 		Files::xfprintf(dat, "nContacts\tFrequency\n");
 		for (i = 0; i < (MAX_CONTACTS + 1); i++)
 		{
-			Files::xfprintf(dat, "%i\t%i\n", i, State.contact_dist[i]);
+			Files::xfprintf(dat, "%i\t%i\n", i, contact_dist[i]);
 		}
 		Files::xfclose(dat);
 	}
 
-	if(P.KeyWorkerProphTimeStartBase < P.SimulationDuration)
+	if(text && P.KeyWorkerProphTimeStartBase < P.SimulationDuration)
 	{
 		outname = output_file_base + ".keyworker.xls";
 		dat = Files::xfopen(outname.c_str(), "wb");
@@ -1756,13 +2107,13 @@ void SaveResults(std::string const& output_file_base)
 		Files::xfprintf(dat, "\t%i\t%i\n", P.KeyWorkerNum, P.KeyWorkerIncHouseNum);
 		for(i = 0; i < P.NumOutputTimeSteps; i++)
 		{
-			Files::xfprintf(dat, "%.10f", TimeSeries[i].t);
+			Files::xfprintf(dat, "%.10f", time_series[i].t);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incI_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].incI_keyworker[j]);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incC_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].incC_keyworker[j]);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumT_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", time_series[i].cumT_keyworker[j]);
 			Files::xfprintf(dat, "\n");
 		}
 		Files::xfclose(dat);
@@ -1773,8 +2124,8 @@ void SaveResults(std::string const& output_file_base)
 		outname = output_file_base + "%s.tree.xls";
 		dat = Files::xfopen(outname.c_str(), "wb");
 		for(i = 0; i < P.PopSize; i++)
-			if(Hosts[i].infect_type % INFECT_TYPE_MASK > 0)
-				Files::xfprintf(dat, "%i\t%i\t%i\t%i\n", i, Hosts[i].infector, Hosts[i].infect_type % INFECT_TYPE_MASK, (int)HOST_AGE_YEAR(i));
+			if(HostsState[i].infect_type % INFECT_TYPE_MASK > 0)
+				Files::xfprintf(dat, "%i\t%i\t%i\t%i\n", i, HostsState[i].infector, HostsState[i].infect_type % INFECT_TYPE_MASK, (int)HOST_AGE_YEAR(i));
 		Files::xfclose(dat);
 	}
 #if defined(_WIN32) || defined(IMAGE_MAGICK)
@@ -1782,7 +2133,7 @@ void SaveResults(std::string const& output_file_base)
 	int d, m, y, dml, f;
 #ifdef _WIN32
 	//if(P.OutputBitmap == 1) CloseAvi(avi);
-	//if((TimeSeries[P.NumOutputTimeSteps - 1].extinct) && (P.OutputOnlyNonExtinct))
+	//if((time_series[P.NumOutputTimeSteps - 1].extinct) && (P.OutputOnlyNonExtinct))
 	//	{
 	//	outname = output_file_base + ".ge" DIRECTORY_SEPARATOR + output_file_base + ".avi";
 	//	DeleteFile(outname);
@@ -1833,7 +2184,7 @@ void SaveResults(std::string const& output_file_base)
 #endif
 
 
-	if((P.DoSeverity)&&(P.OutputSeverity))
+	if(text && (P.DoSeverity)&&(P.OutputSeverity))
 	{
 		outname = output_file_base + ".severity.xls";
 		dat = Files::xfopen(outname.c_str(), "wb");
@@ -1841,12 +2192,12 @@ void SaveResults(std::string const& output_file_base)
 		for (i = 0; i < P.NumOutputTimeSteps; i++)
 		{
 			Files::xfprintf(dat, "%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\n",
-				TimeSeries[i].t, TimeSeries[i].Rdenom, TimeSeries[i].meanTG, TimeSeries[i].meanSI, TimeSeries[i].S, TimeSeries[i].I, TimeSeries[i].R, TimeSeries[i].incI,
-				TimeSeries[i].Mild		, TimeSeries[i].ILI		, TimeSeries[i].SARI	, TimeSeries[i].Critical	, TimeSeries[i].CritRecov	,
-				TimeSeries[i].incMild	, TimeSeries[i].incILI	, TimeSeries[i].incSARI	, TimeSeries[i].incCritical	, TimeSeries[i].incCritRecov,
-				TimeSeries[i].incD,	TimeSeries[i].incDeath_ILI, TimeSeries[i].incDeath_SARI, TimeSeries[i].incDeath_Critical,
-				TimeSeries[i].cumMild	, TimeSeries[i].cumILI	, TimeSeries[i].cumSARI	, TimeSeries[i].cumCritical	, TimeSeries[i].cumCritRecov, TimeSeries[i].D	,
-				TimeSeries[i].cumDeath_ILI, TimeSeries[i].cumDeath_SARI, TimeSeries[i].cumDeath_Critical);
+				time_series[i].t, time_series[i].Rdenom, time_series[i].meanTG, time_series[i].meanSI, time_series[i].S, time_series[i].I, time_series[i].R, time_series[i].incI,
+				time_series[i].Mild		, time_series[i].ILI		, time_series[i].SARI	, time_series[i].Critical	, time_series[i].CritRecov	,
+				time_series[i].incMild	, time_series[i].incILI	, time_series[i].incSARI	, time_series[i].incCritical	, time_series[i].incCritRecov,
+				time_series[i].incD,	time_series[i].incDeath_ILI, time_series[i].incDeath_SARI, time_series[i].incDeath_Critical,
+				time_series[i].cumMild	, time_series[i].cumILI	, time_series[i].cumSARI	, time_series[i].cumCritical	, time_series[i].cumCritRecov, time_series[i].D	,
+				time_series[i].cumDeath_ILI, time_series[i].cumDeath_SARI, time_series[i].cumDeath_Critical);
 		}
 		Files::xfclose(dat);
 
@@ -1881,37 +2232,37 @@ void SaveResults(std::string const& output_file_base)
 			/////// ****** /////// ****** /////// ****** Populate table.
 			for(i = 0; i < P.NumOutputTimeSteps; i++)
 			{
-				Files::xfprintf(dat, "%.10f", TimeSeries[i].t);
+				Files::xfprintf(dat, "%.10f", time_series[i].t);
 
 				//// prevalence
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].Mild_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].ILI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].SARI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].Critical_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].CritRecov_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].Mild_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].ILI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].SARI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].Critical_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].CritRecov_adunit[j]);
 
 				//// incidence
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incMild_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incILI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incSARI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incCritical_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incCritRecov_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incD_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incDeath_ILI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incDeath_SARI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].incDeath_Critical_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incMild_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incILI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incSARI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incCritical_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incCritRecov_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incD_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incDeath_ILI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incDeath_SARI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].incDeath_Critical_adunit[j]);
 
 				//// cumulative incidence
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumMild_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumILI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumSARI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumCritical_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumCritRecov_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumD_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumDeath_ILI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumDeath_SARI_adunit[j]);
-				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", TimeSeries[i].cumDeath_Critical_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumMild_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumILI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumSARI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumCritical_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumCritRecov_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumD_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumDeath_ILI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumDeath_SARI_adunit[j]);
+				for (j = 0; j < P.NumAdunits; j++)		Files::xfprintf(dat, "\t%.10f", time_series[i].cumDeath_Critical_adunit[j]);
 
 				if(i != P.NumOutputTimeSteps - 1) Files::xfprintf(dat, "\n");
 			}
@@ -1919,7 +2270,7 @@ void SaveResults(std::string const& output_file_base)
 		}
 	}
 
-	if (P.DoAdUnits && P.OutputAdUnitAge)
+	if (text && P.DoAdUnits && P.OutputAdUnitAge)
 	{
 		//// output infections by age and admin unit
 		outname = output_file_base + ".age.adunit.xls";
@@ -1941,22 +2292,63 @@ void SaveResults(std::string const& output_file_base)
 		// Populate
 		for (int Time = 0; Time < P.NumOutputTimeSteps; Time++)
 		{
-			Files::xfprintf(dat, "%.10f", TSMean[Time].t);
+			Files::xfprintf(dat, "%.10f", time_series[Time].t);
 			for (int AdUnit = 0; AdUnit < P.NumAdunits; AdUnit++)
 				for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
-					Files::xfprintf(dat, "\t%.10f", TimeSeries[Time].incInf_age_adunit[AgeGroup][AdUnit]);	// incidence
+					Files::xfprintf(dat, "\t%.10f", time_series[Time].incInf_age_adunit[AgeGroup][AdUnit]);	// incidence
 			for (int AdUnit = 0; AdUnit < P.NumAdunits; AdUnit++)
 				for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
-					Files::xfprintf(dat, "\t%.10f", TimeSeries[Time].prevInf_age_adunit[AgeGroup][AdUnit]);	// prevalence
+					Files::xfprintf(dat, "\t%.10f", time_series[Time].prevInf_age_adunit[AgeGroup][AdUnit]);	// prevalence
 			for (int AdUnit = 0; AdUnit < P.NumAdunits; AdUnit++)
 				for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
-					Files::xfprintf(dat, "\t%.10f", TimeSeries[Time].cumInf_age_adunit[AgeGroup][AdUnit]);	// cumulative incidence
+					Files::xfprintf(dat, "\t%.10f", time_series[Time].cumInf_age_adunit[AgeGroup][AdUnit]);	// cumulative incidence
 			Files::xfprintf(dat, "\n");
 		}
 		Files::xfclose(dat);
 	}
 }
 
+// Quantiles are kept for the scalar fields of Results, less t and the maxima cumTmax and cumVmax.
+std::vector<ResultsFile::Field> const& QuantileFields()
+{
+	static const std::vector<ResultsFile::Field> fields = []() {
+		std::vector<ResultsFile::Field> scalars;
+		for (std::size_t i = 0; i < ResultsFile::NumFields; i++)
+		{
+			ResultsFile::Field const& field = ResultsFile::Fields[i];
+			if ((field.extent == ResultsFile::Extent::Scalar) && (field.offset != offsetof(Results, t))
+				&& (field.offset != offsetof(Results, cumTmax)) && (field.offset != offsetof(Results, cumVmax)))
+				scalars.push_back(field);
+		}
+		return scalars;
+	}();
+	return fields;
+}
+
+void SaveQuantiles(std::string const& output_file_base)
+{
+	// Quantiles over the realisations in TSMean, estimated from the sketches AccumulateRealisation keeps.
+	static const double levels[] = { 0.025, 0.25, 0.5, 0.75, 0.975 };
+	std::vector<QuantileSketch> const& quantiles = (TSMean == TSMeanE) ? TSQuantilesE : TSQuantilesNE;
+	std::vector<ResultsFile::Field> const& fields = QuantileFields();
+	if (quantiles.empty()) return;
+
+	std::string outname = output_file_base + ".quantiles.xls";
+	FILE* dat = Files::xfopen(outname.c_str(), "wb");
+	Files::xfprintf(dat, "t");
+	for (ResultsFile::Field const& field : fields)
+		for (double level : levels) Files::xfprintf(dat, "\t%s_q%g", field.name, 100 * level);
+	Files::xfprintf(dat, "\n");
+	for (int i = 0; i < P.NumOutputTimeSteps; i++)
+	{
+		Files::xfprintf(dat, "%.10f", P.OutputTimeStep * i);
+		for (std::size_t f = 0; f < fields.size(); f++)
+			for (double level : levels) Files::xfprintf(dat, "\t%.10f", quantiles[i * fields.size() + f].quantile(level));
+		Files::xfprintf(dat, "\n");
+	}
+	Files::xfclose(dat);
+}
+
 void SaveSummaryResults(std::string const& output_file_base) //// calculates and saves summary results (called for average of extinct and non-extinct realisation time series - look in main)
 {
 	int i, j;
@@ -1964,6 +2356,13 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 	FILE* dat;
 	std::string outname;
 
+	// Raw accumulators: divide by NRactual for means and variances, except cumTmax
+	// and cumVmax which are maxima.
+	if (P.OutputBinaryResults)
+		SaveBinaryResults(output_file_base, { { "sum", TSMean, P.NumOutputTimeSteps, P.DoAdUnits && P.OutputAdUnitAge },
+		                                      { "sum_sq_dev", TSVar, P.NumOutputTimeSteps, false } }, true);
+	if (P.OutputQuantiles) SaveQuantiles(output_file_base);
+
 	c = 1 / ((double)(_I64(P.NRactE) + P.NRactNE));
 
 	if (P.OutputNonSeverity)
@@ -1972,7 +2371,7 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 		dat = Files::xfopen(outname.c_str(), "wb");
 		//// set colnames
 		Files::xfprintf(dat, "t\tS\tL\tI\tR\tD\tincI\tincR\tincD\tincC\tincDC\tincTC\tcumT\tcumTmax\tcumTP\tcumV\tcumVmax\tExtinct\trmsRad\tmaxRad\tvS\tvI\tvR\tvD\tvincI\tvincR\tvincFC\tvincC\tvincDC\tvincTC\tvrmsRad\tvmaxRad\t\t%i\t%i\t%.10f\t%.10f\t%.10f\t\t%.10f\t%.10f\t%.10f\t%.10f\n",
-			P.NRactNE, P.NRactE, P.R0household, P.R0places, P.R0spatial, c * PeakHeightSum, c * PeakHeightSS - c * c * PeakHeightSum * PeakHeightSum, c * PeakTimeSum, c * PeakTimeSS - c * c * PeakTimeSum * PeakTimeSum);
+			P.NRactNE, P.NRactE, P.R0household, P.R0places, P.R0spatial, c * PeakHeightSum, c * PeakHeightSS, c * PeakTimeSum, c * PeakTimeSS);
 		c = 1 / ((double)P.NRactual);
 
 		//// populate table
@@ -1983,18 +2382,18 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 				c * TSMean[i].D, c * TSMean[i].incI, c * TSMean[i].incR, c * TSMean[i].incFC, c * TSMean[i].incC, c * TSMean[i].incDC, c * TSMean[i].incTC,
 				c * TSMean[i].cumT, TSMean[i].cumTmax, c * TSMean[i].cumTP, c * TSMean[i].cumV, TSMean[i].cumVmax, c * TSMean[i].extinct, c * TSMean[i].rmsRad, c * TSMean[i].maxRad);
 			Files::xfprintf(dat, "%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\n",
-				c * TSVar[i].S		- c * c * TSMean[i].S		* TSMean[i].S,
-				c * TSVar[i].I		- c * c * TSMean[i].I		* TSMean[i].I,
-				c * TSVar[i].R		- c * c * TSMean[i].R		* TSMean[i].R,
-				c * TSVar[i].D		- c * c * TSMean[i].D		* TSMean[i].D,
-				c * TSVar[i].incI	- c * c * TSMean[i].incI	* TSMean[i].incI,
-				c * TSVar[i].incR	- c * c * TSMean[i].incR	* TSMean[i].incR,
-				c * TSVar[i].incD	- c * c * TSMean[i].incD	* TSMean[i].incD,
-				c * TSVar[i].incC	- c * c * TSMean[i].incC	* TSMean[i].incC,
-				c * TSVar[i].incDC	- c * c * TSMean[i].incDC	* TSMean[i].incDC, //added detected cases
-				c * TSVar[i].incTC	- c * c * TSMean[i].incTC	* TSMean[i].incTC,
-				c * TSVar[i].rmsRad - c * c * TSMean[i].rmsRad	* TSMean[i].rmsRad,
-				c * TSVar[i].maxRad - c * c * TSMean[i].maxRad	* TSMean[i].maxRad);
+				c * TSVar[i].S,
+				c * TSVar[i].I,
+				c * TSVar[i].R,
+				c * TSVar[i].D,
+				c * TSVar[i].incI,
+				c * TSVar[i].incR,
+				c * TSVar[i].incD,
+				c * TSVar[i].incC,
+				c * TSVar[i].incDC, //added detected cases
+				c * TSVar[i].incTC,
+				c * TSVar[i].rmsRad,
+				c * TSVar[i].maxRad);
 		}
 		Files::xfclose(dat);
 	}
@@ -2017,15 +2416,15 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 				c * TSMean[i].incAPC, c * TSMean[i].incAPA, c * TSMean[i].incAPCS,c*TSMean[i].PropSocDist);
 			for(j = 0; j < MAX_NUM_PLACE_TYPES; j++) Files::xfprintf(dat, "\t%lf", c * TSMean[i].PropPlacesClosed[j]);
 			Files::xfprintf(dat, "\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf",
-				c * TSVar[i].S - c * c * TSMean[i].S * TSMean[i].S,
-				c * TSVar[i].incC - c * c * TSMean[i].incC * TSMean[i].incC,
-				c * TSVar[i].incTC - c * c * TSMean[i].incTC * TSMean[i].incTC,
-				c * TSVar[i].incFC - c * c * TSMean[i].incFC * TSMean[i].incFC,
-				c * TSVar[i].cumT - c * c * TSMean[i].cumT * TSMean[i].cumT,
-				c * TSVar[i].cumUT - c * c * TSMean[i].cumUT * TSMean[i].cumUT,
-				c * TSVar[i].cumTP - c * c * TSMean[i].cumTP * TSMean[i].cumTP,
-				c * TSVar[i].cumV - c * c * TSMean[i].cumV * TSMean[i].cumV);
-			for(j = 0; j < MAX_NUM_PLACE_TYPES; j++) Files::xfprintf(dat, "\t%lf", TSVar[i].PropPlacesClosed[j]);
+				c * TSVar[i].S,
+				c * TSVar[i].incC,
+				c * TSVar[i].incTC,
+				c * TSVar[i].incFC,
+				c * TSVar[i].cumT,
+				c * TSVar[i].cumUT,
+				c * TSVar[i].cumTP,
+				c * TSVar[i].cumV);
+			for(j = 0; j < MAX_NUM_PLACE_TYPES; j++) Files::xfprintf(dat, "	%lf", c * TSVar[i].PropPlacesClosed[j]);
 			Files::xfprintf(dat, "\n");
 		}
 		Files::xfclose(dat);
@@ -2103,13 +2502,13 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 			{
 				Files::xfprintf(dat, "%.10f", c * TSMean[i].t);
 				for (j = 0; j < P.NumAdunits; j++)
-					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incI_adunit[j] - c * c * TSMean[i].incI_adunit[j] * TSMean[i].incI_adunit[j]);
+					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incI_adunit[j]);
 				for (j = 0; j < P.NumAdunits; j++)
-					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incC_adunit[j] - c * c * TSMean[i].incC_adunit[j] * TSMean[i].incC_adunit[j]);
+					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incC_adunit[j]);
 				for (j = 0; j < P.NumAdunits; j++)
-					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incDC_adunit[j] - c * c * TSMean[i].incDC_adunit[j] * TSMean[i].incDC_adunit[j]); //added detected cases: ggilani 03/02/15
+					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incDC_adunit[j]); //added detected cases: ggilani 03/02/15
 				for (j = 0; j < P.NumAdunits; j++)
-					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].cumT_adunit[j] - c * c * TSMean[i].cumT_adunit[j] * TSMean[i].cumT_adunit[j]);
+					Files::xfprintf(dat, "\t%.10f", c * TSVar[i].cumT_adunit[j]);
 				Files::xfprintf(dat, "\n");
 			}
 			Files::xfclose(dat);
@@ -2171,11 +2570,11 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 			for(j = 0; j < 2; j++)
 				Files::xfprintf(dat, "\t%.10f", c * TSMean[i].cumT_keyworker[j]);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incI_keyworker[j] - c * c * TSMean[i].incI_keyworker[j] * TSMean[i].incI_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incI_keyworker[j]);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incC_keyworker[j] - c * c * TSMean[i].incC_keyworker[j] * TSMean[i].incC_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].incC_keyworker[j]);
 			for(j = 0; j < 2; j++)
-				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].cumT_keyworker[j] - c * c * TSMean[i].cumT_keyworker[j] * TSMean[i].cumT_keyworker[j]);
+				Files::xfprintf(dat, "\t%.10f", c * TSVar[i].cumT_keyworker[j]);
 			Files::xfprintf(dat, "\n");
 		}
 		Files::xfclose(dat);
@@ -2307,38 +2706,38 @@ void SaveSummaryResults(std::string const& output_file_base) //// calculates and
 				c * TSMean[i].cumMild, c * TSMean[i].cumILI, c * TSMean[i].cumSARI, c * TSMean[i].cumCritical, c * TSMean[i].cumCritRecov, c*TSMean[i].D,
 				c * TSMean[i].cumDeath_ILI, c * TSMean[i].cumDeath_SARI, c * TSMean[i].cumDeath_Critical);
 			Files::xfprintf(dat, "%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\t%.10f\n",
-				c* TSVar[i].PropSocDist- c * TSMean[i].PropSocDist* c * TSMean[i].PropSocDist,
-				c* TSVar[i].Rdenom - c * TSMean[i].Rdenom * c * TSMean[i].Rdenom,
-				c* TSVar[i].meanTG - c * TSMean[i].meanTG * c * TSMean[i].meanTG,
-				c* TSVar[i].meanSI - c * TSMean[i].meanSI * c * TSMean[i].meanSI,
-				c* TSVar[i].S- c * TSMean[i].S* c * TSMean[i].S,
-				c* TSVar[i].I- c * TSMean[i].I* c * TSMean[i].I,
-				c* TSVar[i].R- c * TSMean[i].R* c * TSMean[i].R,
-				c* TSVar[i].incI- c * TSMean[i].incI* c * TSMean[i].incI,
-				c* TSVar[i].incC- c * TSMean[i].incC* c * TSMean[i].incC,
-				c* TSVar[i].Mild- c * TSMean[i].Mild* c * TSMean[i].Mild,
-				c* TSVar[i].ILI- c * TSMean[i].incILI* c * TSMean[i].incILI,
-				c* TSVar[i].SARI- c * TSMean[i].SARI* c * TSMean[i].SARI,
-				c* TSVar[i].Critical- c * TSMean[i].Critical* c * TSMean[i].Critical,
-				c* TSVar[i].CritRecov- c * TSMean[i].CritRecov* c * TSMean[i].CritRecov,
-				c* TSVar[i].incMild- c * TSMean[i].incMild* c * TSMean[i].incMild,
-				c* TSVar[i].incILI- c * TSMean[i].incILI* c * TSMean[i].incILI,
-				c* TSVar[i].incSARI- c * TSMean[i].incSARI* c * TSMean[i].incSARI,
-				c* TSVar[i].incCritical- c * TSMean[i].incCritical* c * TSMean[i].incCritical,
-				c* TSVar[i].incCritRecov- c * TSMean[i].incCritRecov* c * TSMean[i].incCritRecov,
-				c* TSVar[i].incD- c * TSMean[i].incD* c * TSMean[i].incD,
-				c* TSVar[i].incDeath_ILI- c * TSMean[i].incDeath_ILI* c * TSMean[i].incDeath_ILI,
-				c* TSVar[i].incDeath_SARI- c * TSMean[i].incDeath_SARI* c * TSMean[i].incDeath_SARI,
-				c* TSVar[i].incDeath_Critical- c * TSMean[i].incDeath_Critical* c * TSMean[i].incDeath_Critical,
-				c* TSVar[i].cumMild- c * TSMean[i].cumMild* c * TSMean[i].cumMild,
-				c* TSVar[i].cumILI- c * TSMean[i].cumILI* c * TSMean[i].cumILI,
-				c* TSVar[i].cumSARI- c * TSMean[i].cumSARI* c * TSMean[i].cumSARI,
-				c* TSVar[i].cumCritical- c * TSMean[i].cumCritical* c * TSMean[i].cumCritical,
-				c* TSVar[i].cumCritRecov- c * TSMean[i].cumCritRecov* c * TSMean[i].cumCritRecov,
-				c* TSVar[i].D- c * TSMean[i].D* c * TSMean[i].D,
-				c* TSVar[i].cumDeath_ILI- c * TSMean[i].cumDeath_ILI* c * TSMean[i].cumDeath_ILI,
-				c* TSVar[i].cumDeath_SARI- c * TSMean[i].cumDeath_SARI* c * TSMean[i].cumDeath_SARI,
-				c* TSVar[i].cumDeath_Critical- c * TSMean[i].cumDeath_Critical* c * TSMean[i].cumDeath_Critical);
+				c * TSVar[i].PropSocDist,
+				c * TSVar[i].Rdenom,
+				c * TSVar[i].meanTG,
+				c * TSVar[i].meanSI,
+				c * TSVar[i].S,
+				c * TSVar[i].I,
+				c * TSVar[i].R,
+				c * TSVar[i].incI,
+				c * TSVar[i].incC,
+				c * TSVar[i].Mild,
+				c * TSVar[i].ILI,
+				c * TSVar[i].SARI,
+				c * TSVar[i].Critical,
+				c * TSVar[i].CritRecov,
+				c * TSVar[i].incMild,
+				c * TSVar[i].incILI,
+				c * TSVar[i].incSARI,
+				c * TSVar[i].incCritical,
+				c * TSVar[i].incCritRecov,
+				c * TSVar[i].incD,
+				c * TSVar[i].incDeath_ILI,
+				c * TSVar[i].incDeath_SARI,
+				c * TSVar[i].incDeath_Critical,
+				c * TSVar[i].cumMild,
+				c * TSVar[i].cumILI,
+				c * TSVar[i].cumSARI,
+				c * TSVar[i].cumCritical,
+				c * TSVar[i].cumCritRecov,
+				c * TSVar[i].D,
+				c * TSVar[i].cumDeath_ILI,
+				c * TSVar[i].cumDeath_SARI,
+				c * TSVar[i].cumDeath_Critical);
 		}
 		Files::xfclose(dat);
 
@@ -2593,27 +2992,27 @@ void SaveRandomSeeds(std::string const& output_file_base)
 	Files::xfclose(dat);
 }
 
-void SaveEvents(std::string const& output_file_base)
+void SaveEvents(std::string const& output_file_base, Events const* events, int num_events)
 {
-	/* function: SaveEvents(std::string const&)
+	/* function: SaveEvents(std::string const&, Events const*, int)
 	 *
 	 * Purpose: outputs event log to a csv file if required
-	 * Parameters: name of output file
+	 * Parameters: name of output file, events to save and their number; at most P.MaxInfEvents are saved
 	 * Returns: none
 	 *
 	 * Author: ggilani, 15/10/2014
 	 */
-	int i;
-	
+	if (P.OutputBinaryInfEvents == 2) return;
 	std::string outname = output_file_base + ".infevents.xls";
-	FILE* dat = Files::xfopen(outname.c_str(), "wb");
-	Files::xfprintf(dat, "type,t,thread,ind_infectee,cell_infectee,listpos_infectee,adunit_infectee,x_infectee,y_infectee,t_infector,ind_infector,cell_infector\n");
-	for (i = 0; i < nEvents; i++)
-	{
-		Files::xfprintf(dat, "%i\t%.10f\t%i\t%i\t%i\t%i\t%i\t%.10f\t%.10f\t%.10f\t%i\t%i\n",
-			InfEventLog[i].type, InfEventLog[i].t, InfEventLog[i].thread, InfEventLog[i].infectee_ind, InfEventLog[i].infectee_cell, InfEventLog[i].listpos, InfEventLog[i].infectee_adunit, InfEventLog[i].infectee_x, InfEventLog[i].infectee_y, InfEventLog[i].t_infector, InfEventLog[i].infector_ind, InfEventLog[i].infector_cell);
-	}
-	Files::xfclose(dat);
+	EventLog::write_text(outname, events, (std::size_t)std::min(num_events, P.MaxInfEvents));
+}
+
+void SaveBinaryEvents(std::string const& output_file_base, Events const* events, std::size_t num_events, bool append)
+{
+	if (!P.OutputBinaryInfEvents) return;
+	std::string outname = output_file_base + ".infevents.bin";
+	if (!append) EventLog::create(outname);
+	EventLog::append(outname, events, num_events);
 }
 
 void LoadSnapshot(std::string const& snapshot_load_file)
@@ -2660,6 +3059,8 @@ void LoadSnapshot(std::string const& snapshot_load_file)
 
 	Files::fread_big((void*)Hosts, sizeof(Person), (size_t)P.PopSize, dat);
 	Files::xfprintf_stderr(".");
+	Files::fread_big((void*)HostsState.data(), sizeof(PersonState), (size_t)P.PopSize, dat);
+	Files::xfprintf_stderr(".");
 	Files::fread_big((void*)Households, sizeof(Household), (size_t)P.NumHouseholds, dat);
 	Files::xfprintf_stderr(".");
 	Files::fread_big((void*)Cells, sizeof(Cell), (size_t)P.NumCells, dat);
@@ -2732,6 +3133,7 @@ void SaveSnapshot(std::string const& snapshot_save_file)
 	Files::xfprintf_stderr("## %i\n", i++);
 
 	Files::fwrite_big((void*)Hosts, sizeof(Person), (size_t)P.PopSize, dat);
+	Files::fwrite_big((void*)HostsState.data(), sizeof(PersonState), (size_t)P.PopSize, dat);
 
 	Files::xfprintf_stderr("## %i\n", i++);
 	Files::fwrite_big((void*)Households, sizeof(Household), (size_t)P.NumHouseholds, dat);
@@ -2776,6 +3178,11 @@ void UpdateProbs(int DoPlace)
 			CellLookup[j]->tot_prob = 0;
 		}
 	}
+	UpdateProbsFromS0();
+}
+
+void UpdateProbsFromS0(void)
+{
 #pragma omp parallel for schedule(static,500) default(none) \
 		shared(P, CellLookup)
 	for (int j = 0; j < P.NumPopulatedCells; j++)
@@ -3008,14 +3415,18 @@ void RecordAdminAgeBreakdowns(int t_int)
 void RecordQuarNotInfected(int n, unsigned short int TimeStepNow)
 {
 	int QuarNotInfected = 0, QuarNotSymptomatic = 0;
+	//// No one can be in quarantine before any household has complied with it, so skip the sweep of the population until then.
+	if (State.cumHQ > 0)
+	{
 #pragma omp parallel for schedule(static,1) reduction(+:QuarNotInfected, QuarNotSymptomatic)
-	for (int thread_no = 0; thread_no < P.NumThreads; thread_no++)
-		for (int Person = thread_no; Person < P.PopSize; Person += P.NumThreads)
-			if (HOST_QUARANTINED(Person))
-			{
-				if (Hosts[Person].is_susceptible() || Hosts[Person].is_recovered()) QuarNotInfected++;
-				if (Hosts[Person].is_never_symptomatic()) QuarNotSymptomatic++;
-			}
+		for (int thread_no = 0; thread_no < P.NumThreads; thread_no++)
+			for (int Person = thread_no; Person < P.PopSize; Person += P.NumThreads)
+				if (HOST_QUARANTINED(Person))
+				{
+					if (HostsState[Person].is_susceptible() || HostsState[Person].is_recovered()) QuarNotInfected++;
+					if (HostsState[Person].is_never_symptomatic()) QuarNotSymptomatic++;
+				}
+	}
 
 	TimeSeries[n].prevQuarNotInfected		= (double) QuarNotInfected;
 	TimeSeries[n].prevQuarNotSymptomatic	= (double) QuarNotSymptomatic;
@@ -3462,7 +3873,8 @@ void RecordSample(double t, int n, std::string const& output_file_base)
 			State.NumPlacesClosed[i] = numPC;
 			TimeSeries[n].PropPlacesClosed[i] = ((double)numPC) / ((double)P.Nplace[i]);
 		}
-	for (int i = k = 0; i < P.NumMicrocells; i++) if (Mcells[i].socdist == TreatStat::Treated) k++;
+	//// Only populated microcells are ever socially distanced (see TreatSweep), so there's no need to visit the rest.
+	for (int i = k = 0; i < P.NumPopulatedMicrocells; i++) if (McellLookup[i]->socdist == TreatStat::Treated) k++;
 	TimeSeries[n].PropSocDist = ((double)k) / ((double)P.NumMicrocells);
 
 	//update contact number distribution in State
@@ -3688,7 +4100,7 @@ void CalibrationThresholdCheck(double t,int n)
 	}
 }
 
-void CalcLikelihood(int run, std::string const& DataFile, std::string const& OutFileBase)
+void CalcLikelihood(int run, std::string const& DataFile, std::string const& OutFileBase, bool ToStdout)
 {
 	FILE* dat;
 
@@ -3842,6 +4254,13 @@ void CalcLikelihood(int run, std::string const& DataFile, std::string const& Out
 	if (run + 1 == P.NumRealisations) // at final realisation, output log-likelihood
 	{
 		LL = sumL - log((double)P.NumRealisations);
+		if (ToStdout)
+		{
+			// Reply to a driver sending fitting iterations on stdin.
+			Files::xfprintf(stdout, "%i\t%.8lg\n", P.FitIter, LL);
+			fflush(stdout);
+			return;
+		}
 		std::string TmpFile = OutFileBase + ".ll.tmp";
 		std::string OutFile = OutFileBase + ".ll.txt";
 		dat = Files::xfopen(TmpFile.c_str(), "w");
@@ -3851,11 +4270,10 @@ void CalcLikelihood(int run, std::string const& DataFile, std::string const& Out
 	}
 }
 
-void RecordInfTypes(void)
+void RecordInfTypes(bool accumulate)
 {
 	int i, j, k, l, lc, lc2, b, c, n, i2;
-	unsigned int nf;
-	double* res, * res_av, * res_var, t, s = 0;
+	double t, s = 0;
 
 	for (n = 0; n < P.NumOutputTimeSteps; n++)
 	{
@@ -3874,7 +4292,7 @@ void RecordInfTypes(void)
 	for (b = 0; b < P.NumCells; b++)
 		if ((Cells[b].S != Cells[b].n) || (Cells[b].R > 0))
 			for (c = 0; c < Cells[b].n; c++)
-				Hosts[Cells[b].members[c]].listpos = 0;
+				HostsState[Cells[b].members[c]].listpos = 0;
 	//	for(b=0;b<P.NumCells;b++)
 	//		if((Cells[b].S!=Cells[b].n)||(Cells[b].R>0))
 	{
@@ -3884,12 +4302,12 @@ void RecordInfTypes(void)
 		{
 			//				i=Cells[b].members[c];
 			if (j == 0) j = k = Households[Hosts[i].hh].nh;
-			if (!Hosts[i].is_susceptible() && !Hosts[i].is_immune_at_start())
+			if (!HostsState[i].is_susceptible() && !HostsState[i].is_immune_at_start())
 			{
-				if (Hosts[i].latent_time * P.ModelTimeStep <= P.SimulationDuration)
-					TimeSeries[(int)(Hosts[i].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rdenom++;
+				if (HostsState[i].latent_time * P.ModelTimeStep <= P.SimulationDuration)
+					TimeSeries[(int)(HostsState[i].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rdenom++;
 				infcountry[mcell_country[Hosts[i].mcell]]++;
-				if (Hosts[i].is_susceptible_or_infected())
+				if (HostsState[i].is_susceptible_or_infected())
 				{
 					l = -1;
 				}
@@ -3897,30 +4315,30 @@ void RecordInfTypes(void)
 				{
 					l++;
 				}
-				if ((l >= 0) && (Hosts[i].is_recovered_symp() || Hosts[i].is_dead_was_symp()))
+				if ((l >= 0) && (HostsState[i].is_recovered_symp() || HostsState[i].is_dead_was_symp()))
 				{
 					lc2++;
-					if (Hosts[i].latent_time * P.ModelTimeStep <= t) // This convoluted logic is to pick up households where the index is symptomatic
+					if (HostsState[i].latent_time * P.ModelTimeStep <= t) // This convoluted logic is to pick up households where the index is symptomatic
 					{
-						lc = 1; t = Hosts[i].latent_time * P.ModelTimeStep;
+						lc = 1; t = HostsState[i].latent_time * P.ModelTimeStep;
 					}
 				}
-				else if ((l > 0) && (Hosts[i].latent_time * P.ModelTimeStep < t))
+				else if ((l > 0) && (HostsState[i].latent_time * P.ModelTimeStep < t))
 				{
-					lc = 0; t = Hosts[i].latent_time * P.ModelTimeStep;
+					lc = 0; t = HostsState[i].latent_time * P.ModelTimeStep;
 				}
-				i2 = Hosts[i].infector;
+				i2 = HostsState[i].infector;
 				if (i2 >= 0)
 				{
-					Hosts[i2].listpos++;
-					if (Hosts[i2].latent_time * P.ModelTimeStep <= P.SimulationDuration)
+					HostsState[i2].listpos++;
+					if (HostsState[i2].latent_time * P.ModelTimeStep <= P.SimulationDuration)
 					{
-						TimeSeries[(int)(Hosts[i2].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rtype[Hosts[i].infect_type % INFECT_TYPE_MASK]++;
-						TimeSeries[(int)(Hosts[i2].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rage[HOST_AGE_GROUP(i)]++;
+						TimeSeries[(int)(HostsState[i2].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rtype[HostsState[i].infect_type % INFECT_TYPE_MASK]++;
+						TimeSeries[(int)(HostsState[i2].latent_time * P.ModelTimeStep / P.OutputTimeStep)].Rage[HOST_AGE_GROUP(i)]++;
 					}
 				}
 			}
-			inftype[Hosts[i].infect_type % INFECT_TYPE_MASK]++;
+			inftype[HostsState[i].infect_type % INFECT_TYPE_MASK]++;
 			j--;
 			if (j == 0)
 			{
@@ -3936,12 +4354,35 @@ void RecordInfTypes(void)
 			for (c = 0; c < Cells[b].n; c++)
 			{
 				i = Cells[b].members[c];
-				if (Hosts[i].is_recovered() || Hosts[i].is_dead())
+				if (HostsState[i].is_recovered() || HostsState[i].is_dead())
 				{
-					l = Hosts[i].infect_type / INFECT_TYPE_MASK;
-					if ((l < MAX_GEN_REC) && (Hosts[i].listpos < MAX_SEC_REC)) indivR0[Hosts[i].listpos][l]++;
+					l = HostsState[i].infect_type / INFECT_TYPE_MASK;
+					if ((l < MAX_GEN_REC) && (HostsState[i].listpos < MAX_SEC_REC)) indivR0[HostsState[i].listpos][l]++;
 				}
 			}
+	k = (P.Interventions_StartDate_CalTime > 0) ? ((int)(P.Interventions_StartDate_CalTime - P.DateTriggerReached_SimTime)) : 0;
+	for (n = 0; n < P.NumOutputTimeSteps; n++)
+	{
+		TimeSeries[n].t += k;
+		s = 0;
+		if (TimeSeries[n].Rdenom == 0) TimeSeries[n].Rdenom = 1e-10;
+		for (i = 0; i < NUM_AGE_GROUPS; i++)
+			TimeSeries[n].Rage[i] /= TimeSeries[n].Rdenom;
+		for (i = 0; i < INFECT_TYPE_MASK; i++)
+			s += (TimeSeries[n].Rtype[i] /= TimeSeries[n].Rdenom);
+		TimeSeries[n].Rdenom = s;
+	}
+	if (accumulate) AccumulateRealisation();
+}
+
+void AccumulateRealisation(void)
+{
+	// Adds the realisation in TimeSeries and the RecordInfTypes tables to the means and variances.
+	int i, j, n, k, lc;
+	unsigned int nf;
+	// The peak is searched for starting from the values RecordInfTypes leaves in s and t.
+	double s = TimeSeries[P.NumOutputTimeSteps - 1].Rdenom, t = 1e10;
+
 	/* 	if(!TimeSeries[P.NumOutputTimeSteps-1].extinct) */
 	{
 		for (i = 0; i < INFECT_TYPE_MASK; i++) inftype_av[i] += inftype[i];
@@ -3961,44 +4402,34 @@ void RecordInfTypes(void)
 			}
 	}
 	k = (P.Interventions_StartDate_CalTime > 0) ? ((int)(P.Interventions_StartDate_CalTime - P.DateTriggerReached_SimTime)) : 0;
-	for (n = 0; n < P.NumOutputTimeSteps; n++)
-	{
-		TimeSeries[n].t += k;
-		s = 0;
-		if (TimeSeries[n].Rdenom == 0) TimeSeries[n].Rdenom = 1e-10;
-		for (i = 0; i < NUM_AGE_GROUPS; i++)
-			TimeSeries[n].Rage[i] /= TimeSeries[n].Rdenom;
-		for (i = 0; i < INFECT_TYPE_MASK; i++)
-			s += (TimeSeries[n].Rtype[i] /= TimeSeries[n].Rdenom);
-		TimeSeries[n].Rdenom = s;
-	}
 	nf = sizeof(Results) / sizeof(double);
 	if (!P.DoAdUnits) nf -= MAX_ADUNITS; // TODO: This still processes most of the AdUnit arrays; just not the last one
 
+	int count; // realisations already accumulated into TSMean and TSVar
 	if (TimeSeries[P.NumOutputTimeSteps - 1].extinct)
 	{
-		TSMean = TSMeanE; TSVar = TSVarE; P.NRactE++;
+		TSMean = TSMeanE; TSVar = TSVarE; count = P.NRactE++;
 	}
 	else
 	{
-		TSMean = TSMeanNE; TSVar = TSVarNE; P.NRactNE++;
+		TSMean = TSMeanNE; TSVar = TSVarNE; count = P.NRactNE++;
 	}
+	std::vector<QuantileSketch>& quantiles = (TSMean == TSMeanE) ? TSQuantilesE : TSQuantilesNE;
+	std::vector<ResultsFile::Field> const& quantile_fields = QuantileFields();
+	if (P.OutputQuantiles && quantiles.empty())
+		quantiles.assign(P.NumOutputTimeSteps * quantile_fields.size(), QuantileSketch(P.QuantileSketchSize));
 	lc = -k;
 
-	// This calculates sum and sum of squares of entire TimeSeries array
+	// This updates the sums and sums of squared deviations of the entire TimeSeries array.
+	// Time steps shifted out of range count as zeros.
 	for (n = 0; n < P.NumOutputTimeSteps; n++)
 	{
+		double* res_av = (double*)&TSMean[n] + ResultsDoubleOffsetStart /* skip over initial fields */;
+		double* res_var = (double*)&TSVar[n] + ResultsDoubleOffsetStart;
 		if ((n + lc >= 0) && (n + lc < P.NumOutputTimeSteps))
 		{
 			if (s < TimeSeries[n + lc].incC) { s = TimeSeries[n + lc].incC; t = P.OutputTimeStep * ((double)(_I64(n) + lc)); }
-			res = (double*)&TimeSeries[n + lc];
-			res_av = (double*)&TSMean[n];
-			res_var = (double*)&TSVar[n];
-			for (std::size_t i3 = ResultsDoubleOffsetStart /* skip over initial fields */; i3 < nf; i3++)
-			{
-				res_av[i3] += res[i3];
-				res_var[i3] += res[i3] * res[i3];
-			}
+			RunningStats::add((double const*)&TimeSeries[n + lc] + ResultsDoubleOffsetStart, res_av, res_var, nf - ResultsDoubleOffsetStart, count);
 			if (P.DoAdUnits && P.OutputAdUnitAge)
 				for (std::size_t age = 0; age < NUM_AGE_GROUPS; ++age)
 					for (std::size_t adunit = 0; adunit < (size_t) P.NumAdunits; ++adunit)
@@ -4011,12 +4442,20 @@ void RecordInfTypes(void)
 			if (TSMean[n].cumTmax < TimeSeries[n + lc].cumT) TSMean[n].cumTmax = TimeSeries[n + lc].cumT;
 			if (TSMean[n].cumVmax < TimeSeries[n + lc].cumV) TSMean[n].cumVmax = TimeSeries[n + lc].cumV;
 		}
+		else
+			RunningStats::add(NULL, res_av, res_var, nf - ResultsDoubleOffsetStart, count);
+		if (P.OutputQuantiles)
+			for (std::size_t f = 0; f < quantile_fields.size(); f++)
+			{
+				double x = 0.0;
+				if ((n + lc >= 0) && (n + lc < P.NumOutputTimeSteps))
+					x = *(double const*)((char const*)&TimeSeries[n + lc] + quantile_fields[f].offset);
+				quantiles[n * quantile_fields.size() + f].add(x);
+			}
 		TSMean[n].t += ((double) n )* P.OutputTimeStep;
 	}
-	PeakHeightSum += s;
-	PeakHeightSS += s * s;
-	PeakTimeSum += t;
-	PeakTimeSS += t * t;
+	RunningStats::add(&s, &PeakHeightSum, &PeakHeightSS, 1, P.NRactE + P.NRactNE - 1);
+	RunningStats::add(&t, &PeakTimeSum, &PeakTimeSS, 1, P.NRactE + P.NRactNE - 1);
 }
 
 void CalcOriginDestMatrix_adunit()
@@ -0,0 +1,499 @@
+/** \file  DensityFile.cpp
+ *  \brief Read and write population density files
+ */
+
+#define __STDC_FORMAT_MACROS 1
+#include <algorithm>
+#include <cinttypes>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "DensityFile.h"
+#include "Error.h"
+#include "Files.h"
+#include "Memory.h"
+
+// Longest line accepted in a text density file, matching the old fgets buffer.
+static const std::size_t MAX_LINE_LENGTH = 2048;
+
+// Version of the /DC cache format, after CACHE_HEADER.
+static const uint32_t CACHE_VERSION = 1;
+
+static bool is_blank(const char* line, const char* line_end)
+{
+	for (; line < line_end; line++)
+		if ((*line != ' ') && (*line != '\t') && (*line != '\r')) return false;
+	return true;
+}
+
+// Start of the first line at or after offset pos.
+static std::size_t line_start_after(const char* buf, std::size_t len, std::size_t pos)
+{
+	if (pos == 0) return 0;
+	if (pos >= len) return len;
+	const char* nl = (const char*)memchr(buf + pos - 1, '\n', len - pos + 1);
+	return (nl == NULL) ? len : (std::size_t)(nl - buf) + 1;
+}
+
+// Parses "x y pop cnt [ad]" with the same number syntax as "%lg %lg %lg %i %i".
+static bool parse_record(const char* s, bool do_ad_units, double longitude_cut_line, BinFile& rec)
+{
+	char* end;
+	double x = strtod(s, &end);
+	if (end == s) return false;
+	s = end;
+	double y = strtod(s, &end);
+	if (end == s) return false;
+	s = end;
+	double pop = strtod(s, &end);
+	if (end == s) return false;
+	s = end;
+	long cnt = strtol(s, &end, 0);
+	if (end == s) return false;
+	s = end;
+	long ad = 0;
+	if (do_ad_units)
+	{
+		ad = strtol(s, &end, 0);
+		if (end == s) return false;
+	}
+	// Ensure we use an x which gives us a contiguous whole for the geography.
+	rec.x = (x >= longitude_cut_line) ? x : x + 360;
+	rec.y = y;
+	rec.pop = pop;
+	rec.cnt = (int)cnt;
+	rec.ad = (int)ad;
+	return true;
+}
+
+bool DensityFile::is_binary(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	unsigned int header = 0;
+	size_t n = Files::fread_big(&header, sizeof(unsigned int), 1, dat);
+	Files::xfclose(dat);
+	return (n == 1) && ((header == BINARY_HEADER) || (header == BINARY_HEADER_V2));
+}
+
+static std::size_t field_size(DensityFile::FieldType type)
+{
+	switch (type)
+	{
+	case DensityFile::FieldType::Float32: return sizeof(float);
+	case DensityFile::FieldType::Float64: return sizeof(double);
+	case DensityFile::FieldType::Int32: return sizeof(int32_t);
+	}
+	return 0;
+}
+
+static double get_double(const char* p, DensityFile::FieldType type)
+{
+	switch (type)
+	{
+	case DensityFile::FieldType::Float32: { float f; memcpy(&f, p, sizeof(float)); return (double)f; }
+	case DensityFile::FieldType::Float64: { double d; memcpy(&d, p, sizeof(double)); return d; }
+	case DensityFile::FieldType::Int32: { int32_t i; memcpy(&i, p, sizeof(int32_t)); return (double)i; }
+	}
+	return 0;
+}
+
+// Size of an open file in bytes, so that counts read from its header can be checked before allocating.
+static uint64_t file_size(FILE* dat, std::string const& filename)
+{
+#ifndef _WIN32
+	struct stat st;
+	if (fstat(fileno(dat), &st) != 0) ERR_CRITICAL_FMT("Error %d reading size of %s - %s\n", errno, filename.c_str(), strerror(errno));
+	return (uint64_t)st.st_size;
+#else
+	long long pos = _ftelli64(dat);
+	_fseeki64(dat, 0, SEEK_END);
+	long long len = _ftelli64(dat);
+	_fseeki64(dat, pos, SEEK_SET);
+	if ((pos < 0) || (len < 0)) ERR_CRITICAL_FMT("Error reading size of %s\n", filename.c_str());
+	return (uint64_t)len;
+#endif
+}
+
+static BinFile* read_binary_v2(FILE* dat, std::string const& filename, uint64_t size, uint64_t& num_records, uint32_t& flags)
+{
+	// Bytes before the field descriptors: header, version, record count, flags and field count.
+	const uint64_t preamble = sizeof(unsigned int) + 3 * sizeof(uint32_t) + sizeof(uint64_t);
+	uint32_t version, num_fields;
+	if (Files::fread_big(&version, sizeof(uint32_t), 1, dat) != 1 || version != 2)
+		ERR_CRITICAL_FMT("Unsupported version of binary density file %s\n", filename.c_str());
+	if (Files::fread_big(&num_records, sizeof(uint64_t), 1, dat) != 1
+		|| Files::fread_big(&flags, sizeof(uint32_t), 1, dat) != 1
+		|| Files::fread_big(&num_fields, sizeof(uint32_t), 1, dat) != 1)
+		ERR_CRITICAL_FMT("Error while reading density file %s\n", filename.c_str());
+	if ((uint64_t)num_fields > (size - std::min(size, preamble)) / sizeof(DensityFile::FieldDescriptor))
+		ERR_CRITICAL_FMT("Density file %s is too short for its %u fields\n", filename.c_str(), (unsigned)num_fields);
+	std::vector<DensityFile::FieldDescriptor> fields(num_fields);
+	if (Files::fread_big(fields.data(), sizeof(DensityFile::FieldDescriptor), num_fields, dat) != num_fields)
+		ERR_CRITICAL_FMT("Error while reading density file %s\n", filename.c_str());
+
+	// Byte offset within a record of x, y, pop, cnt, ad; -1 if absent.
+	const char* names[5] = { "x", "y", "pop", "cnt", "ad" };
+	long offset[5] = { -1, -1, -1, -1, -1 };
+	DensityFile::FieldType type[5] = {};
+	std::size_t stride = 0;
+	for (uint32_t f = 0; f < num_fields; f++)
+	{
+		std::size_t size = field_size(fields[f].type);
+		if (size == 0) ERR_CRITICAL_FMT("Unknown field type %u in density file %s\n", (unsigned)fields[f].type, filename.c_str());
+		for (int i = 0; i < 5; i++)
+			if (strncmp(fields[f].name, names[i], sizeof(fields[f].name)) == 0)
+			{
+				offset[i] = (long)stride;
+				type[i] = fields[f].type;
+			}
+		stride += size;
+	}
+	for (int i = 0; i < 4; i++)
+		if (offset[i] < 0) ERR_CRITICAL_FMT("Density file %s has no %s field\n", filename.c_str(), names[i]);
+	uint64_t data_size = size - preamble - (uint64_t)num_fields * sizeof(DensityFile::FieldDescriptor);
+	if (num_records > data_size / stride)
+		ERR_CRITICAL_FMT("Density file %s is too short for its %" PRIu64 " records\n", filename.c_str(), num_records);
+
+	// Stream the packed records through a fixed size buffer.
+	BinFile* records = (BinFile*)Memory::xcalloc((std::size_t)num_records, sizeof(BinFile));
+	const uint64_t block = 1 << 16;
+	char* buf = (char*)Memory::xmalloc((std::size_t)(block * stride));
+	for (uint64_t start = 0; start < num_records; start += block)
+	{
+		std::size_t n = (std::size_t)std::min(block, num_records - start);
+		if (Files::fread_big(buf, stride, n, dat) != n)
+			ERR_CRITICAL_FMT("Error while reading density file %s: expected %" PRIu64 " records\n", filename.c_str(), num_records);
+		for (std::size_t r = 0; r < n; r++)
+		{
+			const char* rec = buf + r * stride;
+			BinFile& out = records[start + r];
+			out.x = get_double(rec + offset[0], type[0]);
+			out.y = get_double(rec + offset[1], type[1]);
+			out.pop = get_double(rec + offset[2], type[2]);
+			out.cnt = (int)get_double(rec + offset[3], type[3]);
+			out.ad = (offset[4] < 0) ? 0 : (int)get_double(rec + offset[4], type[4]);
+		}
+	}
+	Memory::xfree(buf);
+	return records;
+}
+
+BinFile* DensityFile::read_binary(std::string const& filename, uint64_t& num_records, uint32_t* flags)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	BinFile* records;
+	unsigned int header;
+	uint32_t v2_flags = 0;
+	uint64_t size = file_size(dat, filename);
+	if (Files::fread_big(&header, sizeof(unsigned int), 1, dat) != 1)
+		ERR_CRITICAL_FMT("%s is not a binary density file\n", filename.c_str());
+	if (header == BINARY_HEADER_V2)
+		records = read_binary_v2(dat, filename, size, num_records, v2_flags);
+	else if (header == BINARY_HEADER)
+	{
+		unsigned int len;
+		if (Files::fread_big(&len, sizeof(unsigned int), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading density file %s\n", filename.c_str());
+		num_records = len;
+		if (num_records > (size - 2 * sizeof(unsigned int)) / sizeof(BinFile))
+			ERR_CRITICAL_FMT("Density file %s is too short for its %u records\n", filename.c_str(), len);
+		records = (BinFile*)Memory::xcalloc(len, sizeof(BinFile));
+		if (Files::fread_big(records, sizeof(BinFile), (size_t)len, dat) != (size_t)len)
+			ERR_CRITICAL_FMT("Error while reading density file %s: expected %u records\n", filename.c_str(), len);
+	}
+	else
+		ERR_CRITICAL_FMT("%s is not a binary density file\n", filename.c_str());
+	Files::xfclose(dat);
+	if (flags != NULL) *flags = v2_flags;
+	return records;
+}
+
+void DensityFile::write_binary(std::string const& filename, BinFile const* records, uint64_t num_records)
+{
+	if (num_records > UINT_MAX)
+		ERR_CRITICAL_FMT("Too many records (%" PRIu64 ") for a version 1 density file, use version 2\n", num_records);
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	unsigned int header = BINARY_HEADER;
+	unsigned int len = (unsigned int)num_records;
+	Files::fwrite_big((void*)&header, sizeof(unsigned int), 1, dat);
+	Files::fwrite_big((void*)&len, sizeof(unsigned int), 1, dat);
+	Files::fwrite_big((void*)records, sizeof(BinFile), (size_t)num_records, dat);
+	Files::xfclose(dat);
+}
+
+static DensityFile::FieldDescriptor make_field(const char* name, const char* units, DensityFile::FieldType type)
+{
+	DensityFile::FieldDescriptor field;
+	memset(&field, 0, sizeof(field));
+	memcpy(field.name, name, std::min(strlen(name), sizeof(field.name) - 1));
+	memcpy(field.units, units, std::min(strlen(units), sizeof(field.units) - 1));
+	field.type = type;
+	return field;
+}
+
+static char* put_double(char* p, double d, DensityFile::FieldType type)
+{
+	if (type == DensityFile::FieldType::Float32)
+	{
+		float f = (float)d;
+		memcpy(p, &f, sizeof(float));
+		return p + sizeof(float);
+	}
+	memcpy(p, &d, sizeof(double));
+	return p + sizeof(double);
+}
+
+static void write_v2(FILE* dat, BinFile const* records, uint64_t num_records, bool single_precision_coords, uint32_t flags)
+{
+	using namespace DensityFile;
+
+	// Use floats for any double column that they represent exactly.
+	bool x_float = true, y_float = true, pop_float = true;
+	for (uint64_t r = 0; r < num_records; r++)
+	{
+		x_float = x_float && ((double)(float)records[r].x == records[r].x);
+		y_float = y_float && ((double)(float)records[r].y == records[r].y);
+		pop_float = pop_float && ((double)(float)records[r].pop == records[r].pop);
+	}
+	if (single_precision_coords) x_float = y_float = true;
+
+	FieldDescriptor fields[5] = {
+		make_field("x", "degrees", x_float ? FieldType::Float32 : FieldType::Float64),
+		make_field("y", "degrees", y_float ? FieldType::Float32 : FieldType::Float64),
+		make_field("pop", "people", pop_float ? FieldType::Float32 : FieldType::Float64),
+		make_field("cnt", "country code", FieldType::Int32),
+		make_field("ad", "admin unit code", FieldType::Int32)
+	};
+	uint32_t num_fields = 5, version = 2;
+	std::size_t stride = 0;
+	for (uint32_t f = 0; f < num_fields; f++) stride += field_size(fields[f].type);
+
+	unsigned int header = BINARY_HEADER_V2;
+	Files::fwrite_big((void*)&header, sizeof(unsigned int), 1, dat);
+	Files::fwrite_big((void*)&version, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)&num_records, sizeof(uint64_t), 1, dat);
+	Files::fwrite_big((void*)&flags, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)&num_fields, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)fields, sizeof(FieldDescriptor), num_fields, dat);
+
+	const uint64_t block = 1 << 16;
+	char* buf = (char*)Memory::xmalloc((std::size_t)(block * stride));
+	for (uint64_t start = 0; start < num_records; start += block)
+	{
+		std::size_t n = (std::size_t)std::min(block, num_records - start);
+		char* p = buf;
+		for (std::size_t r = 0; r < n; r++)
+		{
+			BinFile const& rec = records[start + r];
+			int32_t cnt = rec.cnt, ad = rec.ad;
+			p = put_double(p, rec.x, fields[0].type);
+			p = put_double(p, rec.y, fields[1].type);
+			p = put_double(p, rec.pop, fields[2].type);
+			memcpy(p, &cnt, sizeof(int32_t));
+			p += sizeof(int32_t);
+			memcpy(p, &ad, sizeof(int32_t));
+			p += sizeof(int32_t);
+		}
+		Files::fwrite_big(buf, stride, n, dat);
+	}
+	Memory::xfree(buf);
+}
+
+void DensityFile::write_binary_v2(std::string const& filename, BinFile const* records, uint64_t num_records,
+	bool single_precision_coords, uint32_t flags)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	write_v2(dat, records, num_records, single_precision_coords, flags);
+	Files::xfclose(dat);
+}
+
+// Bytes of a cache before its version 2 density file: header, version, size, mtime, do_ad_units and cut line.
+static const uint64_t CACHE_PREAMBLE = sizeof(unsigned int) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int64_t)
+	+ sizeof(uint32_t) + sizeof(double);
+
+bool DensityFile::read_cache(std::string const& filename, TextSource const& source, BinFile*& records, uint64_t& num_records)
+{
+	FILE* dat = Files::xfopen_if_exists(filename.c_str(), "rb");
+	if (dat == NULL) return false;
+	uint64_t size = file_size(dat, filename);
+	unsigned int header, v2_header;
+	uint32_t version, do_ad_units;
+	TextSource cached;
+	if ((size < CACHE_PREAMBLE + sizeof(unsigned int))
+		|| (Files::fread_big(&header, sizeof(unsigned int), 1, dat) != 1) || (header != CACHE_HEADER)
+		|| (Files::fread_big(&version, sizeof(uint32_t), 1, dat) != 1) || (version != CACHE_VERSION)
+		|| (Files::fread_big(&cached.size, sizeof(uint64_t), 1, dat) != 1)
+		|| (Files::fread_big(&cached.mtime, sizeof(int64_t), 1, dat) != 1)
+		|| (Files::fread_big(&do_ad_units, sizeof(uint32_t), 1, dat) != 1)
+		|| (Files::fread_big(&cached.longitude_cut_line, sizeof(double), 1, dat) != 1)
+		|| (cached.size != source.size) || (cached.mtime != source.mtime) || ((do_ad_units != 0) != source.do_ad_units)
+		|| (cached.longitude_cut_line != source.longitude_cut_line)
+		|| (Files::fread_big(&v2_header, sizeof(unsigned int), 1, dat) != 1) || (v2_header != BINARY_HEADER_V2))
+	{
+		Files::xfclose(dat);
+		return false;
+	}
+	uint32_t flags;
+	records = read_binary_v2(dat, filename, size - CACHE_PREAMBLE, num_records, flags);
+	Files::xfclose(dat);
+	return true;
+}
+
+void DensityFile::write_cache(std::string const& filename, TextSource const& source, BinFile const* records, uint64_t num_records)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	unsigned int header = CACHE_HEADER;
+	uint32_t version = CACHE_VERSION, do_ad_units = source.do_ad_units ? 1 : 0;
+	Files::fwrite_big((void*)&header, sizeof(unsigned int), 1, dat);
+	Files::fwrite_big((void*)&version, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)&source.size, sizeof(uint64_t), 1, dat);
+	Files::fwrite_big((void*)&source.mtime, sizeof(int64_t), 1, dat);
+	Files::fwrite_big((void*)&do_ad_units, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)&source.longitude_cut_line, sizeof(double), 1, dat);
+	write_v2(dat, records, num_records, false, 0);
+	Files::xfclose(dat);
+}
+
+uint64_t DensityFile::morton_key(uint32_t j, uint32_t k)
+{
+	uint64_t key = 0;
+	for (int b = 0; b < 32; b++)
+		key |= ((uint64_t)((j >> b) & 1) << (2 * b + 1)) | ((uint64_t)((k >> b) & 1) << (2 * b));
+	return key;
+}
+
+void DensityFile::sort_morton(BinFile* records, uint64_t num_records, double min_x, double min_y, double width, double height)
+{
+	std::vector<std::pair<uint64_t, uint64_t>> keys((std::size_t)num_records);
+	for (uint64_t r = 0; r < num_records; r++)
+	{
+		// Same rounding as SetupPopulation uses to place a record in a microcell.
+		double j = floor((records[r].x - min_x) / width + 0.1);
+		double k = floor((records[r].y - min_y) / height + 0.1);
+		keys[r].first = morton_key((j > 0) ? (uint32_t)j : 0, (k > 0) ? (uint32_t)k : 0);
+		keys[r].second = r;
+	}
+	std::stable_sort(keys.begin(), keys.end(),
+		[](std::pair<uint64_t, uint64_t> const& a, std::pair<uint64_t, uint64_t> const& b) { return a.first < b.first; });
+	BinFile* sorted = (BinFile*)Memory::xcalloc((std::size_t)num_records, sizeof(BinFile));
+	for (uint64_t r = 0; r < num_records; r++) sorted[r] = records[keys[r].second];
+	memcpy(records, sorted, (std::size_t)num_records * sizeof(BinFile));
+	Memory::xfree(sorted);
+}
+
+BinFile* DensityFile::parse_text(const char* buf, std::size_t len, uint64_t& num_records, bool do_ad_units,
+	double longitude_cut_line, int num_threads)
+{
+	int num_chunks = (num_threads > 0) ? num_threads : 1;
+	if ((std::size_t)num_chunks > len / MAX_LINE_LENGTH + 1) num_chunks = (int)(len / MAX_LINE_LENGTH + 1);
+
+	// Line-aligned chunk boundaries; chunk c covers [chunk_start[c], chunk_start[c + 1]).
+	std::vector<std::size_t> chunk_start(num_chunks + 1);
+	for (int c = 0; c < num_chunks; c++)
+		chunk_start[c] = line_start_after(buf, len, (len / num_chunks) * c);
+	chunk_start[num_chunks] = len;
+
+	// First pass: count records (and all lines, for error messages) in each chunk.
+	std::vector<uint64_t> chunk_records(num_chunks + 1, 0), chunk_lines(num_chunks + 1, 0);
+#pragma omp parallel for schedule(static,1) default(none) shared(buf, num_chunks, chunk_start, chunk_records, chunk_lines)
+	for (int c = 0; c < num_chunks; c++)
+	{
+		uint64_t records = 0, lines = 0;
+		const char* p = buf + chunk_start[c];
+		const char* chunk_end = buf + chunk_start[c + 1];
+		while (p < chunk_end)
+		{
+			const char* line_end = (const char*)memchr(p, '\n', (std::size_t)(chunk_end - p));
+			if (line_end == NULL) line_end = chunk_end;
+			if (!is_blank(p, line_end)) records++;
+			lines++;
+			p = line_end + 1;
+		}
+		chunk_records[c] = records;
+		chunk_lines[c] = lines;
+	}
+
+	// Exclusive prefix sums give each chunk's first record and line number.
+	std::vector<uint64_t> first_record(num_chunks + 1, 0), first_line(num_chunks + 1, 0);
+	for (int c = 0; c < num_chunks; c++)
+	{
+		first_record[c + 1] = first_record[c] + chunk_records[c];
+		first_line[c + 1] = first_line[c] + chunk_lines[c];
+	}
+	num_records = first_record[num_chunks];
+	BinFile* records = (BinFile*)Memory::xcalloc((std::size_t)num_records, sizeof(BinFile));
+
+	// Second pass: parse each chunk straight into its slice of the output.
+#pragma omp parallel for schedule(static,1) default(none) shared(buf, num_chunks, chunk_start, first_record, first_line, records, do_ad_units, longitude_cut_line)
+	for (int c = 0; c < num_chunks; c++)
+	{
+		char line[MAX_LINE_LENGTH];
+		uint64_t index = first_record[c], line_num = first_line[c];
+		const char* p = buf + chunk_start[c];
+		const char* chunk_end = buf + chunk_start[c + 1];
+		while (p < chunk_end)
+		{
+			const char* line_end = (const char*)memchr(p, '\n', (std::size_t)(chunk_end - p));
+			if (line_end == NULL) line_end = chunk_end;
+			line_num++;
+			if (!is_blank(p, line_end))
+			{
+				std::size_t n = (std::size_t)(line_end - p);
+				if (n >= MAX_LINE_LENGTH) ERR_CRITICAL_FMT("Line %" PRIu64 " of density file is too long\n", line_num);
+				memcpy(line, p, n);
+				line[n] = '\0';
+				if (!parse_record(line, do_ad_units, longitude_cut_line, records[index]))
+					ERR_CRITICAL_FMT("Error reading line %" PRIu64 " of density file, expected %d values: %s\n", line_num, do_ad_units ? 5 : 4, line);
+				index++;
+			}
+			p = line_end + 1;
+		}
+	}
+	return records;
+}
+
+BinFile* DensityFile::read_text(std::string const& filename, uint64_t& num_records, bool do_ad_units,
+	double longitude_cut_line, int num_threads)
+{
+	BinFile* records;
+#ifndef _WIN32
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) ERR_CRITICAL_FMT("Error %d opening file %s - %s\n", errno, filename.c_str(), strerror(errno));
+	struct stat st;
+	if (fstat(fd, &st) != 0) ERR_CRITICAL_FMT("Error %d reading size of %s - %s\n", errno, filename.c_str(), strerror(errno));
+	std::size_t len = (std::size_t)st.st_size;
+	if (len == 0)
+	{
+		close(fd);
+		return parse_text("", 0, num_records, do_ad_units, longitude_cut_line, num_threads);
+	}
+	void* map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) ERR_CRITICAL_FMT("Error %d mapping file %s - %s\n", errno, filename.c_str(), strerror(errno));
+	close(fd);
+	madvise(map, len, MADV_SEQUENTIAL);
+	records = parse_text((const char*)map, len, num_records, do_ad_units, longitude_cut_line, num_threads);
+	munmap(map, len);
+#else
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	fseek(dat, 0, SEEK_END);
+	std::size_t len = (std::size_t)_ftelli64(dat);
+	rewind(dat);
+	char* buf = (char*)Memory::xmalloc(len + 1);
+	if (Files::fread_big(buf, 1, len, dat) != len) ERR_CRITICAL("Error while reading density file\n");
+	Files::xfclose(dat);
+	records = parse_text(buf, len, num_records, do_ad_units, longitude_cut_line, num_threads);
+	Memory::xfree(buf);
+#endif
+	return records;
+}
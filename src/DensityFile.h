@@ -0,0 +1,198 @@
+/** \file  DensityFile.h
+ *  \brief Read and write population density files
+ */
+
+#ifndef COVIDSIM_DENSITYFILE_H_INCLUDED_
+#define COVIDSIM_DENSITYFILE_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct BinFile
+{
+	double x, y, pop;
+	int cnt, ad;
+};
+
+namespace DensityFile
+{
+/// First 4 bytes of a version 1 binary density file, which continues with an
+/// unsigned int record count and then packed BinFile records.
+const unsigned int BINARY_HEADER = 0xf0f0f0f0;
+
+/// First 4 bytes of a version 2 binary density file. This continues with a
+/// uint32 format version (2), a uint64 record count, uint32 flags (V2_*), a
+/// uint32 field count, that many FieldDescriptors and then the records, packed
+/// field by field in descriptor order with no padding.
+const unsigned int BINARY_HEADER_V2 = 0xf0f0f0f2;
+
+/// Version 2 flag: records are sorted by the Morton code of their microcell.
+const uint32_t V2_MORTON_ORDER = 1;
+
+/// First 4 bytes of a /DC cache of a text density file. This continues with a
+/// uint32 format version, the TextSource it was parsed with (uint64 size, int64
+/// modification time, uint32 do_ad_units and double longitude_cut_line) and then
+/// a version 2 binary density file.
+const unsigned int CACHE_HEADER = 0xf0f0f1d0;
+
+enum struct FieldType : uint32_t
+{
+	Float32 = 1,
+	Float64 = 2,
+	Int32 = 3
+};
+
+/// Describes one column of a version 2 density file. Readers look fields up
+/// by name ("x", "y", "pop", "cnt", "ad") and skip names they don't know.
+struct FieldDescriptor
+{
+	char name[16];
+	char units[16];
+	FieldType type;
+};
+
+/// What the records parsed from a text density file depend on, other than its name.
+struct TextSource
+{
+	uint64_t size;				///< Of the text file, as given by Files::stat_file
+	int64_t mtime;
+	bool do_ad_units;
+	double longitude_cut_line;
+};
+
+
+
+/** \brief           Check whether a density file is in a binary format.
+ *  \param  filename The density file to check
+ *  \return          true if the file starts with BINARY_HEADER or BINARY_HEADER_V2
+ */
+
+  bool is_binary(std::string const& filename);
+
+
+
+/** \brief              Read a binary density file of either version.
+ *  \param  filename    The density file to read
+ *  \param  num_records Set to the number of records read
+ *  \param  flags       If not NULL, set to the version 2 flags (0 for version 1)
+ *  \return             Records, allocated with Memory::xcalloc
+ */
+
+  BinFile* read_binary(std::string const& filename, uint64_t& num_records, uint32_t* flags = NULL);
+
+
+
+/** \brief              Write records in the version 1 binary density format.
+ *  \param  filename    The density file to write
+ *  \param  records     Records to write
+ *  \param  num_records Number of records; must fit in an unsigned int
+ */
+
+  void write_binary(std::string const& filename, BinFile const* records, uint64_t num_records);
+
+
+
+/** \brief                          Write records in the version 2 binary density format.
+ *  \param  filename                The density file to write
+ *  \param  records                 Records to write
+ *  \param  num_records             Number of records
+ *  \param  single_precision_coords Store x and y as floats even if that rounds them
+ *  \param  flags                   V2_* flags describing the records
+ *
+ *  Each double column is stored as a float when every value in it survives the
+ *  round trip exactly, so files are lossless unless \a single_precision_coords is
+ *  set. That is intended for microcell centres, where float precision (about a
+ *  metre) is far finer than the microcell size.
+ */
+
+  void write_binary_v2(std::string const& filename, BinFile const* records, uint64_t num_records,
+                       bool single_precision_coords, uint32_t flags);
+
+
+
+/** \brief              Read a cache of a text density file.
+ *  \param  filename    The cache file to read
+ *  \param  source      The text file's size and modification time and the settings it is parsed with
+ *  \param  records     Set to the cached records, allocated with Memory::xcalloc
+ *  \param  num_records Set to the number of records
+ *  \return             false if there is no such cache, or it was made from a different text file
+ *                      or with different settings, in which case the text file must be parsed
+ */
+
+  bool read_cache(std::string const& filename, TextSource const& source, BinFile*& records, uint64_t& num_records);
+
+
+
+/** \brief              Write the records parsed from a text density file to a cache.
+ *  \param  filename    The cache file to write
+ *  \param  source      The text file's size and modification time and the settings it was parsed with
+ *  \param  records     Records to write
+ *  \param  num_records Number of records
+ */
+
+  void write_cache(std::string const& filename, TextSource const& source, BinFile const* records, uint64_t num_records);
+
+
+
+/** \brief     Interleave the bits of two microcell coordinates.
+ *  \param  j  Microcell column
+ *  \param  k  Microcell row
+ *  \return    Morton (Z-order) code
+ */
+
+  uint64_t morton_key(uint32_t j, uint32_t k);
+
+
+
+/** \brief              Stable sort of records into Morton order of their microcell.
+ *  \param  records     Records to sort
+ *  \param  num_records Number of records
+ *  \param  min_x       Left edge of the microcell grid
+ *  \param  min_y       Bottom edge of the microcell grid
+ *  \param  width       Microcell width
+ *  \param  height      Microcell height
+ *
+ *  Microcells are found as in SetupPopulation, so records sharing a microcell end
+ *  up adjacent and neighbouring microcells end up close together.
+ */
+
+  void sort_morton(BinFile* records, uint64_t num_records, double min_x, double min_y, double width, double height);
+
+
+
+/** \brief                     Read a text density file (x y pop country [adunit] per line).
+ *  \param  filename           The density file to read
+ *  \param  num_records        Set to the number of records read
+ *  \param  do_ad_units        Whether each line has a fifth, admin unit, column
+ *  \param  longitude_cut_line Longitudes west of this are shifted by 360 degrees
+ *  \param  num_threads        Number of chunks to parse in parallel
+ *  \return                    Records, allocated with Memory::xcalloc
+ *
+ *  The file is memory mapped where possible and split into line-aligned chunks,
+ *  which are counted and then parsed in parallel. Records come back in file order,
+ *  so the result does not depend on \a num_threads.
+ */
+
+  BinFile* read_text(std::string const& filename, uint64_t& num_records, bool do_ad_units,
+                     double longitude_cut_line, int num_threads);
+
+
+
+/** \brief                     Parse an in-memory text density file; see read_text.
+ *  \param  buf                Text to parse (need not be NUL terminated)
+ *  \param  len                Length of \a buf in bytes
+ *  \param  num_records        Set to the number of records read
+ *  \param  do_ad_units        Whether each line has a fifth, admin unit, column
+ *  \param  longitude_cut_line Longitudes west of this are shifted by 360 degrees
+ *  \param  num_threads        Number of chunks to parse in parallel
+ *  \return                    Records, allocated with Memory::xcalloc
+ *
+ *  Blank lines are skipped.
+ */
+
+  BinFile* parse_text(const char* buf, std::size_t len, uint64_t& num_records, bool do_ad_units,
+                      double longitude_cut_line, int num_threads);
+} // namespace DensityFile
+
+#endif // COVIDSIM_DENSITYFILE_H_INCLUDED_
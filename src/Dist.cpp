@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 
@@ -168,3 +169,21 @@ double dist2_raw(double ax, double ay, double bx, double by)
 	}
 	return periodic_xy(fabs(ax - bx), fabs(ay - by));
 }
+
+// A lower bound on dist2_raw for two points in the spatial domain whose x or y
+// coordinates differ by at least separation, for pruning spatial searches.
+double dist2_raw_min(double separation)
+{
+	if (P.DoPeriodicBoundaries) return 0;
+	if (P.DoUTM_coords)
+	{
+		if (P.in_degrees_.width > 180) return 0;
+		// Points differing in latitude by d are at least d apart, and in longitude by d, at least d
+		// times the cosine of the highest latitude. The margins cover the interpolation in dist2UTM.
+		double max_lat = std::max(fabs(P.SpatialBoundingBox.bottom_left().y), fabs(P.SpatialBoundingBox.top_right().y));
+		double c = std::max(0.0, cos(max_lat * PI / 180) - 1e-4);
+		double a = asin(std::min(1.0, c * sin(std::min(separation, 180.0) * PI / 360)));
+		return 0.999 * 4 * EARTHRADIUS * EARTHRADIUS * a * a;
+	}
+	return separation * separation;
+}
@@ -0,0 +1,167 @@
+/** \file  EventLog.cpp
+ *  \brief Collect infection events and read and write them as binary event streams
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "Error.h"
+#include "EventLog.h"
+#include "Files.h"
+#include "ResultsFile.h"
+
+// Fields of Events in the order their columns are encoded.
+static double Events::* const DoubleFields[] = { &Events::t, &Events::t_infector, &Events::infectee_x, &Events::infectee_y };
+static int Events::* const IntFields[] = { &Events::run, &Events::type, &Events::thread, &Events::infectee_ind, &Events::infector_ind,
+	&Events::infectee_adunit, &Events::listpos, &Events::infectee_cell, &Events::infector_cell };
+
+static void put_varint(std::vector<unsigned char>& out, uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back((unsigned char)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((unsigned char)v);
+}
+
+static bool get_varint(unsigned char const* bytes, std::size_t len, std::size_t& pos, uint64_t& v)
+{
+	v = 0;
+	for (int shift = 0; shift < 64 && pos < len; shift += 7)
+	{
+		unsigned char b = bytes[pos++];
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if (!(b & 0x80)) return true;
+	}
+	return false;
+}
+
+static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+void EventLog::collect(std::vector<Events>* buffers, int num_buffers, std::vector<Events>& events)
+{
+	std::size_t start = events.size();
+	for (int i = 0; i < num_buffers; i++)
+	{
+		events.insert(events.end(), buffers[i].begin(), buffers[i].end());
+		buffers[i].clear();
+	}
+	// Each buffer is already in time order, and stability keeps ties in thread order.
+	std::stable_sort(events.begin() + start, events.end(), [](Events const& a, Events const& b) { return a.t < b.t; });
+}
+
+std::vector<unsigned char> EventLog::encode(Events const* events, std::size_t n)
+{
+	std::vector<unsigned char> out;
+	std::vector<double> values(n);
+	for (auto field : DoubleFields)
+	{
+		for (std::size_t i = 0; i < n; i++) values[i] = events[i].*field;
+		std::vector<unsigned char> packed = ResultsFile::xor_pack(values.data(), n, 1);
+		put_varint(out, packed.size());
+		out.insert(out.end(), packed.begin(), packed.end());
+	}
+	for (auto field : IntFields)
+	{
+		int64_t prev = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			int64_t v = events[i].*field;
+			put_varint(out, zigzag((field == &Events::run) ? v - prev : v));
+			prev = v;
+		}
+	}
+	return out;
+}
+
+bool EventLog::decode(unsigned char const* bytes, std::size_t len, std::size_t n, std::vector<Events>& events)
+{
+	std::size_t start = events.size(), pos = 0;
+	events.resize(start + n);
+	Events* ev = events.data() + start;
+	std::vector<double> values(n);
+	for (auto field : DoubleFields)
+	{
+		uint64_t packed_len;
+		if (!get_varint(bytes, len, pos, packed_len) || packed_len > len - pos) return false;
+		if (!ResultsFile::xor_unpack(bytes + pos, (std::size_t)packed_len, values.data(), n, 1)) return false;
+		pos += (std::size_t)packed_len;
+		for (std::size_t i = 0; i < n; i++) ev[i].*field = values[i];
+	}
+	for (auto field : IntFields)
+	{
+		int64_t prev = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			uint64_t v;
+			if (!get_varint(bytes, len, pos, v)) return false;
+			int64_t x = unzigzag(v);
+			if (field == &Events::run) x += prev;
+			ev[i].*field = (int)x;
+			prev = x;
+		}
+	}
+	return pos == len;
+}
+
+void EventLog::create(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	Files::fwrite_big((void*)MAGIC, 1, sizeof(MAGIC), dat);
+	Files::fwrite_big((void*)&VERSION, sizeof(uint32_t), 1, dat);
+	Files::xfclose(dat);
+}
+
+void EventLog::append(std::string const& filename, Events const* events, std::size_t n)
+{
+	if (n == 0) return;
+	std::vector<unsigned char> bytes = encode(events, n);
+	uint32_t num_events = (uint32_t)n;
+	uint64_t len = bytes.size();
+	FILE* dat = Files::xfopen(filename.c_str(), "ab");
+	Files::fwrite_big((void*)&num_events, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)&len, sizeof(uint64_t), 1, dat);
+	Files::fwrite_big((void*)bytes.data(), 1, bytes.size(), dat);
+	Files::xfclose(dat);
+}
+
+std::vector<Events> EventLog::read(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	char magic[sizeof(MAGIC)];
+	uint32_t version, num_events;
+	if (Files::fread_big(magic, 1, sizeof(magic), dat) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+		ERR_CRITICAL_FMT("%s is not an event stream\n", filename.c_str());
+	if (Files::fread_big(&version, sizeof(uint32_t), 1, dat) != 1 || version != VERSION)
+		ERR_CRITICAL_FMT("Unsupported version of event stream %s\n", filename.c_str());
+
+	std::vector<Events> events;
+	std::vector<unsigned char> bytes;
+	while (Files::fread_big(&num_events, sizeof(uint32_t), 1, dat) == 1)
+	{
+		uint64_t len;
+		if (Files::fread_big(&len, sizeof(uint64_t), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading event stream %s\n", filename.c_str());
+		bytes.resize((std::size_t)len);
+		if (len > 0 && Files::fread_big(bytes.data(), 1, (std::size_t)len, dat) != (std::size_t)len)
+			ERR_CRITICAL_FMT("Error while reading event stream %s\n", filename.c_str());
+		if (!decode(bytes.data(), (std::size_t)len, num_events, events))
+			ERR_CRITICAL_FMT("Corrupt chunk in event stream %s\n", filename.c_str());
+	}
+	Files::xfclose(dat);
+	return events;
+}
+
+void EventLog::write_text(std::string const& filename, Events const* events, std::size_t n)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	Files::xfprintf(dat, "type,t,thread,ind_infectee,cell_infectee,listpos_infectee,adunit_infectee,x_infectee,y_infectee,t_infector,ind_infector,cell_infector\n");
+	for (std::size_t i = 0; i < n; i++)
+	{
+		Files::xfprintf(dat, "%i\t%.10f\t%i\t%i\t%i\t%i\t%i\t%.10f\t%.10f\t%.10f\t%i\t%i\n",
+			events[i].type, events[i].t, events[i].thread, events[i].infectee_ind, events[i].infectee_cell, events[i].listpos, events[i].infectee_adunit, events[i].infectee_x, events[i].infectee_y, events[i].t_infector, events[i].infector_ind, events[i].infector_cell);
+	}
+	Files::xfclose(dat);
+}
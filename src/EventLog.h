@@ -0,0 +1,102 @@
+/** \file  EventLog.h
+ *  \brief Collect infection events and read and write them as binary event streams
+ */
+
+#ifndef COVIDSIM_EVENTLOG_H_INCLUDED_
+#define COVIDSIM_EVENTLOG_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+
+namespace EventLog
+{
+/// First 8 bytes of an event stream. This continues with a uint32 format
+/// version and then any number of chunks, each a uint32 event count, a uint64
+/// byte length and the events encoded by encode. Numbers are native endian.
+const char MAGIC[8] = { 'C', 'S', 'E', 'V', 'E', 'N', 'T', 'S' };
+
+const uint32_t VERSION = 1;
+
+
+
+/** \brief               Move events from per-thread buffers to a single log.
+ *  \param  buffers      Per-thread buffers, each in the order its events were recorded; emptied
+ *  \param  num_buffers  Number of buffers
+ *  \param  events       The events are appended to this
+ *
+ *  Events are appended in time order, those at the same time in thread order,
+ *  so the log doesn't depend on how the threads were scheduled.
+ */
+
+  void collect(std::vector<Events>* buffers, int num_buffers, std::vector<Events>& events);
+
+
+
+/** \brief             Encode events as a chunk of an event stream.
+ *  \param  events     Events to encode
+ *  \param  n          Number of events
+ *  \return            Encoded bytes
+ *
+ *  The chunk is column oriented. Times and positions are XORed with the previous
+ *  event's and packed as ResultsFile::xor_pack does, so runs of events at the
+ *  same time take a byte each, and the integer fields are zigzag varints, the
+ *  run number as a difference from the previous event's. Encoding is lossless.
+ */
+
+  std::vector<unsigned char> encode(Events const* events, std::size_t n);
+
+
+
+/** \brief             Decode a chunk written by encode.
+ *  \param  bytes      Encoded bytes
+ *  \param  len        Number of encoded bytes
+ *  \param  n          Number of events expected
+ *  \param  events     The events are appended to this
+ *  \return            false if \a bytes don't hold exactly \a n events
+ */
+
+  bool decode(unsigned char const* bytes, std::size_t len, std::size_t n, std::vector<Events>& events);
+
+
+
+/** \brief             Start an event stream, replacing any existing file.
+ *  \param  filename   The file to write
+ */
+
+  void create(std::string const& filename);
+
+
+
+/** \brief             Append a chunk of events to an event stream made by create.
+ *  \param  filename   The file to append to
+ *  \param  events     Events to append
+ *  \param  n          Number of events
+ */
+
+  void append(std::string const& filename, Events const* events, std::size_t n);
+
+
+
+/** \brief             Read every event in an event stream.
+ *  \param  filename   The file to read
+ *  \return            The events, in the order they were appended
+ */
+
+  std::vector<Events> read(std::string const& filename);
+
+
+
+/** \brief             Write events as an infection events table (.infevents.xls).
+ *  \param  filename   The file to write
+ *  \param  events     Events to write
+ *  \param  n          Number of events
+ */
+
+  void write_text(std::string const& filename, Events const* events, std::size_t n);
+} // namespace EventLog
+
+#endif // COVIDSIM_EVENTLOG_H_INCLUDED_
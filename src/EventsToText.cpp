@@ -0,0 +1,37 @@
+/** \file  EventsToText.cpp
+ *  \brief Convert an infection event stream to the table written by SaveEvents
+ *
+ *  Usage: EventsToText events_file [output_file_base]
+ *
+ *  The output file base defaults to the event stream's name without its
+ *  ".infevents.bin" suffix, so the table is written alongside it as
+ *  output_file_base.infevents.xls. Every event in the stream is written; unlike
+ *  CovidSim's own table, it is not limited to the maximum number of events.
+ */
+
+#include <string>
+#include <vector>
+
+#include "EventLog.h"
+#include "Files.h"
+
+static const std::string Suffix = ".infevents.bin";
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		Files::xfprintf_stderr("Usage: %s events_file [output_file_base]\n", argv[0]);
+		return 1;
+	}
+	std::string events_file = argv[1];
+	std::string output_file_base = events_file;
+	if (argc == 3)
+		output_file_base = argv[2];
+	else if (events_file.size() > Suffix.size() && events_file.compare(events_file.size() - Suffix.size(), Suffix.size(), Suffix) == 0)
+		output_file_base = events_file.substr(0, events_file.size() - Suffix.size());
+
+	std::vector<Events> events = EventLog::read(events_file);
+	EventLog::write_text(output_file_base + ".infevents.xls", events.data(), events.size());
+	return 0;
+}
@@ -2,6 +2,8 @@
  *  \brief Provide file routines that terminate on failure
  */
 
+#include <sys/stat.h>
+
 #include "Files.h"
 
 size_t Files::fwrite_big(void* buffer, size_t size, size_t count, FILE* stream)
@@ -137,6 +139,20 @@ void Files::xremove(const char* filename) noexcept
   }
 }
 
+bool Files::stat_file(const char* filename, uint64_t& size, int64_t& mtime) noexcept
+{
+#ifdef _WIN32
+  struct _stat64 st;
+  if (_stat64(filename, &st) != 0) return false;
+#else
+  struct stat st;
+  if (stat(filename, &st) != 0) return false;
+#endif
+  size = (uint64_t)st.st_size;
+  mtime = (int64_t)st.st_mtime;
+  return true;
+}
+
 void Files::xsprintf(char* str, const char* format, ...) noexcept
 {
   va_list args;
@@ -8,6 +8,7 @@
   #define _CRT_SECURE_NO_WARNINGS
 #endif
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <cstdarg>
@@ -149,6 +150,18 @@ namespace Files
 
 
 
+/** \brief             Size and modification time of a file, to tell whether it has changed.
+ *  \param  filename   The file to look at
+ *  \param  size       Set to its size in bytes
+ *  \param  mtime      Set to its last modification time, in seconds since the epoch
+ *  \return            false if the file does not exist or can't be read
+ *
+ */
+
+  bool stat_file(const char* filename, uint64_t& size, int64_t& mtime) noexcept;
+
+
+
 /** \brief             Wrapper around sscanf that aborts on error.
  *  \param  s          The string to be parsed
  *  \param n_expected  Number of arguments expected
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cmath>
+
+#include "HouseholdAges.h"
+#include "Constants.h"
+#include "Error.h"
+#include "Rand.h"
+
+const double PROP_OTHER_PARENT_AWAY = 0.0;
+
+// Ages run from 0 to MAX_AGE - 1.
+static const int MAX_AGE = NUM_AGE_GROUPS * AGE_GROUP_WIDTH;
+
+// The probability the rejection sampler accepts an age it has drawn, given
+// that it passes the other tests, is the value it compares a uniform random
+// number with, limited to [0, 1]; a NaN never rejects.
+static double acceptance(double p)
+{
+	return std::isnan(p) ? 1.0 : std::min(1.0, std::max(0.0, p));
+}
+
+HouseholdAgeSampler::HouseholdAgeSampler(Param const& params, int const* inv_age_dist)
+	: params_(params), ages_(inv_age_dist, inv_age_dist + 1000), first_(MAX_AGE + 1)
+{
+	std::sort(ages_.begin(), ages_.end());
+	if ((ages_.front() < 0) || (ages_.back() >= MAX_AGE))
+		ERR_CRITICAL_FMT("Ages must be in [0, %d)\n", MAX_AGE);
+	for (int age = 0, i = 0; age <= MAX_AGE; age++)
+	{
+		while ((i < 1000) && (ages_[i] < age)) i++;
+		first_[age] = i;
+	}
+
+	std::vector<double> old_weights(MAX_AGE), young_weights(MAX_AGE);
+	bool any_old = false, any_young = false;
+	for (int age : ages_)
+	{
+		if (age >= params.NoChildPersAge)
+			old_weights[age] += acceptance((((double)age) - params.NoChildPersAge + 1) / (_I64(params.OldPersAge) - params.NoChildPersAge + 1));
+		if ((age <= params.YoungAndSingle) && (age >= params.MinAdultAge))
+			young_weights[age] += acceptance(1 - params.YoungAndSingleSlope * (((double)age) - params.MinAdultAge) / (_I64(params.YoungAndSingle) - params.MinAdultAge));
+		any_old = any_old || (old_weights[age] > 0);
+		any_young = any_young || (young_weights[age] > 0);
+	}
+	// Without any ages, the rejection sampler would never finish, so the tables
+	// are only needed if there are some.
+	if (any_old) old_ = AliasTable(old_weights);
+	if (any_young) young_ = AliasTable(young_weights);
+}
+
+int HouseholdAgeSampler::any(int tn) const
+{
+	return ages_[(int)(1000.0 * ranf_mt(tn))];
+}
+
+int HouseholdAgeSampler::between(int lo, int hi, int tn) const
+{
+	lo = std::max(lo, 0);
+	hi = std::min(hi, MAX_AGE - 1);
+	int start = first_[std::min(lo, MAX_AGE)], end = (hi < lo) ? start : first_[hi + 1];
+	if (start >= end) ERR_CRITICAL_FMT("No household member can be aged between %d and %d\n", lo, hi);
+	return ages_[start + (int)((end - start) * ranf_mt(tn))];
+}
+
+int HouseholdAgeSampler::weighted(AliasTable const& table, int lo, int hi, int tn) const
+{
+	if (table.size() == 0) ERR_CRITICAL("No household member can be aged to fit a single or couple household\n");
+	// The range, when there is one, excludes few ages with any weight, so this rarely repeats.
+	int age;
+	do
+	{
+		age = table.choose(ranf_mt(tn));
+	} while ((age < lo) || (age > hi));
+	return age;
+}
+
+void HouseholdAgeSampler::sample(int n, int tn, int* a) const
+{
+	Param const& p = params_;
+	int oldest = MAX_AGE - 1;
+
+	if (!p.DoHouseholds)
+	{
+		for (int i = 0; i < n; i++)
+			a[i] = any(tn);
+	}
+	else if (n == 1)
+	{
+		if (ranf_mt(tn) < p.OnePersHouseProbOld)
+			a[0] = weighted(old_, 0, oldest, tn);
+		else if ((p.OnePersHouseProbYoung > 0) && (ranf_mt(tn) < p.OnePersHouseProbYoung / (1 - p.OnePersHouseProbOld)))
+			a[0] = weighted(young_, 0, oldest, tn);
+		else
+			a[0] = between(p.MinAdultAge, oldest, tn);
+	}
+	else if (n == 2)
+	{
+		if (ranf_mt(tn) < p.TwoPersHouseProbOld)
+		{
+			a[0] = weighted(old_, 0, oldest, tn);
+			a[1] = weighted(old_, a[0] - p.MaxFMPartnerAgeGap, a[0] + p.MaxMFPartnerAgeGap, tn);
+		}
+		else if (ranf_mt(tn) < p.OneChildTwoPersProb / (1 - p.TwoPersHouseProbOld))
+		{
+			a[0] = between(0, p.MaxChildAge, tn);
+			a[1] = between(std::max(a[0] + p.MinParentAgeGap, p.MinAdultAge), a[0] + p.MaxParentAgeGap, tn);
+		}
+		else if ((p.TwoPersHouseProbYoung > 0) && (ranf_mt(tn) < p.TwoPersHouseProbYoung / (1 - p.TwoPersHouseProbOld - p.OneChildTwoPersProb)))
+		{
+			a[0] = weighted(young_, 0, oldest, tn);
+			a[1] = between(std::max(a[0] - p.MaxFMPartnerAgeGap, p.MinAdultAge), a[0] + p.MaxMFPartnerAgeGap, tn);
+		}
+		else
+		{
+			a[0] = between(p.MinAdultAge, oldest, tn);
+			a[1] = between(std::max(a[0] - p.MaxFMPartnerAgeGap, p.MinAdultAge), a[0] + p.MaxMFPartnerAgeGap, tn);
+		}
+	}
+	else
+	{
+		int nc;
+		if (n == 3)
+		{
+			if ((p.ZeroChildThreePersProb > 0) || (p.TwoChildThreePersProb > 0))
+				nc = (ranf_mt(tn) < p.ZeroChildThreePersProb) ? 0 : ((ranf_mt(tn) < p.TwoChildThreePersProb) ? 2 : 1);
+			else
+				nc = 1;
+		}
+		else if (n == 4)
+			nc = (ranf_mt(tn) < p.OneChildFourPersProb) ? 1 : 2;
+		else if (n == 5)
+			nc = (ranf_mt(tn) < p.ThreeChildFivePersProb) ? 3 : 2;
+		else
+			nc = n - 2 - (int)(3 * ranf_mt(tn));
+		if (nc <= 0)
+		{
+			a[0] = between(p.MinAdultAge, oldest, tn);
+			a[1] = between(p.MinAdultAge, oldest, tn);
+			a[2] = between(a[1] - p.MaxFMPartnerAgeGap, a[1] + p.MaxMFPartnerAgeGap - 1, tn);
+		}
+		else
+		{
+			int j, k;
+			do
+			{
+				a[0] = 0;
+				for (int i = 1; i < nc; i++)
+					a[i] = a[i - 1] + 1 + ((int)ignpoi_mt((double)(_I64(p.MeanChildAgeGap) - 1), tn));
+				a[0] = any(tn) - a[(int)(ranf_mt(tn) * ((double)nc))];
+				for (int i = 1; i < nc; i++) a[i] += a[0];
+				k = (((nc == 1) && (ranf_mt(tn) < p.OneChildProbYoungestChildUnderFive)) || ((nc == 2) && (ranf_mt(tn) < p.TwoChildrenProbYoungestUnderFive))
+					|| ((nc > 2) && (ranf_mt(tn) < p.ProbYoungestChildUnderFive))) ? 5 : p.MaxChildAge;
+			} while ((a[0] < 0) || (a[0] > k) || (a[nc - 1] > p.MaxChildAge));
+			j = a[nc - 1] - a[0] - (p.MaxParentAgeGap - p.MinParentAgeGap);
+			if (j > 0)
+				j += p.MaxParentAgeGap;
+			else
+				j = p.MaxParentAgeGap;
+			k = a[nc - 1];
+			a[nc] = between(std::max(k + p.MinParentAgeGap, p.MinAdultAge), a[0] + j, tn);
+			if ((n > nc + 1) && (ranf_mt(tn) > PROP_OTHER_PARENT_AWAY))
+				a[nc + 1] = between(std::max(std::max(a[nc] - p.MaxFMPartnerAgeGap, k + p.MinParentAgeGap), p.MinAdultAge),
+					std::min(a[nc] + p.MaxMFPartnerAgeGap, a[0] + j), tn);
+			if (n > nc + 2)
+			{
+				j = ((a[nc + 1] > a[nc]) ? a[nc + 1] : a[nc]) + p.OlderGenGap;
+				if (j >= MAX_AGE) j = MAX_AGE - 1;
+				if (j < p.NoChildPersAge) j = p.NoChildPersAge;
+				for (int i = nc + 2; i < n; i++)
+					a[i] = between(j, oldest, tn);
+			}
+		}
+	}
+}
+
+void HouseholdAgeSampler::sample_by_rejection(Param const& params, int const* inv_age_dist, int n, int tn, int* a)
+{
+	int i, j, k, nc;
+
+	if (!params.DoHouseholds)
+	{
+		for (i = 0; i < n; i++)
+			a[i] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+	}
+	else
+	{
+		if (n == 1)
+		{
+			if (ranf_mt(tn) < params.OnePersHouseProbOld)
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[0] < params.NoChildPersAge)
+					|| (ranf_mt(tn) > (((double)a[0]) - params.NoChildPersAge + 1) / (_I64(params.OldPersAge) - params.NoChildPersAge + 1)));
+			}
+			else if ((params.OnePersHouseProbYoung > 0) && (ranf_mt(tn) < params.OnePersHouseProbYoung / (1 - params.OnePersHouseProbOld)))
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				} while ((a[0] > params.YoungAndSingle) || (a[0] < params.MinAdultAge)
+					|| (ranf_mt(tn) > 1 - params.YoungAndSingleSlope * (((double)a[0]) - params.MinAdultAge) / (_I64(params.YoungAndSingle) - params.MinAdultAge)));
+			}
+			else
+				while ((a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))]) < params.MinAdultAge);
+		}
+		else if (n == 2)
+		{
+			if (ranf_mt(tn) < params.TwoPersHouseProbOld)
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[0] < params.NoChildPersAge)
+					|| (ranf_mt(tn) > (((double)a[0]) - params.NoChildPersAge + 1) / (_I64(params.OldPersAge) - params.NoChildPersAge + 1)));
+				do
+				{
+					a[1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[1] > a[0] + params.MaxMFPartnerAgeGap) || (a[1] < a[0] - params.MaxFMPartnerAgeGap) || (a[1] < params.NoChildPersAge)
+					|| (ranf_mt(tn) > (((double)a[1]) - params.NoChildPersAge + 1) / (_I64(params.OldPersAge) - params.NoChildPersAge + 1)));
+			}
+			else if (ranf_mt(tn) < params.OneChildTwoPersProb / (1 - params.TwoPersHouseProbOld))
+			{
+				while ((a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))]) > params.MaxChildAge);
+				do
+				{
+					a[1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[1] > a[0] + params.MaxParentAgeGap) || (a[1] < a[0] + params.MinParentAgeGap) || (a[1] < params.MinAdultAge));
+			}
+			else if ((params.TwoPersHouseProbYoung > 0) && (ranf_mt(tn) < params.TwoPersHouseProbYoung / (1 - params.TwoPersHouseProbOld - params.OneChildTwoPersProb)))
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				} while ((a[0] < params.MinAdultAge) || (a[0] > params.YoungAndSingle)
+					|| (ranf_mt(tn) > 1 - params.YoungAndSingleSlope * (((double)a[0]) - params.MinAdultAge) / (_I64(params.YoungAndSingle) - params.MinAdultAge)));
+				do
+				{
+					a[1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[1] > a[0] + params.MaxMFPartnerAgeGap) || (a[1] < a[0] - params.MaxFMPartnerAgeGap) || (a[1] < params.MinAdultAge));
+			}
+			else
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				} while (a[0] < params.MinAdultAge);
+				do
+				{
+					a[1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[1] > a[0] + params.MaxMFPartnerAgeGap) || (a[1] < a[0] - params.MaxFMPartnerAgeGap) || (a[1] < params.MinAdultAge));
+			}
+
+		}
+		else
+		{
+			if (n == 3)
+			{
+				if ((params.ZeroChildThreePersProb > 0) || (params.TwoChildThreePersProb > 0))
+					nc = (ranf_mt(tn) < params.ZeroChildThreePersProb) ? 0 : ((ranf_mt(tn) < params.TwoChildThreePersProb) ? 2 : 1);
+				else
+					nc = 1;
+			}
+			else if (n == 4)
+				nc = (ranf_mt(tn) < params.OneChildFourPersProb) ? 1 : 2;
+			else if (n == 5)
+				nc = (ranf_mt(tn) < params.ThreeChildFivePersProb) ? 3 : 2;
+			else
+				nc = n - 2 - (int)(3 * ranf_mt(tn));
+			if (nc <= 0)
+			{
+				do
+				{
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+					a[1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[1] < params.MinAdultAge) || (a[0] < params.MinAdultAge));
+				do
+				{
+					a[2] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+				}
+				while ((a[2] >= a[1] + params.MaxMFPartnerAgeGap) || (a[2] < a[1] - params.MaxFMPartnerAgeGap));
+			}
+			else
+			{
+				do
+				{
+					a[0] = 0;
+					for (i = 1; i < nc; i++)
+						a[i] = a[i - 1] + 1 + ((int)ignpoi_mt((double) (_I64(params.MeanChildAgeGap) - 1), tn));
+					a[0] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))] - a[(int)(ranf_mt(tn) * ((double)nc))];
+					for (i = 1; i < nc; i++) a[i] += a[0];
+					k = (((nc == 1) && (ranf_mt(tn) < params.OneChildProbYoungestChildUnderFive)) || ((nc == 2) && (ranf_mt(tn) < params.TwoChildrenProbYoungestUnderFive))
+						|| ((nc > 2) && (ranf_mt(tn) < params.ProbYoungestChildUnderFive))) ? 5 : params.MaxChildAge;
+				} while ((a[0] < 0) || (a[0] > k) || (a[nc - 1] > params.MaxChildAge));
+				j = a[nc - 1] - a[0] - (params.MaxParentAgeGap - params.MinParentAgeGap);
+				if (j > 0)
+					j += params.MaxParentAgeGap;
+				else
+					j = params.MaxParentAgeGap;
+				do
+				{
+					a[nc] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+					k = a[nc - 1];
+				} while ((a[nc] > a[0] + j) || (a[nc] < k + params.MinParentAgeGap) || (a[nc] < params.MinAdultAge));
+				if ((n > nc + 1) && (ranf_mt(tn) > PROP_OTHER_PARENT_AWAY))
+				{
+					do
+					{
+						a[nc + 1] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))];
+					} while ((a[nc + 1] > a[nc] + params.MaxMFPartnerAgeGap) || (a[nc + 1] < a[nc] - params.MaxFMPartnerAgeGap)
+						|| (a[nc + 1] > a[0] + j) || (a[nc + 1] < k + params.MinParentAgeGap) || (a[nc + 1] < params.MinAdultAge));
+				}
+
+				if (n > nc + 2)
+				{
+					j = ((a[nc + 1] > a[nc]) ? a[nc + 1] : a[nc]) + params.OlderGenGap;
+					if (j >= NUM_AGE_GROUPS * AGE_GROUP_WIDTH) j = NUM_AGE_GROUPS * AGE_GROUP_WIDTH - 1;
+					if (j < params.NoChildPersAge) j = params.NoChildPersAge;
+					for (i = nc + 2; i < n; i++)
+						while ((a[i] = inv_age_dist[(int)(1000.0 * ranf_mt(tn))]) < j);
+				}
+			}
+		}
+	}
+}
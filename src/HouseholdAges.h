@@ -0,0 +1,62 @@
+/** \file  HouseholdAges.h
+ *  \brief Draw the ages of the members of a household
+ */
+
+#ifndef COVIDSIM_HOUSEHOLDAGES_H_INCLUDED_
+#define COVIDSIM_HOUSEHOLDAGES_H_INCLUDED_
+
+#include <vector>
+
+#include "AliasTable.h"
+#include "Param.h"
+
+/// Household age model
+///	- picks number of children
+///	- tries to space them reasonably
+///	- picks parental ages to be consistent with childrens' and each other
+///	- other adults in large households are assumed to be grandparents
+///
+/// Most members' ages are drawn from the population's age distribution limited
+/// to a range, which depends on the household and members already drawn, and
+/// for older and young single people and couples, weighted by age. Rather than
+/// drawing from the whole distribution until an age fits, as the rejection
+/// sampler does, the sampler draws directly from the ages in range: ages are
+/// kept sorted, so those in a range are consecutive, and the weighted
+/// distributions have alias tables. Only the children's ages, which depend on
+/// each other, are still drawn by rejection. The distribution of households is
+/// the same either way.
+class HouseholdAgeSampler
+{
+	Param const& params_;
+	std::vector<int> ages_;		// The 1000 entries of the inverse CDF, sorted
+	std::vector<int> first_;	// first_[a] is the index of the first entry in ages_ >= a
+	AliasTable old_;			// Older single people and couples
+	AliasTable young_;			// Young single people and couples
+
+	int any(int tn) const;
+	int between(int lo, int hi, int tn) const;
+	int weighted(AliasTable const& table, int lo, int hi, int tn) const;
+
+public:
+
+	/// \param params        Household composition parameters, e.g. P
+	/// \param inv_age_dist  Inverse CDF of age with 1000 entries, e.g. State.InvAgeDist[ad]
+	HouseholdAgeSampler(Param const& params, int const* inv_age_dist);
+
+	/// Draw the ages of a household.
+	/// \param n     Number of people in the household
+	/// \param tn    Thread whose random number generator to use
+	/// \param ages  Set to the n ages
+	void sample(int n, int tn, int* ages) const;
+
+	/// Draw the ages of a household by rejection; this was the implementation
+	/// before the sampler, and is kept as the reference it is tested against.
+	/// \param params        Household composition parameters
+	/// \param inv_age_dist  Inverse CDF of age with 1000 entries
+	/// \param n             Number of people in the household
+	/// \param tn            Thread whose random number generator to use
+	/// \param ages          Set to the n ages
+	static void sample_by_rejection(Param const& params, int const* inv_age_dist, int n, int tn, int* ages);
+};
+
+#endif // COVIDSIM_HOUSEHOLDAGES_H_INCLUDED_
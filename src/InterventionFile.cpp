@@ -0,0 +1,479 @@
+/** \file  InterventionFile.cpp
+ *  \brief Read intervention files and their binary cache
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "Error.h"
+#include "Files.h"
+#include "InterventionFile.h"
+
+static const uint32_t CACHE_VERSION = 2;
+
+namespace
+{
+	struct Tag
+	{
+		bool close;			///< </name> rather than <name>
+		bool empty;			///< <name/>, which has no content or closing tag
+		std::string name;
+		int line;
+	};
+
+	/// Walks through the tags of an XML document once, keeping track of the line
+	/// for error messages. Comments, processing instructions and declarations are
+	/// skipped, as are attributes.
+	class Reader
+	{
+	public:
+		Reader(const char* buf, std::size_t len, std::string const& filename)
+			: p_(buf), end_(buf + len), filename_(filename) {}
+
+		int line() const { return line_; }
+		const char* filename() const { return filename_.c_str(); }
+
+		/// Checks the document starts with an XML declaration and moves past it.
+		bool declaration()
+		{
+			if ((end_ - p_ >= 3) && (memcmp(p_, "\xEF\xBB\xBF", 3) == 0)) p_ += 3;
+			skip_space();
+			if ((end_ - p_ < 5) || (memcmp(p_, "<?xml", 5) != 0)) return false;
+			return skip_past("?>");
+		}
+
+		/// Moves to the next tag, skipping any text before it.
+		/// \return false at the end of the document
+		bool next(Tag& tag)
+		{
+			while (true)
+			{
+				const char* lt = (const char*)memchr(p_, '<', end_ - p_);
+				if (lt == NULL)
+				{
+					advance(end_);
+					return false;
+				}
+				advance(lt);
+				if (!markup()) return read_tag(tag);
+			}
+		}
+
+		/// Reads the text content of an element whose opening tag has just been
+		/// read, up to and including its closing tag.
+		std::string text(Tag const& tag)
+		{
+			std::string value;
+			if (tag.empty) return value;
+			while (true)
+			{
+				const char* lt = (const char*)memchr(p_, '<', end_ - p_);
+				if (lt == NULL) ERR_CRITICAL_FMT("%s:%d: <%s> is not closed\n", filename(), tag.line, tag.name.c_str());
+				append_text(value, lt);
+				if ((end_ - p_ >= 9) && (memcmp(p_, "<![CDATA[", 9) == 0))
+				{
+					const char* start = p_ + 9;
+					if (!skip_past("]]>")) ERR_CRITICAL_FMT("%s:%d: Unterminated CDATA section\n", filename(), line_);
+					value.append(start, p_ - 3);
+					continue;
+				}
+				if (markup()) continue;
+				Tag inner;
+				read_tag(inner);
+				if (!inner.close) ERR_CRITICAL_FMT("%s:%d: <%s> should only hold a value, not <%s>\n", filename(), inner.line, tag.name.c_str(), inner.name.c_str());
+				if (inner.name != tag.name) ERR_CRITICAL_FMT("%s:%d: </%s> found where </%s> was expected\n", filename(), inner.line, inner.name.c_str(), tag.name.c_str());
+				return value;
+			}
+		}
+
+		/// Skips the content of an element whose opening tag has just been read,
+		/// up to and including its closing tag.
+		void skip(Tag const& tag)
+		{
+			if (tag.empty) return;
+			std::vector<std::string> open(1, tag.name);
+			Tag inner;
+			while (!open.empty())
+			{
+				if (!next(inner)) ERR_CRITICAL_FMT("%s:%d: <%s> is not closed\n", filename(), tag.line, open.back().c_str());
+				if (!inner.close)
+				{
+					if (!inner.empty) open.push_back(inner.name);
+				}
+				else if (inner.name != open.back())
+					ERR_CRITICAL_FMT("%s:%d: </%s> found where </%s> was expected\n", filename(), inner.line, inner.name.c_str(), open.back().c_str());
+				else
+					open.pop_back();
+			}
+		}
+
+	private:
+		void advance(const char* to)
+		{
+			line_ += (int)std::count(p_, to, '\n');
+			p_ = to;
+		}
+
+		void skip_space()
+		{
+			const char* q = p_;
+			while ((q < end_) && ((*q == ' ') || (*q == '\t') || (*q == '\r') || (*q == '\n'))) q++;
+			advance(q);
+		}
+
+		// Moves past the next occurrence of s, returning false if there isn't one.
+		bool skip_past(const char* s)
+		{
+			const char* found = std::search(p_, end_, s, s + strlen(s));
+			if (found == end_) return false;
+			advance(found + strlen(s));
+			return true;
+		}
+
+		// At a '<': skips a comment, processing instruction or declaration,
+		// returning false if it is a tag instead.
+		bool markup()
+		{
+			if ((end_ - p_ >= 4) && (memcmp(p_, "<!--", 4) == 0))
+			{
+				if (!skip_past("-->")) ERR_CRITICAL_FMT("%s:%d: Unterminated comment\n", filename(), line_);
+				return true;
+			}
+			if ((end_ - p_ >= 9) && (memcmp(p_, "<![CDATA[", 9) == 0))
+			{
+				if (!skip_past("]]>")) ERR_CRITICAL_FMT("%s:%d: Unterminated CDATA section\n", filename(), line_);
+				return true;
+			}
+			if ((end_ - p_ >= 2) && ((p_[1] == '?') || (p_[1] == '!')))
+			{
+				if (!skip_past((p_[1] == '?') ? "?>" : ">")) ERR_CRITICAL_FMT("%s:%d: Unterminated <%c\n", filename(), line_, p_[1]);
+				return true;
+			}
+			return false;
+		}
+
+		// At a '<' starting a tag.
+		bool read_tag(Tag& tag)
+		{
+			tag.line = line_;
+			const char* q = p_ + 1;
+			tag.close = (q < end_) && (*q == '/');
+			if (tag.close) q++;
+			const char* name = q;
+			while ((q < end_) && (*q != '>') && (*q != '/') && (*q != ' ') && (*q != '\t') && (*q != '\r') && (*q != '\n')) q++;
+			tag.name.assign(name, q);
+			if (tag.name.empty()) ERR_CRITICAL_FMT("%s:%d: Tag has no name\n", filename(), tag.line);
+			// Skip attributes, which may hold '>' in quotes.
+			char quote = 0;
+			for (; q < end_; q++)
+				if (quote) { if (*q == quote) quote = 0; }
+				else if ((*q == '"') || (*q == '\'')) quote = *q;
+				else if (*q == '>') break;
+			if (q == end_) ERR_CRITICAL_FMT("%s:%d: <%s is not closed with '>'\n", filename(), tag.line, tag.name.c_str());
+			tag.empty = !tag.close && (q[-1] == '/');
+			advance(q + 1);
+			return true;
+		}
+
+		// Appends the text up to lt, replacing entity and character references.
+		void append_text(std::string& value, const char* lt)
+		{
+			const char* q = p_;
+			while (q < lt)
+			{
+				const char* amp = (const char*)memchr(q, '&', lt - q);
+				if (amp == NULL) amp = lt;
+				value.append(q, amp);
+				if (amp == lt) break;
+				const char* semi = (const char*)memchr(amp, ';', lt - amp);
+				if (semi == NULL) ERR_CRITICAL_FMT("%s:%d: Unterminated '&' reference\n", filename(), line_);
+				std::string ref(amp + 1, semi);
+				if (ref == "lt") value += '<';
+				else if (ref == "gt") value += '>';
+				else if (ref == "amp") value += '&';
+				else if (ref == "quot") value += '"';
+				else if (ref == "apos") value += '\'';
+				else
+				{
+					long c = -1;
+					if ((ref.size() > 2) && (ref[0] == '#') && ((ref[1] == 'x') || (ref[1] == 'X'))) c = strtol(ref.c_str() + 2, NULL, 16);
+					else if ((ref.size() > 1) && (ref[0] == '#')) c = strtol(ref.c_str() + 1, NULL, 10);
+					if ((c <= 0) || (c > 127)) ERR_CRITICAL_FMT("%s:%d: Unsupported reference &%s;\n", filename(), line_, ref.c_str());
+					value += (char)c;
+				}
+				q = semi + 1;
+			}
+			advance(lt);
+		}
+
+		const char* p_;
+		const char* end_;
+		std::string filename_;
+		int line_ = 1;
+	};
+
+	/// The fields of a <parameters> element, with the line each is on.
+	class Fields
+	{
+	public:
+		Fields(Reader& reader, int line) : reader_(reader), line_(line) {}
+
+		void add(std::string const& name, std::string const& value, int line)
+		{
+			fields_.emplace(name, std::make_pair(value, line)); // the first of any repeats is used
+		}
+
+		bool has(const char* name) const { return fields_.count(name) != 0; }
+
+		std::string const& text(const char* name) const
+		{
+			auto field = fields_.find(name);
+			if (field == fields_.end())
+				ERR_CRITICAL_FMT("%s:%d: Incomplete intervention parameter specification: no <%s>\n", reader_.filename(), line_, name);
+			return field->second.first;
+		}
+
+		/// Reads a required field with sscanf format, which converts one value.
+		template <typename T> void get(const char* name, const char* format, T* value) const
+		{
+			if (sscanf(text(name).c_str(), format, value) != 1)
+				ERR_CRITICAL_FMT("%s:%d: Can't read <%s> from \"%s\"\n", reader_.filename(), fields_.find(name)->second.second, name, text(name).c_str());
+		}
+
+		/// As get, but leaves value unchanged if the field is missing.
+		template <typename T> void get_optional(const char* name, const char* format, T* value) const
+		{
+			if (has(name)) get(name, format, value);
+		}
+
+	private:
+		Reader& reader_;
+		int line_;
+		std::map<std::string, std::pair<std::string, int>> fields_;
+	};
+
+	InterventionFile::Spec parse_intervention(Reader& reader, Tag const& intervention)
+	{
+		InterventionFile::Spec spec;
+		Tag tag;
+		if (!reader.next(tag) || tag.close || (tag.name != "parameters"))
+			ERR_CRITICAL_FMT("%s:%d: Incomplete intervention parameter specification: <parameters> should come first\n", reader.filename(), intervention.line);
+
+		Fields fields(reader, tag.line);
+		if (!tag.empty)
+			while (true)
+			{
+				if (!reader.next(tag)) ERR_CRITICAL_FMT("%s:%d: <parameters> is not closed\n", reader.filename(), intervention.line);
+				if (tag.close)
+				{
+					if (tag.name != "parameters") ERR_CRITICAL_FMT("%s:%d: </%s> found where </parameters> was expected\n", reader.filename(), tag.line, tag.name.c_str());
+					break;
+				}
+				fields.add(tag.name, reader.text(tag), tag.line);
+			}
+
+		Intervention& interv = spec.interv;
+		interv = Intervention();
+		std::string type = fields.text("Type");
+		if (type == "Treatment") interv.InterventionType = 0;
+		else if (type == "Vaccination") interv.InterventionType = 1;
+		else if (type == "ITN") interv.InterventionType = 2;
+		else if (type == "IRS") interv.InterventionType = 3;
+		else if (type == "GM") interv.InterventionType = 4;
+		else if (type == "MSAT") interv.InterventionType = 5;
+		else fields.get("Type", "%i", &interv.InterventionType);
+		fields.get("AUThresh", "%i", &interv.DoAUThresh);
+		fields.get("StartTime", "%lf", &interv.StartTime);
+		fields.get("StopTime", "%lf", &interv.StopTime);
+		fields.get("MinDuration", "%lf", &interv.MinDuration);
+		interv.MinDuration *= DAYS_PER_YEAR;
+		fields.get("RepeatInterval", "%lf", &interv.RepeatInterval);
+		interv.RepeatInterval *= DAYS_PER_YEAR;
+		fields.get("MaxPrevAtStart", "%lf", &interv.StartThresholdHigh);
+		fields.get("MinPrevAtStart", "%lf", &interv.StartThresholdLow);
+		fields.get("MaxPrevAtStop", "%lf", &interv.StopThreshold);
+		fields.get_optional("NoStartAfterMinDur", "%i", &interv.NoStartAfterMin);
+		fields.get("Level", "%lf", &interv.Level);
+		fields.get_optional("LevelCellVar", "%lf", &interv.LevelCellVar);
+		fields.get_optional("LevelAUVar", "%lf", &interv.LevelAUVar);
+		fields.get_optional("LevelCountryVar", "%lf", &interv.LevelCountryVar);
+		fields.get_optional("LevelClustering", "%lf", &interv.LevelClustering);
+		fields.get_optional("ControlParam", "%lf", &interv.ControlParam);
+		fields.get_optional("TimeOffset", "%lf", &interv.TimeOffset);
+		fields.get("MaxRounds", "%u", &interv.MaxRounds);
+		fields.get("MaxResource", "%u", &interv.MaxResource);
+		spec.num_sequential_replicas = 0;
+		fields.get_optional("NumSequentialReplicas", "%i", &spec.num_sequential_replicas);
+
+		if (!reader.next(tag) || tag.close || ((tag.name != "adunits") && (tag.name != "countries")))
+			ERR_CRITICAL_FMT("%s:%d: Incomplete adunits/countries specification: <adunits> or <countries> should follow </parameters>\n", reader.filename(), reader.line());
+		spec.by_country = (tag.name == "countries");
+		std::string list = tag.name, item = spec.by_country ? "C" : "A";
+		if (!tag.empty)
+			while (true)
+			{
+				if (!reader.next(tag)) ERR_CRITICAL_FMT("%s:%d: <%s> is not closed\n", reader.filename(), intervention.line, list.c_str());
+				if (tag.close)
+				{
+					if (tag.name != list) ERR_CRITICAL_FMT("%s:%d: </%s> found where </%s> was expected\n", reader.filename(), tag.line, tag.name.c_str(), list.c_str());
+					break;
+				}
+				if (tag.name != item)
+				{
+					reader.skip(tag);
+					continue;
+				}
+				// Only the first word is the name or id, as with "%s".
+				std::string value = reader.text(tag);
+				std::size_t start = value.find_first_not_of(" \t\r\n");
+				if (start == std::string::npos) ERR_CRITICAL_FMT("%s:%d: Empty <%s>\n", reader.filename(), tag.line, item.c_str());
+				spec.units.push_back(value.substr(start, value.find_first_of(" \t\r\n", start) - start));
+			}
+
+		if (!reader.next(tag) || !tag.close || (tag.name != "intervention"))
+			ERR_CRITICAL_FMT("%s:%d: Incorrect intervention specification: </intervention> should follow </%s>\n", reader.filename(), reader.line(), list.c_str());
+		return spec;
+	}
+
+	void write_u32(FILE* dat, uint32_t value)
+	{
+		Files::fwrite_big(&value, sizeof(uint32_t), 1, dat);
+	}
+
+	void write_u64(FILE* dat, uint64_t value)
+	{
+		Files::fwrite_big(&value, sizeof(uint64_t), 1, dat);
+	}
+
+	void write_string(FILE* dat, std::string const& s)
+	{
+		write_u32(dat, (uint32_t)s.size());
+		Files::fwrite_big((void*)s.data(), 1, s.size(), dat);
+	}
+
+	uint32_t read_u32(FILE* dat, std::string const& filename)
+	{
+		uint32_t value;
+		if (Files::fread_big(&value, sizeof(uint32_t), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading intervention cache %s\n", filename.c_str());
+		return value;
+	}
+
+	uint64_t read_u64(FILE* dat, std::string const& filename)
+	{
+		uint64_t value;
+		if (Files::fread_big(&value, sizeof(uint64_t), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading intervention cache %s\n", filename.c_str());
+		return value;
+	}
+
+	std::string read_string(FILE* dat, std::string const& filename)
+	{
+		std::string s(read_u32(dat, filename), '\0');
+		if (Files::fread_big(&s[0], 1, s.size(), dat) != s.size())
+			ERR_CRITICAL_FMT("Error while reading intervention cache %s\n", filename.c_str());
+		return s;
+	}
+}
+
+std::vector<InterventionFile::Spec> InterventionFile::parse(const char* buf, std::size_t len, std::string const& filename)
+{
+	Reader reader(buf, len, filename);
+	if (!reader.declaration()) ERR_CRITICAL_FMT("Intervention file %s not XML.\n", filename.c_str());
+
+	std::vector<Spec> specs;
+	Tag tag;
+	if (!reader.next(tag) || tag.close || (tag.name != "InterventionSettings"))
+		ERR_CRITICAL_FMT("%s:%d: Intervention has no top level <InterventionSettings>.\n", filename.c_str(), reader.line());
+	if (tag.empty) return specs;
+	int top_line = tag.line;
+	while (true)
+	{
+		if (!reader.next(tag)) ERR_CRITICAL_FMT("%s:%d: Intervention has no top level closure.\n", filename.c_str(), top_line);
+		if (tag.close)
+		{
+			if (tag.name != "InterventionSettings") ERR_CRITICAL_FMT("%s:%d: </%s> found where </InterventionSettings> was expected\n", filename.c_str(), tag.line, tag.name.c_str());
+			break;
+		}
+		if (tag.name == "intervention")
+		{
+			if (tag.empty) ERR_CRITICAL_FMT("%s:%d: Incomplete intervention parameter specification: empty <intervention/>\n", filename.c_str(), tag.line);
+			specs.push_back(parse_intervention(reader, tag));
+		}
+		else
+			reader.skip(tag);
+	}
+	return specs;
+}
+
+std::vector<InterventionFile::Spec> InterventionFile::read(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	std::string buf;
+	char chunk[65536];
+	std::size_t n;
+	while ((n = fread(chunk, 1, sizeof(chunk), dat)) > 0) buf.append(chunk, n);
+	if (ferror(dat)) ERR_CRITICAL_FMT("Error while reading intervention file %s\n", filename.c_str());
+	Files::xfclose(dat);
+	return parse(buf.data(), buf.size(), filename);
+}
+
+void InterventionFile::write_cache(std::string const& filename, std::vector<Contents> const& contents)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	write_u32(dat, CACHE_HEADER);
+	write_u32(dat, CACHE_VERSION);
+	write_u32(dat, (uint32_t)sizeof(Intervention));
+	write_u32(dat, (uint32_t)contents.size());
+	for (Contents const& file : contents)
+	{
+		write_string(dat, file.filename);
+		write_u64(dat, file.size);
+		write_u64(dat, (uint64_t)file.mtime);
+		write_u32(dat, (uint32_t)file.specs.size());
+		for (Spec const& spec : file.specs)
+		{
+			Files::fwrite_big((void*)&spec.interv, sizeof(Intervention), 1, dat);
+			write_u32(dat, (uint32_t)spec.num_sequential_replicas);
+			write_u32(dat, spec.by_country ? 1 : 0);
+			write_u32(dat, (uint32_t)spec.units.size());
+			for (std::string const& unit : spec.units) write_string(dat, unit);
+		}
+	}
+	Files::xfclose(dat);
+}
+
+bool InterventionFile::read_cache(std::string const& filename, std::vector<Contents>& contents)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	uint32_t header[3];
+	if ((Files::fread_big(header, sizeof(uint32_t), 3, dat) != 3) || (header[0] != CACHE_HEADER)
+		|| (header[1] != CACHE_VERSION) || (header[2] != sizeof(Intervention)))
+	{
+		Files::xfclose(dat);
+		return false;
+	}
+	contents.resize(read_u32(dat, filename));
+	for (Contents& file : contents)
+	{
+		file.filename = read_string(dat, filename);
+		file.size = read_u64(dat, filename);
+		file.mtime = (int64_t)read_u64(dat, filename);
+		file.specs.resize(read_u32(dat, filename));
+		for (Spec& spec : file.specs)
+		{
+			if (Files::fread_big(&spec.interv, sizeof(Intervention), 1, dat) != 1)
+				ERR_CRITICAL_FMT("Error while reading intervention cache %s\n", filename.c_str());
+			spec.num_sequential_replicas = (int)read_u32(dat, filename);
+			spec.by_country = (read_u32(dat, filename) != 0);
+			spec.units.resize(read_u32(dat, filename));
+			for (std::string& unit : spec.units) unit = read_string(dat, filename);
+		}
+	}
+	Files::xfclose(dat);
+	return true;
+}
@@ -0,0 +1,85 @@
+/** \file  InterventionFile.h
+ *  \brief Read intervention files and their binary cache
+ */
+
+#ifndef COVIDSIM_INTERVENTIONFILE_H_INCLUDED_
+#define COVIDSIM_INTERVENTIONFILE_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+
+namespace InterventionFile
+{
+/// First 4 bytes of a binary intervention cache. This continues with a uint32
+/// format version, uint32 sizeof(Intervention), a uint32 file count and then,
+/// for each file, its name, uint64 size, int64 modification time, a uint32
+/// count of its Specs and the Specs. Strings are a uint32 length followed by
+/// that many bytes.
+const uint32_t CACHE_HEADER = 0xf0f0f1c0;
+
+/// One <intervention> of an intervention file, as parsed but not yet applied to
+/// the admin units (which draws random numbers).
+struct Spec
+{
+	Intervention interv;				///< Durations already converted from years to days
+	int num_sequential_replicas;		///< Copies after the first, each starting where the last stopped
+	bool by_country;					///< units are <C> countries rather than <A> admin units
+	std::vector<std::string> units;		///< Names or ids, as written in the file
+};
+
+/// The interventions of one intervention file.
+struct Contents
+{
+	std::string filename;
+	uint64_t size;				///< Of the file when it was read, as given by Files::stat_file
+	int64_t mtime;
+	std::vector<Spec> specs;
+};
+
+
+
+/** \brief           Parse an in-memory intervention file.
+ *  \param  buf      XML text to parse (need not be NUL terminated)
+ *  \param  len      Length of \a buf in bytes
+ *  \param  filename Name used in error messages
+ *  \return          The interventions in file order
+ *
+ *  A single pass over \a buf: each <parameters> element is read once into its
+ *  fields, whatever their order. Errors give the line they were found on.
+ */
+
+  std::vector<Spec> parse(const char* buf, std::size_t len, std::string const& filename);
+
+
+
+/** \brief           Read and parse an intervention file; see parse.
+ *  \param  filename The intervention file to read
+ */
+
+  std::vector<Spec> read(std::string const& filename);
+
+
+
+/** \brief            Write parsed intervention files to a binary cache.
+ *  \param  filename  The cache file to write
+ *  \param  contents  The intervention files, in the order they are applied
+ */
+
+  void write_cache(std::string const& filename, std::vector<Contents> const& contents);
+
+
+
+/** \brief            Read a binary intervention cache.
+ *  \param  filename  The cache file to read
+ *  \param  contents  Set to the intervention files it holds
+ *  \return           false if the file isn't a cache written by this version of CovidSim
+ */
+
+  bool read_cache(std::string const& filename, std::vector<Contents>& contents);
+} // namespace InterventionFile
+
+#endif // COVIDSIM_INTERVENTIONFILE_H_INCLUDED_
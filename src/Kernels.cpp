@@ -1,4 +1,6 @@
 #include <cmath>
+#include <memory>
+#include <vector>
 #include "Kernels.h"
 #include "Error.h"
 #include "Dist.h"
@@ -8,47 +10,104 @@ using namespace CovidSim::TBD1;
 
 void KernelLookup::setup(double longest_distance)
 {
-	size_t size = (size_t)size_ + 1;
-	lookup_.resize(size);
-	hi_res_.resize(size);
 	delta_ = longest_distance / size_;
+	cache_.clear();
+	tables_.reset();
+	cell_tables_.reset();
+	lookup_ = hi_res_ = nullptr;
 }
 
-void KernelLookup::init(double norm, KernelStruct& kernel)
+static double (KernelStruct::*kernel_function(const KernelStruct& kernel))(double) const
 {
-	double (KernelStruct::*fp)(double) const;
-
 	if (kernel.type_ == 1)
-		fp = &KernelStruct::exponential;
+		return &KernelStruct::exponential;
 	else if (kernel.type_ == 2)
-		fp = &KernelStruct::power;
+		return &KernelStruct::power;
 	else if (kernel.type_ == 3)
-		fp = &KernelStruct::gaussian;
+		return &KernelStruct::gaussian;
 	else if (kernel.type_ == 4)
-		fp = &KernelStruct::step;
+		return &KernelStruct::step;
 	else if (kernel.type_ == 5)
-		fp = &KernelStruct::power_b;
+		return &KernelStruct::power_b;
 	else if (kernel.type_ == 6)
-		fp = &KernelStruct::power_us;
+		return &KernelStruct::power_us;
 	else if (kernel.type_ == 7)
-		fp = &KernelStruct::power_exp;
-	else
-		ERR_CRITICAL_FMT("Unknown kernel type %d.\n", kernel.type_);
+		return &KernelStruct::power_exp;
+	ERR_CRITICAL_FMT("Unknown kernel type %d.\n", kernel.type_);
+}
+
+std::shared_ptr<const KernelLookup::Tables> KernelLookup::find(double norm, const KernelStruct& kernel) const
+{
+	for (const CacheEntry& entry : cache_)
+		if (entry.norm_ == norm && entry.kernel_ == kernel)
+			return entry.tables_;
+	return nullptr;
+}
 
+void KernelLookup::prepare(double norm, const std::vector<KernelStruct>& kernels)
+{
+	std::vector<KernelStruct> missing;
+	for (const KernelStruct& kernel : kernels)
+	{
+		bool seen = (find(norm, kernel) != nullptr);
+		for (const KernelStruct& k : missing)
+			seen = seen || k == kernel;
+		if (!seen) missing.push_back(kernel);
+	}
+	if (missing.empty()) return;
+
+	int num_kernels = (int)missing.size();
+	std::vector<double (KernelStruct::*)(double) const> fp(num_kernels);
+	std::vector<std::shared_ptr<Tables>> tables(num_kernels);
+	for (int k = 0; k < num_kernels; k++)
+	{
+		fp[k] = kernel_function(missing[k]);
+		tables[k] = std::make_shared<Tables>();
+		tables[k]->lookup_.resize((size_t)size_ + 1);
+		tables[k]->hi_res_.resize((size_t)size_ + 1);
+	}
+
+	// One loop over the entries of every table, so that all of the kernels are built at once.
+	long long num_entries = (long long)size_ + 1;
 #pragma omp parallel for schedule(static,500) default(none) \
-		shared(kernel, fp, norm)
-	for (int i = 0; i <= size_; i++)
+		shared(missing, fp, tables, norm, num_entries, num_kernels)
+	for (long long n = 0; n < num_kernels * num_entries; n++)
 	{
-		lookup_[i] = (kernel.*fp)(i * delta_) / norm;
-		hi_res_[i] = (kernel.*fp)(i * delta_ / expansion_factor_) / norm;
+		int k = (int)(n / num_entries);
+		int i = (int)(n % num_entries);
+		const KernelStruct& kernel = missing[k];
+		tables[k]->lookup_[i] = (kernel.*fp[k])(i * delta_) / norm;
+		tables[k]->hi_res_[i] = (kernel.*fp[k])(i * delta_ / expansion_factor_) / norm;
 	}
+
+	for (int k = 0; k < num_kernels; k++)
+		cache_.push_back({ missing[k], norm, tables[k] });
+}
+
+void KernelLookup::init(double norm, KernelStruct& kernel)
+{
+	prepare(norm, { kernel });
+	tables_ = find(norm, kernel);
+	lookup_ = tables_->lookup_.data();
+	hi_res_ = tables_->hi_res_.data();
+}
+
+void KernelLookup::release()
+{
+	std::vector<CacheEntry> in_use;
+	for (CacheEntry& entry : cache_)
+		if (entry.tables_ == tables_)
+			in_use.push_back(entry);
+	cache_.swap(in_use);
 }
 
 /// \todo Move this to somewhere more appropriate
-void KernelLookup::init(const KernelLookup& lookup, Cell **cell_lookup, int cell_lookup_size)
+void KernelLookup::init(Cell **cell_lookup, int cell_lookup_size)
 {
+	// The cells' max_trans only depend on the kernel, so are kept if they're already for this one.
+	bool current = (cell_tables_ == tables_ && cell_tables_lookup_ == cell_lookup && cell_tables_size_ == cell_lookup_size);
 #pragma omp parallel for schedule(static,500) default(none) \
-		shared(lookup, cell_lookup, cell_lookup_size)
+		shared(cell_lookup, cell_lookup_size, current)
 	for (int i = 0; i < cell_lookup_size; i++)
 	{
 		Cell *l = cell_lookup[i];
@@ -56,15 +115,23 @@ void KernelLookup::init(const KernelLookup& lookup, Cell **cell_lookup, int cell
 		for (int j = 0; j < cell_lookup_size; j++)
 		{
 			Cell *m = cell_lookup[j];
-			l->max_trans[j] = (float)lookup.num(dist2_cc_min(l, m));
+			if (!current) l->max_trans[j] = (float)num(dist2_cc_min(l, m));
 			l->tot_prob += l->max_trans[j] * m->n;
 		}
 	}
+	cell_tables_ = tables_;
+	cell_tables_lookup_ = cell_lookup;
+	cell_tables_size_ = cell_lookup_size;
 }
 
 //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// **** //// ****
 //// **** KERNEL DEFINITIONS
 
+bool KernelStruct::operator==(const KernelStruct& other) const
+{
+	return type_ == other.type_ && shape_ == other.shape_ && scale_ == other.scale_ && p3_ == other.p3_ && p4_ == other.p4_;
+}
+
 double KernelStruct::exponential(double r2) const
 {
 	return exp(-sqrt(r2) / scale_);
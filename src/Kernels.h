@@ -1,6 +1,7 @@
 #ifndef COVIDSIM_KERNELS_H_INCLUDED_
 #define COVIDSIM_KERNELS_H_INCLUDED_
 
+#include <memory>
 #include <vector>
 
 struct Cell;
@@ -28,6 +29,9 @@ namespace CovidSim
       /// Distribution parameter
       double p4_;
 
+      /// \return Whether both are the same distribution with the same parameters
+      bool operator==(const KernelStruct& other) const;
+
       /// \param r2 The distance squared
       /// \return Probability
       double exponential(double r2) const;
@@ -80,15 +84,42 @@ namespace CovidSim
     struct KernelLookup
     {
     private:
-      /// Kernel lookup table
-      std::vector<double> lookup_;
-
-      /// Hi-res kernel lookup table for closer distances
-      std::vector<double> hi_res_;
+      /// Lookup tables for one kernel; never modified once built
+      struct Tables
+      {
+        std::vector<double> lookup_;
+        std::vector<double> hi_res_;
+      };
+
+      /// Tables built for earlier kernels, so that switching back to one is cheap
+      struct CacheEntry
+      {
+        KernelStruct kernel_;
+        double norm_;
+        std::shared_ptr<const Tables> tables_;
+      };
+
+      /// The tables in use
+      std::shared_ptr<const Tables> tables_;
+
+      /// Kernel lookup table, tables_->lookup_.data()
+      const double *lookup_ = nullptr;
+
+      /// Hi-res kernel lookup table for closer distances, tables_->hi_res_.data()
+      const double *hi_res_ = nullptr;
 
       /// Longest distance / lookup_.size()
       double delta_;
 
+      std::vector<CacheEntry> cache_;
+
+      /// The tables whose values are in the cells' max_trans, and those cells
+      std::shared_ptr<const Tables> cell_tables_;
+      Cell **cell_tables_lookup_ = nullptr;
+      int cell_tables_size_ = 0;
+
+      std::shared_ptr<const Tables> find(double norm, const KernelStruct& kernel) const;
+
     public:
       /// Size of kernel lookup table
       int size_ = 4000000;
@@ -96,20 +127,32 @@ namespace CovidSim
       /// The hi-res kernel extends only to the longest distance / expansion_factor_
       int expansion_factor_;
 
-      /// Resize the vectors and calculate delta_
+      /// Calculate delta_ and discard any cached tables
       /// \param longest_distance The longest distance to lookup
       void setup(double longest_distance);
 
-      /// Set the values in the lookup table
+      /// Build the tables for several kernels at once, building those not
+      /// already cached concurrently. They are cached for later calls to init.
+      /// \param norm Value to divide the probability by
+      /// \param kernels The kernels to build tables for; duplicates are built once
+      void prepare(double norm, const std::vector<KernelStruct>& kernels);
+
+      /// Set the values in the lookup table, reusing cached tables if this
+      /// kernel has been used before
       /// \param norm Value to divide the probability by
       /// \param kernel The kernel to use when calculating the lookup tables
       void init(double norm, KernelStruct& kernel);
 
-      /// Set the values in the cell lookup table
-      /// \param lookup The kernel lookup table
+      /// Set each cell's max_trans to the kernel value at the minimum distance
+      /// to every other cell, and its tot_prob to their sum weighted by the other
+      /// cells' populations. The kernel is only evaluated if the cells don't
+      /// already hold the current kernel's values.
       /// \param cell_lookup The cell lookup table
       /// \param cell_lookup_size Number of Cell*
-      static void init(const KernelLookup& lookup, Cell **cell_lookup, int cell_lookup_size);
+      void init(Cell **cell_lookup, int cell_lookup_size);
+
+      /// Free the cached tables, other than those in use
+      void release();
 
       /// Perform a lookup
       /// \param r2 The distance squared
@@ -7,10 +7,18 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <cstdint>
 
 #include "Error.h"
 #include "Files.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
 void* Memory::xmalloc(std::size_t size) noexcept
 {
   /* Ensure we're going to allocate some memory.  */
@@ -76,3 +84,66 @@ void Memory::xfree(void* ptr) noexcept
   std::free(ptr);
 }
 
+std::size_t Memory::peak_resident_size() noexcept
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+  return counters.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  return (std::size_t)usage.ru_maxrss; // bytes on macOS
+#else
+  return (std::size_t)usage.ru_maxrss * 1024; // kilobytes on Linux
+#endif
+#endif
+}
+
+
+Memory::Arena::Arena(std::size_t block_size) noexcept : block_size_(block_size)
+{
+}
+
+Memory::Arena::~Arena()
+{
+  release();
+}
+
+void* Memory::Arena::allocate(std::size_t size, std::size_t align) noexcept
+{
+  if (size == 0) size = 1;
+  std::lock_guard<std::mutex> lock(mutex_);
+  used_ += size;
+  if (size > block_size_ / 4)
+  {
+    // Keep using the current block for small allocations.
+    void* block = xcalloc(size, 1);
+    blocks_.push_back(block);
+    return block;
+  }
+  std::size_t padding = (align - reinterpret_cast<std::uintptr_t>(next_) % align) % align;
+  if (next_ == nullptr || padding + size > remaining_)
+  {
+    next_ = static_cast<char*>(xcalloc(block_size_, 1));
+    blocks_.push_back(next_);
+    remaining_ = block_size_;
+    padding = 0;
+  }
+  void* result = next_ + padding;
+  next_ += padding + size;
+  remaining_ -= padding + size;
+  return result;
+}
+
+void Memory::Arena::release() noexcept
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (void* block : blocks_)
+    xfree(block);
+  blocks_.clear();
+  next_ = nullptr;
+  remaining_ = 0;
+  used_ = 0;
+}
@@ -11,6 +11,8 @@
 
 
 #include <cstddef>
+#include <mutex>
+#include <vector>
 
 namespace Memory
 {
@@ -46,6 +48,64 @@ void* xrealloc(void* ptr, std::size_t size) noexcept;
  *  \param ptr Pointer to memory to free.
  */
 void xfree(void* ptr) noexcept;
+
+/** \brief  Largest amount of physical memory the process has used so far.
+ *  \return Peak resident set size in bytes, or 0 if it is not known
+ */
+std::size_t peak_resident_size() noexcept;
+
+/** \brief Bump allocator for the many small arrays built while setting up the
+ *         model, which are kept until the arena is released.
+ *
+ *  Memory is handed out from large blocks, so allocations made one after the
+ *  other are contiguous, and there is no per allocation overhead. Allocations
+ *  can't be freed individually; release() frees them all at once. It is safe
+ *  to allocate from several threads.
+ */
+class Arena
+{
+public:
+  /** \brief             Create an empty arena.
+   *  \param  block_size Size of the blocks memory is allocated from
+   */
+  explicit Arena(std::size_t block_size = 16 << 20) noexcept;
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /** \brief        Allocate zeroed memory, aborting on error.
+   *  \param  size  Amount of memory to allocate
+   *  \param  align Alignment of the memory; a power of 2 no larger than that of std::max_align_t
+   *  \return       Pointer to the memory, valid until release()
+   *
+   *  Requests larger than a quarter of the block size get a block of their own.
+   */
+  void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) noexcept;
+
+  /** \brief     Allocate a zeroed array.
+   *  \param  n  Number of elements
+   *  \return    Pointer to the first element, valid until release()
+   */
+  template <typename T>
+  T* alloc(std::size_t n) noexcept { return static_cast<T*>(allocate(n * sizeof(T), alignof(T))); }
+
+  /** \brief Free everything allocated from the arena. */
+  void release() noexcept;
+
+  /** \brief  Amount of memory allocated from the arena.
+   *  \return Bytes handed out since it was created or last released
+   */
+  std::size_t used() const noexcept { return used_; }
+
+private:
+  std::size_t block_size_;
+  std::vector<void*> blocks_;
+  char* next_ = nullptr;      ///< Start of the unused part of the current block
+  std::size_t remaining_ = 0; ///< Size of the unused part of the current block
+  std::size_t used_ = 0;
+  std::mutex mutex_;
+};
 } // namespace Memory
 
 #endif // MEMORY_H_INCLUDED_
@@ -9,6 +9,7 @@
 #include "Constants.h"
 #include "InfStat.h"
 #include "IndexList.h"
+#include "RunningStats.h"
 
 #include "geometry/Vector2.h"
 
@@ -24,7 +25,7 @@
 
 /*
 In the main InfectSweep loop, we cannot safely set
-Hosts[infectee].infector and Hosts[infectee].infect_type, as concurrent
+HostsState[infectee].infector and HostsState[infectee].infect_type, as concurrent
 threads might be trying to set the values differently. We therefore
 make a queue of `infection`s in `inf_queue` containing the information
 we need, so that we can set the values after the main loop has finished.
@@ -183,6 +184,7 @@ struct Results
 	//// i) SetUpModel (set to zero);
 	//// ii) RecordSample: add to incidence / Timeseries).
 	//// iii) SaveResults and SaveSummary results.
+	//// iv) the field list in ResultsFile.cpp.
 	///// need to update these quantities in InitModel (DONE), Record Sample (DONE) (and of course places where you need to increment, decrement).
 
 };
@@ -259,6 +261,19 @@ struct Place
 	int* group_start, *group_size, *members;
 };
 
+/**
+ * @brief Members of all the places of one type, in one array.
+ *
+ * Place i's members are members[offsets[i]] up to members[offsets[i + 1]], and its
+ * Place::members points to the first of them. Hotels, whose members change during a
+ * run, have room for twice the mean hotel size. Set up in StratifyPlaces.
+ */
+struct PlaceMembership
+{
+	int* offsets; // P.Nplace + 1 elements
+	int* members;
+};
+
 /**
  * @brief Deprecated intervention mechanism.
  *
@@ -293,6 +308,7 @@ struct AdminUnit
 #pragma pack(pop)
 
 extern Person* Hosts;
+extern std::vector<PersonState> HostsState;
 extern std::vector<PersonQuarantine> HostsQuarantine;
 extern Household* Households;
 extern PopVar State, StateT[MAX_NUM_THREADS];
@@ -300,16 +316,19 @@ extern Cell* Cells, ** CellLookup;
 extern Microcell* Mcells, ** McellLookup;
 extern std::vector<uint16_t> mcell_country;
 extern Place** Places;
+extern PlaceMembership PlaceMembers[MAX_NUM_PLACE_TYPES];
 extern AdminUnit AdUnits[MAX_ADUNITS];
 
 //// Time Series defs:
 //// TimeSeries is an array of type results, used to store (unsurprisingly) a time series of every quantity in results. Mostly used in RecordSample.
 //// TSMeanNE and TSVarNE are the mean and variance of non-extinct time series. TSMeanE and TSVarE are the mean and variance of extinct time series. TSMean and TSVar are pointers that point to either extinct or non-extinct.
+//// They hold running sums and sums of squared deviations from the mean (see RunningStats), so divide by the number of realisations for means and variances.
 extern Results* TimeSeries, *TSMean, *TSVar, *TSMeanNE, *TSVarNE, *TSMeanE, *TSVarE; //// TimeSeries used in RecordSample, RecordInfTypes, SaveResults. TSMean and TSVar
+//// Quantile sketches of the scalar fields of extinct and non-extinct time series, if P.OutputQuantiles; see QuantileFields in CovidSim.cpp.
+extern std::vector<QuantileSketch> TSQuantilesE, TSQuantilesNE;
 
 extern Airport* Airports;
-extern Events* InfEventLog;
-extern int nEvents;
+extern std::vector<Events> InfEventLog, InfEventLogT[MAX_NUM_THREADS];
 
 
 extern double inftype[INFECT_TYPE_MASK], inftype_av[INFECT_TYPE_MASK], infcountry[MAX_COUNTRIES], infcountry_av[MAX_COUNTRIES], infcountry_num[MAX_COUNTRIES];
@@ -319,7 +338,7 @@ extern double inf_household_av[MAX_HOUSEHOLD_SIZE + 1][MAX_HOUSEHOLD_SIZE + 1],
 extern double case_household[MAX_HOUSEHOLD_SIZE + 1][MAX_HOUSEHOLD_SIZE + 1], case_household_av[MAX_HOUSEHOLD_SIZE + 1][MAX_HOUSEHOLD_SIZE + 1];
 extern double PropPlaces[NUM_AGE_GROUPS * AGE_GROUP_WIDTH][MAX_NUM_PLACE_TYPES];
 extern double PropPlacesC[NUM_AGE_GROUPS * AGE_GROUP_WIDTH][MAX_NUM_PLACE_TYPES], AirTravelDist[MAX_DIST];
-extern double PeakHeightSum, PeakHeightSS, PeakTimeSum, PeakTimeSS;
+extern double PeakHeightSum, PeakHeightSS, PeakTimeSum, PeakTimeSS; // PeakHeightSS and PeakTimeSS are sums of squared deviations
 
 extern int DoInitUpdateProbs;
 
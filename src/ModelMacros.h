@@ -3,17 +3,17 @@
 
 #include <climits>
 
-#define HOST_TREATED(x)				((Hosts[x].treat_stop_time > TimeStepNow) && (Hosts[x].treat_start_time <= TimeStepNow))
-#define HOST_TO_BE_TREATED(x)		(Hosts[x].treat_stop_time > TimeStepNow)
+#define HOST_TREATED(x)				((HostsState[x].treat_stop_time > TimeStepNow) && (HostsState[x].treat_start_time <= TimeStepNow))
+#define HOST_TO_BE_TREATED(x)		(HostsState[x].treat_stop_time > TimeStepNow)
 #define PLACE_TREATED(x, y)			(Places[x][y].treat_end_time > TimeStepNow)
 #define PLACE_CLOSED(x, y)			((Places[x][y].close_start_time <= TimeStepNow) && (Places[x][y].close_end_time > TimeStepNow))
-#define HOST_TO_BE_VACCED(x)		(Hosts[x].vacc_start_time < USHRT_MAX - 1)
-#define HOST_VACCED(x)				(Hosts[x].vacc_start_time + P.usVaccTimeToEfficacy <= TimeStepNow)
-#define HOST_VACCED_SWITCH(x)		(Hosts[x].vacc_start_time >= P.usVaccTimeEfficacySwitch)
+#define HOST_TO_BE_VACCED(x)		(HostsState[x].vacc_start_time < USHRT_MAX - 1)
+#define HOST_VACCED(x)				(HostsState[x].vacc_start_time + P.usVaccTimeToEfficacy <= TimeStepNow)
+#define HOST_VACCED_SWITCH(x)		(HostsState[x].vacc_start_time >= P.usVaccTimeEfficacySwitch)
 #define HOST_QUARANTINED(x)			((HostsQuarantine[x].comply == 1) && (HostsQuarantine[x].start_time + P.usHQuarantineHouseDuration > TimeStepNow) && (HostsQuarantine[x].start_time <= TimeStepNow))
 #define HOST_TO_BE_QUARANTINED(x)	((HostsQuarantine[x].start_time + P.usHQuarantineHouseDuration > TimeStepNow) && (HostsQuarantine[x].comply < 2))
-#define HOST_ISOLATED(x)			((Hosts[x].isolation_start_time + P.usCaseIsolationDelay <= TimeStepNow) && (Hosts[x].isolation_start_time + P.usCaseIsolationDelay + P.usCaseIsolationDuration > TimeStepNow))
-#define HOST_ABSENT(x)				((Hosts[x].absent_start_time <= TimeStepNow) && (Hosts[x].absent_stop_time > TimeStepNow))
+#define HOST_ISOLATED(x)			((HostsState[x].isolation_start_time + P.usCaseIsolationDelay <= TimeStepNow) && (HostsState[x].isolation_start_time + P.usCaseIsolationDelay + P.usCaseIsolationDuration > TimeStepNow))
+#define HOST_ABSENT(x)				((HostsState[x].absent_start_time <= TimeStepNow) && (HostsState[x].absent_stop_time > TimeStepNow))
 
 /*
   #define NO_TREAT_PROPH_CASES
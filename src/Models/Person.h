@@ -7,31 +7,46 @@
 #include "../Country.h"
 #include "../InfStat.h"
 
+/// What setup decides about a person: where they live, who they live with,
+/// the places they belong to and their traits. Nothing here changes while the
+/// model runs (except the hotel link when airports are modelled), so every
+/// realisation starts from the same people.
 struct Person
 { 
 	int pcell;			/**< place cell that person belongs to. Cells[person->pcell] holds this person */
 	int mcell;			/**< microcell that person belongs to., Mcells[person->mcell] holds this person */
 	int hh;				/**< household that person belongs to. Household[person->hh] holds this person */
-	int infector;		/**< If >=0, Hosts[person->infector] was who infected this person */
-	int listpos;		/**< Goes up to at least MAX_SEC_REC, also used as a temp variable? */
 
 	int PlaceLinks[MAX_NUM_PLACE_TYPES]; //// indexed by i) place type. Value is the number of that place type (e.g. school no. 17; office no. 310 etc.) Place[i][person->PlaceLinks[i]], can be up to P.Nplace[i]
-	float infectiousness, susc, ProbAbsent, ProbCare;
 
 	unsigned int esocdist_comply : 1; /**< boolean: compliant with enhanced social distancing? */
 	unsigned int keyworker : 1;			// also used to binary index cumI_keyworker[] and related arrays
-	unsigned int to_die : 1;
-	unsigned int detected : 1; //added hospitalisation flag: ggilani 28/10/2014, added flag to determined whether this person's infection is detected or not
 	unsigned int care_home_resident : 1; /**< boolean: care home resident? */
 	unsigned int quar_comply : 2;		// can be 0, 1, or 2
 	unsigned int digitalContactTracingUser : 1; /**< boolean: digitalContactTracingUser? */
+
+	unsigned char age;
+	unsigned short int PlaceGroupLinks[MAX_NUM_PLACE_TYPES];	// These can definitely get > 255
+};
+
+/// What happens to a person in a realisation: their infection, its course and
+/// the interventions applied to them. HostsState[i] goes with Hosts[i], and
+/// InitModel resets every person to a default-constructed PersonState at the
+/// start of each realisation.
+struct PersonState
+{
+	int infector;		/**< If >=0, Hosts[person->infector] was who infected this person */
+	int listpos;		/**< Goes up to at least MAX_SEC_REC, also used as a temp variable? */
+
+	float infectiousness, susc, ProbAbsent, ProbCare;
+
+	unsigned int to_die : 1;
+	unsigned int detected : 1; //added hospitalisation flag: ggilani 28/10/2014, added flag to determined whether this person's infection is detected or not
 	unsigned int digitalContactTraced : 1; /**< boolean: digitalContactTraced? */
 	unsigned int index_case_dct : 2;
 
 	unsigned char Travelling;	// Range up to MAX_TRAVEL_TIME
-	unsigned char age;
 	unsigned char num_treats;		// set to 0 and tested < 2. but never modified?
-	unsigned short int PlaceGroupLinks[MAX_NUM_PLACE_TYPES];	// These can definitely get > 255
 
 	short int infect_type;		// INFECT_TYPE_MASK
 	
@@ -47,6 +62,20 @@ struct Person
 	unsigned short int dct_start_time, dct_end_time, dct_trigger_time, dct_test_time; //digital contact tracing start and end time: ggilani 10/03/20
 	int ncontacts; //added this in to record total number of contacts each index case records: ggilani 13/04/20
 
+	// A susceptible person that nothing has happened to yet. ProbAbsent, ProbCare and susc
+	// are drawn afresh for each realisation, and listpos is set from the cell lists.
+	// don't remove the extra parentheses around std::numeric_limits<uint16_t>::max (see PersonQuarantine)
+	PersonState() :
+		infector(-1), listpos(0), infectiousness(0), susc(0), ProbAbsent(0), ProbCare(0),
+		to_die(0), detected(0), digitalContactTraced(0), index_case_dct(0), Travelling(0), num_treats(0), infect_type(0),
+		Severity_Current(Severity::Asymptomatic), Severity_Final(Severity::Asymptomatic),
+		detected_time(0), absent_start_time((std::numeric_limits<uint16_t>::max)() - 1), absent_stop_time(0),
+		isolation_start_time((std::numeric_limits<uint16_t>::max)() - 1), infection_time(0), latent_time(0), recovery_or_death_time(0),
+		SARI_time((std::numeric_limits<uint16_t>::max)() - 1), Critical_time((std::numeric_limits<uint16_t>::max)() - 1), Stepdown_time((std::numeric_limits<uint16_t>::max)() - 1),
+		treat_start_time((std::numeric_limits<uint16_t>::max)() - 1), treat_stop_time(0), vacc_start_time((std::numeric_limits<uint16_t>::max)() - 1),
+		dct_start_time((std::numeric_limits<uint16_t>::max)() - 1), dct_end_time(0), dct_trigger_time((std::numeric_limits<uint16_t>::max)() - 1), dct_test_time(0),
+		ncontacts(0), inf(InfStat::Susceptible) {}
+
 	/** \brief  Query whether a host should be included in mass vaccination.
 	*           The conditions for not being vaccinated are either: the host is dead,
 	*           or the host is a current case, or the host has recovered from
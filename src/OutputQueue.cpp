@@ -0,0 +1,56 @@
+/** \file  OutputQueue.cpp
+ *  \brief Write output files on a background thread
+ */
+
+#include <utility>
+
+#include "OutputQueue.h"
+
+OutputQueue::OutputQueue(std::size_t max_pending)
+	: max_pending_(max_pending > 0 ? max_pending : 1), pending_(0), stop_(false)
+{
+	worker_ = std::thread(&OutputQueue::run, this);
+}
+
+OutputQueue::~OutputQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	changed_.notify_all();
+	worker_.join();
+}
+
+void OutputQueue::push(std::function<void()> job)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	changed_.wait(lock, [this] { return pending_ < max_pending_; });
+	jobs_.push_back(std::move(job));
+	pending_++;
+	lock.unlock();
+	changed_.notify_all();
+}
+
+void OutputQueue::flush()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	changed_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void OutputQueue::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;)
+	{
+		changed_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+		if (jobs_.empty()) return; // only when stopping, so remaining jobs are always run
+		std::function<void()> job = std::move(jobs_.front());
+		jobs_.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+		pending_--;
+		changed_.notify_all();
+	}
+}
@@ -0,0 +1,48 @@
+/** \file  OutputQueue.h
+ *  \brief Write output files on a background thread
+ */
+
+#ifndef COVIDSIM_OUTPUTQUEUE_H_INCLUDED_
+#define COVIDSIM_OUTPUTQUEUE_H_INCLUDED_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/// Runs jobs, such as saving a realisation's results, one at a time and in
+/// order on a background thread so that the simulation can carry on meanwhile.
+/// Memory is bounded: push blocks while max_pending jobs are queued or running.
+class OutputQueue
+{
+	std::size_t max_pending_;
+	std::size_t pending_;
+	bool stop_;
+	std::deque<std::function<void()>> jobs_;
+	std::mutex mutex_;
+	std::condition_variable changed_;
+	std::thread worker_;
+
+	void run();
+
+public:
+
+	/// \param max_pending  Jobs that may be queued or running at once (at least 1)
+	explicit OutputQueue(std::size_t max_pending);
+
+	/// Runs any remaining jobs and stops the background thread.
+	~OutputQueue();
+
+	OutputQueue(OutputQueue const&) = delete;
+	OutputQueue& operator=(OutputQueue const&) = delete;
+
+	/// Queue a job, first waiting until fewer than max_pending are queued or running.
+	void push(std::function<void()> job);
+
+	/// Wait until every queued job has finished.
+	void flush();
+};
+
+#endif
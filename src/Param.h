@@ -32,6 +32,10 @@ struct Param
 	int NRactual;
 	int NRactE;
 	int NRactNE;
+	int NRactRestarted; // Realisations restarted from a checkpoint of an earlier one after it went extinct; not in NRactE, NRactNE or the means
+	int NRactRestartedNE; // Of those, the ones that didn't go extinct
+	double ExtinctRestartTime; // Day to checkpoint realisations at, to restart those that go extinct from; negative for none
+	int MaxExtinctRestarts; // Realisations to restart from one checkpoint before starting afresh
 
 	/**< Time-step defintions. Differentiates between length of time between model updates (ModelTimeStep) and length of time between calculating model outputs (OutputTimeStep). */
 	double SimulationDuration;				/**< The number of days to run for */
@@ -44,7 +48,10 @@ struct Param
 	CovidSim::TBD1::KernelStruct Kernel;
 	CovidSim::TBD1::KernelStruct MoveKernel;
 	CovidSim::TBD1::KernelStruct AirportKernel;
-	unsigned int BinFileLen;
+	uint64_t BinFileLen; // Number of records in the population density file
+	int OutputDensityFileVersion; // Binary density file format written by /M: 1 (default) or 2
+	int OutputQueueLength; // Realisations whose outputs may be waiting to be written in the background (/OQ); 0 writes them in turn
+	int NumRealisationProcesses; // Realisations run at once, each in a single-threaded process forked after setup (/RP); 0 or 1 runs them in turn with all threads
 	int DoBin, DoSaveSnapshot, DoLoadSnapshot, FitIter;
 	double SnapshotSaveTime, SnapshotLoadTime, clP[100];
 	int NumCells; /**< Number of cells  */
@@ -378,6 +385,7 @@ struct Param
 	int KeyWorkerProphCellIncThresh, KeyWorkerPlaceNum[MAX_NUM_PLACE_TYPES], KeyWorkerPopNum, KeyWorkerNum, KeyWorkerIncHouseNum;
 	int DoBlanketMoveRestr, PlaceCloseIncTrig, PlaceCloseIncTrig1, PlaceCloseIncTrig2, TreatMaxCoursesPerCase, DoImportsViaAirports, DoMassVacc, DurImportTimeProfile;
 	int DoRecordInfEvents, MaxInfEvents, RecordInfEventsPerRun;
+	int OutputBinaryInfEvents; // 0: .infevents.xls only; 1: also an uncapped .infevents.bin stream; 2: the stream instead of the table
 	unsigned short int usHQuarantineHouseDuration, usVaccTimeToEfficacy, usVaccTimeEfficacySwitch; //// us = unsigned short versions of their namesakes, multiplied by P.TimeStepsPerDay
 	unsigned short int usCaseIsolationDuration, usCaseIsolationDelay, usCaseAbsenteeismDuration, usCaseAbsenteeismDelay,usAlignDum; // last is for 8 byte alignment
 
@@ -397,6 +405,10 @@ struct Param
 
 	int OutputAge, OutputR0, OutputControls, OutputCountry, OutputAdUnitVar, OutputHousehold, OutputInfType, OutputNonSeverity;
 	int OutputSeverity, OutputSeverityAdminUnit, OutputSeverityAge, OutputNonSummaryResults, OutputAdUnitAge;
+	int OutputBinaryResults; // 0: text tables only; 1: also write a .results.bin file; 2: .results.bin instead of the tables ResultsToText can regenerate
+	int CompressBinaryResults;
+	int OutputQuantiles; // Also write quantiles over realisations of the scalar time series to a .quantiles.xls file
+	int QuantileSketchSize; // Values each level of a quantile sketch holds before it is halved; larger is more accurate
 
 	int MeanChildAgeGap; // Average gap between ages of children in a household, in years
 	int MinAdultAge; // The youngest age, in years, at which someone is considered to be an adult
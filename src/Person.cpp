@@ -2,7 +2,7 @@
 #include "InfStat.h"
 
 
-bool Person::do_not_vaccinate() const
+bool PersonState::do_not_vaccinate() const
 {
 
 	// Originally: inf < InfStat::InfectiousAlmostSymptomatic) || (inf >= InfStat::Dead_WasAsymp)
@@ -12,54 +12,54 @@ bool Person::do_not_vaccinate() const
 	return this->is_dead() || this->is_case() || this->is_recovered_symp();
 }
 
-bool Person::is_alive() const
+bool PersonState::is_alive() const
 {
 	return !this->is_dead();
 }
 
-bool Person::is_case() const
+bool PersonState::is_case() const
 {
 	return (this->inf == InfStat::Case);
 }
 
-bool Person::is_dead() const
+bool PersonState::is_dead() const
 {
 	// In previous versions, this would have been abs(Hosts[i].inf) == InfStat::Dead
 
 	return (this->inf == InfStat::Dead_WasSymp || this->inf == InfStat::Dead_WasAsymp);
 }
 
-bool Person::is_dead_was_symp() const
+bool PersonState::is_dead_was_symp() const
 {
 	return this->inf == InfStat::Dead_WasSymp;
 }
 
-bool Person::is_dead_was_asymp() const
+bool PersonState::is_dead_was_asymp() const
 {
 	return this->inf == InfStat::Dead_WasAsymp;
 }
 
-bool Person::is_immune_at_start() const
+bool PersonState::is_immune_at_start() const
 {
 	return (this->inf == InfStat::ImmuneAtStart);
 }
 
-bool Person::is_infectious_almost_symptomatic() const
+bool PersonState::is_infectious_almost_symptomatic() const
 {
 	return this->inf == InfStat::InfectiousAlmostSymptomatic;
 }
 
-bool Person::is_infectious_asymptomatic_not_case() const
+bool PersonState::is_infectious_asymptomatic_not_case() const
 {
 	return this->inf == InfStat::InfectiousAsymptomaticNotCase;
 }
 
-bool Person::is_latent() const
+bool PersonState::is_latent() const
 {
 	return (this->inf == InfStat::Latent);
 }
 
-bool Person::is_never_symptomatic() const
+bool PersonState::is_never_symptomatic() const
 {
 	// In earlier code, this was written as (inf > 0) - all the positive numbered states.
 
@@ -68,30 +68,30 @@ bool Person::is_never_symptomatic() const
 			(this->inf == InfStat::Dead_WasAsymp);
 }
 
-bool Person::is_not_yet_symptomatic() const
+bool PersonState::is_not_yet_symptomatic() const
 {
 	return (this->inf == InfStat::Susceptible ||
 			this->inf == InfStat::Latent ||
 			this->inf == InfStat::InfectiousAlmostSymptomatic);
 }
 
-bool Person::is_recovered() const
+bool PersonState::is_recovered() const
 {
 	// In previous versions, abs(Hosts[i].inf) == InfStat::Recovered
 	return (this->inf == InfStat::RecoveredFromSymp) || (this->inf == InfStat::RecoveredFromAsymp);
 }
 
-bool Person::is_recovered_symp() const
+bool PersonState::is_recovered_symp() const
 {
 	return this->inf == InfStat::RecoveredFromSymp;
 }
 
-bool Person::is_susceptible() const
+bool PersonState::is_susceptible() const
 {
 	return (this->inf == InfStat::Susceptible);
 }
 
-bool Person::is_susceptible_or_infected() const
+bool PersonState::is_susceptible_or_infected() const
 {
 	// In old versions, this would be abs(inf]) < InfStat::Recovered, so states included
 	// Would be 0, +/- 1, and +/- 2, which in order are...
@@ -103,12 +103,12 @@ bool Person::is_susceptible_or_infected() const
 
 /********************************************************/
 
-void Person::set_case()
+void PersonState::set_case()
 {
 	this->inf = InfStat::Case;
 }
 
-void Person::set_dead() {
+void PersonState::set_dead() {
 
 	/*	In earlier code, this would be: inf = (InfStat)(InfStat_Dead * inf / abs(inf));
 		Where inf / abs(inf) becomes +/- 1. So dead state has same sign as incoming state.
@@ -120,27 +120,27 @@ void Person::set_dead() {
 	this->inf = (this->inf == InfStat::Case) ? InfStat::Dead_WasSymp : InfStat::Dead_WasAsymp;
 }
 
-void Person::set_immune_at_start()
+void PersonState::set_immune_at_start()
 {
 	this->inf = InfStat::ImmuneAtStart;
 }
 
-void Person::set_infectious_almost_symptomatic()
+void PersonState::set_infectious_almost_symptomatic()
 {
 	this->inf = InfStat::InfectiousAlmostSymptomatic;
 }
 
-void Person::set_infectious_asymptomatic_not_case()
+void PersonState::set_infectious_asymptomatic_not_case()
 {
 	this->inf = InfStat::InfectiousAsymptomaticNotCase;
 }
 
-void Person::set_latent()
+void PersonState::set_latent()
 {
 	this->inf = InfStat::Latent;
 }
 
-void Person::set_recovered()
+void PersonState::set_recovered()
 {
 
 	/*	Similar to deaths, this used to be: inf = (InfStat)(InfStat::Recovered * inf / abs(inf));
@@ -153,7 +153,7 @@ void Person::set_recovered()
 	this->inf = (this->inf == InfStat::Case) ? InfStat::RecoveredFromSymp : InfStat::RecoveredFromAsymp;
 }
 
-void Person::set_susceptible()
+void PersonState::set_susceptible()
 {
 	this->inf = InfStat::Susceptible;
 }
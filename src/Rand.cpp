@@ -1,5 +1,6 @@
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include "Rand.h"
 #include "Constants.h"
 #include "Error.h"
@@ -46,6 +47,112 @@ double ranf_mt(int tn)
 	return ((double)z) / Xm1;
 }
 
+// SplitMix64 (Steele, Lea and Flood, "Fast splittable pseudorandom number
+// generators", OOPSLA 2014), used both to scramble stream seeds and as the
+// stream generator.
+static uint64_t splitmix64(uint64_t* state)
+{
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+uint64_t stream_seed(void)
+{
+	// Two draws from the calling thread's generator, so seeds follow the run seeds.
+	uint64_t hi = (uint64_t)(ranf() * 4294967296.0);
+	uint64_t lo = (uint64_t)(ranf() * 4294967296.0);
+	return (hi << 32) ^ lo;
+}
+
+uint64_t stream_init(uint64_t seed, uint64_t index)
+{
+	uint64_t state = seed ^ (index * 0xd1b54a32d192ed03ULL);
+	return splitmix64(&state);
+}
+
+double ranf_stream(uint64_t* state)
+{
+	// 53 random bits, offset so that the result is strictly between 0 and 1 as for ranf.
+	return ((double)(splitmix64(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+void stream_seed_thread(uint64_t state, int tn)
+{
+	uint64_t z = splitmix64(&state);
+	// Both seeds must be in [1, Xm - 1].
+	Xcg1[CACHE_LINE_SIZE * tn] = 1 + (int32_t)((z >> 32) % (uint64_t)(Xm1 - 1));
+	Xcg2[CACHE_LINE_SIZE * tn] = 1 + (int32_t)((z & 0xffffffffULL) % (uint64_t)(Xm2 - 1));
+}
+
+static void shuffle_range(int* values, int n, uint64_t* stream)
+{
+	// Fisher-Yates; ranf_stream is below 1, so index2 <= index1.
+	for (int index1 = n - 1; index1 > 0; index1--)
+	{
+		int index2 = (int)(((double)(index1 + 1)) * ranf_stream(stream));
+		std::swap(values[index1], values[index2]);
+	}
+}
+
+void parallel_shuffle(int* values, int n, uint64_t seed, int chunk_size)
+{
+	// Chunks of the input are read in parallel, each value being sent to a random bucket;
+	// the buckets are then shuffled in parallel. Values in any one bucket are equally likely
+	// to be any of the values, so the buckets' shuffles make a uniform permutation (Sanders,
+	// "Random permutations on distributed, external and hierarchical memory", IPL 67, 1998).
+	// The chunks and buckets depend only on n, not on the threads.
+	int num_chunks = (n + chunk_size - 1) / chunk_size;
+	num_chunks = std::min(num_chunks, 1024);
+	if (num_chunks <= 1)
+	{
+		uint64_t stream = stream_init(seed, 0);
+		shuffle_range(values, n, &stream);
+		return;
+	}
+	chunk_size = (n + num_chunks - 1) / num_chunks;
+	int num_buckets = num_chunks;
+	std::vector<int> offsets((size_t)num_chunks * num_buckets), bucket_start(num_buckets + 1);
+	std::vector<int> shuffled(n);
+
+#pragma omp parallel for schedule(dynamic,1) default(none) shared(values, n, seed, chunk_size, num_chunks, num_buckets, offsets)
+	for (int c = 0; c < num_chunks; c++)
+	{
+		uint64_t stream = stream_init(seed, (uint64_t)c);
+		for (int i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++)
+			offsets[(size_t)c * num_buckets + (int)(ranf_stream(&stream) * num_buckets)]++;
+	}
+	// Each bucket holds what the chunks sent it, in chunk order.
+	int total = 0;
+	for (int b = 0; b < num_buckets; b++)
+	{
+		bucket_start[b] = total;
+		for (int c = 0; c < num_chunks; c++)
+		{
+			int count = offsets[(size_t)c * num_buckets + b];
+			offsets[(size_t)c * num_buckets + b] = total;
+			total += count;
+		}
+	}
+	bucket_start[num_buckets] = total;
+	// The chunks draw the same buckets again as they copy their values into them.
+#pragma omp parallel for schedule(dynamic,1) default(none) shared(values, n, seed, chunk_size, num_chunks, num_buckets, offsets, shuffled)
+	for (int c = 0; c < num_chunks; c++)
+	{
+		uint64_t stream = stream_init(seed, (uint64_t)c);
+		for (int i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++)
+			shuffled[offsets[(size_t)c * num_buckets + (int)(ranf_stream(&stream) * num_buckets)]++] = values[i];
+	}
+#pragma omp parallel for schedule(dynamic,1) default(none) shared(values, seed, num_chunks, num_buckets, bucket_start, shuffled)
+	for (int b = 0; b < num_buckets; b++)
+	{
+		uint64_t stream = stream_init(seed, (uint64_t)(num_chunks + b));
+		shuffle_range(shuffled.data() + bucket_start[b], bucket_start[b + 1] - bucket_start[b], &stream);
+		std::copy(shuffled.begin() + bucket_start[b], shuffled.begin() + bucket_start[b + 1], values + bucket_start[b]);
+	}
+}
+
 void setall(int32_t *pseed1, int32_t *pseed2)
 /*
 **********************************************************************
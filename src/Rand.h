@@ -35,4 +35,19 @@ double gen_gamma_mt(double, double, int);
 double gen_lognormal(double, double);
 void SampleWithoutReplacement(int, int, int);
 
+/* Random number streams for work shared between threads. Each item (person,
+   place, ...) gets its own stream from a seed and its index, so what it draws
+   doesn't depend on which thread handles it or in what order. */
+uint64_t stream_seed(void);
+uint64_t stream_init(uint64_t, uint64_t);
+double ranf_stream(uint64_t*);
+/* Seed thread tn's generator from a stream, so that an item can use the usual
+   _mt functions (ignbin_mt, ignpoi_mt, ...) for its draws. This replaces the
+   thread's state, so save Xcg1/Xcg2 first if the thread's sequence matters. */
+void stream_seed_thread(uint64_t, int);
+/* Randomly permute values[0..n), in parallel, drawing from streams made from the
+   seed; the permutation depends only on the seed and n. Chunks of chunk_size
+   values are read in parallel, so large arrays are split among threads. */
+void parallel_shuffle(int* values, int n, uint64_t seed, int chunk_size = 65536);
+
 #endif // COVIDSIM_RAND_H_INCLUDED_
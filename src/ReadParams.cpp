@@ -143,7 +143,7 @@ std::string Params::lookup_param(ParamMap &base, ParamMap &fallback, ParamMap &p
 	if (iter != fallback.end()) {
 		return search_clp ? Params::clp_overwrite(iter->second, P) : iter->second;
 	}
-	if (base == fallback)
+	if (&base == &fallback)
 	{
 		return "NULL";
 	}
@@ -200,7 +200,7 @@ bool Params::param_found(ParamMap &base, ParamMap &fallback, ParamMap &params, s
 		return true;
 	}
 
-	if (base == fallback)
+	if (&base == &fallback)
 	{
 		return false;
 	}
@@ -491,7 +491,7 @@ void Params::get_double_matrix(ParamMap &fallback, ParamMap &params, std::string
 	Params::get_double_matrix(fallback, fallback, params, param_name, array, sizex, sizey, default_value, false, P);
 }
 
-void Params::get_inverse_cdf(ParamMap fallback, ParamMap params, const char* icdf_name, InverseCdf* inverseCdf, Param* P, double start_value)
+void Params::get_inverse_cdf(ParamMap& fallback, ParamMap& params, const char* icdf_name, InverseCdf* inverseCdf, Param* P, double start_value)
 {
 	Params::get_double_vec(fallback, params, icdf_name, inverseCdf->get_values(), CDF_RES + 1, 0, CDF_RES + 1, P);
 	if (!Params::param_found(fallback, params, icdf_name))
@@ -532,7 +532,7 @@ void Params::alloc_params(Param* P)
 }
 /**************************************************************************************************************/
 
-void Params::output_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::output_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->OutputAge = Params::get_int(params, pre_params, "OutputAge", 1, P);
 	P->OutputSeverity = Params::get_int(params, pre_params, "OutputSeverity", 1, P);
@@ -547,9 +547,17 @@ void Params::output_params(ParamMap adm_params, ParamMap pre_params, ParamMap pa
 	P->OutputInfType = Params::get_int(params, pre_params, "OutputInfType", 0, P);
 	P->OutputNonSeverity = Params::get_int(params, pre_params, "OutputNonSeverity", 0, P);
 	P->OutputNonSummaryResults = Params::get_int(params, pre_params, "OutputNonSummaryResults", 0, P);
+	P->OutputBinaryResults = Params::get_int(params, pre_params, "OutputBinaryResults", 0, P);
+	P->CompressBinaryResults = Params::get_int(params, pre_params, "CompressBinaryResults", 1, P);
+	if ((P->OutputBinaryResults < 0) || (P->OutputBinaryResults > 2))
+		ERR_CRITICAL_FMT("OutputBinaryResults must be 0, 1 or 2, not %d\n", P->OutputBinaryResults);
+	P->OutputQuantiles = Params::get_int(params, pre_params, "OutputQuantiles", 0, P);
+	P->QuantileSketchSize = Params::get_int(params, pre_params, "QuantileSketchSize", 64, P);
+	if (P->QuantileSketchSize < 2)
+		ERR_CRITICAL_FMT("QuantileSketchSize must be at least 2, not %d\n", P->QuantileSketchSize);
 }
 
-void Params::household_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::household_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	if (P->DoHouseholds == 0)
 	{
@@ -576,7 +584,7 @@ void Params::household_params(ParamMap adm_params, ParamMap pre_params, ParamMap
 		P->HouseholdDenomLookup[i] = 1 / pow(((double)(INT64_C(1) + i)), P->HouseholdTransPow);
 }
 
-void Params::waifw_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::waifw_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	//if (!GetInputParameter2(params, pre_params, "WAIFW matrix", "%lf", (void*)P->WAIFW_Matrix, NUM_AGE_GROUPS, NUM_AGE_GROUPS, 0))
 	if (!Params::param_found(params, pre_params, "WAIFW matrix"))
@@ -651,7 +659,7 @@ void Params::waifw_params(ParamMap adm_params, ParamMap pre_params, ParamMap par
 ///// **** AIRPORT PARAMETERS
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::airport_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::airport_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->DoAirports = Params::get_int(params, pre_params, "Include air travel", 0, P);
 	if (P->DoAirports == 0)  // Airports disabled => all places are not to do with airports, and we have no hotels
@@ -714,7 +722,7 @@ void Params::airport_params(ParamMap adm_params, ParamMap pre_params, ParamMap p
 	}
 }
 
-void Params::serology_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::serology_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->SeroConvMaxSens = Params::get_double(params, pre_params, "Maximum sensitivity of serology assay", 1.0, P);
 	P->SeroConvP1 = Params::get_double(params, pre_params, "Seroconversion model parameter 1", 14.0, P);
@@ -728,7 +736,7 @@ void Params::serology_params(ParamMap adm_params, ParamMap pre_params, ParamMap
 ///// **** SEVERITY PARAMETERS
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::severity_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::severity_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->DoSeverity = Params::get_int(params, pre_params, "Do Severity Analysis", 0, P);
 	if (P->DoSeverity == 0)
@@ -830,7 +838,7 @@ void Params::severity_params(ParamMap adm_params, ParamMap pre_params, ParamMap
 ///// **** VACCINATION PARAMETERS
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::vaccination_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::vaccination_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->VaccCellIncThresh = Params::get_double(params, pre_params, "Vaccination trigger incidence per cell", 1000000000, P);
 	P->VaccSuscDrop = Params::get_double(params, pre_params, "Relative susceptibility of vaccinated individual", 1, P);
@@ -890,7 +898,7 @@ void Params::vaccination_params(ParamMap adm_params, ParamMap pre_params, ParamM
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
 
-void Params::treatment_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::treatment_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->DoPlaceGroupTreat = Params::get_int(params, pre_params, "Only treat mixing groups within places", 0, P);
 
@@ -943,7 +951,7 @@ void Params::treatment_params(ParamMap adm_params, ParamMap pre_params, ParamMap
 	}
 }
 
-void Params::carehome_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::carehome_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->CareHomeResidentHouseholdScaling = Params::get_double(pre_params, adm_params, "Scaling of household contacts for care home residents", 1.0, P);
 	P->CareHomeResidentSpatialScaling = Params::get_double(pre_params, adm_params, "Scaling of spatial contacts for care home residents", 1.0, P);
@@ -961,7 +969,7 @@ void Params::carehome_params(ParamMap adm_params, ParamMap pre_params, ParamMap
 	P->CareHomeResidentMinimumAge = Params::get_int(pre_params, adm_params, "Minimum age of care home residents", 1000, P);
 }
 
-void Params::place_type_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::place_type_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	if (P->DoPlaces != 0)
 	{
@@ -1067,7 +1075,7 @@ void Params::place_type_params(ParamMap adm_params, ParamMap pre_params, ParamMa
 ///// **** SEASONALITY
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::seasonality_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::seasonality_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	Params::get_double_vec(params, pre_params, "Daily seasonality coefficients", P->Seasonality, DAYS_PER_YEAR, 1, DAYS_PER_YEAR, P);
 	if (!Params::param_found(params, pre_params, "Daily seasonality coefficients"))
@@ -1085,7 +1093,7 @@ void Params::seasonality_params(ParamMap adm_params, ParamMap pre_params, ParamM
 		P->Seasonality[i] /= s;
 }
 
-void Params::seeding_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, char** AdunitListNames, AdminUnit* AdUnits)
+void Params::seeding_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, char** AdunitListNames, AdminUnit* AdUnits)
 {
 	P->NumSeedLocations = Params::get_int(pre_params, adm_params, "Number of seed locations", 1, P);
 	if (P->NumSeedLocations > MAX_NUM_SEED_LOCATIONS)
@@ -1185,7 +1193,7 @@ void Params::seeding_params(ParamMap adm_params, ParamMap pre_params, ParamMap p
 ///// **** MOVEMENT RESTRICTION PARAMETERS
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::movement_restriction_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::movement_restriction_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->MoveRestrCellIncThresh = Params::get_int(params, pre_params, "Movement restrictions trigger incidence per cell", INT32_MAX, P);
 	P->MoveDelayMean = Params::get_double(params, pre_params, "Delay to start movement restrictions", 0, P);
@@ -1211,7 +1219,7 @@ P->MoveRestrRadius = Params::get_double(params, pre_params, "Minimum radius of m
 ///// **** INTERVENTION DELAYS BY ADMIN UNIT
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::intervention_delays_by_adunit_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, AdminUnit* AdUnits)
+void Params::intervention_delays_by_adunit_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, AdminUnit* AdUnits)
 { //Intervention delays and durations by admin unit: ggilani 16/03/20
 
 	P->DoInterventionDelaysByAdUnit = Params::get_int(params, pre_params, "Include intervention delays by admin unit", 0, P);
@@ -1266,7 +1274,7 @@ void Params::intervention_delays_by_adunit_params(ParamMap adm_params, ParamMap
 ///// **** DIGITAL CONTACT TRACING
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::digital_contact_tracing_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, AdminUnit* AdUnits)
+void Params::digital_contact_tracing_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, AdminUnit* AdUnits)
 {
 	//New code for digital contact tracing - ggilani: 09/03/20
 	P->DoDigitalContactTracing = Params::get_int(params, pre_params, "Include digital contact tracing", 0, P);
@@ -1341,7 +1349,7 @@ void Params::digital_contact_tracing_params(ParamMap adm_params, ParamMap pre_pa
 ///// **** PLACE CLOSURE
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::place_closure_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::place_closure_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->PlaceCloseCellIncThresh1 = Params::get_int(params, pre_params, "Trigger incidence per cell for place closure", 1000000000, P);
 	P->PlaceCloseCellIncThresh2 = Params::get_int(params, pre_params, "Trigger incidence per cell for second place closure", 1000000000, P);
@@ -1404,7 +1412,7 @@ void Params::place_closure_params(ParamMap adm_params, ParamMap pre_params, Para
 ///// **** SOCIAL DISTANCING
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::social_distancing_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::social_distancing_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->SocDistCellIncThresh = Params::get_int(params, pre_params, "Trigger incidence per cell for social distancing", 1000000000, P);
 	P->SocDistCellIncStopThresh = Params::get_int(params, pre_params, "Trigger incidence per cell for end of social distancing", 0, P);
@@ -1475,7 +1483,7 @@ void Params::social_distancing_params(ParamMap adm_params, ParamMap pre_params,
 ///// **** CASE ISOLATION
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::case_isolation_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::case_isolation_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->CaseIsolationTimeStartBase = Params::get_double(params, pre_params, "Case isolation start time", USHRT_MAX / P->TimeStepsPerDay, P);
 	P->CaseIsolationProp = Params::get_double(params, pre_params, "Proportion of detected cases isolated", 0, P);
@@ -1489,7 +1497,7 @@ void Params::case_isolation_params(ParamMap adm_params, ParamMap pre_params, Par
 ///// **** HOUSEHOLD QUARANTINE
 ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::household_quarantine_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::household_quarantine_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	if (P->DoHouseholds == 0)
 	{
@@ -1516,7 +1524,7 @@ void Params::household_quarantine_params(ParamMap adm_params, ParamMap pre_param
 	///// **** VARIABLE EFFICACIES OVER TIME
 	///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// **** ///// ****
 
-void Params::set_variable_efficacy(ParamMap params, ParamMap pre_params, std::string param_name, Param* P, double** matrix, int change_times, double* default_vals, bool force_fail) {
+void Params::set_variable_efficacy(ParamMap& params, ParamMap& pre_params, std::string param_name, Param* P, double** matrix, int change_times, double* default_vals, bool force_fail) {
 	Params::get_double_matrix(params, pre_params, param_name, matrix, change_times, P->NumPlaceTypes, 0, P);
 	if (force_fail || !Params::param_found(params, pre_params, param_name))
 		for (int ChangeTime = 0; ChangeTime < change_times; ChangeTime++) //// by default populate to values of P->SocDistPlaceEffect
@@ -1524,7 +1532,7 @@ void Params::set_variable_efficacy(ParamMap params, ParamMap pre_params, std::st
 				matrix[ChangeTime][PlaceType] = default_vals[PlaceType];
 }
 
-void Params::variable_efficacy_over_time_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P)
+void Params::variable_efficacy_over_time_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P)
 {
 	P->VaryEfficaciesOverTime = Params::get_int(params, pre_params, "Vary efficacies over time", 0, P);
 	//// **** number of change times
@@ -1725,7 +1733,16 @@ void Params::variable_efficacy_over_time_params(ParamMap adm_params, ParamMap pr
 
 /**************************************************************************************************************/
 
-void Params::ReadParams(std::string const& ParamFile, std::string const& PreParamFile, std::string const& AdUnitFile, Param* P, AdminUnit* AdUnits)
+Params::ParamFiles Params::read_param_files(std::string const& ParamFile, std::string const& PreParamFile, std::string const& AdUnitFile)
+{
+	ParamFiles files;
+	files.params = Params::read_params_map(ParamFile.c_str());
+	files.pre_params = Params::read_params_map(PreParamFile.c_str());
+	files.adm_params = Params::read_params_map(AdUnitFile.c_str());
+	return files;
+}
+
+void Params::ReadParams(ParamFiles& files, Param* P, AdminUnit* AdUnits)
 {
 	double s, t;
 	int i, j, k, f, nc, na;
@@ -1736,9 +1753,9 @@ void Params::ReadParams(std::string const& ParamFile, std::string const& PrePara
 	char** AdunitListNames = new char* [MAX_ADUNITS];
 
 	double AgeSuscScale = 1.0;
-	ParamMap params = Params::read_params_map(ParamFile.c_str());
-	ParamMap pre_params = Params::read_params_map(PreParamFile.c_str());
-	ParamMap adm_params = Params::read_params_map(AdUnitFile.c_str());
+	ParamMap& params = files.params;
+	ParamMap& pre_params = files.pre_params;
+	ParamMap& adm_params = files.adm_params;
 
 	if (P->FitIter == 0)
 	{
@@ -1772,6 +1789,10 @@ void Params::ReadParams(std::string const& ParamFile, std::string const& PrePara
 			P->NumNonExtinctRealisations = P->NumRealisations;
 		}
 		P->SmallEpidemicCases = Params::get_int(params, pre_params, "Maximum number of cases defining small outbreak", -1, P);
+		P->ExtinctRestartTime = Params::get_double(params, pre_params, "Restart extinct realisations from day", -1, P);
+		P->MaxExtinctRestarts = Params::get_int(params, pre_params, "Maximum restarts from a checkpoint", 10, P);
+		if ((P->ExtinctRestartTime >= 0) && (P->MaxExtinctRestarts < 1))
+			ERR_CRITICAL_FMT("[Maximum restarts from a checkpoint] must be at least 1, not %d\n", P->MaxExtinctRestarts);
 
 		P->NumCells = -1;
 		P->NMCL = Params::req_int(params, pre_params, "Number of micro-cells per spatial cell width", P);
@@ -2258,10 +2279,14 @@ void Params::ReadParams(std::string const& ParamFile, std::string const& PrePara
 		{
 			P->MaxInfEvents = Params::get_int(params, pre_params, "Max number of infection events to record", 1000, P);
 			P->RecordInfEventsPerRun = Params::get_int(params, pre_params, "Record infection events per run", 0, P);
+			P->OutputBinaryInfEvents = Params::get_int(params, pre_params, "Output binary infection events", 0, P);
+			if ((P->OutputBinaryInfEvents < 0) || (P->OutputBinaryInfEvents > 2))
+				ERR_CRITICAL_FMT("Output binary infection events must be 0, 1 or 2, not %d\n", P->OutputBinaryInfEvents);
 		}
 		else
 		{
 			P->MaxInfEvents = 0;
+			P->OutputBinaryInfEvents = 0;
 		}
 		//Include a limit to the number of infections to simulate, if this happens before time runs out
 		P->LimitNumInfections = Params::get_int(params, pre_params, "Limit number of infections", 0, P);
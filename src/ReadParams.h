@@ -617,37 +617,54 @@ namespace Params
 
 /** \brief                Parse an inverse CDF
  */
-   void get_inverse_cdf(ParamMap fallback, ParamMap params, const char* icdf_name, InverseCdf* inverseCdf, Param* P, double start_value);
+   void get_inverse_cdf(ParamMap& fallback, ParamMap& params, const char* icdf_name, InverseCdf* inverseCdf, Param* P, double start_value);
 
 /** \brief                Allocate memory for 2-D (or higher) objects in params
  */
   void alloc_params(Param* P);
 
-  void waifw_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void output_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void household_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void airport_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void serology_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void severity_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void vaccination_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void treatment_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void carehome_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void place_type_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void seasonality_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void seeding_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, char** AdunitListNames, AdminUnit* AdUnits);
-  void movement_restriction_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void intervention_delays_by_adunit_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, AdminUnit* AdUnits);
-  void digital_contact_tracing_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P, AdminUnit* AdUnits);
-  void place_closure_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void social_distancing_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void case_isolation_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void household_quarantine_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
-  void set_variable_efficacy(ParamMap params, ParamMap pre_params, std::string param_name, Param* P, double** matrix, int change_times, double* default_vals, bool force_fail);
-  void variable_efficacy_over_time_params(ParamMap adm_params, ParamMap pre_params, ParamMap params, Param* P);
+  void waifw_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void output_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void household_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void airport_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void serology_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void severity_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void vaccination_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void treatment_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void carehome_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void place_type_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void seasonality_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void seeding_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, char** AdunitListNames, AdminUnit* AdUnits);
+  void movement_restriction_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void intervention_delays_by_adunit_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, AdminUnit* AdUnits);
+  void digital_contact_tracing_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P, AdminUnit* AdUnits);
+  void place_closure_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void social_distancing_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void case_isolation_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void household_quarantine_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+  void set_variable_efficacy(ParamMap& params, ParamMap& pre_params, std::string param_name, Param* P, double** matrix, int change_times, double* default_vals, bool force_fail);
+  void variable_efficacy_over_time_params(ParamMap& adm_params, ParamMap& pre_params, ParamMap& params, Param* P);
+
+/** \brief                The parameter, pre-parameter and admin unit files, parsed into maps.
+ *
+ *  The files are parsed once; when fitting, each iteration reads the parameters again
+ *  from these maps with only the values of the command-line parameters changed.
+ */
+  struct ParamFiles
+  {
+    ParamMap params, pre_params, adm_params;
+  };
+
+/** \brief                Parse the three parameter files.
+ *  \param ParamFile      The parameter file
+ *  \param PreParamFile   The pre-parameter file
+ *  \param AdUnitFile     The admin unit file
+ */
+  ParamFiles read_param_files(std::string const& ParamFile, std::string const& PreParamFile, std::string const& AdUnitFile);
 
 /** \brief                Top-level call for ReadParams.
  */
-  void ReadParams(std::string const& ParamFile, std::string const& PreParamFile, std::string const& AdUnitFile, Param* P, AdminUnit* AdUnits);
+  void ReadParams(ParamFiles& files, Param* P, AdminUnit* AdUnits);
 
 } // namespace Params
 
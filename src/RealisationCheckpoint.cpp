@@ -0,0 +1,184 @@
+/** \file  RealisationCheckpoint.cpp
+ *  \brief Keep a copy of a realisation part way through, to restart it from if it goes extinct
+ */
+
+#include <algorithm>
+
+#include "Error.h"
+#include "RealisationCheckpoint.h"
+#include "SetupModel.h"
+
+void RealisationCheckpoint::save(RunPoint const& point)
+{
+	point_ = point;
+	do_init_update_probs_ = DoInitUpdateProbs;
+	params_ = P;
+
+	state_ = State;
+	state_t_.assign(StateT, StateT + P.NumThreads);
+	inf_age_adunit_.clear();
+	if (P.DoAdUnits && P.OutputAdUnitAge)
+		for (int Thread = -1; Thread < P.NumThreads; Thread++)
+		{
+			PopVar const& s = (Thread < 0) ? State : StateT[Thread];
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				inf_age_adunit_.insert(inf_age_adunit_.end(), s.prevInf_age_adunit[AgeGroup], s.prevInf_age_adunit[AgeGroup] + P.NumAdunits);
+				inf_age_adunit_.insert(inf_age_adunit_.end(), s.cumInf_age_adunit[AgeGroup], s.cumInf_age_adunit[AgeGroup] + P.NumAdunits);
+			}
+		}
+
+	hosts_state_ = HostsState;
+	hosts_quarantine_ = HostsQuarantine;
+
+	cells_.resize(P.NumPopulatedCells);
+	for (int i = 0; i < P.NumPopulatedCells; i++) cells_[i] = *CellLookup[i];
+	cell_susc_members_.assign(State.CellSuscMemberArray, State.CellSuscMemberArray + P.PopSize);
+	mcells_.resize(P.NumPopulatedMicrocells);
+	for (int i = 0; i < P.NumPopulatedMicrocells; i++) mcells_[i] = *McellLookup[i];
+
+	places_.clear();
+	if (P.DoPlaces)
+		for (int m = 0; m < P.NumPlaceTypes; m++)
+			for (int l = 0; l < P.Nplace[m]; l++)
+			{
+				Place const& p = Places[m][l];
+				PlaceState s = { p.control_trig, p.treat, p.close_start_time, p.close_end_time, p.treat_end_time, {}, p.AbsentLastUpdateTime, p.ProbClose };
+				std::copy(p.Absent, p.Absent + MAX_ABSENT_TIME, s.Absent);
+				places_.push_back(s);
+			}
+
+	int num_adunits = std::min(P.NumAdunits + 1, MAX_ADUNITS);
+	adunits_.assign(AdUnits, AdUnits + num_adunits);
+	adunit_dct_.clear();
+	dct_queues_.clear();
+	if (P.DoAdUnits && P.DoDigitalContactTracing)
+	{
+		for (int i = 0; i < P.NumAdunits; i++)
+			adunit_dct_.insert(adunit_dct_.end(), AdUnits[i].dct, AdUnits[i].dct + AdUnits[i].ndct);
+		for (int Thread = 0; Thread < P.NumThreads; Thread++)
+			for (int i = 0; i < P.NumAdunits; i++)
+				dct_queues_.insert(dct_queues_.end(), StateT[Thread].dct_queue[i], StateT[Thread].dct_queue[i] + StateT[Thread].ndct_queue[i]);
+	}
+
+	// The samples before the checkpoint, as RecordInfTypes later changes their times in place.
+	std::size_t fields = sizeof(Results) / sizeof(double) - ResultsDoubleOffsetStart;
+	time_series_.clear();
+	for (int Time = 0; Time < point.output_time_step; Time++)
+	{
+		time_series_.push_back(TimeSeries[Time].t);
+		double const* first = (double const*)&TimeSeries[Time] + ResultsDoubleOffsetStart;
+		time_series_.insert(time_series_.end(), first, first + fields);
+		if (P.DoAdUnits && P.OutputAdUnitAge)
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				time_series_.insert(time_series_.end(), TimeSeries[Time].prevInf_age_adunit[AgeGroup], TimeSeries[Time].prevInf_age_adunit[AgeGroup] + P.NumAdunits);
+				time_series_.insert(time_series_.end(), TimeSeries[Time].incInf_age_adunit[AgeGroup], TimeSeries[Time].incInf_age_adunit[AgeGroup] + P.NumAdunits);
+				time_series_.insert(time_series_.end(), TimeSeries[Time].cumInf_age_adunit[AgeGroup], TimeSeries[Time].cumInf_age_adunit[AgeGroup] + P.NumAdunits);
+			}
+	}
+
+	empty_ = false;
+	restarts_ = 0;
+}
+
+RealisationCheckpoint::RunPoint RealisationCheckpoint::restore()
+{
+	if (empty_) ERR_CRITICAL("No realisation checkpoint to restore\n");
+
+	// The realisation counts and seeds belong to the sequence of realisations, not to this one.
+	int NRactual = P.NRactual, NRactE = P.NRactE, NRactNE = P.NRactNE, NRactRestarted = P.NRactRestarted, NRactRestartedNE = P.NRactRestartedNE;
+	int32_t nextRunSeed1 = P.nextRunSeed1, nextRunSeed2 = P.nextRunSeed2;
+	P = params_;
+	P.NRactual = NRactual; P.NRactE = NRactE; P.NRactNE = NRactNE; P.NRactRestarted = NRactRestarted; P.NRactRestartedNE = NRactRestartedNE;
+	P.nextRunSeed1 = nextRunSeed1; P.nextRunSeed2 = nextRunSeed2;
+
+	// The pointers in State and StateT are to the same arrays as when saved, so only their contents need copying back.
+	State = state_;
+	std::copy(state_t_.begin(), state_t_.end(), StateT);
+	if (P.DoAdUnits && P.OutputAdUnitAge)
+	{
+		auto source = inf_age_adunit_.begin();
+		for (int Thread = -1; Thread < P.NumThreads; Thread++)
+		{
+			PopVar& s = (Thread < 0) ? State : StateT[Thread];
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				std::copy(source, source + P.NumAdunits, s.prevInf_age_adunit[AgeGroup]); source += P.NumAdunits;
+				std::copy(source, source + P.NumAdunits, s.cumInf_age_adunit[AgeGroup]); source += P.NumAdunits;
+			}
+		}
+	}
+
+	HostsState = hosts_state_;
+	HostsQuarantine = hosts_quarantine_;
+
+	for (int i = 0; i < P.NumPopulatedCells; i++) *CellLookup[i] = cells_[i];
+	std::copy(cell_susc_members_.begin(), cell_susc_members_.end(), State.CellSuscMemberArray);
+	for (int i = 0; i < P.NumPopulatedMicrocells; i++) *McellLookup[i] = mcells_[i];
+
+	if (P.DoPlaces)
+	{
+		auto source = places_.begin();
+		for (int m = 0; m < P.NumPlaceTypes; m++)
+			for (int l = 0; l < P.Nplace[m]; l++, ++source)
+			{
+				Place& p = Places[m][l];
+				p.control_trig = source->control_trig;
+				p.treat = source->treat;
+				p.close_start_time = source->close_start_time;
+				p.close_end_time = source->close_end_time;
+				p.treat_end_time = source->treat_end_time;
+				std::copy(source->Absent, source->Absent + MAX_ABSENT_TIME, p.Absent);
+				p.AbsentLastUpdateTime = source->AbsentLastUpdateTime;
+				p.ProbClose = source->ProbClose;
+			}
+	}
+
+	std::copy(adunits_.begin(), adunits_.end(), AdUnits);
+	if (P.DoAdUnits && P.DoDigitalContactTracing)
+	{
+		auto dct = adunit_dct_.begin();
+		for (int i = 0; i < P.NumAdunits; i++)
+		{
+			std::copy(dct, dct + AdUnits[i].ndct, AdUnits[i].dct);
+			dct += AdUnits[i].ndct;
+		}
+		auto queue = dct_queues_.begin();
+		for (int Thread = 0; Thread < P.NumThreads; Thread++)
+			for (int i = 0; i < P.NumAdunits; i++)
+			{
+				std::copy(queue, queue + StateT[Thread].ndct_queue[i], StateT[Thread].dct_queue[i]);
+				queue += StateT[Thread].ndct_queue[i];
+			}
+	}
+
+	std::size_t fields = sizeof(Results) / sizeof(double) - ResultsDoubleOffsetStart;
+	auto sample = time_series_.begin();
+	for (int Time = 0; Time < point_.output_time_step; Time++)
+	{
+		TimeSeries[Time].t = *sample++;
+		std::copy(sample, sample + fields, (double*)&TimeSeries[Time] + ResultsDoubleOffsetStart); sample += fields;
+		if (P.DoAdUnits && P.OutputAdUnitAge)
+			for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+			{
+				std::copy(sample, sample + P.NumAdunits, TimeSeries[Time].prevInf_age_adunit[AgeGroup]); sample += P.NumAdunits;
+				std::copy(sample, sample + P.NumAdunits, TimeSeries[Time].incInf_age_adunit[AgeGroup]); sample += P.NumAdunits;
+				std::copy(sample, sample + P.NumAdunits, TimeSeries[Time].cumInf_age_adunit[AgeGroup]); sample += P.NumAdunits;
+			}
+	}
+
+	// The spatial infection probabilities are too big to copy, but are rebuilt from each
+	// cell's S0 as restored if they have been updated since the start of the realisation.
+	if (DoInitUpdateProbs || do_init_update_probs_) UpdateProbsFromS0();
+	DoInitUpdateProbs = do_init_update_probs_;
+
+	restarts_++;
+	return point_;
+}
+
+void RealisationCheckpoint::clear()
+{
+	empty_ = true;
+	restarts_ = 0;
+}
@@ -0,0 +1,82 @@
+/** \file  RealisationCheckpoint.h
+ *  \brief Keep a copy of a realisation part way through, to restart it from if it goes extinct
+ */
+
+#ifndef COVIDSIM_REALISATIONCHECKPOINT_H_INCLUDED_
+#define COVIDSIM_REALISATIONCHECKPOINT_H_INCLUDED_
+
+#include <cstdint>
+#include <vector>
+
+#include "Model.h"
+#include "Param.h"
+
+/// An in-memory copy of everything a realisation changes as it runs: the
+/// state of each person, cell, populated microcell, place and admin unit, the
+/// totals in State and StateT, the parameters (the current intervention
+/// effects, calibration and course counts live there) and the samples of
+/// TimeSeries recorded so far. Restoring it puts the
+/// model back as it was when it was saved, so that RunModel can carry on from
+/// that point with different random numbers.
+///
+/// Taken between time steps, when the infection, place and host closure
+/// queues are empty. Not taken with airports (hotel stays change Hosts and
+/// the hotels' members), infection events, bitmaps or the origin-destination
+/// matrix, which aren't copied.
+class RealisationCheckpoint
+{
+public:
+	/// Where RunModel was when the checkpoint was taken.
+	struct RunPoint
+	{
+		int output_time_step;				///< Next sample to record
+		double sim_time;
+		double prop_susceptible;			///< Proportion susceptible when the spatial probabilities were last updated
+	};
+
+	bool empty() const { return empty_; }
+
+	/// Copies the model as it is now, at point in RunModel.
+	void save(RunPoint const& point);
+
+	/// Puts the model back as it was when saved, apart from the realisation
+	/// counts and the seeds for the next realisation.
+	/// \return Where to carry on running from
+	RunPoint restore();
+
+	void clear();
+
+	/// Number of realisations restarted from this checkpoint.
+	int restarts() const { return restarts_; }
+
+private:
+	/// The parts of a place that change during a realisation.
+	struct PlaceState
+	{
+		unsigned short int control_trig, treat, close_start_time, close_end_time, treat_end_time;
+		unsigned short int Absent[MAX_ABSENT_TIME], AbsentLastUpdateTime;
+		float ProbClose;
+	};
+
+	bool empty_ = true;
+	int restarts_ = 0;
+	RunPoint point_;
+	int do_init_update_probs_;
+
+	Param params_;
+	PopVar state_;
+	std::vector<PopVar> state_t_;
+	std::vector<int> inf_age_adunit_;			///< prevInf_age_adunit and cumInf_age_adunit of State, then of each thread
+	std::vector<ContactEvent> dct_queues_;		///< Each thread's digital contact tracing queue for each admin unit
+	std::vector<PersonState> hosts_state_;
+	std::vector<PersonQuarantine> hosts_quarantine_;
+	std::vector<Cell> cells_;					///< Populated cells
+	std::vector<int> cell_susc_members_;		///< State.CellSuscMemberArray
+	std::vector<Microcell> mcells_;				///< Populated microcells
+	std::vector<PlaceState> places_;			///< Places of every type, one type after another
+	std::vector<AdminUnit> adunits_;
+	std::vector<int> adunit_dct_;				///< People being digitally contact traced in each admin unit
+	std::vector<double> time_series_;			///< t and the fields from S on of each sample recorded, then their age by admin unit arrays
+};
+
+#endif // COVIDSIM_REALISATIONCHECKPOINT_H_INCLUDED_
@@ -0,0 +1,353 @@
+/** \file  RealisationPool.cpp
+ *  \brief Run realisations concurrently in worker processes that share the population
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef COVIDSIM_MPI
+#include <mpi.h>
+#endif
+
+#include "Error.h"
+#include "RealisationPool.h"
+
+namespace
+{
+	struct ResultHeader
+	{
+		int32_t realisation;
+		uint64_t size;
+	};
+
+	/// Hands out realisations in order and merges their results in order,
+	/// holding on to results that finish early.
+	class InOrder
+	{
+	public:
+		InOrder(int num_realisations, RealisationPool::Merge const& merge)
+			: num_realisations_(num_realisations), merge_(merge) {}
+
+		/// The next realisation to run, or -1 if there are none left.
+		int next() { return (carry_on_ && next_to_run_ < num_realisations_) ? next_to_run_++ : -1; }
+
+		void finished(int realisation, std::vector<char>& result)
+		{
+			finished_[realisation].swap(result);
+			while (carry_on_ && finished_.count(next_to_merge_))
+			{
+				carry_on_ = merge_(next_to_merge_, finished_[next_to_merge_]);
+				finished_.erase(next_to_merge_);
+				next_to_merge_++;
+			}
+		}
+
+		bool done() const { return !carry_on_ || next_to_merge_ >= num_realisations_; }
+		int num_merged() const { return next_to_merge_; }
+
+	private:
+		int num_realisations_;
+		RealisationPool::Merge const& merge_;
+		int next_to_run_ = 0, next_to_merge_ = 0;
+		bool carry_on_ = true;
+		std::map<int, std::vector<char>> finished_; // results waiting for earlier realisations
+	};
+}
+
+#ifndef _WIN32
+
+namespace
+{
+	struct Worker
+	{
+		pid_t pid;
+		int to_worker;		///< Write end of the pipe of realisations to run
+		int from_worker;	///< Read end of the pipe of results
+		int realisation;	///< Realisation being run, or -1 if idle
+	};
+
+	// Returns false at end of file.
+	bool read_all(int fd, void* buf, std::size_t size)
+	{
+		char* p = (char*)buf;
+		while (size > 0)
+		{
+			ssize_t n = read(fd, p, size);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0) ERR_CRITICAL_FMT("Error %d reading from realisation worker\n", errno);
+			if (n == 0) return false;
+			p += n;
+			size -= (std::size_t)n;
+		}
+		return true;
+	}
+
+	void write_all(int fd, void const* buf, std::size_t size)
+	{
+		char const* p = (char const*)buf;
+		while (size > 0)
+		{
+			ssize_t n = write(fd, p, size);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0) ERR_CRITICAL_FMT("Error %d writing to realisation worker\n", errno);
+			p += n;
+			size -= (std::size_t)n;
+		}
+	}
+
+	// Body of a worker process: run each realisation it is sent until told to stop.
+	void worker_main(int from_parent, int to_parent, RealisationPool::Run const& run)
+	{
+		int32_t realisation;
+		std::vector<char> result;
+		while (read_all(from_parent, &realisation, sizeof(realisation)) && realisation >= 0)
+		{
+			result.clear();
+			run(realisation, result);
+			ResultHeader header = { realisation, result.size() };
+			write_all(to_parent, &header, sizeof(header));
+			write_all(to_parent, result.data(), result.size());
+		}
+		fflush(stdout);
+		fflush(stderr);
+		_exit(0);
+	}
+}
+
+int RealisationPool::run(int num_workers, int num_realisations, Run const& run, Merge const& merge)
+{
+	if (num_workers > num_realisations) num_workers = num_realisations;
+	fflush(stdout);
+	fflush(stderr);
+
+	std::vector<Worker> workers;
+	for (int w = 0; w < num_workers; w++)
+	{
+		int to_worker[2], from_worker[2];
+		if (pipe(to_worker) != 0 || pipe(from_worker) != 0) ERR_CRITICAL_FMT("Error %d creating pipes to realisation worker\n", errno);
+		pid_t pid = fork();
+		if (pid < 0) ERR_CRITICAL_FMT("Error %d starting realisation worker\n", errno);
+		if (pid == 0)
+		{
+			// Keep only this worker's ends of its own pipes.
+			for (Worker const& other : workers)
+			{
+				close(other.to_worker);
+				close(other.from_worker);
+			}
+			close(to_worker[1]);
+			close(from_worker[0]);
+			worker_main(to_worker[0], from_worker[1], run);
+		}
+		close(to_worker[0]);
+		close(from_worker[1]);
+		workers.push_back({ pid, to_worker[1], from_worker[0], -1 });
+	}
+
+	InOrder order(num_realisations, merge);
+	auto hand_out = [&](Worker& worker) {
+		int32_t realisation = order.next();
+		write_all(worker.to_worker, &realisation, sizeof(realisation));
+		worker.realisation = realisation;
+	};
+	for (Worker& worker : workers) hand_out(worker);
+
+	while (!order.done())
+	{
+		std::vector<pollfd> fds;
+		std::vector<Worker*> busy;
+		for (Worker& worker : workers)
+			if (worker.realisation >= 0)
+			{
+				fds.push_back({ worker.from_worker, POLLIN, 0 });
+				busy.push_back(&worker);
+			}
+		if (poll(fds.data(), fds.size(), -1) < 0)
+		{
+			if (errno == EINTR) continue;
+			ERR_CRITICAL_FMT("Error %d waiting for realisation workers\n", errno);
+		}
+		for (std::size_t i = 0; i < fds.size(); i++)
+		{
+			if (fds[i].revents == 0) continue;
+			Worker& worker = *busy[i];
+			ResultHeader header;
+			std::vector<char> result;
+			bool ok = read_all(worker.from_worker, &header, sizeof(header));
+			if (ok)
+			{
+				result.resize(header.size);
+				ok = read_all(worker.from_worker, result.data(), result.size());
+			}
+			if (!ok || header.realisation != worker.realisation)
+				ERR_CRITICAL_FMT("Realisation worker stopped while running realisation %d\n", worker.realisation);
+			order.finished(header.realisation, result);
+			hand_out(worker);
+		}
+	}
+
+	// Workers still running are no longer needed.
+	for (Worker& worker : workers)
+	{
+		if (worker.realisation >= 0) kill(worker.pid, SIGKILL);
+		close(worker.to_worker);
+		close(worker.from_worker);
+	}
+	for (Worker& worker : workers)
+	{
+		int status;
+		while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR);
+	}
+	return order.num_merged();
+}
+
+#else
+
+int RealisationPool::run(int, int, Run const&, Merge const&)
+{
+	ERR_CRITICAL("Running realisations in worker processes is not supported on Windows\n");
+	return 0;
+}
+
+#endif
+
+#ifdef COVIDSIM_MPI
+
+namespace
+{
+	enum Tag { TagRealisation = 1, TagResultSize = 2, TagResult = 3 };
+
+	// MPI counts are ints, so results are sent in pieces no bigger than this.
+	const std::size_t MaxMessage = std::size_t(1) << 30;
+
+	void send_result(int32_t realisation, std::vector<char> const& result)
+	{
+		ResultHeader header = { realisation, result.size() };
+		MPI_Send(&header, sizeof(header), MPI_BYTE, 0, TagResultSize, MPI_COMM_WORLD);
+		for (std::size_t sent = 0; sent < result.size(); sent += MaxMessage)
+			MPI_Send(result.data() + sent, (int)std::min(MaxMessage, result.size() - sent), MPI_BYTE, 0, TagResult, MPI_COMM_WORLD);
+	}
+
+	// Returns the rank the result came from.
+	int receive_result(ResultHeader& header, std::vector<char>& result)
+	{
+		MPI_Status status;
+		MPI_Recv(&header, sizeof(header), MPI_BYTE, MPI_ANY_SOURCE, TagResultSize, MPI_COMM_WORLD, &status);
+		result.resize(header.size);
+		for (std::size_t received = 0; received < result.size(); received += MaxMessage)
+			MPI_Recv(result.data() + received, (int)std::min(MaxMessage, result.size() - received), MPI_BYTE,
+				status.MPI_SOURCE, TagResult, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		return status.MPI_SOURCE;
+	}
+
+	void send_realisation(int rank, int32_t realisation)
+	{
+		MPI_Send(&realisation, 1, MPI_INT32_T, rank, TagRealisation, MPI_COMM_WORLD);
+	}
+}
+
+int RealisationPool::start_mpi(int* argc, char*** argv)
+{
+	// Only the main thread calls MPI; OpenMP threads within a process don't.
+	int provided, size;
+	MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	return size;
+}
+
+int RealisationPool::mpi_rank()
+{
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	return rank;
+}
+
+void RealisationPool::stop_mpi()
+{
+	MPI_Finalize();
+}
+
+int RealisationPool::run_mpi(int num_realisations, Run const& run, Merge const& merge)
+{
+	int size;
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	if (size < 2) ERR_CRITICAL("Running realisations over MPI needs at least 2 processes\n");
+	fflush(stdout);
+	fflush(stderr);
+
+	if (mpi_rank() != 0)
+	{
+		int32_t realisation;
+		std::vector<char> result;
+		while (true)
+		{
+			MPI_Recv(&realisation, 1, MPI_INT32_T, 0, TagRealisation, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+			if (realisation < 0) break;
+			result.clear();
+			run(realisation, result);
+			send_result(realisation, result);
+		}
+		fflush(stdout);
+		fflush(stderr);
+		return 0;
+	}
+
+	InOrder order(num_realisations, merge);
+	std::vector<int> running(size, -1); // realisation each rank is running, or -1 if idle
+	int num_busy = 0;
+	auto hand_out = [&](int rank) {
+		running[rank] = order.next();
+		send_realisation(rank, running[rank]);
+		if (running[rank] >= 0) num_busy++;
+	};
+	for (int rank = 1; rank < size; rank++) hand_out(rank);
+
+	// Unlike forked workers, ranks can't be killed, so once merging has stopped
+	// those still running are waited for and their results dropped.
+	while (num_busy > 0)
+	{
+		ResultHeader header;
+		std::vector<char> result;
+		int rank = receive_result(header, result);
+		if (header.realisation != running[rank])
+			ERR_CRITICAL_FMT("Rank %d sent realisation %d while running realisation %d\n", rank, (int)header.realisation, running[rank]);
+		num_busy--;
+		if (!order.done()) order.finished(header.realisation, result);
+		hand_out(rank);
+	}
+	return order.num_merged();
+}
+
+#else
+
+int RealisationPool::start_mpi(int*, char***)
+{
+	return 1;
+}
+
+int RealisationPool::mpi_rank()
+{
+	return 0;
+}
+
+void RealisationPool::stop_mpi()
+{
+}
+
+int RealisationPool::run_mpi(int, Run const&, Merge const&)
+{
+	ERR_CRITICAL("Running realisations over MPI needs CovidSim to be built with USE_MPI\n");
+	return 0;
+}
+
+#endif
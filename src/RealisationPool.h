@@ -0,0 +1,63 @@
+/** \file  RealisationPool.h
+ *  \brief Run realisations concurrently in worker processes that share the population
+ */
+
+#ifndef COVIDSIM_REALISATIONPOOL_H_INCLUDED_
+#define COVIDSIM_REALISATIONPOOL_H_INCLUDED_
+
+#include <functional>
+#include <vector>
+
+/// Runs realisations in worker processes forked from this one once the model
+/// is set up. Workers share the population with it copy-on-write, so only the
+/// pages a realisation changes are duplicated. Realisations are handed out in
+/// order as workers become free, and each worker sends back the result of each
+/// of its realisations as a block of bytes. The results are passed on in
+/// realisation order.
+///
+/// They match running the realisations in turn only with one thread (/c:1),
+/// as runs with more threads depend on the thread count. They also only match
+/// if each earlier realisation drew new seeds exactly once. A realisation whose
+/// calibration to the trigger date gives up and starts again with new seeds
+/// (every 14 iterations) draws more, and the realisations after it then start
+/// from different seeds than they would have in turn.
+///
+/// Workers are single-threaded: the OpenMP runtime can't start new threads in
+/// a forked process once the parent has used it. Not available on Windows.
+///
+/// Alternatively, with MPI, realisations are run by the other processes of an
+/// MPI job, each having set up the model itself.
+class RealisationPool
+{
+public:
+	/// Runs a realisation in a worker, filling in its result.
+	using Run = std::function<void(int realisation, std::vector<char>& result)>;
+
+	/// Takes the result of a realisation, returning whether to carry on.
+	using Merge = std::function<bool(int realisation, std::vector<char> const& result)>;
+
+	/// Runs realisations 0 to num_realisations - 1 in up to num_workers worker
+	/// processes, passing the result of each to merge in order until it returns
+	/// false. Realisations started beyond that point are abandoned.
+	/// \return The number of realisations merged
+	static int run(int num_workers, int num_realisations, Run const& run, Merge const& merge);
+
+	/// Starts MPI, if CovidSim is built with it (USE_MPI).
+	/// \return The number of processes in the MPI job; 1 without MPI
+	static int start_mpi(int* argc, char*** argv);
+
+	/// This process's rank in the MPI job; 0 without MPI.
+	static int mpi_rank();
+
+	static void stop_mpi();
+
+	/// As run, but over the processes of an MPI job, which may be on several
+	/// hosts. Every process must have set up the same model. Rank 0 hands out
+	/// realisations to the others and merges their results; the others run
+	/// realisations, with as many threads as they were set up with, until told
+	/// to stop, and then return 0.
+	/// \return On rank 0, the number of realisations merged
+	static int run_mpi(int num_realisations, Run const& run, Merge const& merge);
+};
+
+#endif
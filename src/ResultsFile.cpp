@@ -0,0 +1,364 @@
+/** \file  ResultsFile.cpp
+ *  \brief Read and write columnar binary results files
+ */
+
+#include <cstring>
+
+#include "Error.h"
+#include "Files.h"
+#include "ResultsFile.h"
+
+#define RESULTS_FIELD(name, extent) { #name, offsetof(Results, name), ResultsFile::Extent::extent }
+#define RESULTS_AGE_ADUNIT_FIELD(name) { #name, 0, ResultsFile::Extent::AgeAdUnit }
+
+// Every double in Results from S onwards must be listed here, in any order.
+// test-results-file checks that none are missing.
+const ResultsFile::Field ResultsFile::Fields[] = {
+	RESULTS_FIELD(t, Scalar),
+	RESULTS_FIELD(S, Scalar), RESULTS_FIELD(L, Scalar), RESULTS_FIELD(I, Scalar), RESULTS_FIELD(R, Scalar),
+	RESULTS_FIELD(D, Scalar), RESULTS_FIELD(incC, Scalar), RESULTS_FIELD(incTC, Scalar), RESULTS_FIELD(incFC, Scalar),
+	RESULTS_FIELD(incI, Scalar), RESULTS_FIELD(incR, Scalar), RESULTS_FIELD(incD, Scalar), RESULTS_FIELD(incDC, Scalar),
+	RESULTS_FIELD(meanTG, Scalar), RESULTS_FIELD(meanSI, Scalar),
+	RESULTS_FIELD(CT, Scalar), RESULTS_FIELD(incCT, Scalar), RESULTS_FIELD(incCC, Scalar), RESULTS_FIELD(DCT, Scalar),
+	RESULTS_FIELD(incDCT, Scalar),
+	RESULTS_FIELD(incC_country, Country),
+	RESULTS_FIELD(cumT, Scalar), RESULTS_FIELD(cumUT, Scalar), RESULTS_FIELD(cumTP, Scalar), RESULTS_FIELD(cumV, Scalar),
+	RESULTS_FIELD(cumTmax, Scalar), RESULTS_FIELD(cumVmax, Scalar), RESULTS_FIELD(cumDC, Scalar),
+	RESULTS_FIELD(extinct, Scalar), RESULTS_FIELD(cumVG, Scalar),
+	RESULTS_FIELD(incHQ, Scalar), RESULTS_FIELD(incAC, Scalar), RESULTS_FIELD(incAH, Scalar), RESULTS_FIELD(incAA, Scalar),
+	RESULTS_FIELD(incACS, Scalar), RESULTS_FIELD(incAPC, Scalar), RESULTS_FIELD(incAPA, Scalar), RESULTS_FIELD(incAPCS, Scalar),
+	RESULTS_FIELD(incIa, AgeGroup), RESULTS_FIELD(incCa, AgeGroup), RESULTS_FIELD(incDa, AgeGroup),
+	RESULTS_FIELD(incItype, InfectType), RESULTS_FIELD(Rtype, InfectType), RESULTS_FIELD(Rage, AgeGroup),
+	RESULTS_FIELD(Rdenom, Scalar),
+	RESULTS_FIELD(rmsRad, Scalar), RESULTS_FIELD(maxRad, Scalar), RESULTS_FIELD(PropPlacesClosed, PlaceType),
+	RESULTS_FIELD(PropSocDist, Scalar),
+	RESULTS_FIELD(incI_adunit, AdUnit), RESULTS_FIELD(incC_adunit, AdUnit), RESULTS_FIELD(cumT_adunit, AdUnit),
+	RESULTS_FIELD(incD_adunit, AdUnit), RESULTS_FIELD(cumD_adunit, AdUnit), RESULTS_FIELD(incH_adunit, AdUnit),
+	RESULTS_FIELD(incDC_adunit, AdUnit),
+	RESULTS_FIELD(incCT_adunit, AdUnit), RESULTS_FIELD(incCC_adunit, AdUnit), RESULTS_FIELD(incDCT_adunit, AdUnit),
+	RESULTS_FIELD(DCT_adunit, AdUnit),
+	RESULTS_FIELD(incI_keyworker, KeyWorker), RESULTS_FIELD(incC_keyworker, KeyWorker), RESULTS_FIELD(cumT_keyworker, KeyWorker),
+
+	RESULTS_FIELD(Mild, Scalar), RESULTS_FIELD(ILI, Scalar), RESULTS_FIELD(SARI, Scalar), RESULTS_FIELD(Critical, Scalar),
+	RESULTS_FIELD(CritRecov, Scalar),
+	RESULTS_FIELD(incMild, Scalar), RESULTS_FIELD(incILI, Scalar), RESULTS_FIELD(incSARI, Scalar),
+	RESULTS_FIELD(incCritical, Scalar), RESULTS_FIELD(incCritRecov, Scalar),
+	RESULTS_FIELD(cumMild, Scalar), RESULTS_FIELD(cumILI, Scalar), RESULTS_FIELD(cumSARI, Scalar),
+	RESULTS_FIELD(cumCritical, Scalar), RESULTS_FIELD(cumCritRecov, Scalar),
+	RESULTS_FIELD(incDeath_ILI, Scalar), RESULTS_FIELD(incDeath_SARI, Scalar), RESULTS_FIELD(incDeath_Critical, Scalar),
+	RESULTS_FIELD(cumDeath_ILI, Scalar), RESULTS_FIELD(cumDeath_SARI, Scalar), RESULTS_FIELD(cumDeath_Critical, Scalar),
+
+	RESULTS_FIELD(Mild_adunit, AdUnit), RESULTS_FIELD(ILI_adunit, AdUnit), RESULTS_FIELD(SARI_adunit, AdUnit),
+	RESULTS_FIELD(Critical_adunit, AdUnit), RESULTS_FIELD(CritRecov_adunit, AdUnit),
+	RESULTS_FIELD(incMild_adunit, AdUnit), RESULTS_FIELD(incILI_adunit, AdUnit), RESULTS_FIELD(incSARI_adunit, AdUnit),
+	RESULTS_FIELD(incCritical_adunit, AdUnit), RESULTS_FIELD(incCritRecov_adunit, AdUnit),
+	RESULTS_FIELD(cumMild_adunit, AdUnit), RESULTS_FIELD(cumILI_adunit, AdUnit), RESULTS_FIELD(cumSARI_adunit, AdUnit),
+	RESULTS_FIELD(cumCritical_adunit, AdUnit), RESULTS_FIELD(cumCritRecov_adunit, AdUnit),
+	RESULTS_FIELD(incDeath_ILI_adunit, AdUnit), RESULTS_FIELD(incDeath_SARI_adunit, AdUnit),
+	RESULTS_FIELD(incDeath_Critical_adunit, AdUnit),
+	RESULTS_FIELD(cumDeath_ILI_adunit, AdUnit), RESULTS_FIELD(cumDeath_SARI_adunit, AdUnit),
+	RESULTS_FIELD(cumDeath_Critical_adunit, AdUnit),
+
+	RESULTS_FIELD(Mild_age, AgeGroup), RESULTS_FIELD(ILI_age, AgeGroup), RESULTS_FIELD(SARI_age, AgeGroup),
+	RESULTS_FIELD(Critical_age, AgeGroup), RESULTS_FIELD(CritRecov_age, AgeGroup),
+	RESULTS_FIELD(incMild_age, AgeGroup), RESULTS_FIELD(incILI_age, AgeGroup), RESULTS_FIELD(incSARI_age, AgeGroup),
+	RESULTS_FIELD(incCritical_age, AgeGroup), RESULTS_FIELD(incCritRecov_age, AgeGroup),
+	RESULTS_FIELD(cumMild_age, AgeGroup), RESULTS_FIELD(cumILI_age, AgeGroup), RESULTS_FIELD(cumSARI_age, AgeGroup),
+	RESULTS_FIELD(cumCritical_age, AgeGroup), RESULTS_FIELD(cumCritRecov_age, AgeGroup),
+	RESULTS_FIELD(incDeath_ILI_age, AgeGroup), RESULTS_FIELD(incDeath_SARI_age, AgeGroup),
+	RESULTS_FIELD(incDeath_Critical_age, AgeGroup),
+	RESULTS_FIELD(cumDeath_ILI_age, AgeGroup), RESULTS_FIELD(cumDeath_SARI_age, AgeGroup),
+	RESULTS_FIELD(cumDeath_Critical_age, AgeGroup),
+
+	RESULTS_FIELD(prevQuarNotInfected, Scalar), RESULTS_FIELD(prevQuarNotSymptomatic, Scalar),
+
+	RESULTS_AGE_ADUNIT_FIELD(prevInf_age_adunit), RESULTS_AGE_ADUNIT_FIELD(incInf_age_adunit),
+	RESULTS_AGE_ADUNIT_FIELD(cumInf_age_adunit)
+};
+
+const std::size_t ResultsFile::NumFields = sizeof(ResultsFile::Fields) / sizeof(ResultsFile::Fields[0]);
+
+uint32_t ResultsFile::width(Extent extent, uint32_t num_adunits)
+{
+	switch (extent)
+	{
+	case Extent::Scalar: return 1;
+	case Extent::Country: return MAX_COUNTRIES;
+	case Extent::AgeGroup: return NUM_AGE_GROUPS;
+	case Extent::InfectType: return INFECT_TYPE_MASK;
+	case Extent::PlaceType: return MAX_NUM_PLACE_TYPES;
+	case Extent::AdUnit: return num_adunits;
+	case Extent::KeyWorker: return 2;
+	case Extent::AgeAdUnit: return NUM_AGE_GROUPS * num_adunits;
+	}
+	return 0;
+}
+
+ResultsFile::Column const* ResultsFile::Table::find(std::string const& column_name) const
+{
+	for (auto const& column : columns)
+		if (column.name == column_name) return &column;
+	return NULL;
+}
+
+double ResultsFile::Contents::attribute(std::string const& name, double default_value) const
+{
+	for (auto const& attr : attributes)
+		if (attr.first == name) return attr.second;
+	return default_value;
+}
+
+ResultsFile::Table const* ResultsFile::Contents::find(std::string const& table_name) const
+{
+	for (auto const& table : tables)
+		if (table.name == table_name) return &table;
+	return NULL;
+}
+
+std::vector<unsigned char> ResultsFile::xor_pack(double const* values, std::size_t n, std::size_t stride)
+{
+	std::vector<unsigned char> bytes;
+	bytes.reserve(n * 4);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		uint64_t bits, prev = 0;
+		memcpy(&bits, &values[i], sizeof(bits));
+		if (i >= stride) memcpy(&prev, &values[i - stride], sizeof(prev));
+		uint64_t x = bits ^ prev;
+		if (x == 0)
+		{
+			bytes.push_back(0x80);
+			continue;
+		}
+		int lead = 0, trail = 0;
+		while (((x >> (8 * (7 - lead))) & 0xff) == 0) lead++;
+		while (((x >> (8 * trail)) & 0xff) == 0) trail++;
+		bytes.push_back((unsigned char)((lead << 4) | trail));
+		for (int b = 7 - lead; b >= trail; b--) bytes.push_back((unsigned char)((x >> (8 * b)) & 0xff));
+	}
+	return bytes;
+}
+
+bool ResultsFile::xor_unpack(unsigned char const* bytes, std::size_t len, double* values, std::size_t n, std::size_t stride)
+{
+	std::size_t pos = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		if (pos >= len) return false;
+		int lead = bytes[pos] >> 4, trail = bytes[pos] & 0x0f;
+		pos++;
+		if (lead + trail > 8) return false;
+		uint64_t x = 0, prev = 0;
+		if (lead < 8)
+		{
+			if (pos + (8 - lead - trail) > len) return false;
+			for (int b = 7 - lead; b >= trail; b--) x |= (uint64_t)bytes[pos++] << (8 * b);
+		}
+		if (i >= stride) memcpy(&prev, &values[i - stride], sizeof(prev));
+		prev ^= x;
+		memcpy(&values[i], &prev, sizeof(prev));
+	}
+	return pos == len;
+}
+
+static void write_string(FILE* dat, std::string const& s)
+{
+	uint32_t len = (uint32_t)s.size();
+	Files::fwrite_big((void*)&len, sizeof(uint32_t), 1, dat);
+	Files::fwrite_big((void*)s.data(), 1, len, dat);
+}
+
+static bool read_string(FILE* dat, std::string& s)
+{
+	uint32_t len;
+	if (Files::fread_big(&len, sizeof(uint32_t), 1, dat) != 1) return false;
+	s.resize(len);
+	return (len == 0) || (Files::fread_big(&s[0], 1, len, dat) == len);
+}
+
+// Copies one field of every row into values, row major.
+static void gather(ResultsFile::Field const& field, ResultsFile::TableSource const& table, uint32_t num_adunits, std::vector<double>& values)
+{
+	uint32_t w = ResultsFile::width(field.extent, num_adunits);
+	values.resize((std::size_t)table.num_rows * w);
+	double* out = values.data();
+	for (int row = 0; row < table.num_rows; row++)
+	{
+		Results const& r = table.rows[row];
+		if (field.extent == ResultsFile::Extent::AgeAdUnit)
+		{
+			double** src = (strcmp(field.name, "prevInf_age_adunit") == 0) ? r.prevInf_age_adunit
+				: (strcmp(field.name, "incInf_age_adunit") == 0) ? r.incInf_age_adunit : r.cumInf_age_adunit;
+			for (int age = 0; age < NUM_AGE_GROUPS; age++)
+			{
+				memcpy(out, src[age], num_adunits * sizeof(double));
+				out += num_adunits;
+			}
+		}
+		else
+		{
+			memcpy(out, (char const*)&r + field.offset, w * sizeof(double));
+			out += w;
+		}
+	}
+}
+
+void ResultsFile::write(std::string const& filename, std::vector<std::string> const& adunit_names,
+                        std::vector<std::pair<std::string, double>> const& attributes,
+                        std::vector<TableSource> const& tables, bool compress)
+{
+	uint32_t num_adunits = (uint32_t)adunit_names.size();
+	FILE* dat = Files::xfopen(filename.c_str(), "wb");
+	Files::fwrite_big((void*)MAGIC, 1, sizeof(MAGIC), dat);
+	Files::fwrite_big((void*)&VERSION, sizeof(uint32_t), 1, dat);
+
+	Files::fwrite_big((void*)&num_adunits, sizeof(uint32_t), 1, dat);
+	for (auto const& name : adunit_names) write_string(dat, name);
+
+	uint32_t num_attributes = (uint32_t)attributes.size();
+	Files::fwrite_big((void*)&num_attributes, sizeof(uint32_t), 1, dat);
+	for (auto const& attr : attributes)
+	{
+		write_string(dat, attr.first);
+		Files::fwrite_big((void*)&attr.second, sizeof(double), 1, dat);
+	}
+
+	uint32_t num_tables = (uint32_t)tables.size();
+	Files::fwrite_big((void*)&num_tables, sizeof(uint32_t), 1, dat);
+	std::vector<double> values;
+	for (auto const& table : tables)
+	{
+		uint32_t num_rows = (uint32_t)table.num_rows, num_columns = 0;
+		for (std::size_t f = 0; f < NumFields; f++)
+			if (table.age_adunit || (Fields[f].extent != Extent::AgeAdUnit)) num_columns++;
+		write_string(dat, table.name);
+		Files::fwrite_big((void*)&num_rows, sizeof(uint32_t), 1, dat);
+		Files::fwrite_big((void*)&num_columns, sizeof(uint32_t), 1, dat);
+
+		for (std::size_t f = 0; f < NumFields; f++)
+		{
+			Field const& field = Fields[f];
+			if (!table.age_adunit && (field.extent == Extent::AgeAdUnit)) continue;
+			uint32_t w = width(field.extent, num_adunits);
+			gather(field, table, num_adunits, values);
+
+			bool constant = true;
+			for (std::size_t i = 1; i < values.size() && constant; i++)
+				constant = (memcmp(&values[i], &values[0], sizeof(double)) == 0);
+			Encoding encoding = Encoding::Raw;
+			std::vector<unsigned char> packed;
+			if (constant && !values.empty())
+				encoding = Encoding::Constant;
+			else if (compress)
+			{
+				packed = xor_pack(values.data(), values.size(), w);
+				if (packed.size() < values.size() * sizeof(double)) encoding = Encoding::XorPacked;
+			}
+
+			write_string(dat, field.name);
+			Files::fwrite_big((void*)&field.extent, sizeof(Extent), 1, dat);
+			Files::fwrite_big((void*)&w, sizeof(uint32_t), 1, dat);
+			Files::fwrite_big((void*)&encoding, sizeof(Encoding), 1, dat);
+			uint64_t len;
+			if (encoding == Encoding::Constant)
+			{
+				len = sizeof(double);
+				Files::fwrite_big((void*)&len, sizeof(uint64_t), 1, dat);
+				Files::fwrite_big((void*)values.data(), sizeof(double), 1, dat);
+			}
+			else if (encoding == Encoding::XorPacked)
+			{
+				len = packed.size();
+				Files::fwrite_big((void*)&len, sizeof(uint64_t), 1, dat);
+				Files::fwrite_big((void*)packed.data(), 1, packed.size(), dat);
+			}
+			else
+			{
+				len = values.size() * sizeof(double);
+				Files::fwrite_big((void*)&len, sizeof(uint64_t), 1, dat);
+				Files::fwrite_big((void*)values.data(), sizeof(double), values.size(), dat);
+			}
+		}
+	}
+	Files::xfclose(dat);
+}
+
+ResultsFile::Contents ResultsFile::read(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	Contents contents;
+	char magic[sizeof(MAGIC)];
+	uint32_t version, num_adunits, num_attributes, num_tables;
+	if (Files::fread_big(magic, 1, sizeof(magic), dat) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+		ERR_CRITICAL_FMT("%s is not a results file\n", filename.c_str());
+	if (Files::fread_big(&version, sizeof(uint32_t), 1, dat) != 1 || version != VERSION)
+		ERR_CRITICAL_FMT("Unsupported version of results file %s\n", filename.c_str());
+
+	if (Files::fread_big(&num_adunits, sizeof(uint32_t), 1, dat) != 1)
+		ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+	contents.adunit_names.resize(num_adunits);
+	for (auto& name : contents.adunit_names)
+		if (!read_string(dat, name)) ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+
+	if (Files::fread_big(&num_attributes, sizeof(uint32_t), 1, dat) != 1)
+		ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+	contents.attributes.resize(num_attributes);
+	for (auto& attr : contents.attributes)
+		if (!read_string(dat, attr.first) || Files::fread_big(&attr.second, sizeof(double), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+
+	if (Files::fread_big(&num_tables, sizeof(uint32_t), 1, dat) != 1)
+		ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+	contents.tables.resize(num_tables);
+	std::vector<unsigned char> bytes;
+	for (auto& table : contents.tables)
+	{
+		uint32_t num_columns;
+		if (!read_string(dat, table.name)
+			|| Files::fread_big(&table.num_rows, sizeof(uint32_t), 1, dat) != 1
+			|| Files::fread_big(&num_columns, sizeof(uint32_t), 1, dat) != 1)
+			ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+		table.columns.resize(num_columns);
+		for (auto& column : table.columns)
+		{
+			Encoding encoding;
+			uint64_t len;
+			if (!read_string(dat, column.name)
+				|| Files::fread_big(&column.extent, sizeof(Extent), 1, dat) != 1
+				|| Files::fread_big(&column.width, sizeof(uint32_t), 1, dat) != 1
+				|| Files::fread_big(&encoding, sizeof(Encoding), 1, dat) != 1
+				|| Files::fread_big(&len, sizeof(uint64_t), 1, dat) != 1)
+				ERR_CRITICAL_FMT("Error while reading results file %s\n", filename.c_str());
+			std::size_t n = (std::size_t)table.num_rows * column.width;
+			column.values.resize(n);
+			bytes.resize((std::size_t)len);
+			if (len > 0 && Files::fread_big(bytes.data(), 1, (std::size_t)len, dat) != (std::size_t)len)
+				ERR_CRITICAL_FMT("Error while reading column %s of results file %s\n", column.name.c_str(), filename.c_str());
+			bool ok;
+			switch (encoding)
+			{
+			case Encoding::Raw:
+				ok = (len == n * sizeof(double));
+				if (ok && n > 0) memcpy(column.values.data(), bytes.data(), (std::size_t)len);
+				break;
+			case Encoding::Constant:
+				ok = (len == sizeof(double));
+				if (ok)
+				{
+					double v;
+					memcpy(&v, bytes.data(), sizeof(double));
+					for (auto& x : column.values) x = v;
+				}
+				break;
+			case Encoding::XorPacked:
+				ok = (column.width > 0) && xor_unpack(bytes.data(), (std::size_t)len, column.values.data(), n, column.width);
+				break;
+			default:
+				ok = false;
+			}
+			if (!ok) ERR_CRITICAL_FMT("Corrupt column %s in results file %s\n", column.name.c_str(), filename.c_str());
+		}
+	}
+	Files::xfclose(dat);
+	return contents;
+}
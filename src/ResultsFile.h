@@ -0,0 +1,172 @@
+/** \file  ResultsFile.h
+ *  \brief Read and write columnar binary results files
+ */
+
+#ifndef COVIDSIM_RESULTSFILE_H_INCLUDED_
+#define COVIDSIM_RESULTSFILE_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Model.h"
+
+namespace ResultsFile
+{
+/// First 8 bytes of a results file. This continues with a uint32 format
+/// version, the admin unit names, the attributes and then the tables. Strings
+/// are a uint32 length followed by that many chars; numbers are native endian.
+const char MAGIC[8] = { 'C', 'S', 'R', 'E', 'S', 'U', 'L', 'T' };
+
+const uint32_t VERSION = 1;
+
+/// What the values of an array field in Results are indexed by. Each determines
+/// the width of the field's column.
+enum struct Extent : uint8_t
+{
+	Scalar = 0,
+	Country = 1,		///< MAX_COUNTRIES
+	AgeGroup = 2,		///< NUM_AGE_GROUPS
+	InfectType = 3,		///< INFECT_TYPE_MASK
+	PlaceType = 4,		///< MAX_NUM_PLACE_TYPES
+	AdUnit = 5,			///< Number of admin units in the file
+	KeyWorker = 6,		///< 2
+	AgeAdUnit = 7		///< NUM_AGE_GROUPS x admin units, age group major
+};
+
+/// How a column's values are stored.
+enum struct Encoding : uint8_t
+{
+	Raw = 0,		///< Row major doubles
+	Constant = 1,	///< A single double shared by every value
+	XorPacked = 2	///< Each double XORed with the previous row's, then packed; see xor_pack
+};
+
+/// A field of Results that is written to results files.
+struct Field
+{
+	const char* name;
+	std::size_t offset;	///< Byte offset in Results; unused for AgeAdUnit fields
+	Extent extent;
+};
+
+/// The fields written to results files, in file order.
+extern const Field Fields[];
+extern const std::size_t NumFields;
+
+/// A column read back from a results file; values are row major.
+struct Column
+{
+	std::string name;
+	Extent extent;
+	uint32_t width;
+	std::vector<double> values;
+
+	double at(uint32_t row, uint32_t index = 0) const { return values[(std::size_t)row * width + index]; }
+};
+
+struct Table
+{
+	std::string name;
+	uint32_t num_rows;
+	std::vector<Column> columns;
+
+	/// The named column, or NULL if the table doesn't have one.
+	Column const* find(std::string const& column_name) const;
+};
+
+/// Everything in a results file.
+struct Contents
+{
+	std::vector<std::string> adunit_names;
+	std::vector<std::pair<std::string, double>> attributes;
+	std::vector<Table> tables;
+
+	/// The named attribute, or \a default_value if there isn't one.
+	double attribute(std::string const& name, double default_value) const;
+
+	/// The named table, or NULL if there isn't one.
+	Table const* find(std::string const& table_name) const;
+};
+
+/// A table to write: rows of Results, as in TimeSeries.
+struct TableSource
+{
+	std::string name;
+	Results const* rows;
+	int num_rows;
+	bool age_adunit;	///< Also write the age by admin unit fields
+};
+
+
+
+/** \brief               Number of values in one row of a field.
+ *  \param  extent       The field's extent
+ *  \param  num_adunits  Number of admin units in the file
+ *  \return              The width of the field's column
+ */
+
+  uint32_t width(Extent extent, uint32_t num_adunits);
+
+
+
+/** \brief               Write a results file.
+ *  \param  filename     The file to write
+ *  \param  adunit_names Admin unit names; admin unit fields are trimmed to this many
+ *  \param  attributes   Named values describing the run, e.g. output switches
+ *  \param  tables       Tables to write
+ *  \param  compress     Allow XorPacked encoding of columns
+ *
+ *  Each column is written as Constant if all of its values are identical, as
+ *  XorPacked if \a compress is set and that is smaller, and as Raw otherwise.
+ *  All encodings are lossless.
+ */
+
+  void write(std::string const& filename, std::vector<std::string> const& adunit_names,
+             std::vector<std::pair<std::string, double>> const& attributes,
+             std::vector<TableSource> const& tables, bool compress);
+
+
+
+/** \brief             Read a results file.
+ *  \param  filename   The file to read
+ *  \return            The file's contents
+ */
+
+  Contents read(std::string const& filename);
+
+
+
+/** \brief             Pack doubles using the XorPacked encoding.
+ *  \param  values     Values to pack
+ *  \param  n          Number of values
+ *  \param  stride     Distance to the value each one is XORed with; a column's width
+ *  \return            Packed bytes
+ *
+ *  Each value is XORed with the one \a stride before it (the first \a stride with
+ *  zero), so in a row major column each is compared with the same entry in the
+ *  previous row. Zero bytes at either end of the result are dropped, and a
+ *  control byte holding the number of leading (high, top nibble) and trailing
+ *  (low, bottom nibble) zero bytes precedes the bytes that remain. Unchanged
+ *  values take one byte, and whole numbers and slowly changing values take a few.
+ */
+
+  std::vector<unsigned char> xor_pack(double const* values, std::size_t n, std::size_t stride);
+
+
+
+/** \brief             Unpack doubles packed by xor_pack.
+ *  \param  bytes      Packed bytes
+ *  \param  len        Number of packed bytes
+ *  \param  values     Set to the unpacked values
+ *  \param  n          Number of values expected
+ *  \param  stride     The stride they were packed with
+ *  \return            false if \a bytes don't hold exactly \a n values
+ */
+
+  bool xor_unpack(unsigned char const* bytes, std::size_t len, double* values, std::size_t n, std::size_t stride);
+} // namespace ResultsFile
+
+#endif // COVIDSIM_RESULTSFILE_H_INCLUDED_
@@ -0,0 +1,208 @@
+/** \file  ResultsToText.cpp
+ *  \brief Convert a realisation's results file back to the tab-separated tables written by SaveResults
+ *
+ *  Usage: ResultsToText results_file [output_file_base]
+ *
+ *  The output file base defaults to the results file name without its
+ *  ".results.bin" suffix, so the tables are written alongside it under the names
+ *  CovidSim would have used.
+ */
+
+#include <initializer_list>
+#include <string>
+
+#include "Error.h"
+#include "Files.h"
+#include "ResultsFile.h"
+
+using ResultsFile::Column;
+using ResultsFile::Table;
+
+static const std::string Suffix = ".results.bin";
+
+static Column const& column(Table const& table, const char* name)
+{
+	Column const* col = table.find(name);
+	if (col == NULL) ERR_CRITICAL_FMT("Results file has no %s column\n", name);
+	return *col;
+}
+
+// Writes every value of each column in turn for one row.
+static void write_columns(FILE* dat, Table const& table, uint32_t row, std::initializer_list<const char*> names, const char* format)
+{
+	for (auto name : names)
+	{
+		Column const& col = column(table, name);
+		for (uint32_t j = 0; j < col.width; j++) Files::xfprintf(dat, format, col.at(row, j));
+	}
+}
+
+static void write_adunit_header(FILE* dat, ResultsFile::Contents const& contents, std::initializer_list<const char*> prefixes)
+{
+	for (auto prefix : prefixes)
+		for (auto const& name : contents.adunit_names) Files::xfprintf(dat, "\t%s%s", prefix, name.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		Files::xfprintf_stderr("Usage: %s results_file [output_file_base]\n", argv[0]);
+		return 1;
+	}
+	std::string results_file = argv[1];
+	std::string output_file_base = results_file;
+	if (argc == 3)
+		output_file_base = argv[2];
+	else if (results_file.size() > Suffix.size() && results_file.compare(results_file.size() - Suffix.size(), Suffix.size(), Suffix) == 0)
+		output_file_base = results_file.substr(0, results_file.size() - Suffix.size());
+
+	ResultsFile::Contents contents = ResultsFile::read(results_file);
+	Table const* ts = contents.find("timeseries");
+	if (ts == NULL) ERR_CRITICAL_FMT("%s has no timeseries table; summary results files can't be converted\n", results_file.c_str());
+	Table const& table = *ts;
+	FILE* dat;
+	std::string outname;
+
+	if (contents.attribute("OutputNonSeverity", 0))
+	{
+		outname = output_file_base + ".xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t\tS\tL\tI\tR\tD\tincI\tincR\tincFC\tincC\tincDC\tincTC\tincCT\tincCC\tcumT\tcumTP\tcumV\tcumVG\tExtinct\trmsRad\tmaxRad\n");
+		const char* names[] = { "t", "S", "L", "I", "R", "D", "incI", "incR", "incFC", "incC", "incDC", "incTC", "incCT", "incCC",
+			"cumT", "cumTP", "cumV", "cumVG", "extinct", "rmsRad", "maxRad" };
+		for (uint32_t i = 0; i < table.num_rows; i++)
+			for (int c = 0; c < 21; c++)
+			{
+				// SaveResults has always written a 't' rather than a tab after cumTP.
+				const char* sep = (c == 0) ? "" : (c == 16) ? "t" : "\t";
+				Files::xfprintf(dat, "%s%.10f", sep, column(table, names[c]).at(i));
+				if (c == 20) Files::xfprintf(dat, "\n");
+			}
+		Files::xfclose(dat);
+	}
+
+	if (contents.attribute("OutputAdunit", 0))
+	{
+		outname = output_file_base + ".adunit.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t");
+		write_adunit_header(dat, contents, { "I_", "C_", "DC_" });
+		Files::xfprintf(dat, "\n");
+		for (uint32_t i = 0; i < table.num_rows; i++)
+		{
+			Files::xfprintf(dat, "%.10f", column(table, "t").at(i));
+			write_columns(dat, table, i, { "incI_adunit", "incC_adunit", "incDC_adunit" }, "\t%.10f");
+			Files::xfprintf(dat, "\n");
+		}
+		Files::xfclose(dat);
+	}
+
+	if (contents.attribute("OutputDigitalContactTracing", 0))
+	{
+		outname = output_file_base + ".digitalcontacttracing.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t");
+		write_adunit_header(dat, contents, { "incDCT_", "DCT_" });
+		Files::xfprintf(dat, "\n");
+		for (uint32_t i = 0; i < table.num_rows; i++)
+		{
+			Files::xfprintf(dat, "%.10lf", column(table, "t").at(i));
+			write_columns(dat, table, i, { "incDCT_adunit", "DCT_adunit" }, "\t%.10lf");
+			Files::xfprintf(dat, "\n");
+		}
+		Files::xfclose(dat);
+	}
+
+	if (contents.attribute("OutputKeyWorker", 0))
+	{
+		outname = output_file_base + ".keyworker.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t");
+		for (int i = 0; i < 2; i++) Files::xfprintf(dat, "\tI%i", i);
+		for (int i = 0; i < 2; i++) Files::xfprintf(dat, "\tC%i", i);
+		for (int i = 0; i < 2; i++) Files::xfprintf(dat, "\tT%i", i);
+		Files::xfprintf(dat, "\t%i\t%i\n", (int)contents.attribute("KeyWorkerNum", 0), (int)contents.attribute("KeyWorkerIncHouseNum", 0));
+		for (uint32_t i = 0; i < table.num_rows; i++)
+		{
+			Files::xfprintf(dat, "%.10f", column(table, "t").at(i));
+			write_columns(dat, table, i, { "incI_keyworker", "incC_keyworker", "cumT_keyworker" }, "\t%.10f");
+			Files::xfprintf(dat, "\n");
+		}
+		Files::xfclose(dat);
+	}
+
+	if (contents.attribute("OutputSeverity", 0))
+	{
+		outname = output_file_base + ".severity.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t\tRt\tTG\tSI\tS\tI\tR\tincI\tMild\tILI\tSARI\tCritical\tCritRecov\tincMild\tincILI\tincSARI\tincCritical\tincCritRecov\tincDeath\tincDeath_ILI\tincDeath_SARI\tincDeath_Critical\tcumMild\tcumILI\tcumSARI\tcumCritical\tcumCritRecov\tcumDeath\tcumDeath_ILI\tcumDeath_SARI\tcumDeath_Critical\n");
+		const char* names[] = { "t", "Rdenom", "meanTG", "meanSI", "S", "I", "R", "incI",
+			"Mild", "ILI", "SARI", "Critical", "CritRecov",
+			"incMild", "incILI", "incSARI", "incCritical", "incCritRecov",
+			"incD", "incDeath_ILI", "incDeath_SARI", "incDeath_Critical",
+			"cumMild", "cumILI", "cumSARI", "cumCritical", "cumCritRecov", "D",
+			"cumDeath_ILI", "cumDeath_SARI", "cumDeath_Critical" };
+		for (uint32_t i = 0; i < table.num_rows; i++)
+		{
+			Files::xfprintf(dat, "%.10f", column(table, names[0]).at(i));
+			for (std::size_t c = 1; c < sizeof(names) / sizeof(names[0]); c++) Files::xfprintf(dat, "\t%.10f", column(table, names[c]).at(i));
+			Files::xfprintf(dat, "\n");
+		}
+		Files::xfclose(dat);
+
+		if (contents.attribute("OutputSeverityAdminUnit", 0))
+		{
+			outname = output_file_base + ".severity.adunit.xls";
+			dat = Files::xfopen(outname.c_str(), "wb");
+			Files::xfprintf(dat, "t");
+			// The missing separator after incDeath_Critical_adu matches SaveResults.
+			write_adunit_header(dat, contents, { "Mild_", "ILI_", "SARI_", "Critical_", "CritRecov_",
+				"incI_", "incMild_", "incILI_", "incSARI_", "incCritical_", "incCritRecov_",
+				"incDeath_adu", "incDeath_ILI_adu", "incDeath_SARI_adu", "incDeath_Critical_adu" "cumMild_",
+				"cumILI_", "cumSARI_", "cumCritical_", "cumCritRecov_", "cumDeaths_",
+				"cumDeath_ILI_", "cumDeath_SARI_", "cumDeath_Critical_" });
+			Files::xfprintf(dat, "\n");
+			for (uint32_t i = 0; i < table.num_rows; i++)
+			{
+				Files::xfprintf(dat, "%.10f", column(table, "t").at(i));
+				write_columns(dat, table, i, { "Mild_adunit", "ILI_adunit", "SARI_adunit", "Critical_adunit", "CritRecov_adunit",
+					"incI_adunit", "incMild_adunit", "incILI_adunit", "incSARI_adunit", "incCritical_adunit", "incCritRecov_adunit",
+					"incD_adunit", "incDeath_ILI_adunit", "incDeath_SARI_adunit", "incDeath_Critical_adunit",
+					"cumMild_adunit", "cumILI_adunit", "cumSARI_adunit", "cumCritical_adunit", "cumCritRecov_adunit",
+					"cumD_adunit", "cumDeath_ILI_adunit", "cumDeath_SARI_adunit", "cumDeath_Critical_adunit" }, "\t%.10f");
+				if (i != table.num_rows - 1) Files::xfprintf(dat, "\n");
+			}
+			Files::xfclose(dat);
+		}
+	}
+
+	if (contents.attribute("OutputAdUnitAge", 0))
+	{
+		outname = output_file_base + ".age.adunit.xls";
+		dat = Files::xfopen(outname.c_str(), "wb");
+		Files::xfprintf(dat, "t");
+		const char* prefixes[] = { "incInf", "prevInf", "cumInf" };
+		for (auto prefix : prefixes)
+			for (auto const& name : contents.adunit_names)
+				for (int AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+					Files::xfprintf(dat, "\t%s_AG_%i_%s", prefix, AgeGroup, name.c_str());
+		Files::xfprintf(dat, "\n");
+		uint32_t num_adunits = (uint32_t)contents.adunit_names.size();
+		for (uint32_t i = 0; i < table.num_rows; i++)
+		{
+			Files::xfprintf(dat, "%.10f", column(table, "t").at(i));
+			for (auto name : { "incInf_age_adunit", "prevInf_age_adunit", "cumInf_age_adunit" })
+			{
+				Column const& col = column(table, name);
+				for (uint32_t AdUnit = 0; AdUnit < num_adunits; AdUnit++)
+					for (uint32_t AgeGroup = 0; AgeGroup < NUM_AGE_GROUPS; AgeGroup++)
+						Files::xfprintf(dat, "\t%.10f", col.at(i, AgeGroup * num_adunits + AdUnit));
+			}
+			Files::xfprintf(dat, "\n");
+		}
+		Files::xfclose(dat);
+	}
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+/** \file  RunningStats.cpp
+ *  \brief Accumulate means, variances and quantiles over realisations one at a time
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "Error.h"
+#include "RunningStats.h"
+
+void RunningStats::add(double const* x, double* sum, double* m2, std::size_t n, int count)
+{
+	// With sums rather than means kept, the mean before the update is sum / count
+	// and after it (sum + x) / (count + 1).
+	double inv_before = (count > 0) ? 1.0 / count : 0.0;
+	double inv_after = 1.0 / (count + 1.0);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		double xi = x ? x[i] : 0.0;
+		double delta = xi - sum[i] * inv_before;
+		sum[i] += xi;
+		m2[i] += delta * (xi - sum[i] * inv_after);
+	}
+}
+
+void RunningStats::merge(double const* sum_b, double const* m2_b, int count_b, double* sum, double* m2, std::size_t n, int count)
+{
+	if (count_b == 0) return;
+	if (count == 0)
+	{
+		std::copy(sum_b, sum_b + n, sum);
+		std::copy(m2_b, m2_b + n, m2);
+		return;
+	}
+	double inv_a = 1.0 / count, inv_b = 1.0 / count_b;
+	double weight = (double)count * count_b / ((double)count + count_b);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		double delta = sum_b[i] * inv_b - sum[i] * inv_a;
+		m2[i] += m2_b[i] + delta * delta * weight;
+		sum[i] += sum_b[i];
+	}
+}
+
+QuantileSketch::QuantileSketch(int k) : k_(k + (k & 1)), count_(0)
+{
+	if (k_ < 2) ERR_CRITICAL_FMT("Quantile sketch size must be at least 2, not %d\n", k);
+	clear();
+}
+
+void QuantileSketch::clear()
+{
+	count_ = 0;
+	levels_.assign(1, std::vector<double>());
+	odd_.assign(1, 0);
+}
+
+void QuantileSketch::add(double x)
+{
+	levels_[0].push_back(x);
+	count_++;
+	if (levels_[0].size() >= (std::size_t)k_) compact(0);
+}
+
+void QuantileSketch::compact(std::size_t level)
+{
+	if (level + 1 == levels_.size())
+	{
+		levels_.emplace_back();
+		odd_.push_back(0);
+	}
+	std::vector<double>& values = levels_[level];
+	std::sort(values.begin(), values.end());
+	// An odd one out (the largest) stays behind, so the total weight is unchanged.
+	std::size_t paired = values.size() & ~(std::size_t)1;
+	std::vector<double>& next = levels_[level + 1];
+	for (std::size_t i = odd_[level]; i < paired; i += 2) next.push_back(values[i]);
+	odd_[level] = !odd_[level];
+	values.erase(values.begin(), values.begin() + paired);
+	if (next.size() >= (std::size_t)k_) compact(level + 1);
+}
+
+void QuantileSketch::merge(QuantileSketch const& other)
+{
+	while (levels_.size() < other.levels_.size())
+	{
+		levels_.emplace_back();
+		odd_.push_back(0);
+	}
+	for (std::size_t level = 0; level < other.levels_.size(); level++)
+		levels_[level].insert(levels_[level].end(), other.levels_[level].begin(), other.levels_[level].end());
+	count_ += other.count_;
+	for (std::size_t level = 0; level < levels_.size(); level++)
+		if (levels_[level].size() >= (std::size_t)k_) compact(level);
+}
+
+double QuantileSketch::quantile(double q) const
+{
+	std::vector<std::pair<double, long long>> weighted;
+	for (std::size_t level = 0; level < levels_.size(); level++)
+		for (double value : levels_[level]) weighted.push_back({ value, 1LL << level });
+	if (weighted.empty()) return 0.0;
+	std::sort(weighted.begin(), weighted.end());
+
+	double target = q * (double)count_;
+	long long cumulative = 0;
+	for (auto const& value : weighted)
+	{
+		cumulative += value.second;
+		if ((double)cumulative >= target) return value.first;
+	}
+	return weighted.back().first;
+}
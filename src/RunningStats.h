@@ -0,0 +1,73 @@
+/** \file  RunningStats.h
+ *  \brief Accumulate means, variances and quantiles over realisations one at a time
+ */
+
+#ifndef COVIDSIM_RUNNINGSTATS_H_INCLUDED_
+#define COVIDSIM_RUNNINGSTATS_H_INCLUDED_
+
+#include <cstddef>
+#include <vector>
+
+/// Running sums and sums of squared deviations from the mean (M2) of columns
+/// of doubles, such as the doubles of a Results row. The variance of a column
+/// over count samples is m2 / count. Updating M2 directly, rather than summing
+/// squares and subtracting the squared mean at the end, doesn't lose precision
+/// when the variance is small next to the mean.
+namespace RunningStats
+{
+	/** \brief            Add a sample to the columns (Welford's update).
+	 *  \param  x         The sample's values, or NULL for zeros
+	 *  \param  sum       Running sums, updated
+	 *  \param  m2        Running sums of squared deviations, updated
+	 *  \param  n         Number of columns
+	 *  \param  count     Number of samples already added
+	 */
+	void add(double const* x, double* sum, double* m2, std::size_t n, int count);
+
+	/** \brief            Merge the columns of another set of samples into these (Chan et al.'s update).
+	 *  \param  sum_b     The other samples' sums
+	 *  \param  m2_b      The other samples' sums of squared deviations
+	 *  \param  count_b   Number of other samples
+	 *  \param  sum       Running sums, updated
+	 *  \param  m2        Running sums of squared deviations, updated
+	 *  \param  n         Number of columns
+	 *  \param  count     Number of samples already added
+	 */
+	void merge(double const* sum_b, double const* m2_b, int count_b, double* sum, double* m2, std::size_t n, int count);
+}
+
+/// A fixed-size summary of a stream of values from which quantiles can be
+/// estimated (a KLL-style sketch with a constant compactor size). Values are
+/// kept exactly until k of them have been added; after that, levels of k
+/// values are sorted and halved, each survivor standing for twice as many, so
+/// memory grows only with log(count / k). Which half survives alternates, not
+/// randomly, so results are reproducible.
+class QuantileSketch
+{
+public:
+	explicit QuantileSketch(int k = 64);
+
+	void add(double x);
+
+	/// Adds the values summarised by another sketch.
+	void merge(QuantileSketch const& other);
+
+	/// The smallest value with at least a proportion q of the values at or below it.
+	/// \return 0 if nothing has been added
+	double quantile(double q) const;
+
+	/// Number of values added.
+	long long count() const { return count_; }
+
+	void clear();
+
+private:
+	void compact(std::size_t level);
+
+	int k_;
+	long long count_;
+	std::vector<std::vector<double>> levels_;	///< Values of weight 2^level
+	std::vector<char> odd_;						///< Which half the next compaction of each level keeps
+};
+
+#endif // COVIDSIM_RUNNINGSTATS_H_INCLUDED_
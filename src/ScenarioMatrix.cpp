@@ -0,0 +1,123 @@
+/** \file  ScenarioMatrix.cpp
+ *  \brief Read a matrix of scenarios to run on the same population
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Error.h"
+#include "Files.h"
+#include "ScenarioMatrix.h"
+
+namespace
+{
+	enum struct Column { R0Scale, Interventions, Clp };
+
+	std::string trim(std::string const& s)
+	{
+		std::size_t start = s.find_first_not_of(" \t\r");
+		if (start == std::string::npos) return std::string();
+		return s.substr(start, s.find_last_not_of(" \t\r") + 1 - start);
+	}
+
+	std::vector<std::string> split(std::string const& s, char sep)
+	{
+		std::vector<std::string> cells;
+		std::size_t start = 0, end;
+		while ((end = s.find(sep, start)) != std::string::npos)
+		{
+			cells.push_back(trim(s.substr(start, end - start)));
+			start = end + 1;
+		}
+		cells.push_back(trim(s.substr(start)));
+		return cells;
+	}
+
+	double to_double(std::string const& cell, std::string const& column, std::string const& filename, int line)
+	{
+		char* end;
+		double value = strtod(cell.c_str(), &end);
+		if ((end == cell.c_str()) || (*end != '\0'))
+			ERR_CRITICAL_FMT("%s:%d: Can't read %s from \"%s\"\n", filename.c_str(), line, column.c_str(), cell.c_str());
+		return value;
+	}
+}
+
+std::vector<ScenarioMatrix::Scenario> ScenarioMatrix::parse(std::string const& text, std::string const& filename)
+{
+	std::vector<Scenario> scenarios;
+	std::vector<std::string> names;
+	std::vector<Column> columns;
+	std::vector<int> clp_index;
+	std::size_t start = 0;
+	for (int line = 1; start < text.size(); line++)
+	{
+		std::size_t end = text.find('\n', start);
+		if (end == std::string::npos) end = text.size();
+		std::string row = trim(text.substr(start, end - start));
+		start = end + 1;
+		if (row.empty() || (row[0] == '#')) continue;
+
+		std::vector<std::string> cells = split(row, ',');
+		if (columns.empty())
+		{
+			for (std::string const& name : cells)
+			{
+				int index = -1;
+				if (name == "R") columns.push_back(Column::R0Scale);
+				else if (name == "I") columns.push_back(Column::Interventions);
+				else if ((name.size() > 3) && (name.size() <= 5) && (name.compare(0, 3, "CLP") == 0) && isdigit((unsigned char)name[3])
+					&& ((name.size() == 4) || isdigit((unsigned char)name[4])))
+				{
+					columns.push_back(Column::Clp);
+					index = atoi(name.c_str() + 3);
+				}
+				else
+					ERR_CRITICAL_FMT("%s:%d: Unknown scenario column \"%s\"; expected R, I or CLP0 to CLP99\n", filename.c_str(), line, name.c_str());
+				names.push_back(name);
+				clp_index.push_back(index);
+			}
+			continue;
+		}
+
+		if (cells.size() != columns.size())
+			ERR_CRITICAL_FMT("%s:%d: Scenario has %d cells but there are %d columns\n", filename.c_str(), line, (int)cells.size(), (int)columns.size());
+		Scenario scenario = { line, {}, false, 1.0, false, {} };
+		for (std::size_t c = 0; c < cells.size(); c++)
+		{
+			if (cells[c].empty()) continue;
+			switch (columns[c])
+			{
+			case Column::R0Scale:
+				scenario.has_r0_scale = true;
+				scenario.r0_scale = to_double(cells[c], names[c], filename, line);
+				break;
+			case Column::Interventions:
+				scenario.has_interventions = true;
+				if (cells[c] != "-")
+					for (std::string const& file : split(cells[c], ';'))
+						if (!file.empty()) scenario.intervention_files.push_back(file);
+				break;
+			case Column::Clp:
+				scenario.clp.emplace_back(clp_index[c], to_double(cells[c], names[c], filename, line));
+				break;
+			}
+		}
+		scenarios.push_back(scenario);
+	}
+	if (columns.empty()) ERR_CRITICAL_FMT("Scenario file %s has no header row\n", filename.c_str());
+	return scenarios;
+}
+
+std::vector<ScenarioMatrix::Scenario> ScenarioMatrix::read(std::string const& filename)
+{
+	FILE* dat = Files::xfopen(filename.c_str(), "rb");
+	std::string text;
+	char chunk[65536];
+	std::size_t n;
+	while ((n = fread(chunk, 1, sizeof(chunk), dat)) > 0) text.append(chunk, n);
+	if (ferror(dat)) ERR_CRITICAL_FMT("Error while reading scenario file %s\n", filename.c_str());
+	Files::xfclose(dat);
+	return parse(text, filename);
+}
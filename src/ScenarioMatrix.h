@@ -0,0 +1,52 @@
+/** \file  ScenarioMatrix.h
+ *  \brief Read a matrix of scenarios to run on the same population
+ */
+
+#ifndef COVIDSIM_SCENARIOMATRIX_H_INCLUDED_
+#define COVIDSIM_SCENARIOMATRIX_H_INCLUDED_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ScenarioMatrix
+{
+/// The command-line options one scenario overrides. Anything not overridden
+/// keeps its value from the command line.
+struct Scenario
+{
+	int line;											///< Line of the scenario file, for messages
+	std::vector<std::pair<int, double>> clp;			///< /CLP index and value
+	bool has_r0_scale;
+	double r0_scale;									///< /R
+	bool has_interventions;
+	std::vector<std::string> intervention_files;		///< /I, in order; may be empty for none
+};
+
+
+
+/** \brief           Parse an in-memory scenario file.
+ *  \param  text     CSV text to parse
+ *  \param  filename Name used in error messages
+ *  \return          One Scenario per row after the header
+ *
+ *  The first row names the columns: R, I, or CLP followed by its number (as
+ *  with /CLP, CLP05 and CLP5 are the same). Each further row is a scenario. An
+ *  empty cell keeps the command-line value. I cells hold intervention files
+ *  separated by ';', or - for none. Blank lines and lines starting with # are
+ *  skipped. Cells can't be quoted.
+ */
+
+  std::vector<Scenario> parse(std::string const& text, std::string const& filename);
+
+
+
+/** \brief           Read and parse a scenario file; see parse.
+ *  \param  filename The scenario file to read
+ */
+
+  std::vector<Scenario> read(std::string const& filename);
+} // namespace ScenarioMatrix
+
+#endif // COVIDSIM_SCENARIOMATRIX_H_INCLUDED_
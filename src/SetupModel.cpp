@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <chrono>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
 #include <ctime>
+#include <thread>
 #include <vector>
 #define __STDC_FORMAT_MACROS 1
 
@@ -18,22 +21,25 @@
 #include "InfStat.h"
 #include "Bitmap.h"
 #include "Memory.h"
+#include "DensityFile.h"
+#include "SpatialGrid.h"
+#include "HouseholdAges.h"
 
 void* BinFileBuf;
 BinFile* BF;
 int netbuf[MAX_NUM_PLACE_TYPES * 1000000];
+Memory::Arena SetupArena;
+SetupStages SetupProgress;
 
 
 ///// INITIALIZE / SET UP FUNCTIONS
-void SetupModel(std::string const& density_file, std::string const& out_density_file, std::string const& load_network_file,
+void SetupModel(std::string const& density_file, std::string const& density_cache_file, std::string const& out_density_file, std::string const& load_network_file,
 				std::string const& save_network_file, std::string const& school_file, std::string const& reg_demog_file,
 				std::string const& out_file_base)
 {
 	int l, m, j2, l2, m2;
-	unsigned int rn;
+	uint64_t rn;
 	double t, s, s2;
-	char buf[2048];
-	FILE* dat;
 
 	// allocate memory for integers used in multi=threaded random number generation.
   Xcg1 = (int32_t*)Memory::xcalloc(MAX_NUM_THREADS * CACHE_LINE_SIZE, sizeof(int32_t));
@@ -42,71 +48,49 @@ void SetupModel(std::string const& density_file, std::string const& out_density_
 	P.nextSetupSeed2 = P.setupSeed2;
 	setall(&P.nextSetupSeed1, &P.nextSetupSeed2);
 	P.DoBin = -1;
+	SetupProgress.begin("density");
+	bool density_resumed = false;
 	if (!density_file.empty())
 	{
 		Files::xfprintf_stderr("Scanning population density file\n");
-		dat = Files::xfopen(density_file.c_str(), "rb");
-		unsigned int density_file_header;
-		Files::fread_big(&density_file_header, sizeof(unsigned int), 1, dat);
-		if (density_file_header == 0xf0f0f0f0) //code for first 4 bytes of binary file ## NOTE - SHOULD BE LONG LONG TO COPE WITH BIGGER POPULATIONS
+		if (DensityFile::is_binary(density_file))
 		{
 			P.DoBin = 1;
-			Files::fread_big(&(P.BinFileLen), sizeof(unsigned int), 1, dat);
-			BinFileBuf = Memory::xcalloc(P.BinFileLen, sizeof(BinFile));
-			Files::fread_big(BinFileBuf, sizeof(BinFile), (size_t)P.BinFileLen, dat);
-			BF = (BinFile*)BinFileBuf;
-			Files::xfclose(dat);
+			BF = DensityFile::read_binary(density_file, P.BinFileLen);
 		}
 		else
 		{
 			P.DoBin = 0;
-			// Count the number of lines in the density file
-			rewind(dat);
-			P.BinFileLen = 0;
-			while(fgets(buf, sizeof(buf), dat) != NULL) P.BinFileLen++;
-			if(ferror(dat)) ERR_CRITICAL("Error while reading density file\n");
-			// Read each line, and build the binary structure that corresponds to it
-			rewind(dat);
-			BinFileBuf = (void*)Memory::xcalloc(P.BinFileLen, sizeof(BinFile));
-			BF = (BinFile*)BinFileBuf;
-			unsigned int index = 0;
-			while(fgets(buf, sizeof(buf), dat) != NULL)
-			{
-				int i2;
-				double x, y;
-				// This shouldn't be able to happen, as we just counted the number of lines:
-				if (index == P.BinFileLen) ERR_CRITICAL("Too many input lines while reading density file\n");
-				if (P.DoAdUnits)
+			// Without a cache, a setup checkpoint holds the parsed records instead, but is only read by the same setup.
+			std::string cache_file = density_cache_file;
+			bool use_cache = true;
+			if (cache_file.empty() && SetupProgress.checkpointing())
+			{
+				cache_file = SetupProgress.checkpoint_file("density");
+				use_cache = SetupProgress.completed("density");
+			}
+			// The records also depend on whether there are admin units and on the cut line.
+			DensityFile::TextSource source = { 0, 0, P.DoAdUnits != 0, P.LongitudeCutLine };
+			if (!Files::stat_file(density_file.c_str(), source.size, source.mtime))
+				ERR_CRITICAL_FMT("Unable to read size of density file %s\n", density_file.c_str());
+			if (use_cache && !cache_file.empty() && DensityFile::read_cache(cache_file, source, BF, P.BinFileLen))
+			{
+				// The cache holds exactly the records parsed from the text file, so carry on as if we had parsed it.
+				Files::xfprintf_stderr("Reading cached density file %s\n", cache_file.c_str());
+				density_resumed = true;
+			}
+			else
+			{
+				BF = DensityFile::read_text(density_file, P.BinFileLen, P.DoAdUnits != 0, P.LongitudeCutLine, P.NumThreads);
+				if (!cache_file.empty())
 				{
-					Files::xsscanf(buf, 5, "%lg %lg %lg %i %i", &x, &y, &t, &i2, &l);
-					if (l / P.CountryDivisor != i2)
-					{
-						//Files::xfprintf_stderr("# %lg %lg %lg %i %i\n",x,y,t,i2,l);
-					}
-				}
-				else {
-					Files::xsscanf(buf, 4, "%lg %lg %lg %i", &x, &y, &t, &i2);
-					l = 0;
-				}
-				// Ensure we use an x which gives us a contiguous whole for the
-				// geography.
-				if (x >= P.LongitudeCutLine) {
-					BF[index].x = x;
+					Files::xfprintf_stderr("Saving parsed density file to %s\n", cache_file.c_str());
+					DensityFile::write_cache(cache_file, source, BF, P.BinFileLen);
+					if (density_cache_file.empty()) SetupProgress.mark_completed("density");
 				}
-				else {
-					BF[index].x = x + 360;
-				}
-				BF[index].y = y;
-				BF[index].pop = t;
-				BF[index].cnt = i2;
-				BF[index].ad = l;
-				index++;
 			}
-			if(ferror(dat)) ERR_CRITICAL("Error while reading density file\n");
-			// This shouldn't be able to happen, as we just counted the number of lines:
-			if (index != P.BinFileLen) ERR_CRITICAL("Too few input lines while reading density file\n");
-			Files::xfclose(dat);
 		}
+		BinFileBuf = (void*)BF;
 
 		if (P.DoAdunitBoundaries)
 		{
@@ -211,6 +195,7 @@ void SetupModel(std::string const& density_file, std::string const& out_density_
 	Files::xfprintf_stderr("Coords xmcell=%lg m   ymcell = %lg m\n",
 		sqrt(dist2_raw(P.in_degrees_.width / 2, P.in_degrees_.height / 2, P.in_degrees_.width / 2 + P.in_microcells_.width, P.in_degrees_.height / 2)),
 		sqrt(dist2_raw(P.in_degrees_.width / 2, P.in_degrees_.height / 2, P.in_degrees_.width / 2, P.in_degrees_.height / 2 + P.in_microcells_.height)));
+	SetupProgress.end((double)P.PopSize, density_resumed);
 
 	SetupPopulation(density_file, out_density_file, school_file, reg_demog_file);
 
@@ -271,32 +256,49 @@ void SetupModel(std::string const& density_file, std::string const& out_density_
 		}
 	}
 
-	//added memory allocation and initialisation of infection event log, if DoRecordInfEvents is set to 1: ggilani - 10/10/2014
-	if (P.DoRecordInfEvents)
-	{
-		InfEventLog = (Events*)Memory::xcalloc(P.MaxInfEvents, sizeof(Events));
-	}
-
-	if(P.OutputNonSeverity) SaveAgeDistrib(out_file_base);
+	if (P.OutputNonSeverity && !out_file_base.empty()) SaveAgeDistrib(out_file_base);
 
 	Files::xfprintf_stderr("Initialising places...\n");
+	SetupProgress.begin("places");
+	bool places_resumed = false;
 	if (P.DoPlaces)
 	{
 		if (!load_network_file.empty())
 			LoadPeopleToPlaces(load_network_file);
+		else if (SetupProgress.completed("places"))
+		{
+			LoadPeopleToPlaces(SetupProgress.checkpoint_file("places"));
+			places_resumed = true;
+		}
 		else
+		{
 			AssignPeopleToPlaces();
+			if (SetupProgress.checkpointing())
+			{
+				// Renamed once written, so a setup killed while saving doesn't leave a partial network to resume from.
+				std::string checkpoint_file = SetupProgress.checkpoint_file("places");
+				SavePeopleToPlaces(checkpoint_file + ".tmp");
+#ifdef _WIN32
+				remove(checkpoint_file.c_str()); // rename does not replace an existing file on Windows
+#endif
+				Files::xrename((checkpoint_file + ".tmp").c_str(), checkpoint_file.c_str());
+				SetupProgress.mark_completed("places");
+			}
+		}
 	}
 
 	if (P.DoPlaces && !save_network_file.empty())
 		SavePeopleToPlaces(save_network_file);
+	SetupProgress.end((double)P.PopSize, places_resumed);
 	//SaveDistribs();
 
 	// From here on, we want the same random numbers regardless of whether we used the RNG to make the network,
 	// or loaded the network from a file. Therefore we need to reseed the RNG.
 	setall(&P.nextSetupSeed1, &P.nextSetupSeed2);
 
+	SetupProgress.begin("stratification");
 	StratifyPlaces();
+	SetupProgress.end((double)P.PopSize);
 	for (int i = 0; i < P.NumCells; i++)
 	{
 		Cells[i].S = Cells[i].n;
@@ -305,9 +307,11 @@ void SetupModel(std::string const& density_file, std::string const& out_density_
 	}
 
 	Files::xfprintf_stderr("Initialising kernel...\n");
+	SetupProgress.begin("kernels");
 	P.Kernel = P.MoveKernel;
 	P.KernelLookup.init(1.0, P.Kernel);
-	CovidSim::TBD1::KernelLookup::init(P.KernelLookup, CellLookup, P.NumPopulatedCells);
+	P.KernelLookup.init(CellLookup, P.NumPopulatedCells);
+	SetupProgress.end();
 
 	for (int i = 0; i < P.PopSize; i++) Hosts[i].keyworker = Hosts[i].care_home_resident = 0;
 	double nstaff = 0, nres = 0;
@@ -473,7 +477,13 @@ void SetupModel(std::string const& density_file, std::string const& out_density_
 	}
 
 	UpdateProbs(0);
-	if (P.DoAirports) SetupAirports();
+	if (P.DoAirports)
+	{
+		SetupProgress.begin("airports");
+		SetupAirports();
+		SetupProgress.end();
+	}
+	P.KernelLookup.release();
 
 	TSMean = TSMeanNE; TSVar = TSVarNE;
 	Files::xfprintf_stderr("Calculated approx cell probabilities\n");
@@ -584,7 +594,10 @@ void ResetTimeSeries()
 		}
 		TSMean = TSMeanNE; TSVar = TSVarNE;
 	}
-
+	TSQuantilesE.clear();
+	TSQuantilesNE.clear();
+	// These are reset with the realisation counts, which their running variances depend on.
+	PeakHeightSum = PeakHeightSS = PeakTimeSum = PeakTimeSS = 0;
 }
 
 int ReadFitIter(std::string const& FitFile)
@@ -593,30 +606,33 @@ int ReadFitIter(std::string const& FitFile)
 	Purpose of this function is:
 		i) read and return a flag from FitFile determining whether to continue fitting;
 		ii) if continuing fitting, to amend parameters (via command line params P.clP) from a fit file (for a particular iteration/update/proposed posterior sample from CovidSimMCMC)
+	If FitFile is "-", each iteration is instead read as a line from stdin, with the same contents as a fit file, from a driver that keeps this process running between iterations.
 	*/
 
 	// Compare with functions CovidSimMCMC::StartJobs and CovidSimMCMC::EndJobs
 
 	FILE* FitFile_Iter_dat;
 	int PosteriorSampleNumber, NumFittedParams, cl_index[100];
-	double Clock_1, Clock_2;
+	bool FitPipe = (FitFile == "-");
 
-	std::string fit_file_iter_filename = FitFile + ".f" + std::to_string(P.FitIter) + ".txt";
+	std::string fit_file_iter_filename = FitPipe ? "stdin" : FitFile + ".f" + std::to_string(P.FitIter) + ".txt";
 	P.clP[99] = -1; // CLP #99 reserved for fitting overdispersion in likelihood.
 
-	// Have program wait (indefinitely) until FitFile_Iter_dat / fit_file_iter_filename appears.
-	do
+	if (FitPipe)
 	{
-		Clock_1 = ((double) clock()) / CLOCKS_PER_SEC;
-		do
-		{
-			Clock_2 = ((double)clock()) / CLOCKS_PER_SEC;
-		}
-		while ((Clock_2 > Clock_1) && (Clock_2 < Clock_1 + 1.0)); // first condition by definition true on first go of inner do-while, won't be true for very long if inner do-while not called and Clock_2 not reset, which it will be if more than 1 second has elapsed between setting of Clock_2 and resetting of Clock_1. 
-	} while (!(FitFile_Iter_dat = Files::xfopen_if_exists(fit_file_iter_filename.c_str(), "r"))); // if fit_file_iter_filename exists, proceed. Otherwise go through outer and inner do-while's again. 
+		// Blocks until the driver sends the next iteration. It stops fitting by sending NumFittedParams <= 0 or closing stdin.
+		FitFile_Iter_dat = stdin;
+		if (fscanf(FitFile_Iter_dat, "%i %i", &PosteriorSampleNumber, &NumFittedParams) != 2) NumFittedParams = 0;
+	}
+	else
+	{
+		// Have program wait (indefinitely) until FitFile_Iter_dat / fit_file_iter_filename appears, checking once a second.
+		while (!(FitFile_Iter_dat = Files::xfopen_if_exists(fit_file_iter_filename.c_str(), "r")))
+			std::this_thread::sleep_for(std::chrono::seconds(1));
 
-	// Extract iteration/posterior sample number, and number of fitted parameters from FitFile_Iter_dat
-	Files::xfscanf(FitFile_Iter_dat, 2, "%i %i", &PosteriorSampleNumber, &NumFittedParams);
+		// Extract iteration/posterior sample number, and number of fitted parameters from FitFile_Iter_dat
+		Files::xfscanf(FitFile_Iter_dat, 2, "%i %i", &PosteriorSampleNumber, &NumFittedParams);
+	}
 
 	// Output any errors to stderrr.
 	// NumFittedParams < 0 is flag set in CovidSimMCMC::EndJobs.
@@ -631,25 +647,88 @@ int ReadFitIter(std::string const& FitFile)
 		for (int ParamNum = 0; ParamNum < NumFittedParams; ParamNum++) Files::xfscanf(FitFile_Iter_dat, 1, "%i"	, &(cl_index[ParamNum])		); // extract indices of parameters to fit (GlobalID and LocalID in CovidSimMCMC)
 		for (int ParamNum = 0; ParamNum < NumFittedParams; ParamNum++) Files::xfscanf(FitFile_Iter_dat, 1, "%lg", &P.clP[cl_index[ParamNum]]); // update values in clP array at those indices (proposedParams[Region][Run][ParamNumber] in CovidSimMCMC)
 	}																						
-	Files::xfclose(FitFile_Iter_dat);
+	if (!FitPipe) Files::xfclose(FitFile_Iter_dat);
 
 	// continue fitting (0) or stop (1)
 	return (NumFittedParams > 0) ? 0 : 1;
 }
 
-void InitTransmissionCoeffs(void)
+// Adds values in order with Kahan compensation. Totals made this way from per-block partial
+// sums do not depend on how the blocks were shared among threads.
+static double SumInOrder(std::vector<double> const& values)
 {
-	// To calibrate R0 and various transmission coefficients/betas, effectivey run the model, (more-or-less) deterministically through the population WITHOUT any interventions. Asks how many secondary infections there would be, given infectious period, per infection at household, place and spatial levels. 
-	double NumPeopleInPlaceGroup; 
-	double ProbSurvive, ProbSurviveNonCareHome;
-	double quantile, LatentToSympDelay;
-	double HH_Infections = 0; // total number of spatial infections summed over entire population in #pragma loop below.
-	double SpatialInfections = 0; // total number of spatial infections summed over entire population in #pragma loop below.
-	double PlaceInfections = 0; // total number of place infections (and all place types) summed over entire population in #pragma loop below
+	double sum = 0, compensation = 0;
+	for (double v : values)
+	{
+		double y = v - compensation;
+		double t = sum + y;
+		compensation = (t - sum) - y;
+		sum = t;
+	}
+	return sum;
+}
+
+// Probability of escaping infection over time steps [from, to) of an infectious period, given
+// infectiousness scaled to a per-step probability of infection.
+static double ProbEscapeInfection(double scale, int from, int to)
+{
+	double ProbSurvive = 1.0;
+#pragma omp simd reduction(*:ProbSurvive)
+	for (int InfectiousDay = from; InfectiousDay < to; InfectiousDay++)
+	{
+		double ProbSurviveToday = 1.0 - scale * P.infectiousness[InfectiousDay];
+		ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
+	}
+	return ProbSurvive;
+}
+
+// Parameters read by the pass over the population in InitTransmissionCoeffs. The pass is only repeated
+// (e.g. between fitting iterations) when one of these changes, so any parameter it uses must be listed here.
+static std::vector<double> PopulationR0Inputs(void)
+{
+	std::vector<double> Inputs;
+	auto Add = [&Inputs](double const* Values, int Num) { Inputs.insert(Inputs.end(), Values, Values + Num); };
+	Inputs = { (double)P.PopSize, P.SusceptibilitySD, (double)P.DoPartialImmunity, P.InfectiousnessSD, P.SymptInfectiousness, P.AsymptInfectiousness,
+		P.InfectiousPeriod, P.ModelTimeStep, (double)P.DoHouseholds, (double)P.NoInfectiousnessSDinHH, P.CareHomeResidentHouseholdScaling, P.HouseholdTrans,
+		P.LatentToSymptDelay, P.CareHomeResidentSpatialScaling, (double)P.Got_WAIFW_Matrix_Spatial, (double)P.NumAdunits, P.SymptSpatialContactRate,
+		(double)P.DoPlaces, (double)P.NumPlaceTypes, (double)P.HotelPlaceType, P.CareHomePropResidents, P.CareHomeWorkerGroupScaling };
+	Add(P.InitialImmunity, NUM_AGE_GROUPS);
+	Add(P.AgeInfectiousness, NUM_AGE_GROUPS);
+	Add(P.ProportionSymptomatic, NUM_AGE_GROUPS);
+	Add(P.AgeSusceptibility, NUM_AGE_GROUPS);
+	Add(P.RelativeSpatialContact, NUM_AGE_GROUPS);
+	Add(P.infectious_icdf.get_values(), CDF_RES + 1);
+	Add(P.infectiousness, MAX_INFECTIOUS_STEPS);
+	Add(P.HouseholdDenomLookup, MAX_HOUSEHOLD_SIZE);
+	if (P.Got_WAIFW_Matrix_Spatial)
+	{
+		for (int InfecteeAge = 0; InfecteeAge < NUM_AGE_GROUPS; InfecteeAge++) Add(P.WAIFW_Matrix_SpatialOnly[InfecteeAge], NUM_AGE_GROUPS);
+		for (int Adunit = 0; Adunit < ((P.NumAdunits > 0) ? P.NumAdunits : 1); Adunit++) Add(P.PropAgeGroup[Adunit], NUM_AGE_GROUPS);
+	}
+	Add(P.PlaceTypeTrans, MAX_NUM_PLACE_TYPES);
+	Add(P.PlaceTypeGroupSizeParam1, MAX_NUM_PLACE_TYPES);
+	Add(P.SymptPlaceTypeContactRate, MAX_NUM_PLACE_TYPES);
+	Add(P.SymptPlaceTypeWithdrawalProp, MAX_NUM_PLACE_TYPES);
+	Add(P.PlaceTypePropBetweenGroupLinks, MAX_NUM_PLACE_TYPES);
+	return Inputs;
+}
+
+// Household and place R0, and spatial R0 per unit of spatial beta, found by the pass over the population
+// in InitTransmissionCoeffs for the parameters in Inputs.
+static struct
+{
+	std::vector<double> Inputs;
+	double R0household, R0places, Spatial_R0, RecoveryTimeSteps;
+} PopulationR0;
 
-	double Household_Infectiousness = 0; /// Household infectiousness
-	double Spatial_Infectiousness = 0; /// Household infectiousness
-	double Place_Infectiousness = 0;
+static void InitPopulationR0(uint64_t seed)
+{
+	// To calibrate R0 and various transmission coefficients/betas, effectivey run the model, (more-or-less) deterministically through the population WITHOUT any interventions. Asks how many secondary infections there would be, given infectious period, per infection at household, place and spatial levels. 
+	// People are taken in fixed blocks, each drawing from its own stream and summing into its own
+	// partial sums, which are then added in block order, so the results do not depend on the number of threads.
+	int PeoplePerBlock = 4096;
+	int NumBlocks = (P.PopSize + PeoplePerBlock - 1) / PeoplePerBlock;
+	std::vector<double> HH_Infections(NumBlocks), SpatialInfections(NumBlocks), PlaceInfections(NumBlocks), HH_SAR_Denom(NumBlocks);
 
 	double HouseholdMeanSize = 0;
 	double CumulativeHHSizeDist = 0; 
@@ -661,175 +740,195 @@ void InitTransmissionCoeffs(void)
 	}
 	Files::xfprintf_stderr("Household mean size = %lg\n", HouseholdMeanSize);
 
+	// Cumulative infectiousness by time step, so that spatial infections over any part of the infectious period are a difference.
+	std::vector<double> CumInfectiousness(MAX_INFECTIOUS_STEPS + 1);
+	for (int InfectiousDay = 0; InfectiousDay < MAX_INFECTIOUS_STEPS; InfectiousDay++)
+		CumInfectiousness[InfectiousDay + 1] = CumInfectiousness[InfectiousDay] + P.infectiousness[InfectiousDay];
+	// If doing contact matrices, spatial infectiousness of an infector is scaled by their contact rate averaged over infectee ages,
+	// weighted by the age distribution of their admin unit (unlike InfectSweep, infectees are not explicitly considered here).
+	int NumAvContactRateAdunits = (P.NumAdunits > 0) ? P.NumAdunits : 1;
+	std::vector<double> AvContactRate_Infector((size_t)NumAvContactRateAdunits * NUM_AGE_GROUPS, 1.0);
+	if (P.Got_WAIFW_Matrix_Spatial)
+		for (int Adunit = 0; Adunit < NumAvContactRateAdunits; Adunit++)
+			for (int InfectorAge = 0; InfectorAge < NUM_AGE_GROUPS; InfectorAge++)
+			{
+				double AvContactRate = 0;
+				for (int InfecteeAge = 0; InfecteeAge < NUM_AGE_GROUPS; InfecteeAge++)
+					AvContactRate += P.PropAgeGroup[Adunit][InfecteeAge] * P.WAIFW_Matrix_SpatialOnly[InfecteeAge][InfectorAge];
+				AvContactRate_Infector[(size_t)Adunit * NUM_AGE_GROUPS + InfectorAge] = AvContactRate;
+			}
+
 	//// Loops below sum household and spatial infections 
-	double HH_SAR_Denom = 0.0; // household secondary-attack rate denominator. Will sum over following #pragma loop
-#pragma omp parallel for private(Household_Infectiousness,Spatial_Infectiousness,quantile,LatentToSympDelay,ProbSurvive) schedule(static,1) reduction(+:HH_Infections,SpatialInfections,HH_SAR_Denom) default(none) shared(P, Households, Hosts, Mcells)
+	std::vector<int32_t> saved_Xcg1(Xcg1, Xcg1 + MAX_NUM_THREADS * CACHE_LINE_SIZE), saved_Xcg2(Xcg2, Xcg2 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+#pragma omp parallel for schedule(static,1) default(none) \
+		shared(P, Households, Hosts, HostsState, Mcells, seed, NumBlocks, PeoplePerBlock, HH_Infections, SpatialInfections, HH_SAR_Denom, CumInfectiousness, AvContactRate_Infector)
 	for (int Thread = 0; Thread < P.NumThreads; Thread++) // loop over threads
-	{
-		for (int Person = Thread; Person < P.PopSize; Person += P.NumThreads) // loop over people
+		for (int Block = Thread; Block < NumBlocks; Block += P.NumThreads) // loop over blocks of people
 		{
-			// assign susceptibility of each host.
-			if (P.SusceptibilitySD == 0)
-				Hosts[Person].susc = (float)((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[HOST_AGE_GROUP(Person)]) : 1.0);
-			else
-				Hosts[Person].susc = (float)(((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[HOST_AGE_GROUP(Person)]) : 1.0) * gen_gamma_mt(1 / (P.SusceptibilitySD * P.SusceptibilitySD), 1 / (P.SusceptibilitySD * P.SusceptibilitySD), Thread));
+			stream_seed_thread(stream_init(seed, (uint64_t)Block), Thread);
+			int LastPerson = std::min((Block + 1) * PeoplePerBlock, P.PopSize);
+			double SusceptibilityShape = (P.SusceptibilitySD == 0) ? 0 : 1 / (P.SusceptibilitySD * P.SusceptibilitySD);
+			double InfectiousnessShape = (P.InfectiousnessSD == 0) ? 0 : 1 / (P.InfectiousnessSD * P.InfectiousnessSD);
+			for (int Person = Block * PeoplePerBlock; Person < LastPerson; Person++) // loop over people
+			{
+				int AgeGroup = HOST_AGE_GROUP(Person);
+				// assign susceptibility of each host.
+				if (P.SusceptibilitySD == 0)
+					HostsState[Person].susc = (float)((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[AgeGroup]) : 1.0);
+				else
+					HostsState[Person].susc = (float)(((P.DoPartialImmunity) ? (1.0 - P.InitialImmunity[AgeGroup]) : 1.0) * gen_gamma_mt(SusceptibilityShape, SusceptibilityShape, Thread));
 
-			// assign infectiousness of each host.
-			if (P.InfectiousnessSD == 0)
-				Hosts[Person].infectiousness = (float)P.AgeInfectiousness[HOST_AGE_GROUP(Person)];
-			else
-				Hosts[Person].infectiousness = (float)(P.AgeInfectiousness[HOST_AGE_GROUP(Person)] * gen_gamma_mt(1 / (P.InfectiousnessSD * P.InfectiousnessSD), 1 / (P.InfectiousnessSD * P.InfectiousnessSD), Thread));
+				// assign infectiousness of each host.
+				if (P.InfectiousnessSD == 0)
+					HostsState[Person].infectiousness = (float)P.AgeInfectiousness[AgeGroup];
+				else
+					HostsState[Person].infectiousness = (float)(P.AgeInfectiousness[AgeGroup] * gen_gamma_mt(InfectiousnessShape, InfectiousnessShape, Thread));
 
-			// scale infectiousness by symptomatic or asymptomatic multiplier
-			if (ranf_mt(Thread) < P.ProportionSymptomatic[HOST_AGE_GROUP(Person)])	// if symptomatic, scale by Symptomatic Infectiousness (and make negative)...
-				Hosts[Person].infectiousness *= (float)(-P.SymptInfectiousness);
-			else					// ... or if asymptomatic
-				Hosts[Person].infectiousness *= (float)P.AsymptInfectiousness;
+				// scale infectiousness by symptomatic or asymptomatic multiplier
+				if (ranf_mt(Thread) < P.ProportionSymptomatic[AgeGroup])	// if symptomatic, scale by Symptomatic Infectiousness (and make negative)...
+					HostsState[Person].infectiousness *= (float)(-P.SymptInfectiousness);
+				else					// ... or if asymptomatic
+					HostsState[Person].infectiousness *= (float)P.AsymptInfectiousness;
 
-			// choose recovery_or_death_time from infectious period quantiles (inverse cumulative distribution function). Will reset this later for each person in Update::DoIncub.
-			int j = (int)floor((quantile = ranf_mt(Thread) * CDF_RES));
-			quantile -= ((double)j);
-			Hosts[Person].recovery_or_death_time = (unsigned short int) floor(0.5 - (P.InfectiousPeriod * log(quantile * P.infectious_icdf[j + 1] + (1.0 - quantile) * P.infectious_icdf[j]) / P.ModelTimeStep));
+				// choose recovery_or_death_time from infectious period quantiles (inverse cumulative distribution function). Will reset this later for each person in Update::DoIncub.
+				double quantile = ranf_mt(Thread) * CDF_RES;
+				int j = (int)floor(quantile);
+				quantile -= ((double)j);
+				HostsState[Person].recovery_or_death_time = (unsigned short int) floor(0.5 - (P.InfectiousPeriod * log(quantile * P.infectious_icdf[j + 1] + (1.0 - quantile) * P.infectious_icdf[j]) / P.ModelTimeStep));
+				int RecoveryTime = (int)HostsState[Person].recovery_or_death_time;
 
-			// ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** 
-			// ** // ** Household Infections
+				// ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** 
+				// ** // ** Household Infections
 
-			if (P.DoHouseholds) // code block effectively same as household infections in InfectSweep
-			{
-				// choose multiplier of infectiousness
-				if (P.NoInfectiousnessSDinHH)
-					Household_Infectiousness = ((Hosts[Person].infectiousness < 0) ? P.SymptInfectiousness : P.AsymptInfectiousness);
-				else
-					Household_Infectiousness = fabs(Hosts[Person].infectiousness);
-				// Care home residents less likely to infect via "household" contacts.
-				if (Hosts[Person].care_home_resident) Household_Infectiousness *= P.CareHomeResidentHouseholdScaling;
-				Household_Infectiousness *= P.ModelTimeStep * P.HouseholdTrans * P.HouseholdDenomLookup[Households[Hosts[Person].hh].nhr - 1];
-				ProbSurvive = 1.0;
-				for (int InfectiousDay = 0; InfectiousDay < (int)Hosts[Person].recovery_or_death_time; InfectiousDay++) // loop over days adding to force of infection, probability that other household members will be infected.
-				{ 
-					double ProbSurviveToday = 1.0 - Household_Infectiousness * P.infectiousness[InfectiousDay];
-					ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
+				if (P.DoHouseholds) // code block effectively same as household infections in InfectSweep
+				{
+					// choose multiplier of infectiousness
+					double Household_Infectiousness;
+					if (P.NoInfectiousnessSDinHH)
+						Household_Infectiousness = ((HostsState[Person].infectiousness < 0) ? P.SymptInfectiousness : P.AsymptInfectiousness);
+					else
+						Household_Infectiousness = fabs(HostsState[Person].infectiousness);
+					// Care home residents less likely to infect via "household" contacts.
+					if (Hosts[Person].care_home_resident) Household_Infectiousness *= P.CareHomeResidentHouseholdScaling;
+					Household_Infectiousness *= P.ModelTimeStep * P.HouseholdTrans * P.HouseholdDenomLookup[Households[Hosts[Person].hh].nhr - 1];
+					// probability that other household members escape infection over the infectious period.
+					double ProbSurvive = ProbEscapeInfection(Household_Infectiousness, 0, RecoveryTime);
+
+					// loop over people in households. If household member susceptible (they will be unless already infected in this code block), 
+					// and ensuring person doesn't infect themselves, add to household infections, taking account of their age and whether they're a care home resident, 
+					// Person.e. the usual stuff in CalcInfSusc.cpp, but without interventions.
+					// Everyone is susceptible at the end of setup. Between fitting iterations or scenarios HostsState holds the end of
+					// the last realisation instead, so isn't consulted, to give the same R0 as a fresh setup.
+					for (int HouseholdMember = Households[Hosts[Person].hh].FirstPerson; HouseholdMember < Households[Hosts[Person].hh].FirstPerson + Households[Hosts[Person].hh].nh; HouseholdMember++)
+						if (HouseholdMember != Person)
+							HH_Infections[Block] += (1 - ProbSurvive) * P.AgeSusceptibility[AgeGroup] * ((Hosts[HouseholdMember].care_home_resident) ? P.CareHomeResidentHouseholdScaling : 1.0);
+					HH_SAR_Denom[Block] += (double)(Households[Hosts[Person].hh].nhr - 1); // add to household denominator
 				}
 
-				// loop over people in households. If household member susceptible (they will be unless already infected in this code block), 
-				// and ensuring person doesn't infect themselves, add to household infections, taking account of their age and whether they're a care home resident, 
-				// Person.e. the usual stuff in CalcInfSusc.cpp, but without interventions
-				for (int HouseholdMember = Households[Hosts[Person].hh].FirstPerson; HouseholdMember < Households[Hosts[Person].hh].FirstPerson + Households[Hosts[Person].hh].nh; HouseholdMember++)
-					if ((Hosts[HouseholdMember].is_susceptible()) && (HouseholdMember != Person))
-						HH_Infections += (1 - ProbSurvive) * P.AgeSusceptibility[HOST_AGE_GROUP(Person)] * ((Hosts[HouseholdMember].care_home_resident) ? P.CareHomeResidentHouseholdScaling : 1.0);
-				HH_SAR_Denom += (double)(Households[Hosts[Person].hh].nhr - 1); // add to household denominator
-			}
-
-			// ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** 
-			// ** // ** Spatial Infections
-
-			// Sum over number of days until recovery time, in two parts: entire infection and after symptoms occur, as spatial contact rate differs between these periods.
-			LatentToSympDelay = (P.LatentToSymptDelay > Hosts[Person].recovery_or_death_time * P.ModelTimeStep) ? Hosts[Person].recovery_or_death_time * P.ModelTimeStep : P.LatentToSymptDelay;
-			// Care home residents less likely to infect via "spatial" contacts. This doesn't correct for non care home residents being less likely to infect care home residents,
-			// but since the latter are a small proportion of the population, this is a minor issue
-			Spatial_Infectiousness = fabs(Hosts[Person].infectiousness) * P.RelativeSpatialContact[HOST_AGE_GROUP(Person)] * ((Hosts[Person].care_home_resident) ? P.CareHomeResidentSpatialScaling : 1.0) * P.ModelTimeStep;
-			if (P.Got_WAIFW_Matrix_Spatial)
-			{
-				// if doing contact matrices, then need to scale spatial infections of this person (infector) to various infectees.
-				// Unlike InfectSweep though, here we don't explicitly consider infectees, so take an average over whole population, weighted by age distribution.
-				double AvContactRate_Infector = 0;
-				// sum over "infectee" age groups to scale infectiousness of this infector.
-				for (int InfecteeAge = 0; InfecteeAge < NUM_AGE_GROUPS; InfecteeAge++)
-					//AvContactRate_Infector += P.PropAgeGroup[0][InfecteeAge] * P.WAIFW_Matrix_SpatialOnly[InfecteeAge][HOST_AGE_GROUP(Person)]; // use index 0 for admin unit if doing whole country.
-					AvContactRate_Infector += P.PropAgeGroup[Mcells[Hosts[Person].mcell].adunit][InfecteeAge] * P.WAIFW_Matrix_SpatialOnly[InfecteeAge][HOST_AGE_GROUP(Person)];
-				// scale spatial infectiousness by weighted average.
-				Spatial_Infectiousness *= AvContactRate_Infector; 
-			}
-			int NumDaysInfectiousNotSymptomatic = (int)(LatentToSympDelay / P.ModelTimeStep);
-			int InfectiousDay;
-			/// Add to spatial infections from all days where latent but not symptomatic
-			for (InfectiousDay = 0; InfectiousDay < NumDaysInfectiousNotSymptomatic; InfectiousDay++) SpatialInfections += Spatial_Infectiousness * P.infectiousness[InfectiousDay];
-			Spatial_Infectiousness *= ((Hosts[Person].infectiousness < 0) ? P.SymptSpatialContactRate : 1);
-			/// Add to spatial infections when symptomatic (note do not initialize InfectiousDay again.)
-			for (; InfectiousDay < (int)Hosts[Person].recovery_or_death_time; InfectiousDay++) SpatialInfections += Spatial_Infectiousness * P.infectiousness[InfectiousDay];
+				// ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** 
+				// ** // ** Spatial Infections
+
+				// Sum over number of days until recovery time, in two parts: entire infection and after symptoms occur, as spatial contact rate differs between these periods.
+				double LatentToSympDelay = (P.LatentToSymptDelay > RecoveryTime * P.ModelTimeStep) ? RecoveryTime * P.ModelTimeStep : P.LatentToSymptDelay;
+				// Care home residents less likely to infect via "spatial" contacts. This doesn't correct for non care home residents being less likely to infect care home residents,
+				// but since the latter are a small proportion of the population, this is a minor issue
+				double Spatial_Infectiousness = fabs(HostsState[Person].infectiousness) * P.RelativeSpatialContact[AgeGroup] * ((Hosts[Person].care_home_resident) ? P.CareHomeResidentSpatialScaling : 1.0) * P.ModelTimeStep;
+				if (P.Got_WAIFW_Matrix_Spatial)
+					Spatial_Infectiousness *= AvContactRate_Infector[(size_t)Mcells[Hosts[Person].mcell].adunit * NUM_AGE_GROUPS + AgeGroup];
+				int NumDaysInfectiousNotSymptomatic = std::min((int)(LatentToSympDelay / P.ModelTimeStep), RecoveryTime);
+				/// Add to spatial infections from all days where latent but not symptomatic, then from days when symptomatic
+				SpatialInfections[Block] += Spatial_Infectiousness * (CumInfectiousness[NumDaysInfectiousNotSymptomatic]
+					+ ((HostsState[Person].infectiousness < 0) ? P.SymptSpatialContactRate : 1) * (CumInfectiousness[RecoveryTime] - CumInfectiousness[NumDaysInfectiousNotSymptomatic]));
+			}
 		}
-	}
+	std::copy(saved_Xcg1.begin(), saved_Xcg1.end(), Xcg1);
+	std::copy(saved_Xcg2.begin(), saved_Xcg2.end(), Xcg2);
 	// Divide total spatial infections by PopSize to get Spatial R0. 
-	double Spatial_R0 = SpatialInfections  / (double)P.PopSize;
+	PopulationR0.Spatial_R0 = SumInOrder(SpatialInfections) / (double)P.PopSize;
 	// Divide total household infections by summed household denominators to get household secondary attack rate
-	Files::xfprintf_stderr("Household SAR = %lg\n", HH_Infections / HH_SAR_Denom);
+	Files::xfprintf_stderr("Household SAR = %lg\n", SumInOrder(HH_Infections) / SumInOrder(HH_SAR_Denom));
 	// Divide total household infections by PopSize to get household R0
-	P.R0household = HH_Infections / ((double)P.PopSize);
-	Files::xfprintf_stderr("Household R0 = %lg\n", P.R0household);
+	PopulationR0.R0household = SumInOrder(HH_Infections) / ((double)P.PopSize);
+	Files::xfprintf_stderr("Household R0 = %lg\n", PopulationR0.R0household);
 
 	// ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** // ** 
 	// ** // ** Place Infections
+	double TotalPlaceInfections = 0; // total number of place infections (and all place types)
 	if (P.DoPlaces)
 		for (int PlaceType = 0; PlaceType < P.NumPlaceTypes; PlaceType++)
 			if (PlaceType != P.HotelPlaceType)
 			{
-				double PreviousTotalPlaceInfections = PlaceInfections;
-#pragma omp parallel for private(ProbSurvive,LatentToSympDelay,Place_Infectiousness,NumPeopleInPlaceGroup,ProbSurviveNonCareHome) schedule(static,1000) reduction(+:PlaceInfections) default(none) shared(P, Hosts, Places, PlaceType)
-				for (int Person = 0; Person < P.PopSize; Person++)
-				{
-					int PlaceNum = Hosts[Person].PlaceLinks[PlaceType];
-					if (PlaceNum >= 0) //// i.e. if person has a link to a particular Place of this PlaceType.
+#pragma omp parallel for schedule(static,1) default(none) shared(P, Hosts, HostsState, Places, PlaceType, NumBlocks, PeoplePerBlock, PlaceInfections)
+				for (int Thread = 0; Thread < P.NumThreads; Thread++) // loop over threads
+					for (int Block = Thread; Block < NumBlocks; Block += P.NumThreads) // loop over blocks of people
 					{
-						LatentToSympDelay = (P.LatentToSymptDelay > Hosts[Person].recovery_or_death_time * P.ModelTimeStep) ? Hosts[Person].recovery_or_death_time * P.ModelTimeStep : P.LatentToSymptDelay;
-						Place_Infectiousness = fabs(Hosts[Person].infectiousness) * P.ModelTimeStep * P.PlaceTypeTrans[PlaceType];
-						double PlaceInf_Scaled = Place_Infectiousness / P.PlaceTypeGroupSizeParam1[PlaceType];
-						ProbSurvive = 1.0;
-						int NumDaysInfectiousNotSymptomatic = (int)(LatentToSympDelay / P.ModelTimeStep);
-						int InfectiousDay; 
-						for (InfectiousDay = 0; InfectiousDay < NumDaysInfectiousNotSymptomatic; InfectiousDay++)
-						{
-							double ProbSurviveToday = 1.0 - PlaceInf_Scaled * P.infectiousness[InfectiousDay];
-							ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
-						}
-						NumPeopleInPlaceGroup = ((double)(_I64(Places[PlaceType][PlaceNum].group_size[Hosts[Person].PlaceGroupLinks[PlaceType]]) - 1));
-						PlaceInf_Scaled *= (((Hosts[Person].infectiousness < 0) && (!Hosts[Person].care_home_resident)) ? // if person symptomatic and not a care home resident
-							(P.SymptPlaceTypeContactRate[PlaceType] * (1 - P.SymptPlaceTypeWithdrawalProp[PlaceType])) : 1);
-						for (; InfectiousDay < (int)Hosts[Person].recovery_or_death_time; InfectiousDay++)
+						PlaceInfections[Block] = 0;
+						int LastPerson = std::min((Block + 1) * PeoplePerBlock, P.PopSize);
+						for (int Person = Block * PeoplePerBlock; Person < LastPerson; Person++)
 						{
-							double ProbSurviveToday = 1.0 - PlaceInf_Scaled * P.infectiousness[InfectiousDay];
-							ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
+							int PlaceNum = Hosts[Person].PlaceLinks[PlaceType];
+							if (PlaceNum < 0) continue; //// i.e. unless person has a link to a particular Place of this PlaceType.
+							int RecoveryTime = (int)HostsState[Person].recovery_or_death_time;
+							double LatentToSympDelay = (P.LatentToSymptDelay > RecoveryTime * P.ModelTimeStep) ? RecoveryTime * P.ModelTimeStep : P.LatentToSymptDelay;
+							double Place_Infectiousness = fabs(HostsState[Person].infectiousness) * P.ModelTimeStep * P.PlaceTypeTrans[PlaceType];
+							double SymptMultiplier = (((HostsState[Person].infectiousness < 0) && (!Hosts[Person].care_home_resident)) ? // if person symptomatic and not a care home resident
+								(P.SymptPlaceTypeContactRate[PlaceType] * (1 - P.SymptPlaceTypeWithdrawalProp[PlaceType])) : 1);
+							int NumDaysInfectiousNotSymptomatic = std::min((int)(LatentToSympDelay / P.ModelTimeStep), RecoveryTime);
+							double NumPeopleInPlaceGroup = ((double)(_I64(Places[PlaceType][PlaceNum].group_size[Hosts[Person].PlaceGroupLinks[PlaceType]]) - 1));
+
+							// within the person's group
+							double PlaceInf_Scaled = Place_Infectiousness / P.PlaceTypeGroupSizeParam1[PlaceType];
+							double ProbSurviveNonCareHome = ProbEscapeInfection(PlaceInf_Scaled, 0, NumDaysInfectiousNotSymptomatic)
+								* ProbEscapeInfection(PlaceInf_Scaled * SymptMultiplier, NumDaysInfectiousNotSymptomatic, RecoveryTime);
+
+							// between groups
+							PlaceInf_Scaled = P.PlaceTypePropBetweenGroupLinks[PlaceType] * Place_Infectiousness / ((double)Places[PlaceType][PlaceNum].n);
+							// use group structure to model multiple care homes with shared staff - in which case residents of one "group" don't mix with those in another, only staff do.
+							// calculation uses average proportion of care home "members" who are residents.
+							if (Hosts[Person].care_home_resident)
+								PlaceInf_Scaled *= (1.0 - P.CareHomePropResidents) + P.CareHomePropResidents * (P.CareHomeWorkerGroupScaling * (((double)Places[PlaceType][PlaceNum].n - 1) - NumPeopleInPlaceGroup) + NumPeopleInPlaceGroup) / ((double)Places[PlaceType][PlaceNum].n - 1);
+							double ProbSurvive = ProbEscapeInfection(PlaceInf_Scaled, 0, NumDaysInfectiousNotSymptomatic)
+								* ProbEscapeInfection(PlaceInf_Scaled * SymptMultiplier, NumDaysInfectiousNotSymptomatic, RecoveryTime);
+							// add to PlaceInfections. Weighted sum of PlaceGroup and non-place group infectins within that place.
+							PlaceInfections[Block] += (1 - ProbSurviveNonCareHome * ProbSurvive) * NumPeopleInPlaceGroup + (1 - ProbSurvive) * (((double)(_I64(Places[PlaceType][PlaceNum].n) - 1)) - NumPeopleInPlaceGroup);
 						}
-
-						ProbSurviveNonCareHome = ProbSurvive;
-						PlaceInf_Scaled = P.PlaceTypePropBetweenGroupLinks[PlaceType] * Place_Infectiousness / ((double)Places[PlaceType][PlaceNum].n);
-
-						// use group structure to model multiple care homes with shared staff - in which case residents of one "group" don't mix with those in another, only staff do.
-						// calculation uses average proportion of care home "members" who are residents.
-						if (Hosts[Person].care_home_resident)
-							PlaceInf_Scaled *= (1.0 - P.CareHomePropResidents) + P.CareHomePropResidents * (P.CareHomeWorkerGroupScaling * (((double)Places[PlaceType][PlaceNum].n - 1) - NumPeopleInPlaceGroup) + NumPeopleInPlaceGroup) / ((double)Places[PlaceType][PlaceNum].n - 1);
-						ProbSurvive = 1.0;
-						for (InfectiousDay = 0; InfectiousDay < NumDaysInfectiousNotSymptomatic; InfectiousDay++)
-						{
-							double ProbSurviveToday = 1.0 - PlaceInf_Scaled * P.infectiousness[InfectiousDay];
-							ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
-						}
-						PlaceInf_Scaled *= (((Hosts[Person].infectiousness < 0) && (!Hosts[Person].care_home_resident)) ? (P.SymptPlaceTypeContactRate[PlaceType] * (1 - P.SymptPlaceTypeWithdrawalProp[PlaceType])) : 1);
-						for (; InfectiousDay < (int)Hosts[Person].recovery_or_death_time; InfectiousDay++)
-						{
-							double ProbSurviveToday = 1.0 - PlaceInf_Scaled * P.infectiousness[InfectiousDay];
-							ProbSurvive *= ((ProbSurviveToday < 0) ? 0 : ProbSurviveToday);
-						}
-						// add to PlaceInfections. Weighted sum of PlaceGroup and non-place group infectins within that place.
-						PlaceInfections += (1 - ProbSurviveNonCareHome * ProbSurvive) * NumPeopleInPlaceGroup + (1 - ProbSurvive) * (((double)(_I64(Places[PlaceType][PlaceNum].n) - 1)) - NumPeopleInPlaceGroup);
 					}
-				}
-				Files::xfprintf_stderr("%lg  ", (PlaceInfections - PreviousTotalPlaceInfections) / ((double)P.PopSize));
+				double PlaceTypeInfections = SumInOrder(PlaceInfections);
+				TotalPlaceInfections += PlaceTypeInfections;
+				Files::xfprintf_stderr("%lg  ", PlaceTypeInfections / ((double)P.PopSize));
 			}
-	double recovery_time_days = 0;
-	double recovery_time_timesteps = 0;
-#pragma omp parallel for schedule(static,500) reduction(+:recovery_time_days,recovery_time_timesteps) default(none) shared(P, Hosts)
+	// Recovery times are whole time steps, so their total is exact.
+	int64_t recovery_time_total = 0;
+#pragma omp parallel for schedule(static,500) reduction(+:recovery_time_total) default(none) shared(P, HostsState)
 	for (int Person = 0; Person < P.PopSize; Person++)
 	{
-		recovery_time_days += Hosts[Person].recovery_or_death_time * P.ModelTimeStep;
-		recovery_time_timesteps += Hosts[Person].recovery_or_death_time;
-		Hosts[Person].recovery_or_death_time = 0; // reset everybody's recovery_or_death_time
+		recovery_time_total += HostsState[Person].recovery_or_death_time;
+		HostsState[Person].recovery_or_death_time = 0; // reset everybody's recovery_or_death_time
 	}
 
 	// Divide total number of place infections by PopSize to get "place" R0. 
-	P.R0places = PlaceInfections / ((double)P.PopSize);
-	recovery_time_days /= ((double)P.PopSize);
-	recovery_time_timesteps /= ((double)P.PopSize);
-	Files::xfprintf_stderr("\nR0 for places = %lg\n", P.R0places);
+	PopulationR0.R0places = TotalPlaceInfections / ((double)P.PopSize);
+	PopulationR0.RecoveryTimeSteps = ((double)recovery_time_total) / ((double)P.PopSize);
+	Files::xfprintf_stderr("\nR0 for places = %lg\n", PopulationR0.R0places);
+}
+
+void InitTransmissionCoeffs(void)
+{
+	// Drawn even when the pass over the population isn't repeated, so that later random numbers don't depend on whether it was.
+	uint64_t seed = stream_seed();
+	std::vector<double> Inputs = PopulationR0Inputs();
+	if (Inputs != PopulationR0.Inputs)
+	{
+		InitPopulationR0(seed);
+		PopulationR0.Inputs.swap(Inputs);
+	}
+	else
+		Files::xfprintf_stderr("Household R0 = %lg, R0 for places = %lg (parameters unchanged)\n", PopulationR0.R0household, PopulationR0.R0places);
+	P.R0household = PopulationR0.R0household;
+	P.R0places = PopulationR0.R0places;
+	double Spatial_R0 = PopulationR0.Spatial_R0;
+	double recovery_time_timesteps = PopulationR0.RecoveryTimeSteps;
+	double recovery_time_days = recovery_time_timesteps * P.ModelTimeStep;
 	if (!P.FixLocalBeta)
 	{
 		if (P.DoSI)
@@ -847,16 +946,18 @@ void InitTransmissionCoeffs(void)
 
 void SetupPopulation(std::string const& density_file, std::string const& out_density_file, std::string const& school_file, std::string const& reg_demog_file)
 {
-	int j, l, m, i2, j2, last_i, mr, ad, country;
-	unsigned int rn, rn2;
+	int j, l, m, i2, j2, last_i, mr, country;
+	uint64_t rn, rn2;
 	double t, s, x, y, xh, yh, maxd, CumAgeDist[NUM_AGE_GROUPS + 1];
 	char buf[4096], *col;
 	const char delimiters[] = " \t,";
-	FILE* dat = NULL, *dat2;
+	FILE* dat = NULL;
 	BinFile rec;
+	bool mcell_centres = false;
 	double *mcell_dens;
 	int *mcell_adunits, *mcell_num;
 
+	SetupProgress.begin("microcells");
 	// allocate memory
 	Cells			= (Cell*)		Memory::xcalloc(P.NumCells		, sizeof(Cell));
 	Mcells			= (Microcell*)	Memory::xcalloc(P.NumMicrocells	, sizeof(Microcell));
@@ -880,7 +981,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 	{
 		if (!P.DoAdunitBoundaries) P.NumAdunits = 0;
 		//		dat2 = Files::xfopen("EnvTest.txt","w");
-		Files::xfprintf_stderr("Density file contains %i datapoints.\n", (int)P.BinFileLen);
+		Files::xfprintf_stderr("Density file contains %" PRIu64 " datapoints.\n", P.BinFileLen);
 		for (rn = rn2 = mr = 0; rn < P.BinFileLen; rn++)
 		{
 			int k;
@@ -960,7 +1061,8 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 					if (mcell_adunits[l] >= 0) P.BinFileLen++;
 				BinFileBuf = (void*)Memory::xcalloc(P.BinFileLen, sizeof(BinFile));
 				BF = (BinFile*)BinFileBuf;
-				Files::xfprintf_stderr("Binary density file should contain %i microcells.\n", (int)P.BinFileLen);
+				mcell_centres = true;
+				Files::xfprintf_stderr("Binary density file should contain %" PRIu64 " microcells.\n", P.BinFileLen);
 				rn = 0;
 				for (l = 0; l < P.NumMicrocells; l++)
 					if (mcell_adunits[l] >= 0)
@@ -977,13 +1079,15 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 
 		if (!out_density_file.empty())
 		{
-			dat2 = Files::xfopen(out_density_file.c_str(), "wb");
-			rn = 0xf0f0f0f0;
-			Files::fwrite_big((void*)& rn, sizeof(unsigned int), 1, dat2);
-			Files::xfprintf_stderr("Saving population density file with NC=%i...\n", (int)P.BinFileLen);
-			Files::fwrite_big((void*) & (P.BinFileLen), sizeof(unsigned int), 1, dat2);
-			Files::fwrite_big(BinFileBuf, sizeof(BinFile), (size_t)P.BinFileLen, dat2);
-			Files::xfclose(dat2);
+			Files::xfprintf_stderr("Saving population density file with NC=%" PRIu64 "...\n", P.BinFileLen);
+			if (P.OutputDensityFileVersion == 2)
+			{
+				DensityFile::sort_morton(BF, P.BinFileLen, P.SpatialBoundingBox.bottom_left().x, P.SpatialBoundingBox.bottom_left().y,
+					P.in_microcells_.width, P.in_microcells_.height);
+				DensityFile::write_binary_v2(out_density_file, BF, P.BinFileLen, mcell_centres, DensityFile::V2_MORTON_ORDER);
+			}
+			else
+				DensityFile::write_binary(out_density_file, BF, P.BinFileLen);
 		}
 		Memory::xfree(BinFileBuf);
 		Files::xfprintf_stderr("Population files read.\n");
@@ -1133,26 +1237,55 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 		P.PopSize = (int)t;
 		Files::xfprintf_stderr("Population size reset from %i to %i\n", i, P.PopSize);
 	}
-	t = 1.0;
-	for (int i = m = 0; i < (P.NumMicrocells - 1); i++)
+	// People are shared among microcells in proportion to density by a multinomial draw, made
+	// as conditional binomials. Microcells are taken in fixed blocks: the blocks' totals are
+	// drawn in turn, then the microcells of each block in parallel, from the block's own
+	// random number stream, so the population doesn't depend on the number of threads.
+	int mcells_per_block = 1024;
+	int num_mcell_blocks = (P.NumMicrocells + mcells_per_block - 1) / mcells_per_block;
+	std::vector<double> block_dens(num_mcell_blocks);
+	std::vector<int> block_pop(num_mcell_blocks);
+#pragma omp parallel for schedule(static) default(none) shared(P, mcell_dens, block_dens, num_mcell_blocks, mcells_per_block)
+	for (int b = 0; b < num_mcell_blocks; b++)
+		for (int i = b * mcells_per_block; i < std::min((b + 1) * mcells_per_block, P.NumMicrocells); i++)
+			block_dens[b] += mcell_dens[i];
+	t = 0;
+	for (int b = 0; b < num_mcell_blocks; b++) t += block_dens[b];
+	for (int b = m = 0; b < num_mcell_blocks - 1; b++)
 	{
-		s = mcell_dens[i] / maxd / t;
-		if (s > 1.0) s = 1.0;
-		m += (Mcells[i].n = (int)ignbin_mt((int32_t)(P.PopSize - m), s, 0));
-		t -= mcell_dens[i] / maxd;
+		s = (block_dens[b] <= 0) ? 0.0 : (block_dens[b] >= t) ? 1.0 : block_dens[b] / t;
+		m += (block_pop[b] = (int)ignbin_mt((int32_t)(P.PopSize - m), s, 0));
+		t -= block_dens[b];
+	}
+	block_pop[num_mcell_blocks - 1] = P.PopSize - m;
+	uint64_t mcell_seed = stream_seed();
+	std::vector<int32_t> saved_Xcg1(Xcg1, Xcg1 + MAX_NUM_THREADS * CACHE_LINE_SIZE), saved_Xcg2(Xcg2, Xcg2 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+#pragma omp parallel for schedule(static,1) default(none) \
+		shared(P, Mcells, mcell_dens, block_dens, block_pop, num_mcell_blocks, mcells_per_block, mcell_seed)
+	for (int tn = 0; tn < P.NumThreads; tn++)
+		for (int b = tn; b < num_mcell_blocks; b += P.NumThreads)
+		{
+			stream_seed_thread(stream_init(mcell_seed, b), tn);
+			int last = std::min((b + 1) * mcells_per_block, P.NumMicrocells) - 1;
+			int left = block_pop[b];
+			double w = block_dens[b];
+			for (int i = b * mcells_per_block; i < last; i++)
+			{
+				double p = (mcell_dens[i] <= 0) ? 0.0 : (mcell_dens[i] >= w) ? 1.0 : mcell_dens[i] / w;
+				left -= (Mcells[i].n = (int)ignbin_mt((int32_t)left, p, tn));
+				w -= mcell_dens[i];
+			}
+			Mcells[last].n = left;
+		}
+	std::copy(saved_Xcg1.begin(), saved_Xcg1.end(), Xcg1);
+	std::copy(saved_Xcg2.begin(), saved_Xcg2.end(), Xcg2);
+	for (int i = 0; i < P.NumMicrocells; i++)
 		if (Mcells[i].n > 0)
 		{
 			P.NumPopulatedMicrocells++;
 			if (mcell_adunits[i] < 0) ERR_CRITICAL_FMT("Cell %i has adunits < 0 (indexing AdUnits)\n", i);
 			AdUnits[mcell_adunits[i]].n += Mcells[i].n;
 		}
-	}
-	Mcells[P.NumMicrocells - 1].n = P.PopSize - m;
-	if (Mcells[P.NumMicrocells - 1].n > 0)
-	{
-		P.NumPopulatedMicrocells++;
-		AdUnits[mcell_adunits[P.NumMicrocells - 1]].n += Mcells[P.NumMicrocells - 1].n;
-	}
 
 	Memory::xfree(mcell_dens);
 	Memory::xfree(mcell_num);
@@ -1161,28 +1294,52 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 
 	McellLookup = (Microcell **)Memory::xcalloc(P.NumPopulatedMicrocells, sizeof(Microcell*));
 	State.CellMemberArray = (int*)Memory::xcalloc(P.PopSize, sizeof(int));
-	P.NumPopulatedCells = 0;
-	for (int i = i2 = j2 = 0; i < P.NumCells; i++)
+	// People are numbered by cell, and within a cell by microcell, so each cell's and
+	// microcell's members are a range of CellMemberArray found by prefix sums.
+	std::vector<int> cell_first_person(P.NumCells + 1), cell_first_mcell(P.NumCells + 1);
+#pragma omp parallel for schedule(static) default(none) shared(P, Cells, Mcells, cell_first_person, cell_first_mcell)
+	for (int i = 0; i < P.NumCells; i++)
 	{
 		Cells[i].n = 0;
 		int k = (i / P.nch) * P.NMCL * P.total_microcells_high_ + (i % P.nch) * P.NMCL;
-		Cells[i].members = State.CellMemberArray + j2;
-		for (l = 0; l < P.NMCL; l++)
-			for (m = 0; m < P.NMCL; m++)
+		for (int l2 = 0; l2 < P.NMCL; l2++)
+			for (int m2 = 0; m2 < P.NMCL; m2++)
 			{
-				j = k + m + l * P.total_microcells_high_;
-				if (Mcells[j].n > 0)
+				int mc = k + m2 + l2 * P.total_microcells_high_;
+				if (Mcells[mc].n > 0)
 				{
-					Mcells[j].members = State.CellMemberArray + j2;
-					//Mcells[j].members=(int *)Memory::xcalloc(Mcells[j].n,sizeof(int)); //replaced line above with this to ensure members don't get mixed across microcells
-					McellLookup[i2++] = Mcells + j;
-					Cells[i].n += Mcells[j].n;
-					j2 += Mcells[j].n;
+					Cells[i].n += Mcells[mc].n;
+					cell_first_mcell[i + 1]++;
 				}
 			}
+		cell_first_person[i + 1] = Cells[i].n;
+	}
+	P.NumPopulatedCells = 0;
+	for (int i = 0; i < P.NumCells; i++)
+	{
 		if (Cells[i].n > 0) P.NumPopulatedCells++;
+		cell_first_person[i + 1] += cell_first_person[i];
+		cell_first_mcell[i + 1] += cell_first_mcell[i];
 	}
-	Files::xfprintf_stderr("Number of hosts assigned = %i\n", j2);
+#pragma omp parallel for schedule(static) default(none) shared(P, Cells, Mcells, McellLookup, State, cell_first_person, cell_first_mcell)
+	for (int i = 0; i < P.NumCells; i++)
+	{
+		int k = (i / P.nch) * P.NMCL * P.total_microcells_high_ + (i % P.nch) * P.NMCL;
+		int person = cell_first_person[i], pm = cell_first_mcell[i];
+		Cells[i].members = State.CellMemberArray + person;
+		for (int l2 = 0; l2 < P.NMCL; l2++)
+			for (int m2 = 0; m2 < P.NMCL; m2++)
+			{
+				int mc = k + m2 + l2 * P.total_microcells_high_;
+				if (Mcells[mc].n > 0)
+				{
+					Mcells[mc].members = State.CellMemberArray + person;
+					McellLookup[pm++] = Mcells + mc;
+					person += Mcells[mc].n;
+				}
+			}
+	}
+	Files::xfprintf_stderr("Number of hosts assigned = %i\n", cell_first_person[P.NumCells]);
 	if (!P.DoAdUnits) P.AdunitLevel1Lookup[0] = 0;
 	Files::xfprintf_stderr("Number of cells with non-zero population = %i\n", P.NumPopulatedCells);
 	Files::xfprintf_stderr("Number of microcells with non-zero population = %i\n", P.NumPopulatedMicrocells);
@@ -1202,8 +1359,9 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 	i2 = 0;
 
 	Hosts = (Person*)Memory::xcalloc(P.PopSize, sizeof(Person));
+	HostsState = std::vector<PersonState>(P.PopSize, PersonState());
 	HostsQuarantine = std::vector<PersonQuarantine>(P.PopSize, PersonQuarantine());
-	Files::xfprintf_stderr("sizeof(Person)=%i\n", (int) sizeof(Person));
+	Files::xfprintf_stderr("sizeof(Person)=%i sizeof(PersonState)=%i\n", (int) sizeof(Person), (int) sizeof(PersonState));
 	for (int i = 0; i < P.NumPopulatedCells; i++)
 	{
 		Cell *c = CellLookup[i];
@@ -1214,73 +1372,116 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 			c->cum_trans = (float*)Memory::xcalloc(P.NumPopulatedCells, sizeof(float));
 		}
 	}
-	for (int i = 0; i < P.NumCells; i++)
-	{
-		Cells[i].cumTC = 0;
-		for (j = 0; j < Cells[i].n; j++) Cells[i].members[j] = -1;
-	}
 	Files::xfprintf_stderr("Cells assigned\n");
+	SetupProgress.end((double)P.PopSize);
+	SetupProgress.begin("households");
 	for (int i = 0; i <= MAX_HOUSEHOLD_SIZE; i++) denom_household[i] = 0;
-	P.NumHouseholds = 0;
-	int numberOfPeople = 0;
-	int MCell = 0;
-	for (int PopMCellIndex = 0; PopMCellIndex < P.NumPopulatedMicrocells; PopMCellIndex++)
-	{
-		MCell = (int)(McellLookup[PopMCellIndex] - Mcells);
-		l = ((MCell / P.total_microcells_high_) / P.NMCL) * P.nch + ((MCell % P.total_microcells_high_) / P.NMCL);
-		ad = (!reg_demog_file.empty() && (P.DoAdUnits)) ? Mcells[MCell].adunit : 0;
-		for (int k = 0; k < Mcells[MCell].n;)
+
+	// Each microcell draws its household sizes from its own stream. Sizes are recorded in the
+	// listpos of each member (used temporarily) and households counted, then numbered in turn.
+	uint64_t household_size_seed = stream_seed();
+	std::vector<int> mcell_first_household(P.NumPopulatedMicrocells + 1);
+#pragma omp parallel for schedule(static,1) default(none) \
+		shared(P, Hosts, HostsState, Mcells, McellLookup, State, reg_demog_file, household_size_seed, mcell_first_household)
+	for (int tn = 0; tn < P.NumThreads; tn++)
+		for (int pm = tn; pm < P.NumPopulatedMicrocells; pm += P.NumThreads)
 		{
-			m = 1;
-			if (P.DoHouseholds)
-			{
-				s = ranf_mt(0);
-				while ((s > P.HouseholdSizeDistrib[ad][m - 1]) && (k + m < Mcells[MCell].n) && (m < MAX_HOUSEHOLD_SIZE)) m++;
-			}
-			denom_household[m]++;
-			for (i2 = 0; i2 < m; i2++)
+			int mc = (int)(McellLookup[pm] - Mcells);
+			int cell = ((mc / P.total_microcells_high_) / P.NMCL) * P.nch + ((mc % P.total_microcells_high_) / P.NMCL);
+			int ad = (!reg_demog_file.empty() && (P.DoAdUnits)) ? Mcells[mc].adunit : 0;
+			int first = (int)(Mcells[mc].members - State.CellMemberArray);
+			uint64_t stream = stream_init(household_size_seed, (uint64_t)mc);
+			for (int k = 0; k < Mcells[mc].n;)
 			{
-				//				Files::xfprintf_stderr("%i ",i+i2);
-				Hosts[numberOfPeople + i2].listpos = m; //used temporarily to store household size
-				Mcells[MCell].members[k + i2] = numberOfPeople + i2;
-				Cells[l].susceptible[Cells[l].cumTC] = numberOfPeople + i2;
-				Cells[l].members[Cells[l].cumTC++] = numberOfPeople + i2;
-				Hosts[numberOfPeople + i2].pcell = l;
-				Hosts[numberOfPeople + i2].mcell = MCell;
-				Hosts[numberOfPeople + i2].hh = P.NumHouseholds;
+				int size = 1;
+				if (P.DoHouseholds)
+				{
+					double r = ranf_stream(&stream);
+					while ((r > P.HouseholdSizeDistrib[ad][size - 1]) && (k + size < Mcells[mc].n) && (size < MAX_HOUSEHOLD_SIZE)) size++;
+				}
+				for (int i = first + k; i < first + k + size; i++)
+				{
+					HostsState[i].listpos = size;
+					Hosts[i].pcell = cell;
+					Hosts[i].mcell = mc;
+					Mcells[mc].members[i - first] = i;
+				}
+				mcell_first_household[pm + 1]++;
+				k += size;
 			}
-			P.NumHouseholds++;
-			numberOfPeople += m;
-			k += m;
 		}
+	for (int pm = 0; pm < P.NumPopulatedMicrocells; pm++)
+		mcell_first_household[pm + 1] += mcell_first_household[pm];
+	P.NumHouseholds = mcell_first_household[P.NumPopulatedMicrocells];
+#pragma omp parallel for schedule(static,1) default(none) shared(P, Hosts, HostsState, Mcells, McellLookup, State, mcell_first_household)
+	for (int tn = 0; tn < P.NumThreads; tn++)
+		for (int pm = tn; pm < P.NumPopulatedMicrocells; pm += P.NumThreads)
+		{
+			Microcell const& mcell = *McellLookup[pm];
+			int first = (int)(mcell.members - State.CellMemberArray);
+			for (int i = first, hh = mcell_first_household[pm]; i < first + mcell.n; i += HostsState[i].listpos, hh++)
+				for (int i2 = i; i2 < i + HostsState[i].listpos; i2++)
+					Hosts[i2].hh = hh;
+		}
+#pragma omp parallel for schedule(static) default(none) shared(P, CellLookup, State)
+	for (int i = 0; i < P.NumPopulatedCells; i++)
+	{
+		Cell* c = CellLookup[i];
+		int first = (int)(c->members - State.CellMemberArray);
+		for (int j = 0; j < c->n; j++) c->members[j] = c->susceptible[j] = first + j;
+		c->cumTC = c->n;
 	}
 	Households = (Household*)Memory::xcalloc(P.NumHouseholds, sizeof(Household));
 	for (j = 0; j < NUM_AGE_GROUPS; j++) AgeDist[j] = AgeDist2[j] = 0;
-	if (P.DoHouseholds) Files::xfprintf_stderr("Household sizes assigned to %i people\n", numberOfPeople);
-
-	FILE* stderr_shared = stderr;
-#pragma omp parallel for private(j2,j,x,y,xh,yh,i2,m) schedule(static,1) default(none) \
-		shared(P, Households, Hosts, Mcells, McellLookup, AdUnits, reg_demog_file, stderr_shared)
+	if (P.DoHouseholds) Files::xfprintf_stderr("Household sizes assigned to %i people\n", P.PopSize);
+	SetupProgress.end((double)P.PopSize);
+	SetupProgress.begin("ages");
+
+	// Households are grouped by size, so that each thread handles a run of similar households,
+	// and each draws its location and ages from its own random number stream, so they don't
+	// depend on the number of threads. The threads' generators are put back afterwards.
+	std::vector<HouseholdAgeSampler> age_samplers;
+	for (int i = 0; i < (((P.DoAdUnits) && !reg_demog_file.empty()) ? P.NumAdunits : 1); i++)
+		age_samplers.emplace_back(P, State.InvAgeDist[i]);
+	std::vector<int> household_order(P.NumHouseholds), size_start(MAX_HOUSEHOLD_SIZE + 2);
+	for (int i = 0; i < P.PopSize; i += HostsState[i].listpos)
+		size_start[HostsState[i].listpos + 1]++;
+	for (m = 1; m <= MAX_HOUSEHOLD_SIZE; m++)
+	{
+		denom_household[m] = size_start[m + 1];
+		size_start[m + 1] += size_start[m];
+	}
+	for (int i = 0; i < P.PopSize; i += HostsState[i].listpos)
+		household_order[size_start[HostsState[i].listpos]++] = i;
+	uint64_t household_seed = stream_seed();
+	saved_Xcg1.assign(Xcg1, Xcg1 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+	saved_Xcg2.assign(Xcg2, Xcg2 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+	int households_per_block = 1024;
+#pragma omp parallel for private(j,x,y,xh,yh,i2,m) schedule(static,1) default(none) \
+		shared(P, Households, Hosts, HostsState, Mcells, reg_demog_file, age_samplers, household_order, household_seed, households_per_block)
 	for (int tn = 0; tn < P.NumThreads; tn++)
-		for (j2 = tn; j2 < P.NumPopulatedMicrocells; j2 += P.NumThreads)
-		{
-			j = (int)(McellLookup[j2] - Mcells);
-			x = (double)(j / P.total_microcells_high_);
-			y = (double)(j % P.total_microcells_high_);
-			int i = Mcells[j].members[0];
-			if (j % 100 == 0)
-				Files::xfprintf(stderr_shared, "%i=%i (%i %i)            \r", j, Mcells[j].n, Mcells[j].adunit, (AdUnits[Mcells[j].adunit].id % P.AdunitLevel1Mask) / P.AdunitLevel1Divisor);
-			for (int k = 0; k < Mcells[j].n;)
+		for (int block = tn * households_per_block; block < P.NumHouseholds; block += P.NumThreads * households_per_block)
+			for (int h = block; h < std::min(block + households_per_block, P.NumHouseholds); h++)
 			{
-				m = Hosts[i].listpos;
+				int i = household_order[h];
+				int ages[MAX_HOUSEHOLD_SIZE + 2];
+				m = HostsState[i].listpos;
+				j = Hosts[i].mcell;
+				x = (double)(j / P.total_microcells_high_);
+				y = (double)(j % P.total_microcells_high_);
+				stream_seed_thread(stream_init(household_seed, Hosts[i].hh), tn);
 				xh = P.in_microcells_.width * (ranf_mt(tn) + x);
 				yh = P.in_microcells_.height * (ranf_mt(tn) + y);
-				AssignHouseholdAges(m, i, tn, !reg_demog_file.empty());
-				for (i2 = 0; i2 < m; i2++) Hosts[i + i2].listpos = 0;
+				age_samplers[(!reg_demog_file.empty() && (P.DoAdUnits)) ? Mcells[j].adunit : 0].sample(m, tn, ages);
+				for (i2 = 0; i2 < m; i2++)
+				{
+					Hosts[i + i2].age = (unsigned char)ages[i2];
+					HostsState[i + i2].listpos = 0;
+				}
 				if (P.DoHouseholds)
 				{
 					for (i2 = 0; i2 < m; i2++) {
-						Hosts[i + i2].set_susceptible(); //added this so that infection status is set to zero and household r0 is correctly calculated
+						HostsState[i + i2].set_susceptible(); //added this so that infection status is set to zero and household r0 is correctly calculated
 					}
 				}
 				Households[Hosts[i].hh].FirstPerson = i;
@@ -1288,10 +1489,9 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 				Households[Hosts[i].hh].nhr = m;
 				Households[Hosts[i].hh].loc.x = (float)xh;
 				Households[Hosts[i].hh].loc.y = (float)yh;
-				i += m;
-				k += m;
 			}
-		}
+	std::copy(saved_Xcg1.begin(), saved_Xcg1.end(), Xcg1);
+	std::copy(saved_Xcg2.begin(), saved_Xcg2.end(), Xcg2);
 	if (P.DoCorrectAgeDist)
 	{
 		double** AgeDistAd, ** AgeDistCorrF, ** AgeDistCorrB;
@@ -1386,6 +1586,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 		AgeDist[HOST_AGE_GROUP(i)]++;
 	}
 	Files::xfprintf_stderr("Ages/households assigned\n");
+	SetupProgress.end((double)P.PopSize);
 
 	if (!P.DoRandomInitialInfectionLoc)
 	{
@@ -1416,6 +1617,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 		if (Mcells[j].n < P.NumInitialInfections[0])
 			ERR_CRITICAL("Too few people in seed microcell to start epidemic with required number of initial infectionz.\n");
 	}
+	SetupProgress.begin("place locations");
 	Files::xfprintf_stderr("Checking cells...\n");
 	maxd = ((double)P.PopSize);
 	last_i = 0;
@@ -1465,7 +1667,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 			Files::xfscanf(dat, 2, "%i %i", &m, &(P.PlaceTypeMaxAgeRead[j]));
 			Places[j] = (Place*)Memory::xcalloc(m, sizeof(Place));
 			for (int i = 0; i < m; i++)
-				Places[j][i].AvailByAge = (unsigned short int*)Memory::xcalloc(P.PlaceTypeMaxAgeRead[j], sizeof(unsigned short int));
+				Places[j][i].AvailByAge = SetupArena.alloc<unsigned short int>(P.PlaceTypeMaxAgeRead[j]);
 			P.Nplace[j] = 0;
 			for (int i = 0; i < P.NumMicrocells; i++) Mcells[i].NumPlacesByType[j] = 0;
 		}
@@ -1496,7 +1698,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 			for (j = 0; j < P.nsp; j++)
 				if (Mcells[i].NumPlacesByType[j] > 0)
 				{
-					Mcells[i].places[j] = (int*)Memory::xcalloc(Mcells[i].NumPlacesByType[j], sizeof(int));
+					Mcells[i].places[j] = SetupArena.alloc<int>(Mcells[i].NumPlacesByType[j]);
 					Mcells[i].NumPlacesByType[j] = 0;
 				}
 		for (j = 0; j < P.nsp; j++)
@@ -1520,8 +1722,9 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 	{
 		Files::xfprintf_stderr("Configuring places...\n");
 
+		FILE* stderr_shared = stderr;
 #pragma omp parallel for private(j2,j,t,m,s,x,y,xh,yh) schedule(static,1) default(none) \
-			shared(P, Hosts, Places, PropPlaces, Mcells, maxd, last_i, mcell_country, stderr_shared)
+			shared(P, Hosts, Places, PropPlaces, Mcells, maxd, last_i, mcell_country, stderr_shared, SetupArena)
 		for (int tn = 0; tn < P.NumThreads; tn++)
 			for (j2 = P.nsp + tn; j2 < P.NumPlaceTypes; j2 += P.NumThreads)
 			{
@@ -1545,7 +1748,7 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 					t -= ((double)Mcells[i].n) / maxd;
 					if (Mcells[i].NumPlacesByType[j2] > 0)
 					{
-						Mcells[i].places[j2] = (int*)Memory::xcalloc(Mcells[i].NumPlacesByType[j2], sizeof(int));
+						Mcells[i].places[j2] = SetupArena.alloc<int>(Mcells[i].NumPlacesByType[j2]);
 						x = (double)(i / P.total_microcells_high_);
 						y = (double)(i % P.total_microcells_high_);
 						for (j = 0; j < Mcells[i].NumPlacesByType[j2]; j++)
@@ -1637,71 +1840,71 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 	}
 	Files::xfprintf_stderr("Allocated cell and host memory\n");
 	Files::xfprintf_stderr("Assigned hosts to cells\n");
+	SetupProgress.end();
 
 }
 
 void SetupAirports(void)
 {
 	int k, l, m;
-	double x, y, t, tmin;
+	double t, tmin;
 	IndexList* base, *cur;
 
 	Files::xfprintf_stderr("Assigning airports to microcells\n");
 	// Convince static analysers that values are set correctly:
 	if (!(P.DoAirports && P.HotelPlaceType < P.NumPlaceTypes)) ERR_CRITICAL("DoAirports || HotelPlaceType not set\n");
 
+	// Only the kernel lookup is needed here; the cells keep the movement kernel's max_trans.
 	P.Kernel = P.AirportKernel;
 	P.KernelLookup.init(1.0, P.Kernel);
-	CovidSim::TBD1::KernelLookup::init(P.KernelLookup, CellLookup, P.NumPopulatedCells);
 	Airports[0].DestMcells = (IndexList*)Memory::xcalloc(_I64(P.NumPopulatedMicrocells) * NNA, sizeof(IndexList));
 	base = (IndexList*)Memory::xcalloc(_I64(P.NumPopulatedMicrocells) * NNA, sizeof(IndexList));
 	for (int i = 0; i < P.Nairports; i++) Airports[i].num_mcell = 0;
-	cur = base;
-	for (int i = 0; i < P.NumMicrocells; i++)
-		if (Mcells[i].n > 0)
+	for (int i = 0; i < P.NumPopulatedMicrocells; i++)
+		McellLookup[i]->AirportList = base + _I64(i) * NNA;
+
+	// Each microcell's NNA airports with the most kernel weighted traffic are found with a
+	// spatial index over the airports with traffic. Kernels don't increase with distance, so
+	// the search stops once airports further away couldn't score highly enough even with the
+	// most traffic. Ties go to the lower numbered airport; the list is in descending order.
+	std::vector<int> airport_ids;
+	std::vector<double> airport_x, airport_y;
+	double max_traffic = 0;
+	for (int j = 0; j < P.Nairports; j++)
+		if (Airports[j].total_traffic > 0)
 		{
-			Mcells[i].AirportList = cur;
-			cur += NNA;
+			airport_ids.push_back(j);
+			airport_x.push_back(Airports[j].loc.x);
+			airport_y.push_back(Airports[j].loc.y);
+			max_traffic = std::max(max_traffic, (double)Airports[j].total_traffic);
 		}
-
-	FILE* stderr_shared = stderr;
-#pragma omp parallel for private(k,l,x,y,t,tmin) schedule(static,10000) default(none) \
-		shared(P, Airports, Mcells, stderr_shared)
-	for (int i = 0; i < P.NumMicrocells; i++)
-		if (Mcells[i].n > 0)
+	SpatialGrid airport_grid(airport_x, airport_y);
+#pragma omp parallel for schedule(static,1) default(none) \
+		shared(P, Airports, Mcells, McellLookup, airport_ids, airport_grid, max_traffic)
+	for (int tn = 0; tn < P.NumThreads; tn++)
+	{
+		std::vector<SpatialGrid::Scored> found;
+		for (int pm = tn; pm < P.NumPopulatedMicrocells; pm += P.NumThreads)
 		{
-			if (i % 10000 == 0) Files::xfprintf(stderr_shared, "\n%i           ", i);
-			x = (((double)(i / P.total_microcells_high_)) + 0.5) * P.in_microcells_.width;
-			y = (((double)(i % P.total_microcells_high_)) + 0.5) * P.in_microcells_.height;
-			k = l = 0;
-			tmin = 1e20;
-			for (int j = 0; j < P.Nairports; j++)
-				if (Airports[j].total_traffic > 0)
-				{
-					t = P.KernelLookup.num(dist2_raw(x, y, Airports[j].loc.x, Airports[j].loc.y)) * Airports[j].total_traffic;
-					if (k < NNA)
-					{
-						Mcells[i].AirportList[k].id = j;
-						Mcells[i].AirportList[k].prob = (float)t;
-						if (t < tmin) { tmin = t; l = k; }
-						k++;
-					}
-					else if (t > tmin)
-					{
-						Mcells[i].AirportList[l].id = j;
-						Mcells[i].AirportList[l].prob = (float)t;
-						tmin = 1e20;
-						for (k = 0; k < NNA; k++)
-							if (Mcells[i].AirportList[k].prob < tmin)
-							{
-								tmin = Mcells[i].AirportList[k].prob;
-								l = k;
-							}
-					}
-				}
+			int i = (int)(McellLookup[pm] - Mcells);
+			double x = (((double)(i / P.total_microcells_high_)) + 0.5) * P.in_microcells_.width;
+			double y = (((double)(i % P.total_microcells_high_)) + 0.5) * P.in_microcells_.height;
+			airport_grid.best(x, y, NNA,
+				[x, y, &airport_ids](int a) { Airport const& ap = Airports[airport_ids[a]]; return P.KernelLookup.num(dist2_raw(x, y, ap.loc.x, ap.loc.y)) * ap.total_traffic; },
+				[max_traffic](double separation) { return P.KernelLookup.num(dist2_raw_min(separation)) * max_traffic; },
+				found);
+			for (int j = 0; j < (int)found.size(); j++)
+			{
+				Mcells[i].AirportList[j].id = airport_ids[found[j].index];
+				Mcells[i].AirportList[j].prob = (float)found[j].score;
+			}
 			for (int j = 0; j < NNA; j++)
+			{
+#pragma omp atomic
 				Airports[Mcells[i].AirportList[j].id].num_mcell++;
+			}
 		}
+	}
 	cur = Airports[0].DestMcells;
 	Files::xfprintf_stderr("Microcell airport lists collated.\n");
 	for (int i = 0; i < P.Nairports; i++)
@@ -1710,29 +1913,34 @@ void SetupAirports(void)
 		cur += Airports[i].num_mcell;
 		Airports[i].num_mcell = 0;
 	}
-#pragma omp parallel for private(k,l,t,tmin) schedule(static,10000) default(none) \
-		shared(P, Airports, Mcells, stderr_shared)
-	for (int i = 0; i < P.NumMicrocells; i++)
-		if (Mcells[i].n > 0)
+	// Each microcell takes the next free entries in its airports' lists, which are then put in
+	// microcell order so that they don't depend on the order the threads got there.
+#pragma omp parallel for private(k,l,t,tmin) schedule(static,1000) default(none) \
+		shared(P, Airports, Mcells, McellLookup)
+	for (int pm = 0; pm < P.NumPopulatedMicrocells; pm++)
+	{
+		int i = (int)(McellLookup[pm] - Mcells);
+		t = 0;
+		for (int j = 0; j < NNA; j++)
 		{
-			if (i % 10000 == 0) Files::xfprintf(stderr_shared, "\n%i           ", i);
-			t = 0;
-			for (int j = 0; j < NNA; j++)
-			{
-				t += Mcells[i].AirportList[j].prob;
-				k = Mcells[i].AirportList[j].id;
-#pragma omp critical (airport)
-				l = (Airports[k].num_mcell++);
-				Airports[k].DestMcells[l].id = i;
-				Airports[k].DestMcells[l].prob = Mcells[i].AirportList[j].prob * ((float)Mcells[i].n);
-			}
-			tmin = 0;
-			for (int j = 0; j < NNA; j++)
-			{
-				Mcells[i].AirportList[j].prob = (float)(tmin + Mcells[i].AirportList[j].prob / t);
-				tmin = Mcells[i].AirportList[j].prob;
-			}
+			t += Mcells[i].AirportList[j].prob;
+			k = Mcells[i].AirportList[j].id;
+#pragma omp atomic capture
+			l = Airports[k].num_mcell++;
+			Airports[k].DestMcells[l].id = i;
+			Airports[k].DestMcells[l].prob = Mcells[i].AirportList[j].prob * ((float)Mcells[i].n);
 		}
+		tmin = 0;
+		for (int j = 0; j < NNA; j++)
+		{
+			Mcells[i].AirportList[j].prob = (float)(tmin + Mcells[i].AirportList[j].prob / t);
+			tmin = Mcells[i].AirportList[j].prob;
+		}
+	}
+#pragma omp parallel for schedule(dynamic,1) default(none) shared(P, Airports)
+	for (int i = 0; i < P.Nairports; i++)
+		std::sort(Airports[i].DestMcells, Airports[i].DestMcells + Airports[i].num_mcell,
+			[](IndexList const& a, IndexList const& b) { return a.id < b.id; });
 	Files::xfprintf_stderr("Airport microcell lists collated.\n");
 	for (int i = 0; i < P.Nairports; i++)
 		if (Airports[i].total_traffic > 0)
@@ -1764,34 +1972,52 @@ void SetupAirports(void)
 		}
 	Files::xfprintf_stderr("\nInitialising hotel to airport lookup tables\n");
 	Memory::xfree(base);
-#pragma omp parallel for private(l,m,t,tmin) schedule(static,1) default(none) shared(P, Airports, Places, stderr_shared)
+
+	// Each airport's hotels are those within a radius, widened in steps until there are enough
+	// of them, so the radius is the first step beyond its m'th nearest hotel.
+	std::vector<double> hotel_x(P.Nplace[P.HotelPlaceType]), hotel_y(P.Nplace[P.HotelPlaceType]);
+	for (int j = 0; j < P.Nplace[P.HotelPlaceType]; j++)
+	{
+		hotel_x[j] = Places[P.HotelPlaceType][j].loc.x;
+		hotel_y[j] = Places[P.HotelPlaceType][j].loc.y;
+	}
+	SpatialGrid hotel_grid(hotel_x, hotel_y);
+	FILE* stderr_shared = stderr;
+#pragma omp parallel for private(l,m,t,tmin) schedule(dynamic,1) default(none) shared(P, Airports, Places, hotel_grid, stderr_shared)
 	for (int i = 0; i < P.Nairports; i++)
 		if (Airports[i].total_traffic > 0)
 		{
 			m = (int)(Airports[i].total_traffic / HOTELS_PER_1000PASSENGER / 1000);
 			if (m < MIN_HOTELS_PER_AIRPORT) m = MIN_HOTELS_PER_AIRPORT;
 			Files::xfprintf(stderr_shared, "\n%i    ", i);
+			double x = Airports[i].loc.x, y = Airports[i].loc.y;
+			auto hotel_dist2 = [x, y](int j) { return dist2_raw(x, y, Places[P.HotelPlaceType][j].loc.x, Places[P.HotelPlaceType][j].loc.y); };
+			std::vector<SpatialGrid::Neighbour> nearest;
+			hotel_grid.nearest(x, y, m, hotel_dist2, dist2_raw_min, [](int) { return true; }, nearest);
+			if ((int)nearest.size() < m)
+				ERR_CRITICAL_FMT("Airport %i needs %i hotels but there are only %i\n", i, m, (int)nearest.size());
 			tmin = MAX_DIST_AIRPORT_TO_HOTEL * MAX_DIST_AIRPORT_TO_HOTEL * 0.75;
 			do
 			{
 				tmin += 0.25 * MAX_DIST_AIRPORT_TO_HOTEL * MAX_DIST_AIRPORT_TO_HOTEL;
-				Airports[i].num_place = 0;
-				for (int j = 0; j < P.Nplace[P.HotelPlaceType]; j++)
-					if (dist2_raw(Airports[i].loc.x, Airports[i].loc.y,
-						Places[P.HotelPlaceType][j].loc.x, Places[P.HotelPlaceType][j].loc.y) < tmin)
-						Airports[i].num_place++;
-			} while (Airports[i].num_place < m);
+			} while (tmin <= nearest.back().dist2);
+			std::vector<SpatialGrid::Neighbour> hotels;
+			hotel_grid.search(x, y,
+				[tmin](double separation) { return dist2_raw_min(separation) >= tmin; },
+				[&](int j)
+				{
+					double d2 = hotel_dist2(j);
+					if (d2 < tmin) hotels.push_back({ d2, j });
+				});
+			std::sort(hotels.begin(), hotels.end(), [](SpatialGrid::Neighbour const& a, SpatialGrid::Neighbour const& b) { return a.index < b.index; });
+			Airports[i].num_place = (int)hotels.size();
 			if (tmin > MAX_DIST_AIRPORT_TO_HOTEL * MAX_DIST_AIRPORT_TO_HOTEL) Files::xfprintf(stderr_shared, "*** %i : %lg %i ***\n", i, sqrt(tmin), Airports[i].num_place);
 			Airports[i].DestPlaces = (IndexList*)Memory::xcalloc(Airports[i].num_place, sizeof(IndexList));
-			Airports[i].num_place = 0;
-			for (int j = 0; j < P.Nplace[P.HotelPlaceType]; j++)
-				if ((t = dist2_raw(Airports[i].loc.x, Airports[i].loc.y,
-					Places[P.HotelPlaceType][j].loc.x, Places[P.HotelPlaceType][j].loc.y)) < tmin)
-				{
-					Airports[i].DestPlaces[Airports[i].num_place].prob = (float)P.KernelLookup.num(t);
-					Airports[i].DestPlaces[Airports[i].num_place].id = j;
-					Airports[i].num_place++;
-				}
+			for (int j = 0; j < Airports[i].num_place; j++)
+			{
+				Airports[i].DestPlaces[j].prob = (float)P.KernelLookup.num(hotels[j].dist2);
+				Airports[i].DestPlaces[j].id = hotels[j].index;
+			}
 			t = 0;
 			for (int j = 0; j < Airports[i].num_place; j++)
 			{
@@ -1811,181 +2037,10 @@ void SetupAirports(void)
 	for (int i = 0; i < P.Nplace[P.HotelPlaceType]; i++) Places[P.HotelPlaceType][i].n = 0;
 	P.Kernel = P.MoveKernel;
 	P.KernelLookup.init(1.0, P.Kernel);
-	CovidSim::TBD1::KernelLookup::init(P.KernelLookup, CellLookup, P.NumPopulatedCells);
+	P.KernelLookup.init(CellLookup, P.NumPopulatedCells);
 	Files::xfprintf_stderr("\nAirport initialisation completed successfully\n");
 }
 
-const double PROP_OTHER_PARENT_AWAY = 0.0;
-
-void AssignHouseholdAges(int n, int pers, int tn, bool do_adunit_demog)
-{
-	/* Complex household age distribution model
-		- picks number of children (nc)
-		- tries to space them reasonably
-		- picks parental ages to be consistent with childrens' and each other
-		- other adults in large households are assumed to be grandparents
-		- for Thailand, 2 person households are 95% couples without children, 5% 1 parent families
-	*/
-	int i, j, k, nc, ad;
-	int a[MAX_HOUSEHOLD_SIZE + 2];
-
-	ad = (do_adunit_demog && (P.DoAdUnits)) ? Mcells[Hosts[pers].mcell].adunit : 0;
-	if (!P.DoHouseholds)
-	{
-		for (i = 0; i < n; i++)
-			a[i] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-	}
-	else
-	{
-		if (n == 1)
-		{
-			if (ranf_mt(tn) < P.OnePersHouseProbOld)
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[0] < P.NoChildPersAge)
-					|| (ranf_mt(tn) > (((double)a[0]) - P.NoChildPersAge + 1) / (_I64(P.OldPersAge) - P.NoChildPersAge + 1)));
-			}
-			else if ((P.OnePersHouseProbYoung > 0) && (ranf_mt(tn) < P.OnePersHouseProbYoung / (1 - P.OnePersHouseProbOld)))
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				} while ((a[0] > P.YoungAndSingle) || (a[0] < P.MinAdultAge)
-					|| (ranf_mt(tn) > 1 - P.YoungAndSingleSlope * (((double)a[0]) - P.MinAdultAge) / (_I64(P.YoungAndSingle) - P.MinAdultAge)));
-			}
-			else
-				while ((a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))]) < P.MinAdultAge);
-		}
-		else if (n == 2)
-		{
-			if (ranf_mt(tn) < P.TwoPersHouseProbOld)
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[0] < P.NoChildPersAge)
-					|| (ranf_mt(tn) > (((double)a[0]) - P.NoChildPersAge + 1) / (_I64(P.OldPersAge) - P.NoChildPersAge + 1)));
-				do
-				{
-					a[1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[1] > a[0] + P.MaxMFPartnerAgeGap) || (a[1] < a[0] - P.MaxFMPartnerAgeGap) || (a[1] < P.NoChildPersAge)
-					|| (ranf_mt(tn) > (((double)a[1]) - P.NoChildPersAge + 1) / (_I64(P.OldPersAge) - P.NoChildPersAge + 1)));
-			}
-			else if (ranf_mt(tn) < P.OneChildTwoPersProb / (1 - P.TwoPersHouseProbOld))
-			{
-				while ((a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))]) > P.MaxChildAge);
-				do
-				{
-					a[1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[1] > a[0] + P.MaxParentAgeGap) || (a[1] < a[0] + P.MinParentAgeGap) || (a[1] < P.MinAdultAge));
-			}
-			else if ((P.TwoPersHouseProbYoung > 0) && (ranf_mt(tn) < P.TwoPersHouseProbYoung / (1 - P.TwoPersHouseProbOld - P.OneChildTwoPersProb)))
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				} while ((a[0] < P.MinAdultAge) || (a[0] > P.YoungAndSingle)
-					|| (ranf_mt(tn) > 1 - P.YoungAndSingleSlope * (((double)a[0]) - P.MinAdultAge) / (_I64(P.YoungAndSingle) - P.MinAdultAge)));
-				do
-				{
-					a[1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[1] > a[0] + P.MaxMFPartnerAgeGap) || (a[1] < a[0] - P.MaxFMPartnerAgeGap) || (a[1] < P.MinAdultAge));
-			}
-			else
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				} while (a[0] < P.MinAdultAge);
-				do
-				{
-					a[1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[1] > a[0] + P.MaxMFPartnerAgeGap) || (a[1] < a[0] - P.MaxFMPartnerAgeGap) || (a[1] < P.MinAdultAge));
-			}
-
-		}
-		else
-		{
-			if (n == 3)
-			{
-				if ((P.ZeroChildThreePersProb > 0) || (P.TwoChildThreePersProb > 0))
-					nc = (ranf_mt(tn) < P.ZeroChildThreePersProb) ? 0 : ((ranf_mt(tn) < P.TwoChildThreePersProb) ? 2 : 1);
-				else
-					nc = 1;
-			}
-			else if (n == 4)
-				nc = (ranf_mt(tn) < P.OneChildFourPersProb) ? 1 : 2;
-			else if (n == 5)
-				nc = (ranf_mt(tn) < P.ThreeChildFivePersProb) ? 3 : 2;
-			else
-				nc = n - 2 - (int)(3 * ranf_mt(tn));
-			if (nc <= 0)
-			{
-				do
-				{
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-					a[1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[1] < P.MinAdultAge) || (a[0] < P.MinAdultAge));
-				do
-				{
-					a[2] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-				}
-				while ((a[2] >= a[1] + P.MaxMFPartnerAgeGap) || (a[2] < a[1] - P.MaxFMPartnerAgeGap));
-			}
-			else
-			{
-				do
-				{
-					a[0] = 0;
-					for (i = 1; i < nc; i++)
-						a[i] = a[i - 1] + 1 + ((int)ignpoi_mt((double) (_I64(P.MeanChildAgeGap) - 1), tn));
-					a[0] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))] - a[(int)(ranf_mt(tn) * ((double)nc))];
-					for (i = 1; i < nc; i++) a[i] += a[0];
-					k = (((nc == 1) && (ranf_mt(tn) < P.OneChildProbYoungestChildUnderFive)) || ((nc == 2) && (ranf_mt(tn) < P.TwoChildrenProbYoungestUnderFive))
-						|| ((nc > 2) && (ranf_mt(tn) < P.ProbYoungestChildUnderFive))) ? 5 : P.MaxChildAge;
-				} while ((a[0] < 0) || (a[0] > k) || (a[nc - 1] > P.MaxChildAge));
-				j = a[nc - 1] - a[0] - (P.MaxParentAgeGap - P.MinParentAgeGap);
-				if (j > 0)
-					j += P.MaxParentAgeGap;
-				else
-					j = P.MaxParentAgeGap;
-				do
-				{
-					a[nc] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-					k = a[nc - 1];
-				} while ((a[nc] > a[0] + j) || (a[nc] < k + P.MinParentAgeGap) || (a[nc] < P.MinAdultAge));
-				if ((n > nc + 1) && (ranf_mt(tn) > PROP_OTHER_PARENT_AWAY))
-				{
-					do
-					{
-						a[nc + 1] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))];
-					} while ((a[nc + 1] > a[nc] + P.MaxMFPartnerAgeGap) || (a[nc + 1] < a[nc] - P.MaxFMPartnerAgeGap)
-						|| (a[nc + 1] > a[0] + j) || (a[nc + 1] < k + P.MinParentAgeGap) || (a[nc + 1] < P.MinAdultAge));
-				}
-
-				if (n > nc + 2)
-				{
-					j = ((a[nc + 1] > a[nc]) ? a[nc + 1] : a[nc]) + P.OlderGenGap;
-					if (j >= NUM_AGE_GROUPS * AGE_GROUP_WIDTH) j = NUM_AGE_GROUPS * AGE_GROUP_WIDTH - 1;
-					if (j < P.NoChildPersAge) j = P.NoChildPersAge;
-					for (i = nc + 2; i < n; i++)
-						while ((a[i] = State.InvAgeDist[ad][(int)(1000.0 * ranf_mt(tn))]) < j);
-				}
-			}
-		}
-	}
-	for (i = 0; i < n; i++) Hosts[pers + i].age = (unsigned char) a[i];
-}
-
 void AssignPeopleToPlaces()
 {
 	int i2, j, j2, k, k2, l, m, tp, f, f2, f3, f4, ic, a, cnt, ca, nn;
@@ -1994,6 +2049,7 @@ void AssignPeopleToPlaces()
 	double s, t, *NearestPlacesProb[MAX_NUM_THREADS];
 	Cell* ct;
 	int npt;
+	Memory::Arena cell_places; // lists of places in each cell, replacing the cells' susceptible arrays while assigning
 
 	npt = MAX_NUM_PLACE_TYPES;
 
@@ -2003,7 +2059,7 @@ void AssignPeopleToPlaces()
 		for (int i = 0; i < P.NumCells; i++)
 		{
 			Cells[i].infected = Cells[i].susceptible;
-			Cells[i].susceptible = (int*)Memory::xcalloc(Cells[i].n, sizeof(int));
+			Cells[i].susceptible = cell_places.alloc<int>(Cells[i].n);
 			Cells[i].cumTC = Cells[i].n;
 		}
 
@@ -2016,52 +2072,58 @@ void AssignPeopleToPlaces()
 			}
 		}
 
+		// Build the tables for every kernel used during setup at once.
+		std::vector<CovidSim::TBD1::KernelStruct> kernels(1, P.MoveKernel);
+		if (P.DoAirports) kernels.push_back(P.AirportKernel);
+		for (tp = 0; tp < P.NumPlaceTypes; tp++)
+			if (tp != P.HotelPlaceType)
+			{
+				CovidSim::TBD1::KernelStruct kernel = { P.PlaceTypeKernelType[tp], P.PlaceTypeKernelShape[tp], P.PlaceTypeKernelScale[tp],
+					P.PlaceTypeKernelP3[tp], P.PlaceTypeKernelP4[tp] };
+				kernels.push_back(kernel);
+			}
+		P.KernelLookup.prepare(1.0, kernels);
+
 		for (tp = 0; tp < P.NumPlaceTypes; tp++)
 		{
 			if (tp != P.HotelPlaceType)
 			{
-				cnt = 0;
-				for (a = 0; a < P.NumPopulatedCells; a++)
+				// Who may belong to a place of this type is drawn cell by cell in parallel, each cell
+				// from its own stream, and the people are then put in a random order.
+				uint64_t eligible_seed = stream_seed(), order_seed = stream_seed();
+				std::vector<int> cell_first_person(P.NumPopulatedCells + 1);
+#pragma omp parallel for schedule(dynamic,16) default(none) shared(P, CellLookup, Hosts, PropPlaces, tp, eligible_seed, cell_first_person)
+				for (int pc = 0; pc < P.NumPopulatedCells; pc++)
 				{
-					Cell *c = CellLookup[a];
+					Cell *c = CellLookup[pc];
+					uint64_t stream = stream_init(eligible_seed, (uint64_t)pc);
 					c->n = 0;
-					for (j = 0; j < c->cumTC; j++)
+					for (int j = 0; j < c->cumTC; j++)
 					{
-						k = HOST_AGE_YEAR(c->members[j]);
-						f = ((PropPlaces[k][tp] > 0) && (ranf() < PropPlaces[k][tp]));
+						int age = HOST_AGE_YEAR(c->members[j]);
+						bool f = ((PropPlaces[age][tp] > 0) && (ranf_stream(&stream) < PropPlaces[age][tp]));
 						if (f)
-							for (k = 0; (k < tp) && (f); k++)
-								if (Hosts[c->members[j]].PlaceLinks[k] >= 0) f = 0; //(ranf()<P.PlaceExclusivityMatrix[tp][k]);
+							for (int k = 0; (k < tp) && (f); k++)
+								if (Hosts[c->members[j]].PlaceLinks[k] >= 0) f = false; //(ranf()<P.PlaceExclusivityMatrix[tp][k]);
 						// Am assuming people can only belong to 1 place (and a hotel) at present
 						if (f)
 						{
 							c->susceptible[c->n] = c->members[j];
 							(c->n)++;
-							cnt++;
 						}
 					}
 					c->S = c->n;
 					c->I = 0;
+					cell_first_person[pc + 1] = c->n;
 				}
+				for (int pc = 0; pc < P.NumPopulatedCells; pc++)
+					cell_first_person[pc + 1] += cell_first_person[pc];
+				cnt = cell_first_person[P.NumPopulatedCells];
 				PeopleArray = (int*)Memory::xcalloc(cnt, sizeof(int));
-				j2 = 0;
-				for (a = 0; a < P.NumPopulatedCells; a++)
-				{
-					Cell *c = CellLookup[a];
-					for (j = 0; j < c->n; j++)
-					{
-						PeopleArray[j2] = c->susceptible[j];
-						j2++;
-					}
-				}
-				// Use the Fisher–Yates shuffle algorithm to get a random permutation of PeopleArray
-				for (int index1 = cnt - 1; index1 > 0; index1--)
-				{
-					int index2 = (int)(((double)(index1 + 1)) * ranf());
-					int tmp = PeopleArray[index1];
-					PeopleArray[index1] = PeopleArray[index2];
-					PeopleArray[index2] = tmp;
-				}
+#pragma omp parallel for schedule(static) default(none) shared(P, CellLookup, PeopleArray, cell_first_person)
+				for (int pc = 0; pc < P.NumPopulatedCells; pc++)
+					std::copy(CellLookup[pc]->susceptible, CellLookup[pc]->susceptible + CellLookup[pc]->n, PeopleArray + cell_first_person[pc]);
+				parallel_shuffle(PeopleArray, cnt, order_seed);
 				m = 0;
 				if (tp < P.nsp)
 				{
@@ -2212,10 +2274,7 @@ void AssignPeopleToPlaces()
 					for (int i = 0; i < P.NumCells; i++)
 					{
 						if (Cells[i].S > Cells[i].cumTC)
-						{
-							Memory::xfree(Cells[i].susceptible);
-							Cells[i].susceptible = (int*)Memory::xcalloc(Cells[i].S, sizeof(int));
-						}
+							Cells[i].susceptible = cell_places.alloc<int>(Cells[i].S);
 						Cells[i].S = 0;
 					}
 					for (j = 0; j < P.Nplace[tp]; j++)
@@ -2240,18 +2299,72 @@ void AssignPeopleToPlaces()
 				P.Kernel.p3_ = P.PlaceTypeKernelP3[tp];
 				P.Kernel.p4_ = P.PlaceTypeKernelP4[tp];
 				P.KernelLookup.init(1.0, P.Kernel);
-				CovidSim::TBD1::KernelLookup::init(P.KernelLookup, CellLookup, P.NumPopulatedCells);
-				UpdateProbs(1);
+				// Cell to cell probabilities are only used when choosing among all places.
+				if (P.PlaceTypeNearestNeighb[tp] == 0)
+					P.KernelLookup.init(CellLookup, P.NumPopulatedCells);
 				ca = 0;
 				Files::xfprintf_stderr("Allocating people to place type %i\n", tp);
 				a = cnt;
 				nn = P.PlaceTypeNearestNeighb[tp];
-				if (P.PlaceTypeNearestNeighb[tp] > 0)
+				if ((P.PlaceTypeNearestNeighb[tp] > 0) && (tp >= P.nsp))
+				{
+					// Without capacities to fill, each person's choice is independent of everyone
+					// else's, so people are assigned in parallel, each with their own random number
+					// stream, choosing among the nn nearest places in their country weighted by the kernel.
+					std::vector<double> place_x(P.Nplace[tp]), place_y(P.Nplace[tp]);
+					for (int i = 0; i < P.Nplace[tp]; i++)
+					{
+						place_x[i] = Places[tp][i].loc.x;
+						place_y[i] = Places[tp][i].loc.y;
+					}
+					SpatialGrid grid(place_x, place_y);
+					uint64_t seed = stream_seed();
+#pragma omp parallel default(shared) reduction(+:ca)
+					{
+						std::vector<SpatialGrid::Neighbour> nearest;
+						std::vector<double> cum_prob(nn);
+#pragma omp for schedule(dynamic, 1000)
+						for (int j = 0; j < a; j++)
+						{
+							int i = PeopleArray[j];
+							if (Hosts[i].PlaceLinks[tp] >= 0) continue; // already assigned due to household membership
+							auto const host_country = mcell_country[Hosts[i].mcell];
+							auto const& home = Households[Hosts[i].hh].loc;
+							grid.nearest(home.x, home.y, nn,
+								[tp, &home](int place) { return dist2_raw(home.x, home.y, Places[tp][place].loc.x, Places[tp][place].loc.y); }, dist2_raw_min,
+								[tp, host_country](int place) { return mcell_country[Places[tp][place].mcell] == host_country; }, nearest);
+							int np = 0;
+							double total = 0;
+							for (auto const& n : nearest)
+							{
+								double prob = P.KernelLookup.num(n.dist2);
+								if (prob > 0)
+								{
+									total += prob;
+									nearest[np] = n;
+									cum_prob[np++] = total;
+								}
+							}
+							if (np == 0)
+							{
+								Files::xfprintf_stderr("# %i %i     \r", i, j);
+								continue;
+							}
+							uint64_t stream = stream_init(seed, (uint64_t)i);
+							double r = ranf_stream(&stream) * total;
+							int chosen = 0;
+							while ((chosen < np - 1) && (cum_prob[chosen] <= r)) chosen++;
+							Hosts[i].PlaceLinks[tp] = nearest[chosen].index;
+							ca++;
+						}
+					}
+				}
+				else if (P.PlaceTypeNearestNeighb[tp] > 0)
 				{
+					// School places are taken as people are assigned, so this is done in turn.
 					int tn = 0;
 					for (j = 0; j < a; j++)
 					{
-						if (j % 1000 == 0) Files::xfprintf_stderr("(%i) %i      \r", tp, j);
 						for (i2 = 0; i2 < nn; i2++)	NearestPlacesProb[tn][i2] = 0;
 						l = 1; k = m = f2 = 0;
 						int i = PeopleArray[j];
@@ -2387,8 +2500,6 @@ void AssignPeopleToPlaces()
 						for (i2 = m2; i2 >= f; i2--)
 						{
 							int tn = 0;
-							if (i2 % 10000 == 0)
-								Files::xfprintf_stderr("(%i) %i            \r", tp, i2);
 							k = PeopleArray[i2];
 							int i = Hosts[k].pcell;
 							f2 = 1;
@@ -2459,7 +2570,6 @@ void AssignPeopleToPlaces()
 			Cells[i].n = Cells[i].cumTC;
 			Cells[i].cumTC = 0;
 			Cells[i].S = Cells[i].I = Cells[i].L = Cells[i].R = 0;
-			Memory::xfree(Cells[i].susceptible);
 			Cells[i].susceptible = Cells[i].infected;
 		}
 	}
@@ -2478,80 +2588,153 @@ void StratifyPlaces(void)
 		for (int j = 0; j < P.NumPlaceTypes; j++)
 			for (int i = 0; i < P.Nplace[j]; i++)
 				Places[j][i].n = 0;
-#pragma omp parallel for schedule(static,1) default(none) \
+
+		// Count the members of each place. Hotels start empty, with room for twice their mean size.
+#pragma omp parallel for schedule(static,500) default(none) \
 			shared(P, Places, Hosts)
-		for (int tn = 0; tn < P.NumThreads; tn++)
-			for (int j = tn; j < P.NumPlaceTypes; j += P.NumThreads)
+		for (int i = 0; i < P.PopSize; i++)
+			for (int j = 0; j < P.NumPlaceTypes; j++)
 			{
-				if (j == P.HotelPlaceType)
+				int k = Hosts[i].PlaceLinks[j];
+				if ((j != P.HotelPlaceType) && (k >= 0))
 				{
-					int l = 2 * ((int)P.PlaceTypeMeanSize[j]);
-					for (int i = 0; i < P.Nplace[j]; i++)
-					{
-						Places[j][i].members = (int*)Memory::xcalloc(l, sizeof(int));
-						Places[j][i].n = 0;
-					}
+#pragma omp atomic
+					Places[j][k].n++;
 				}
-				else
+			}
+
+		// Each place's members start at the sum of the sizes of the places before it, found in
+		// parallel blocks: each block's total, then the totals before each block, then the offsets.
+		std::vector<int> block_start(_I64(P.NumThreads) + 1);
+		for (int j = 0; j < P.NumPlaceTypes; j++)
+		{
+			int hotel_size = 2 * ((int)P.PlaceTypeMeanSize[j]);
+			PlaceMembership& membership = PlaceMembers[j];
+			membership.offsets = SetupArena.alloc<int>(_I64(P.Nplace[j]) + 1);
+#pragma omp parallel for schedule(static,1) default(none) \
+				shared(P, Places, block_start, hotel_size, j)
+			for (int tn = 0; tn < P.NumThreads; tn++)
+			{
+				int total = 0;
+				for (int i = (int)((_I64(P.Nplace[j]) * tn) / P.NumThreads); i < (int)((_I64(P.Nplace[j]) * (tn + 1)) / P.NumThreads); i++)
+					total += (j == P.HotelPlaceType) ? hotel_size : Places[j][i].n;
+				block_start[_I64(tn) + 1] = total;
+			}
+			for (int tn = 0; tn < P.NumThreads; tn++)
+				block_start[_I64(tn) + 1] += block_start[tn];
+#pragma omp parallel for schedule(static,1) default(none) \
+				shared(P, Places, block_start, hotel_size, j, membership)
+			for (int tn = 0; tn < P.NumThreads; tn++)
+			{
+				int offset = block_start[tn];
+				for (int i = (int)((_I64(P.Nplace[j]) * tn) / P.NumThreads); i < (int)((_I64(P.Nplace[j]) * (tn + 1)) / P.NumThreads); i++)
 				{
-					for (int i = 0; i < P.PopSize; i++)
+					membership.offsets[i] = offset;
+					offset += (j == P.HotelPlaceType) ? hotel_size : Places[j][i].n;
+				}
+			}
+			membership.offsets[P.Nplace[j]] = block_start[P.NumThreads];
+			membership.members = SetupArena.alloc<int>(block_start[P.NumThreads]);
+#pragma omp parallel for schedule(static,500) default(none) \
+				shared(P, Places, j, membership)
+			for (int i = 0; i < P.Nplace[j]; i++)
+			{
+				Places[j][i].members = membership.members + membership.offsets[i];
+				Places[j][i].n = 0;
+			}
+		}
+
+		// Fill in the members. Their order within each place depends on the threads, so is put
+		// back to ascending before the groups are formed.
+#pragma omp parallel for schedule(static,500) default(none) \
+			shared(P, Places, Hosts)
+		for (int i = 0; i < P.PopSize; i++)
+			for (int j = 0; j < P.NumPlaceTypes; j++)
+			{
+				int k = Hosts[i].PlaceLinks[j];
+				if ((j != P.HotelPlaceType) && (k >= 0))
+				{
+					int m;
+#pragma omp atomic capture
+					m = Places[j][k].n++;
+					Places[j][k].members[m] = i;
+				}
+			}
+
+		// Split each place's members into groups at random. Each place draws from its own random
+		// number stream, so the groups don't depend on the number of threads. The threads'
+		// generators are put back afterwards. The number of groups of every place is drawn first,
+		// so that the group arrays of a place type can be allocated at once and filled without
+		// locking the arena; the second pass draws it again to carry on with the same stream.
+		std::vector<uint64_t> seed(P.NumPlaceTypes);
+		for (int j = 0; j < P.NumPlaceTypes; j++)
+			seed[j] = stream_seed();
+		std::vector<int32_t> saved_Xcg1(Xcg1, Xcg1 + MAX_NUM_THREADS * CACHE_LINE_SIZE), saved_Xcg2(Xcg2, Xcg2 + MAX_NUM_THREADS * CACHE_LINE_SIZE);
+		auto draw_num_groups = [&seed](int j, int i, int tn)
+		{
+			stream_seed_thread(stream_init(seed[j], i), tn);
+			double t = ((double)Places[j][i].n) / P.PlaceTypeGroupSizeParam1[j] - 1.0;
+			return (t < 0) ? 1 : 1 + (int)ignpoi_mt(t, tn);
+		};
+		for (int j = 0; j < P.NumPlaceTypes; j++)
+		{
+			if (j == P.HotelPlaceType) continue;
+#pragma omp parallel for schedule(static,1) default(none) \
+				shared(P, Places, draw_num_groups, j)
+			for (int tn = 0; tn < P.NumThreads; tn++)
+				for (int i = tn; i < P.Nplace[j]; i += P.NumThreads)
+					if (Places[j][i].n > 0)
 					{
-						if (Hosts[i].PlaceLinks[j] >= 0)
-							Places[j][Hosts[i].PlaceLinks[j]].n++;
+						std::sort(Places[j][i].members, Places[j][i].members + Places[j][i].n);
+						Places[j][i].ng = draw_num_groups(j, i, tn);
 					}
-					for (int i = 0; i < P.Nplace[j]; i++)
+			int64_t num_groups = 0;
+			for (int i = 0; i < P.Nplace[j]; i++)
+				if (Places[j][i].n > 0) num_groups += Places[j][i].ng;
+			int* group_start = SetupArena.alloc<int>(num_groups);
+			int* group_size = SetupArena.alloc<int>(num_groups);
+			for (int i = 0; i < P.Nplace[j]; i++)
+				if (Places[j][i].n > 0)
+				{
+					Places[j][i].group_start = group_start;
+					Places[j][i].group_size = group_size;
+					group_start += Places[j][i].ng;
+					group_size += Places[j][i].ng;
+				}
+#pragma omp parallel for schedule(static,1) default(none) \
+				shared(P, Places, Hosts, draw_num_groups, j)
+			for (int tn = 0; tn < P.NumThreads; tn++)
+				for (int i = tn; i < P.Nplace[j]; i += P.NumThreads)
+					if (Places[j][i].n > 0)
 					{
-						if (Places[j][i].n > 0)
+						draw_num_groups(j, i, tn);
+						int m = Places[j][i].n - Places[j][i].ng;
+						int l;
+						for (int k = l = 0; k < Places[j][i].ng; k++)
 						{
-							Places[j][i].members = (int*)Memory::xcalloc(Places[j][i].n, sizeof(int));
+							double t = 1 / ((double)(_I64(Places[j][i].ng) - k));
+							Places[j][i].group_start[k] = l;
+							Places[j][i].group_size[k] = 1 + ignbin_mt((int32_t)m, t, tn);
+							m -= (Places[j][i].group_size[k] - 1);
+							l += Places[j][i].group_size[k];
 						}
-						Places[j][i].n = 0;
-					}
-					for (int i = 0; i < P.PopSize; i++)
-					{
-						int k = Hosts[i].PlaceLinks[j];
-						if (k >= 0)
+						for (int k = 0; k < Places[j][i].n; k++)
 						{
-							Places[j][k].members[Places[j][k].n] = i;
-							Places[j][k].n++;
+							l = (int)(((double)Places[j][i].n) * ranf_mt(tn));
+							int n = Places[j][i].members[l];
+							Places[j][i].members[l] = Places[j][i].members[k];
+							Places[j][i].members[k] = n;
 						}
-					}
-					for (int i = 0; i < P.Nplace[j]; i++)
-						if (Places[j][i].n > 0)
-						{
-							double t = ((double)Places[j][i].n) / P.PlaceTypeGroupSizeParam1[j] - 1.0;
-							if (t < 0)
-								Places[j][i].ng = 1;
-							else
-								Places[j][i].ng = 1 + (int)ignpoi_mt(t, tn);
-							Places[j][i].group_start = (int*)Memory::xcalloc(Places[j][i].ng, sizeof(int));
-							Places[j][i].group_size = (int*)Memory::xcalloc(Places[j][i].ng, sizeof(int));
-							int m = Places[j][i].n - Places[j][i].ng;
-							int l;
-							for (int k = l = 0; k < Places[j][i].ng; k++)
-							{
-								t = 1 / ((double)(_I64(Places[j][i].ng) - k));
-								Places[j][i].group_start[k] = l;
-								Places[j][i].group_size[k] = 1 + ignbin_mt((int32_t)m, t, tn);
-								m -= (Places[j][i].group_size[k] - 1);
-								l += Places[j][i].group_size[k];
-							}
-							for (int k = 0; k < Places[j][i].n; k++)
+						for (int k = l = 0; k < Places[j][i].ng; k++)
+							for (m = 0; m < Places[j][i].group_size[k]; m++)
 							{
-								l = (int)(((double)Places[j][i].n) * ranf_mt(tn));
-								int n = Places[j][i].members[l];
-								Places[j][i].members[l] = Places[j][i].members[k];
-								Places[j][i].members[k] = n;
+								Hosts[Places[j][i].members[l]].PlaceGroupLinks[j] = k;
+								l++;
 							}
-							for (int k = l = 0; k < Places[j][i].ng; k++)
-								for (m = 0; m < Places[j][i].group_size[k]; m++)
-								{
-									Hosts[Places[j][i].members[l]].PlaceGroupLinks[j] = k;
-									l++;
-								}
-						}
-				}
-			}
+					}
+		}
+		std::copy(saved_Xcg1.begin(), saved_Xcg1.end(), Xcg1);
+		std::copy(saved_Xcg2.begin(), saved_Xcg2.end(), Xcg2);
 
 #pragma omp parallel for schedule(static,1) default (none) \
 			shared(P, Places, StateT)
@@ -3,6 +3,16 @@
 
 #include <string>
 #include "Files.h"
+#include "DensityFile.h"
+#include "Memory.h"
+#include "SetupStages.h"
+
+/// Holds arrays built while setting up the model that are kept for the whole run,
+/// such as place members and groups.
+extern Memory::Arena SetupArena;
+
+/// Times the stages of setup, and saves those that can be resumed if given a checkpoint prefix.
+extern SetupStages SetupProgress;
 
 int ReadFitIter(std::string const&);
 void ResetTimeSeries(void);
@@ -16,6 +26,10 @@ void InitTransmissionCoeffs(void);
  * 							be converted to binary and can be saved with `out_density_file`.
  * 							A binary file saved via `out_density_file` from a previous run
  * 							can be also used here.
+ * @param density_cache_file	Binary copy of the parsed text `density_file`. If it exists and was
+ * 							made from the same text file and settings it is read instead of
+ * 							`density_file`, otherwise it is written after the text file has
+ * 							been parsed. An empty string disables the cache.
  * @param out_density_file	Output population density file path. An empty string won't save
  * 							the binary form of the `density_file` contents.
  * @param load_network_file Population model file path to load from a previous run. An empty
@@ -28,7 +42,7 @@ void InitTransmissionCoeffs(void);
  * 							administrative units to be used for population age distribution
  * @param out_file_base		Output file path prefix
  */
-void SetupModel(std::string const& density_file, std::string const& out_density_file, std::string const& load_network_file,
+void SetupModel(std::string const& density_file, std::string const& density_cache_file, std::string const& out_density_file, std::string const& load_network_file,
 				std::string const& save_network_file, std::string const& school_file, std::string const& reg_demog_file,
 				std::string const& out_file_base);
 
@@ -55,15 +69,6 @@ void SetupPopulation(std::string const& density_file, std::string const& out_den
 
 void SetupAirports(void);
 
-/**
- * Populate ages for each host household randomly using distribution.
- *
- * @param n					Number of people in household
- * @param pers				Person to assign
- * @param tn				Thread number
- * @param do_adunit_demog	Flag if regional demography file exists
- */
-void AssignHouseholdAges(int n, int pers, int tn, bool do_adunit_demog);
 void AssignPeopleToPlaces(void);
 void StratifyPlaces(void);
 
@@ -90,15 +95,10 @@ void SavePeopleToPlaces(std::string const& save_network_file);
  */
 void SaveAgeDistrib(std::string const& output_file_base);
 void UpdateProbs(int);
+void UpdateProbsFromS0(void);
 
 // network file format version; update this number when you make changes to the format of the
 // network file, to ensure old/incompatible files are not loaded.
 const int NETWORK_FILE_VERSION = 1;
 
-struct BinFile
-{
-	double x, y, pop;
-	int cnt, ad;
-};
-
 #endif // COVIDSIM_SETUPMODEL_H_INCLUDED_
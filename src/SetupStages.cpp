@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "Files.h"
+#include "Memory.h"
+#include "SetupStages.h"
+
+SetupStages::SetupStages() : start_(std::chrono::steady_clock::now())
+{
+}
+
+std::string SetupStages::fingerprint(std::vector<std::string> const& args, std::vector<std::string> const& files,
+	std::vector<std::string> const& large_files)
+{
+	// 64 bit FNV-1a, with a 0 byte after each argument and file so that they can't run together.
+	uint64_t hash = UINT64_C(14695981039346656037);
+	auto add = [&hash](unsigned char const* bytes, std::size_t n)
+	{
+		for (std::size_t i = 0; i < n; i++)
+			hash = (hash ^ bytes[i]) * UINT64_C(1099511628211);
+	};
+	unsigned char const end = 0;
+	for (auto const& arg : args)
+	{
+		add((unsigned char const*)arg.data(), arg.size());
+		add(&end, 1);
+	}
+	std::vector<unsigned char> buf(1 << 16);
+	for (auto const& file : files)
+	{
+		FILE* dat = file.empty() ? NULL : Files::xfopen_if_exists(file.c_str(), "rb");
+		if (dat == NULL) continue;
+		std::size_t n;
+		while ((n = fread(buf.data(), 1, buf.size(), dat)) > 0)
+			add(buf.data(), n);
+		Files::xfclose(dat);
+		add(&end, 1);
+	}
+	for (auto const& file : large_files)
+	{
+		uint64_t size;
+		int64_t mtime;
+		if (file.empty() || !Files::stat_file(file.c_str(), size, mtime)) continue;
+		add((unsigned char const*)&size, sizeof(size));
+		add((unsigned char const*)&mtime, sizeof(mtime));
+		add(&end, 1);
+	}
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016" PRIx64, hash);
+	return hex;
+}
+
+void SetupStages::set_checkpoint(std::string const& prefix, std::string const& fingerprint)
+{
+	prefix_ = prefix;
+	fingerprint_ = fingerprint;
+	completed_.clear();
+	std::string manifest = prefix_ + ".stages";
+	FILE* dat = Files::xfopen_if_exists(manifest.c_str(), "r");
+	if (dat == NULL) return;
+	// The first line is the fingerprint; stages are listed after it, one per line.
+	char buf[1024];
+	bool matches = false;
+	for (int line = 0; fgets(buf, sizeof(buf), dat) != NULL; line++)
+	{
+		buf[strcspn(buf, "\r\n")] = 0;
+		if (line == 0)
+			matches = (fingerprint_ == buf);
+		else if (matches && buf[0] != 0)
+			completed_.push_back(buf);
+	}
+	Files::xfclose(dat);
+	if (!matches)
+		Files::xfprintf_stderr("Setup checkpoint %s is from a different setup and will be replaced\n", manifest.c_str());
+	else if (!completed_.empty())
+		Files::xfprintf_stderr("Resuming setup from checkpoint %s\n", manifest.c_str());
+}
+
+bool SetupStages::completed(std::string const& name) const
+{
+	return std::find(completed_.begin(), completed_.end(), name) != completed_.end();
+}
+
+void SetupStages::mark_completed(std::string const& name)
+{
+	if (!checkpointing() || completed(name)) return;
+	completed_.push_back(name);
+	write_manifest();
+}
+
+void SetupStages::write_manifest() const
+{
+	// Written in full and then renamed, so that a setup killed while writing leaves the old list intact.
+	std::string manifest = prefix_ + ".stages", tmp = manifest + ".tmp";
+	FILE* dat = Files::xfopen(tmp.c_str(), "w");
+	Files::xfprintf(dat, "%s\n", fingerprint_.c_str());
+	for (auto const& name : completed_)
+		Files::xfprintf(dat, "%s\n", name.c_str());
+	Files::xfclose(dat);
+#ifdef _WIN32
+	remove(manifest.c_str()); // rename does not replace an existing file on Windows
+#endif
+	Files::xrename(tmp.c_str(), manifest.c_str());
+}
+
+void SetupStages::begin(std::string const& name)
+{
+	if (!current_.empty()) end();
+	current_ = name;
+	Files::xfprintf_stderr("Setup stage: %s\n", name.c_str());
+	stage_start_ = std::chrono::steady_clock::now();
+	stage_peak_memory_ = Memory::peak_resident_size();
+}
+
+void SetupStages::end(double items, bool resumed)
+{
+	if (current_.empty()) return;
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - stage_start_;
+	long long growth = (long long)Memory::peak_resident_size() - (long long)stage_peak_memory_;
+	stages_.push_back({ current_, seconds.count(), growth, items, resumed });
+	current_.clear();
+}
+
+double SetupStages::elapsed() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
+
+void SetupStages::report() const
+{
+	Files::xfprintf_stderr("%-26s %10s %12s %14s\n", "Setup stage", "Time (s)", "Peak MB +", "People/s");
+	double total = 0;
+	for (auto const& stage : stages_)
+	{
+		char rate[32] = "";
+		if (stage.items > 0 && stage.seconds > 0)
+			snprintf(rate, sizeof(rate), "%.4g", stage.items / stage.seconds);
+		Files::xfprintf_stderr("%-26s %10.3f %12.1f %14s%s\n", stage.name.c_str(), stage.seconds,
+			stage.peak_memory_growth / 1048576.0, rate, stage.resumed ? "  (from checkpoint)" : "");
+		total += stage.seconds;
+	}
+	Files::xfprintf_stderr("%-26s %10.3f\nPeak memory %.1f MB\n", "Total of stages", total, Memory::peak_resident_size() / 1048576.0);
+}
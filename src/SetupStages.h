@@ -0,0 +1,91 @@
+/** \file  SetupStages.h
+ *  \brief Time the stages of setting up the model, and let an interrupted setup resume
+ */
+
+#ifndef COVIDSIM_SETUPSTAGES_H_INCLUDED_
+#define COVIDSIM_SETUPSTAGES_H_INCLUDED_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// Records the wall time, growth in peak memory and throughput of each stage of
+/// setup, for a report once setup is complete. Stages are timed one at a time,
+/// in the order they run.
+///
+/// Given a checkpoint prefix, stages whose output can be saved (such as the
+/// parsed density file or the place network) save it to a file named after
+/// the prefix and the stage, and are listed as completed in <prefix>.stages.
+/// A later setup with the same fingerprint (the command line, parameter files
+/// and input data files) reads those files instead of redoing the stages.
+class SetupStages
+{
+public:
+	struct Stage
+	{
+		std::string name;
+		double seconds;
+		long long peak_memory_growth;	///< Increase in the peak resident size of the process, in bytes
+		double items;					///< Number of people (or other items) processed, or 0
+		bool resumed;					///< Read from a checkpoint rather than computed
+	};
+
+	SetupStages();
+
+	/// \param  args          Command line arguments that affect setup
+	/// \param  files         Files whose contents affect setup; any that can't be read are skipped
+	/// \param  large_files   Files that affect setup but are too large to read for this, such as
+	///                       the density file; their size and modification time are used instead
+	/// \return               A hash of the arguments and files, in hexadecimal
+	static std::string fingerprint(std::vector<std::string> const& args, std::vector<std::string> const& files,
+		std::vector<std::string> const& large_files);
+
+	/// Save completed stages to files starting with prefix, and resume from any
+	/// that were saved by an earlier setup with the same fingerprint.
+	/// \param prefix       Path prefix of the checkpoint files
+	/// \param fingerprint  Identifies the inputs to setup
+	void set_checkpoint(std::string const& prefix, std::string const& fingerprint);
+
+	/// \return Whether stages are saved as they are completed
+	bool checkpointing() const { return !prefix_.empty(); }
+
+	/// \param  name Stage name
+	/// \return      The file a stage's output is saved in
+	std::string checkpoint_file(std::string const& name) const { return prefix_ + "." + name + ".bin"; }
+
+	/// \param  name Stage name
+	/// \return      Whether the stage was saved by an earlier setup with the same fingerprint
+	bool completed(std::string const& name) const;
+
+	/// Record that a stage's output has been saved to its checkpoint file.
+	void mark_completed(std::string const& name);
+
+	/// Start timing a stage, ending any stage still being timed.
+	void begin(std::string const& name);
+
+	/// Finish timing the current stage.
+	/// \param items    Number of people (or other items) processed, for the throughput
+	/// \param resumed  Whether the stage was read from a checkpoint
+	void end(double items = 0, bool resumed = false);
+
+	/// \return Wall time since the setup started, in seconds
+	double elapsed() const;
+
+	std::vector<Stage> const& stages() const { return stages_; }
+
+	/// Print a table of the stages to stderr.
+	void report() const;
+
+private:
+	void write_manifest() const;
+
+	std::chrono::steady_clock::time_point start_, stage_start_;
+	std::size_t stage_peak_memory_ = 0;
+	std::string current_;
+	std::vector<Stage> stages_;
+	std::string prefix_, fingerprint_;
+	std::vector<std::string> completed_;
+};
+
+#endif // COVIDSIM_SETUPSTAGES_H_INCLUDED_
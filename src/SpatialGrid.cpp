@@ -0,0 +1,56 @@
+/** \file  SpatialGrid.cpp
+ *  \brief Find the points nearest a location using a uniform grid of buckets
+ */
+
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid(std::vector<double> const& x, std::vector<double> const& y, double points_per_bucket)
+	: x0_(0), y0_(0), bucket_size_(1), width_(1), height_(1)
+{
+	int n = (int)x.size();
+	if (n > 0)
+	{
+		double x1 = x[0], y1 = y[0];
+		x0_ = x[0]; y0_ = y[0];
+		for (int i = 1; i < n; i++)
+		{
+			x0_ = std::min(x0_, x[i]); x1 = std::max(x1, x[i]);
+			y0_ = std::min(y0_, y[i]); y1 = std::max(y1, y[i]);
+		}
+		double area = std::max((x1 - x0_) * (y1 - y0_), 1e-12);
+		bucket_size_ = std::sqrt(area * std::max(points_per_bucket, 1.0) / n);
+		if (bucket_size_ <= 0) bucket_size_ = 1;
+		// Cap the bucket count, e.g. for points lying along a line.
+		width_ = 1 + (int)std::min(32767.0, (x1 - x0_) / bucket_size_);
+		height_ = 1 + (int)std::min(32767.0, (y1 - y0_) / bucket_size_);
+		while ((double)width_ * height_ > 4.0 * n + 16)
+		{
+			bucket_size_ *= 2;
+			width_ = 1 + (int)std::min(32767.0, (x1 - x0_) / bucket_size_);
+			height_ = 1 + (int)std::min(32767.0, (y1 - y0_) / bucket_size_);
+		}
+	}
+
+	// Counting sort of the points into buckets.
+	start_.assign((size_t)width_ * height_ + 1, 0);
+	std::vector<int> bucket(n);
+	for (int i = 0; i < n; i++)
+	{
+		bucket[i] = bucket_y(y[i]) * width_ + bucket_x(x[i]);
+		start_[bucket[i] + 1]++;
+	}
+	for (size_t b = 1; b < start_.size(); b++) start_[b] += start_[b - 1];
+	index_.resize(n);
+	x_.resize(n);
+	y_.resize(n);
+	position_.resize(n);
+	std::vector<int> next(start_.begin(), start_.end() - 1);
+	for (int i = 0; i < n; i++)
+	{
+		int pos = next[bucket[i]]++;
+		index_[pos] = i;
+		position_[i] = pos;
+		x_[pos] = x[i];
+		y_[pos] = y[i];
+	}
+}
@@ -0,0 +1,159 @@
+/** \file  SpatialGrid.h
+ *  \brief Find the points nearest a location using a uniform grid of buckets
+ */
+
+#ifndef COVIDSIM_SPATIALGRID_H_INCLUDED_
+#define COVIDSIM_SPATIALGRID_H_INCLUDED_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// An index over a fixed set of points, such as the places of one type, for
+/// finding the k nearest to a location. Points are bucketed on a square grid
+/// and buckets are searched in rings outward from the location's bucket until no
+/// unsearched bucket can hold anything nearer than the k found so far. Distances
+/// may be measured other than in the grid's coordinates, e.g. on the sphere, so
+/// long as they can be bounded below by how far apart the coordinates are.
+class SpatialGrid
+{
+	double x0_, y0_, bucket_size_;
+	int width_, height_;		// in buckets
+	std::vector<int> start_;	// Points in bucket b are at [start_[b], start_[b + 1]) in index_, x_ and y_
+	std::vector<int> index_;
+	std::vector<double> x_, y_;
+	std::vector<int> position_;	// position_[index] is where a point is in index_, x_ and y_
+
+	int bucket_x(double x) const { return std::min(width_ - 1, std::max(0, (int)std::floor((x - x0_) / bucket_size_))); }
+	int bucket_y(double y) const { return std::min(height_ - 1, std::max(0, (int)std::floor((y - y0_) / bucket_size_))); }
+
+public:
+
+	struct Neighbour
+	{
+		double dist2;
+		int index;
+	};
+
+	struct Scored
+	{
+		double score;
+		int index;
+	};
+
+	SpatialGrid() : x0_(0), y0_(0), bucket_size_(1), width_(0), height_(0) {}
+
+	/// \param x, y               Point coordinates; points are referred to by their index in these
+	/// \param points_per_bucket  Average number of points per bucket, were they spread evenly
+	SpatialGrid(std::vector<double> const& x, std::vector<double> const& y, double points_per_bucket = 4);
+
+	int size() const { return (int)index_.size(); }
+
+	/** \brief             Visit points in rings of buckets outward from a location.
+	 *  \param  x, y       Location to search from
+	 *  \param  stop       stop(separation) is called before each ring, and ends the search if it
+	 *                     returns true; no point in that ring or beyond has both coordinates
+	 *                     within \a separation of the location's
+	 *  \param  visit      visit(index) is called for each point in the ring
+	 */
+	template <typename Stop, typename Visit>
+	void search(double x, double y, Stop stop, Visit visit) const
+	{
+		if (index_.empty()) return;
+		int cx = bucket_x(x), cy = bucket_y(y);
+		int max_ring = std::max(std::max(cx, width_ - 1 - cx), std::max(cy, height_ - 1 - cy));
+		for (int ring = 0; ring <= max_ring; ring++)
+		{
+			// Points in this ring are at least ring - 1 buckets away.
+			if (stop(std::max(ring - 1, 0) * bucket_size_)) break;
+			for (int by = std::max(0, cy - ring); by <= std::min(height_ - 1, cy + ring); by++)
+			{
+				bool edge_row = (by == cy - ring) || (by == cy + ring);
+				for (int bx = cx - ring; bx <= cx + ring; bx += (edge_row ? 1 : 2 * ring))
+				{
+					if (bx < 0 || bx >= width_) continue;
+					int b = by * width_ + bx;
+					for (int i = start_[b]; i < start_[b + 1]; i++) visit(index_[i]);
+				}
+			}
+		}
+	}
+
+	/** \brief             Find the nearest points that are acceptable.
+	 *  \param  x, y       Location to search from
+	 *  \param  k          Number of points wanted
+	 *  \param  dist2      dist2(index) is the squared distance of a point from the location
+	 *  \param  min_dist2  min_dist2(separation) is at most dist2 for any point with an x or y
+	 *                     coordinate \a separation or more from the location's; non-decreasing
+	 *  \param  accept     accept(index) says whether a point may be chosen
+	 *  \param  result     Set to up to \a k points, nearest first, ties broken by index
+	 *
+	 *  \a accept is only called for points that are near enough to be chosen.
+	 */
+	template <typename Dist2, typename MinDist2, typename Accept>
+	void nearest(double x, double y, int k, Dist2 dist2, MinDist2 min_dist2, Accept accept, std::vector<Neighbour>& result) const
+	{
+		result.clear();
+		if (k <= 0) return;
+		// Heap ordering with the worst of the points found on top.
+		auto nearer = [](Neighbour const& a, Neighbour const& b) { return (a.dist2 < b.dist2) || ((a.dist2 == b.dist2) && (a.index < b.index)); };
+		search(x, y,
+			[&](double separation) { return ((int)result.size() == k) && (min_dist2(separation) > result.front().dist2); },
+			[&](int index)
+			{
+				Neighbour n = { dist2(index), index };
+				if (((int)result.size() == k) && !nearer(n, result.front())) return;
+				if (!accept(n.index)) return;
+				if ((int)result.size() == k)
+				{
+					std::pop_heap(result.begin(), result.end(), nearer);
+					result.back() = n;
+				}
+				else result.push_back(n);
+				std::push_heap(result.begin(), result.end(), nearer);
+			});
+		std::sort_heap(result.begin(), result.end(), nearer);
+	}
+
+	/// The nearest acceptable points by Euclidean distance; see above.
+	template <typename Accept>
+	void nearest(double x, double y, int k, Accept accept, std::vector<Neighbour>& result) const
+	{
+		nearest(x, y, k,
+			[this, x, y](int index) { int i = position_[index]; return (x_[i] - x) * (x_[i] - x) + (y_[i] - y) * (y_[i] - y); },
+			[](double separation) { return separation * separation; }, accept, result);
+	}
+
+	/** \brief             Find the points with the highest scores, such as kernel weighted traffic.
+	 *  \param  x, y       Location to search from
+	 *  \param  k          Number of points wanted
+	 *  \param  score      score(index) is a point's score
+	 *  \param  max_score  max_score(separation) is at least the score of any point with an x or
+	 *                     y coordinate \a separation or more from the location's; non-increasing
+	 *  \param  result     Set to up to \a k points, highest scores first, ties broken by index
+	 */
+	template <typename Score, typename MaxScore>
+	void best(double x, double y, int k, Score score, MaxScore max_score, std::vector<Scored>& result) const
+	{
+		result.clear();
+		if (k <= 0) return;
+		auto better = [](Scored const& a, Scored const& b) { return (a.score > b.score) || ((a.score == b.score) && (a.index < b.index)); };
+		search(x, y,
+			[&](double separation) { return ((int)result.size() == k) && (max_score(separation) < result.front().score); },
+			[&](int index)
+			{
+				Scored s = { score(index), index };
+				if ((int)result.size() == k)
+				{
+					if (!better(s, result.front())) return;
+					std::pop_heap(result.begin(), result.end(), better);
+					result.back() = s;
+				}
+				else result.push_back(s);
+				std::push_heap(result.begin(), result.end(), better);
+			});
+		std::sort_heap(result.begin(), result.end(), better);
+	}
+};
+
+#endif // COVIDSIM_SPATIALGRID_H_INCLUDED_
@@ -35,7 +35,7 @@ void TravelReturnSweep(double t)
 		l = 1 + floorOfTime % MAX_TRAVEL_TIME;
 		FILE* stderr_shared = stderr;
 #pragma omp parallel for reduction(+:nr, ner) schedule(static, 1) default(none) \
-			shared(P, Places, Hosts, l, stderr_shared)
+			shared(P, Places, Hosts, HostsState, l, stderr_shared)
 		for (int tn = 0; tn < P.NumThreads; tn++)
 		{
 			for (int j = tn; j < P.Nplace[P.HotelPlaceType]; j += P.NumThreads)
@@ -44,7 +44,7 @@ void TravelReturnSweep(double t)
 				for (int k = n - 1; k >= 0; k--)
 				{
 					int i = Places[P.HotelPlaceType][j].members[k];
-					if (Hosts[i].Travelling == l)
+					if (HostsState[i].Travelling == l)
 					{
 						n--;
 						/*						if((n<0)||(Places[P.HotelPlaceType][j].members[n]<0)||(Places[P.HotelPlaceType][j].members[n]>=P.PopSize))
@@ -64,7 +64,7 @@ void TravelReturnSweep(double t)
 							Files::xfprintf(stderr_shared, "(%i %i) ", j, Hosts[i].PlaceLinks[P.HotelPlaceType]);
 						}
 						Hosts[i].PlaceLinks[P.HotelPlaceType] = -1;
-						Hosts[i].Travelling = 0;
+						HostsState[i].Travelling = 0;
 					}
 				}
 				Places[P.HotelPlaceType][j].n = n;
@@ -90,7 +90,7 @@ void TravelDepartSweep(double t)
 		d = floorOfTime % MAX_TRAVEL_TIME;
 		nad = nld = nsk = 0;
 #pragma omp parallel for reduction(+:nad,nsk) schedule(static,1) default(none) \
-			shared(t, P, Airports, Mcells, Hosts, Places, bm, mps, d)
+			shared(t, P, Airports, Mcells, Hosts, HostsState, Places, bm, mps, d)
 		for (int tn = 0; tn < P.NumThreads; tn++)
 			for (int i = tn; i < P.Nairports; i += P.NumThreads)
 				if ((Airports[i].total_traffic > 0) && (Airports[i].num_mcell > 0))
@@ -111,11 +111,11 @@ void TravelDepartSweep(double t)
 						int i2 = Mcells[l].members[k];
 
 						// Original:
-						// if ((abs(Hosts[i2].inf) < InfStat::InfectiousAsymptomaticNotCase) && (Hosts[i2].inf != InfStat::Case))
+						// if ((abs(HostsState[i2].inf) < InfStat::InfectiousAsymptomaticNotCase) && (HostsState[i2].inf != InfStat::Case))
 						// but also note: above is equivalent to if ((abs(inf) < 2) && (inf != -2)),
 						// so if h were -2, it would fail the first case, and the second is redundant.
 
-						if (Hosts[i2].is_not_yet_symptomatic())
+						if (HostsState[i2].is_not_yet_symptomatic())
 						{
 							int d2 = HOST_AGE_GROUP(i2);
 							if ((P.RelativeTravelRate[d2] == 1) || (ranf_mt(tn) < P.RelativeTravelRate[d2]))
@@ -173,7 +173,7 @@ void TravelDepartSweep(double t)
 												Places[P.HotelPlaceType][l].members[hp] = i2;
 												d2 = (d + P.InvJourneyDurationDistrib[(int)(ranf_mt(tn) * 1024.0)]) % MAX_TRAVEL_TIME;
 												Hosts[i2].PlaceLinks[P.HotelPlaceType] = l;
-												Hosts[i2].Travelling = 1 + d2;
+												HostsState[i2].Travelling = 1 + d2;
 												nad++;
 												j++;
 											}
@@ -200,7 +200,7 @@ void TravelDepartSweep(double t)
 		nl = ((double)P.PlaceTypeMeanSize[P.HotelPlaceType]) * P.HotelPropLocal / P.MeanLocalJourneyTime;
 		nsk = 0;
 #pragma omp parallel for reduction(+:nld,nsk) schedule(static,1) default(none) \
-			shared(P, Places, Cells, CellLookup, Hosts, Households, nl, bm, mps, d)
+			shared(P, Places, Cells, CellLookup, Hosts, HostsState, Households, nl, bm, mps, d)
 		for (int tn = 0; tn < P.NumThreads; tn++)
 			for (int i = tn; i < P.Nplace[P.HotelPlaceType]; i += P.NumThreads)
 			{
@@ -227,7 +227,7 @@ void TravelDepartSweep(double t)
 							int i2 = ct->susceptible[m];
 							int d2 = HOST_AGE_GROUP(i2);
 							int f3 = 0;
-							if ((Hosts[i2].Travelling == 0) && ((P.RelativeTravelRate[d2] == 1) || (ranf_mt(tn) < P.RelativeTravelRate[d2])))
+							if ((HostsState[i2].Travelling == 0) && ((P.RelativeTravelRate[d2] == 1) || (ranf_mt(tn) < P.RelativeTravelRate[d2])))
 							{
 #pragma omp critical
 								{if (Hosts[i2].PlaceLinks[P.HotelPlaceType] == -1) { Hosts[i2].PlaceLinks[P.HotelPlaceType] = -2; f3 = 1; }}
@@ -261,7 +261,7 @@ void TravelDepartSweep(double t)
 										int hp = Places[P.HotelPlaceType][i].n;
 										Places[P.HotelPlaceType][i].n++;
 										Places[P.HotelPlaceType][i].members[hp] = i2;
-										Hosts[i2].Travelling = 1 + d2;
+										HostsState[i2].Travelling = 1 + d2;
 										nld++;
 #pragma omp critical
 										Hosts[i2].PlaceLinks[P.HotelPlaceType] = i;
@@ -303,7 +303,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 	FILE* stderr_shared = stderr;
 	
 #pragma omp parallel for private(CellQueue) schedule(static,1) default(none) \
-		shared(t, P, CellLookup, Hosts, AdUnits, Households, Places, SamplingQueue, Cells, Mcells, StateT, Household_Beta, SpatialSeasonal_Beta, seasonality, TimeStepNow, fp, BlanketMoveRestrInPlace, stderr_shared)
+		shared(t, P, CellLookup, Hosts, HostsState, AdUnits, Households, Places, SamplingQueue, Cells, Mcells, StateT, Household_Beta, SpatialSeasonal_Beta, seasonality, TimeStepNow, fp, BlanketMoveRestrInPlace, stderr_shared)
 	for (int ThreadNum = 0; ThreadNum < P.NumThreads; ThreadNum++)
 		for (int CellIndex = ThreadNum; CellIndex < P.NumPopulatedCells; CellIndex += P.NumThreads) //// loop over (in parallel) all populated cells. Loop 1)
 		{
@@ -317,6 +317,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 				int InfectiousPersonIndex = ThisCell->infected[InfectiousPersonIndex_ThisCell];
 				//// get InfectiousPerson from Hosts (array of people) corresponding to InfectiousPersonIndex, using pointer arithmetic.
 				Person* InfectiousPerson = Hosts + InfectiousPersonIndex;
+				PersonState* InfectiousPersonState = &HostsState[InfectiousPersonIndex];
 
 				//evaluate flag for digital contact tracing (DigiContactTrace_ThisPersonNow) here at the beginning for each individual
 				// DigiContactTrace_ThisPersonNow = 1 if:
@@ -326,7 +327,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 				// AND the selected host is a digital contact tracing user
 				// otherwise DigiContactTrace_ThisPersonNow = 0
 				bool DigiContactTrace_ThisPersonNow = ((P.DoDigitalContactTracing) && (t >= AdUnits[Mcells[InfectiousPerson->mcell].adunit].DigitalContactTracingTimeStart)
-					&& (t < AdUnits[Mcells[InfectiousPerson->mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[InfectiousPersonIndex].digitalContactTracingUser == 1)); // && (TimeStepNow <= (Hosts[InfectiousPersonIndex].detected_time + P.usCaseIsolationDelay)));
+					&& (t < AdUnits[Mcells[InfectiousPerson->mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[InfectiousPersonIndex].digitalContactTracingUser == 1)); // && (TimeStepNow <= (HostsState[InfectiousPersonIndex].detected_time + P.usCaseIsolationDelay)));
 
 				// BEGIN HOUSEHOLD INFECTIONS
 				
@@ -335,7 +336,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 					// For InfectiousPerson's household (InfectiousPerson->hh), 
 					// if the number of hosts (nh) in that Household is greater than 1
 					// AND the selected host is not travelling
-					if ((Households[InfectiousPerson->hh].nh > 1) && (!InfectiousPerson->Travelling))
+					if ((Households[InfectiousPerson->hh].nh > 1) && (!InfectiousPersonState->Travelling))
 					{
 						int FirstHouseholdMember = Households[InfectiousPerson->hh].FirstPerson;
 						int LastHouseholdMember = FirstHouseholdMember + Households[InfectiousPerson->hh].nh;
@@ -357,7 +358,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 						// Loop over household members
 						for (int HouseholdMember = FirstHouseholdMember; HouseholdMember < LastHouseholdMember; HouseholdMember++) //// loop over all people in household 
 						{
-							if (Hosts[HouseholdMember].is_susceptible() && (!Hosts[HouseholdMember].Travelling)) //// if people in household uninfected/susceptible and not travelling
+							if (HostsState[HouseholdMember].is_susceptible() && (!HostsState[HouseholdMember].Travelling)) //// if people in household uninfected/susceptible and not travelling
 							{
 								double Household_FOI = Household_Infectiousness * CalcHouseSusc(HouseholdMember, TimeStepNow, InfectiousPersonIndex);		//// Household force of infection (FOI = infectiousness x susceptibility) from person InfectiousPersonIndex/InfectiousPerson on fellow household member
 								
@@ -365,10 +366,10 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 								if (ranf_mt(ThreadNum) < Household_FOI)
 								{
 									// explicitly cast to short to resolve level 4 warning
-									const short int infect_type = static_cast<short int>(1 + INFECT_TYPE_MASK * (1 + InfectiousPerson->infect_type / INFECT_TYPE_MASK));
+									const short int infect_type = static_cast<short int>(1 + INFECT_TYPE_MASK * (1 + InfectiousPersonState->infect_type / INFECT_TYPE_MASK));
 
 									if (AddInfections(ThreadNum, Hosts[HouseholdMember].pcell % P.NumThreads, InfectiousPersonIndex, HouseholdMember, infect_type))
-										Hosts[HouseholdMember].infector = InfectiousPersonIndex; //// assign InfectiousPersonIndex as infector of person HouseholdMember
+										HostsState[HouseholdMember].infector = InfectiousPersonIndex; //// assign InfectiousPersonIndex as infector of person HouseholdMember
 								} // if FOI > random value between 0 and 1
 							} // if person in household uninfected/susceptible and not travelling
 						} // loop over people in household
@@ -412,7 +413,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 								// BEGIN NON-HOTEL INFECTIONS
 								
 								// if linked place isn't a hotel and selected host isn't travelling
-								if ((PlaceType != P.HotelPlaceType) && (!InfectiousPerson->Travelling))
+								if ((PlaceType != P.HotelPlaceType) && (!InfectiousPersonState->Travelling))
 								{
 									// PlaceGroupLink_index is index of group (of place type PlaceType) that selected host is linked to 
 									int PlaceGroupLink_index = (InfectiousPerson->PlaceGroupLinks[PlaceType]);
@@ -490,9 +491,9 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 											double PlaceSusceptibility_DCT_scaled = P.ProportionDigitalContactsIsolate * PlaceSusceptibility;
 											// if random number < PlaceSusceptibility_DCT_scaled
 											// AND number of contacts of InfectiousPersonIndex(!) is less than maximum digital contact to trace
-											if ((Hosts[InfectiousPersonIndex].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) <PlaceSusceptibility_DCT_scaled))
+											if ((HostsState[InfectiousPersonIndex].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) <PlaceSusceptibility_DCT_scaled))
 											{
-												Hosts[InfectiousPersonIndex].ncontacts++; //add to number of contacts made
+												HostsState[InfectiousPersonIndex].ncontacts++; //add to number of contacts made
 												int AdminUnit = Mcells[Hosts[PotentialInfectee_PlaceGroup].mcell].adunit;
 												if ((StateT[ThreadNum].ndct_queue[AdminUnit] < AdUnits[AdminUnit].n))
 												{
@@ -506,7 +507,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 											}
 										}
 
-										if (Hosts[PotentialInfectee_PlaceGroup].is_susceptible() && (!HOST_ABSENT(PotentialInfectee_PlaceGroup))) //// if person PotentialInfectee_PlaceGroup uninfected and not absent.
+										if (HostsState[PotentialInfectee_PlaceGroup].is_susceptible() && (!HOST_ABSENT(PotentialInfectee_PlaceGroup))) //// if person PotentialInfectee_PlaceGroup uninfected and not absent.
 										{
 											Microcell* MicroCell_PotentialInfectee_PlaceGroup = Mcells + Hosts[PotentialInfectee_PlaceGroup].mcell;
 											//downscale PlaceSusceptibility if it has been scaled up do to digital contact tracing
@@ -531,7 +532,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 											if ((PlaceSusceptibility == 1) || (ranf_mt(ThreadNum) < PlaceSusceptibility))
 											{
 												// explicitly cast to short to resolve level 4 warning
-												const short int infect_type = static_cast<short int> (2 + PlaceType + INFECT_TYPE_MASK * (1 + InfectiousPerson->infect_type / INFECT_TYPE_MASK));
+												const short int infect_type = static_cast<short int> (2 + PlaceType + INFECT_TYPE_MASK * (1 + InfectiousPersonState->infect_type / INFECT_TYPE_MASK));
 
 												AddInfections(ThreadNum, Hosts[PotentialInfectee_PlaceGroup].pcell % P.NumThreads, InfectiousPersonIndex, PotentialInfectee_PlaceGroup, infect_type);
 											}
@@ -542,7 +543,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 								
 								// BEGIN HOTEL INFECTIONS
 								// if InfectiousPerson is not travelling or selected link is to a hotel
-								if ((PlaceType == P.HotelPlaceType) || (!InfectiousPerson->Travelling))
+								if ((PlaceType == P.HotelPlaceType) || (!InfectiousPersonState->Travelling))
 								{
 									Place_Infectiousness *= P.PlaceTypePropBetweenGroupLinks[PlaceType] * P.PlaceTypeGroupSizeParam1[PlaceType] / ((double)Places[PlaceType][PlaceLink].n);
 									if (Place_Infectiousness > 1) Place_Infectiousness = 1;
@@ -586,9 +587,9 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 											// PlaceSusceptibility_DCT_scaled = place susceptibility * proportion of digital contacts who self isolate
 											double PlaceSusceptibility_DCT_scaled = P.ProportionDigitalContactsIsolate * PlaceSusceptibility;
 											// if number of contacts of infectious person < maximum and random number < PlaceSusceptibility_DCT_scaled
-											if ((Hosts[InfectiousPersonIndex].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) < PlaceSusceptibility_DCT_scaled))
+											if ((HostsState[InfectiousPersonIndex].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) < PlaceSusceptibility_DCT_scaled))
 											{
-												Hosts[InfectiousPersonIndex].ncontacts++; //add to number of contacts made
+												HostsState[InfectiousPersonIndex].ncontacts++; //add to number of contacts made
 												int ad = Mcells[Hosts[PotentialInfectee_Hotel].mcell].adunit;
 												// find adunit for contact and add both contact and infectious host to lists - storing both so I can set times later.
 												if ((StateT[ThreadNum].ndct_queue[ad] < AdUnits[ad].n))
@@ -598,7 +599,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 										}
 
 										// if potential infectee PotentialInfectee_Hotel uninfected and not absent.
-										if (Hosts[PotentialInfectee_Hotel].is_susceptible() && (!HOST_ABSENT(PotentialInfectee_Hotel)))
+										if (HostsState[PotentialInfectee_Hotel].is_susceptible() && (!HOST_ABSENT(PotentialInfectee_Hotel)))
 										{
 											// MicroCell_PotentialInfectee_Hotel = microcell of potential infectee
 											Microcell* MicroCell_PotentialInfectee_Hotel = Mcells + Hosts[PotentialInfectee_Hotel].mcell;
@@ -629,7 +630,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 											if ((PlaceSusceptibility == 1) || (ranf_mt(ThreadNum) < PlaceSusceptibility))
 											{
 												// explicitly cast to short to resolve level 4 warning
-												const short int infect_type = static_cast<short int> (2 + PlaceType + MAX_NUM_PLACE_TYPES + INFECT_TYPE_MASK * (1 + InfectiousPerson->infect_type / INFECT_TYPE_MASK));
+												const short int infect_type = static_cast<short int> (2 + PlaceType + MAX_NUM_PLACE_TYPES + INFECT_TYPE_MASK * (1 + InfectiousPersonState->infect_type / INFECT_TYPE_MASK));
 												
 												AddInfections(ThreadNum, Hosts[PotentialInfectee_Hotel].pcell% P.NumThreads, InfectiousPersonIndex, PotentialInfectee_Hotel, infect_type);
 											} // susceptibility test
@@ -656,7 +657,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 				if (SpatialSeasonal_Beta > 0) 
 				{
 					double SpatialInf_ThisPerson; 
-					if (InfectiousPerson->Travelling) //// if host currently away from their cell, they cannot add to their cell's spatial infectiousness.
+					if (InfectiousPersonState->Travelling) //// if host currently away from their cell, they cannot add to their cell's spatial infectiousness.
 						SpatialInf_ThisPerson = 0; 
 					else
 					{
@@ -743,10 +744,11 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 					int PotentialInfector_Index = ThisCell->infected[PotentialInfector_CellIndex];
 					// PotentialInfector_Spatial is the jth infected person in the cell
 					Person* PotentialInfector_Spatial = Hosts + PotentialInfector_Index;
+					PersonState* PotentialInfectorState_Spatial = &HostsState[PotentialInfector_Index];
 
 					//calculate flag (DigiContactTrace_ThisPersonNow) for digital contact tracing here at the beginning for each individual infector
 					bool DigiContactTrace_ThisPersonNow = ((P.DoDigitalContactTracing) && (t >= AdUnits[Mcells[PotentialInfector_Spatial->mcell].adunit].DigitalContactTracingTimeStart)
-						&& (t < AdUnits[Mcells[PotentialInfector_Spatial->mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[PotentialInfector_Index].digitalContactTracingUser == 1)); // && (TimeStepNow <= (Hosts[PotentialInfector_Spatial].detected_time + P.usCaseIsolationDelay)));
+						&& (t < AdUnits[Mcells[PotentialInfector_Spatial->mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[PotentialInfector_Index].digitalContactTracingUser == 1)); // && (TimeStepNow <= (HostsState[PotentialInfector_Spatial].detected_time + P.usCaseIsolationDelay)));
 
 					//// decide on infectee
 					
@@ -773,7 +775,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 						// initialise KeepSearchingForCellToInfect = 0 (KeepSearchingForCellToInfect = 1 is the while condition for this loop)
 						KeepSearchingForCellToInfect = 0;
 						// if random number greater than acceptance probablility or infectee is dead
-						if ((ranf_mt(ThreadNum) >= AcceptProb) || Hosts[PotentialInfectee_Spatial].is_dead()) //// if rejected, or infectee PotentialInfectee_Spatial/SusceptiblePerson already dead, ensure do-while evaluated again (i.e. choose a new infectee).
+						if ((ranf_mt(ThreadNum) >= AcceptProb) || HostsState[PotentialInfectee_Spatial].is_dead()) //// if rejected, or infectee PotentialInfectee_Spatial/SusceptiblePerson already dead, ensure do-while evaluated again (i.e. choose a new infectee).
 						{
 							// set KeepSearchingForCellToInfect = 1 so loop continues (i.e. another PotentialInfectee_Spatial will be chosen)
 							KeepSearchingForCellToInfect = 1;
@@ -781,7 +783,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 						else
 						{
 							//// if potential infectee not travelling, and either is not part of cell ThisCell or doesn't share a household with infector.
-							if ((!Hosts[PotentialInfectee_Spatial].Travelling) && ((ThisCell != ct) || (Hosts[PotentialInfectee_Spatial].hh != PotentialInfector_Spatial->hh)))
+							if ((!HostsState[PotentialInfectee_Spatial].Travelling) && ((ThisCell != ct) || (Hosts[PotentialInfectee_Spatial].hh != PotentialInfector_Spatial->hh)))
 							{
 								// pick microcell of infector (Microcell_PotentialInfector)
 								Microcell* Microcell_PotentialInfector = Mcells + PotentialInfector_Spatial->mcell;
@@ -796,9 +798,9 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 									//if infectee is also a user, add them as a contact
 									if (Hosts[PotentialInfectee_Spatial].digitalContactTracingUser && (PotentialInfector_Index != PotentialInfectee_Spatial))
 									{
-										if ((Hosts[PotentialInfector_Index].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) < Spatial_Susc * P.ProportionDigitalContactsIsolate))
+										if ((HostsState[PotentialInfector_Index].ncontacts < P.MaxDigitalContactsToTrace) && (ranf_mt(ThreadNum) < Spatial_Susc * P.ProportionDigitalContactsIsolate))
 										{
-											Hosts[PotentialInfector_Index].ncontacts++; //add to number of contacts made
+											HostsState[PotentialInfector_Index].ncontacts++; //add to number of contacts made
 											int ad = Mcells[Hosts[PotentialInfectee_Spatial].mcell].adunit;
 											if ((StateT[ThreadNum].ndct_queue[ad] < AdUnits[ad].n))
 											{
@@ -840,10 +842,10 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 									{
 										CellQueue = ((int)(ct - Cells)) % P.NumThreads;
 
-										if (Hosts[PotentialInfectee_Spatial].is_susceptible())
+										if (HostsState[PotentialInfectee_Spatial].is_susceptible())
 										{
 											// explicitly cast to short to resolve level 4 warning
-											const short int infect_type = static_cast<short int>(2 + 2 * MAX_NUM_PLACE_TYPES + INFECT_TYPE_MASK * (1 + PotentialInfector_Spatial->infect_type / INFECT_TYPE_MASK));
+											const short int infect_type = static_cast<short int>(2 + 2 * MAX_NUM_PLACE_TYPES + INFECT_TYPE_MASK * (1 + PotentialInfectorState_Spatial->infect_type / INFECT_TYPE_MASK));
 											
 											AddInfections(ThreadNum, CellQueue, PotentialInfector_Index, PotentialInfectee_Spatial, infect_type);
 										}
@@ -858,7 +860,7 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 
 
 #pragma omp parallel for schedule(static,1) default(none) \
-		shared(t, run, P, StateT, Hosts, TimeStepNow)
+		shared(t, run, P, StateT, Hosts, HostsState, TimeStepNow)
 	for (int j = 0; j < P.NumThreads; j++)
 	{
 		for (int k = 0; k < P.NumThreads; k++)
@@ -868,8 +870,8 @@ void InfectSweep(double t, int run) // added run number as argument in order to
 				int infector			= StateT[k].inf_queue[j][i].infector;
 				int infectee			= StateT[k].inf_queue[j][i].infectee;
 				short int infect_type	= StateT[k].inf_queue[j][i].infect_type;
-				Hosts[infectee].infector = infector;
-				Hosts[infectee].infect_type = infect_type;
+				HostsState[infectee].infector = infector;
+				HostsState[infectee].infect_type = infect_type;
 				if (infect_type == -1) //// i.e. if host doesn't have an infector
 					DoFalseCase(infectee, t, TimeStepNow, j);
 				else
@@ -895,7 +897,7 @@ void IncubRecoverySweep(double t)
 //				Files::xfprintf_stderr("Holiday %HolidayNumber t=%lg\n", HolidayNumber, t);
 				for (int PlaceType = 0; PlaceType < P.NumPlaceTypes; PlaceType++)
 				{
-#pragma omp parallel for schedule(static,1) default(none) shared(P, Places, Hosts, HolidayNumber, PlaceType, ht)
+#pragma omp parallel for schedule(static,1) default(none) shared(P, Places, HostsState, HolidayNumber, PlaceType, ht)
 					for (int ThreadNum = 0; ThreadNum < P.NumThreads; ThreadNum++)
 						for (int PlaceNumber = ThreadNum; PlaceNumber < P.Nplace[PlaceType]; PlaceNumber += P.NumThreads)
 						{
@@ -908,8 +910,8 @@ void IncubRecoverySweep(double t)
 
 								for (int PlaceMember = 0; PlaceMember < Places[PlaceType][PlaceNumber].n; PlaceMember++)
 								{
-									if (Hosts[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_start_time	> HolidayStart	) Hosts[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_start_time	= (unsigned short) HolidayStart;
-									if (Hosts[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_stop_time		< HolidayEnd	) Hosts[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_stop_time	= (unsigned short) HolidayEnd;
+									if (HostsState[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_start_time	> HolidayStart	) HostsState[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_start_time	= (unsigned short) HolidayStart;
+									if (HostsState[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_stop_time		< HolidayEnd	) HostsState[Places[PlaceType][PlaceNumber].members[PlaceMember]].absent_stop_time	= (unsigned short) HolidayEnd;
 								}
 							}
 						}
@@ -917,19 +919,19 @@ void IncubRecoverySweep(double t)
 			}
 		}
 
-#pragma omp parallel for schedule(static,1) default(none) shared(t, P, CellLookup, Hosts, AdUnits, Mcells, StateT, TimeStepNow)
+#pragma omp parallel for schedule(static,1) default(none) shared(t, P, CellLookup, Hosts, HostsState, AdUnits, Mcells, StateT, TimeStepNow)
 	for (int ThreadNum = 0; ThreadNum < P.NumThreads; ThreadNum++)	//// loop over threads
 		for (int CellIndex = ThreadNum; CellIndex < P.NumPopulatedCells; CellIndex += P.NumThreads)	//// loop/step over populated cells
 		{
 			Cell* ThisCell = CellLookup[CellIndex]; //// find (pointer-to) ThisCell.
 			for (int LatentPerson = ((int)ThisCell->L - 1); LatentPerson >= 0; LatentPerson--) //// loop backwards over latently infected people, hence it starts from L - 1 and goes to zero. Runs backwards because of pointer swapping?
-				if (TimeStepNow == Hosts[ThisCell->latent[LatentPerson]].latent_time) //// if now after time at which person became infectious (latent_time a slight misnomer).
+				if (TimeStepNow == HostsState[ThisCell->latent[LatentPerson]].latent_time) //// if now after time at which person became infectious (latent_time a slight misnomer).
 					DoIncub(ThisCell->latent[LatentPerson], TimeStepNow, ThreadNum); //// move infected person from latently infected (L) to infectious (I), but not symptomatic
 
 			for (int InfeciousPersonIndexWithinCell = ThisCell->I - 1; InfeciousPersonIndexWithinCell >= 0; InfeciousPersonIndexWithinCell--) ///// loop backwards over Infectious people. Runs backwards because of pointer swapping?
 			{
 				int InfectiousPersonIndex = ThisCell->infected[InfeciousPersonIndexWithinCell];	//// person index
-				Person* InfectiousPerson = Hosts + InfectiousPersonIndex;	//// person
+				PersonState* InfectiousPerson = &HostsState[InfectiousPersonIndex];	//// person
 
 				unsigned short int CaseTime; //// time at which person becomes case (i.e. moves from infectious and asymptomatic to infectious and symptomatic).
 				CaseTime = InfectiousPerson->latent_time + ((int)(P.LatentToSymptDelay / P.ModelTimeStep)); //// time that person si/ci becomes case (symptomatic)...
@@ -967,11 +969,11 @@ void IncubRecoverySweep(double t)
 					}
 
 					//once host recovers, will no longer make contacts for contact tracing - if we are doing contact tracing and case was infectious when contact tracing was active, increment state vector
-					if ((P.DoDigitalContactTracing) && (Hosts[InfectiousPersonIndex].latent_time>= AdUnits[Mcells[Hosts[InfectiousPersonIndex].mcell].adunit].DigitalContactTracingTimeStart) && (Hosts[InfectiousPersonIndex].recovery_or_death_time < AdUnits[Mcells[Hosts[InfectiousPersonIndex].mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[InfectiousPersonIndex].digitalContactTracingUser == 1) && (P.OutputDigitalContactDist))
+					if ((P.DoDigitalContactTracing) && (HostsState[InfectiousPersonIndex].latent_time>= AdUnits[Mcells[Hosts[InfectiousPersonIndex].mcell].adunit].DigitalContactTracingTimeStart) && (HostsState[InfectiousPersonIndex].recovery_or_death_time < AdUnits[Mcells[Hosts[InfectiousPersonIndex].mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration) && (Hosts[InfectiousPersonIndex].digitalContactTracingUser == 1) && (P.OutputDigitalContactDist))
 					{
-						if (Hosts[InfectiousPersonIndex].ncontacts > MAX_CONTACTS) Hosts[InfectiousPersonIndex].ncontacts = MAX_CONTACTS;
+						if (HostsState[InfectiousPersonIndex].ncontacts > MAX_CONTACTS) HostsState[InfectiousPersonIndex].ncontacts = MAX_CONTACTS;
 						//increment bin in State corresponding to this number of contacts
-						StateT[ThreadNum].contact_dist[Hosts[InfectiousPersonIndex].ncontacts]++;
+						StateT[ThreadNum].contact_dist[HostsState[InfectiousPersonIndex].ncontacts]++;
 					}
 				}
 			}
@@ -996,7 +998,7 @@ void DigitalContactTracingSweep(double t)
 
 	FILE* stderr_shared = stderr;
 #pragma omp parallel for schedule(static,1) default(none) \
-		shared(t, P, AdUnits, StateT, Hosts, TimeStepNow, stderr_shared)
+		shared(t, P, AdUnits, StateT, Hosts, HostsState, TimeStepNow, stderr_shared)
 	for (int tn = 0; tn < P.NumThreads; tn++)
 	{
 		for (int i = tn; i < P.NumAdunits; i += P.NumThreads)
@@ -1019,7 +1021,7 @@ void DigitalContactTracingSweep(double t)
 						if (infector==-1)
 						{
 							//i.e. this is an index case that has been detected by becoming symptomatic and added to the digital contact tracing queue
-							dct_start_time = Hosts[contact].dct_trigger_time; //trigger time for these cases is set in DoIncub and already accounts for delay between onset and isolation
+							dct_start_time = HostsState[contact].dct_trigger_time; //trigger time for these cases is set in DoIncub and already accounts for delay between onset and isolation
 							dct_end_time = dct_start_time + (unsigned short int)(P.LengthDigitalContactIsolation * P.TimeStepsPerDay);
 
 						}
@@ -1027,9 +1029,9 @@ void DigitalContactTracingSweep(double t)
 						{
 							//trigger times are either set in DoDetectedCase or in the loop below (for asymptomatic and presymptomatic cases that are picked up via testing
 							//If the contact's index case has a trigger time that means that they have been detected, and we can calculate start and end isolation times for the contact.
-							if (Hosts[infector].dct_trigger_time < (USHRT_MAX - 1))
+							if (HostsState[infector].dct_trigger_time < (USHRT_MAX - 1))
 							{
-								if (contact_time > Hosts[infector].dct_trigger_time)
+								if (contact_time > HostsState[infector].dct_trigger_time)
 								{
 									//if the contact time was made after host detected, we should use the later time
 									dct_start_time = contact_time + (unsigned short int) (P.DigitalContactTracingDelay * P.TimeStepsPerDay);
@@ -1037,7 +1039,7 @@ void DigitalContactTracingSweep(double t)
 								else
 								{
 									//if the contact time was made before or at the same time as detection, use the trigger time instead
-									dct_start_time = Hosts[infector].dct_trigger_time + (unsigned short int) (P.DigitalContactTracingDelay * P.TimeStepsPerDay);
+									dct_start_time = HostsState[infector].dct_trigger_time + (unsigned short int) (P.DigitalContactTracingDelay * P.TimeStepsPerDay);
 								}
 								dct_end_time = dct_start_time + (unsigned short int)(P.LengthDigitalContactIsolation * P.TimeStepsPerDay);
 							}
@@ -1046,7 +1048,7 @@ void DigitalContactTracingSweep(double t)
 								dct_start_time = USHRT_MAX - 1; //for contacts of asymptomatic or presymptomatic cases - they won't get added as their index case won't know that they are infected (unless explicitly tested)
 								//but we keep them in the queue in case their index case is detected as the contact of someone else and gets their trigger time set
 								//set dct_end_time to recovery time of infector, in order to remove from queue if their infector isn't detected before they recover.
-								dct_end_time = Hosts[infector].recovery_or_death_time;
+								dct_end_time = HostsState[infector].recovery_or_death_time;
 							}
 						}
 
@@ -1054,20 +1056,20 @@ void DigitalContactTracingSweep(double t)
 						if (dct_start_time == TimeStepNow)
 						{
 							//if the host has been detected due to being symptomatic, they are now an index case - set this variable now. For index cases detected by testing, this will be set on testing
-							if ((infector==-1) && (Hosts[contact].index_case_dct == 0)) //don't really need the second condition as the first should only be true when the second isn't (due to how this contact is logged in DoDetectedCase)
+							if ((infector==-1) && (HostsState[contact].index_case_dct == 0)) //don't really need the second condition as the first should only be true when the second isn't (due to how this contact is logged in DoDetectedCase)
 							{
-								Hosts[contact].index_case_dct = 1; //assign them as an index case
+								HostsState[contact].index_case_dct = 1; //assign them as an index case
 							}
 
 							//if contact is not being traced at all
-							if (Hosts[contact].digitalContactTraced == 0)
+							if (HostsState[contact].digitalContactTraced == 0)
 							{
 								//move into the contact tracing list for that admin unit, set start and end times, update flag and remove from queue
 								if (AdUnits[i].ndct < AdUnits[i].n) //AdUnits[i].n is length of queue
 								{
-									Hosts[contact].dct_start_time = dct_start_time;
-									Hosts[contact].dct_end_time = dct_end_time;
-									Hosts[contact].digitalContactTraced = 1;
+									HostsState[contact].dct_start_time = dct_start_time;
+									HostsState[contact].dct_end_time = dct_end_time;
+									HostsState[contact].digitalContactTraced = 1;
 									// At this point, we do testing on index cases who have been picked up on symptoms alone, in order to figure out whether and when
 									// to remove their contacts (if P.RemoveContactsOfNegativeIndexCase). It's much harder to do it in the next loop as we don't have all
 									// the information about the contact event there and would need to loop over all contacts again to look for their index case
@@ -1075,19 +1077,19 @@ void DigitalContactTracingSweep(double t)
 									// Only set test times if P.DoDCTTest. If P.DoDCTTest==0, but we are finding contacts of contacts, we check to see if contacts should become index cases every day they are in isolation.
 									if (P.DoDCTTest)
 									{
-										if (Hosts[contact].index_case_dct == 1)
+										if (HostsState[contact].index_case_dct == 1)
 										{
 											//set testing time (which has a different delay to contact testing delay), but no need to set index_case link
-											Hosts[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay);
+											HostsState[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay);
 											//if host is infectious at test time
-											if ((Hosts[contact].dct_test_time >= Hosts[contact].latent_time) && (Hosts[contact].dct_test_time < Hosts[contact].recovery_or_death_time))
+											if ((HostsState[contact].dct_test_time >= HostsState[contact].latent_time) && (HostsState[contact].dct_test_time < HostsState[contact].recovery_or_death_time))
 											{
 												//if false negative, remove from queue by setting the end time to the test time
 												if ((P.SensitivityDCT == 0) || ((P.SensitivityDCT < 1) && (ranf_mt(tn) >= P.SensitivityDCT)))
 												{
-													Hosts[contact].dct_end_time = Hosts[contact].dct_test_time;
+													HostsState[contact].dct_end_time = HostsState[contact].dct_test_time;
 													//set index_dct_flag to 2 to indicate that contacts should be removed, if we are removing based on negative test result of index case
-													if (P.RemoveContactsOfNegativeIndexCase) Hosts[contact].index_case_dct = 2;
+													if (P.RemoveContactsOfNegativeIndexCase) HostsState[contact].index_case_dct = 2;
 												}
 											}
 											//if host is non-infectious)
@@ -1097,23 +1099,23 @@ void DigitalContactTracingSweep(double t)
 												if ((P.SpecificityDCT == 1) || ((P.SpecificityDCT > 0) && (ranf_mt(tn) < P.SpecificityDCT)))
 												{
 													//again mark them to be removed from list at test time rather than end_time, and change index_case_dct flag
-													Hosts[contact].dct_end_time = Hosts[contact].dct_test_time;
-													if (P.RemoveContactsOfNegativeIndexCase) Hosts[contact].index_case_dct = 2;
+													HostsState[contact].dct_end_time = HostsState[contact].dct_test_time;
+													if (P.RemoveContactsOfNegativeIndexCase) HostsState[contact].index_case_dct = 2;
 												}
 											}
 										}
-										else if (Hosts[contact].index_case_dct == 0)
+										else if (HostsState[contact].index_case_dct == 0)
 										{
 											//if their infector is set to be removed from the list at test time, and their contacts will also be removed at this stage
-											if ((Hosts[infector].index_case_dct == 2) && (P.RemoveContactsOfNegativeIndexCase))
+											if ((HostsState[infector].index_case_dct == 2) && (P.RemoveContactsOfNegativeIndexCase))
 											{
 												//set end time to match end time of infector
-												Hosts[contact].dct_end_time = Hosts[infector].dct_end_time;
+												HostsState[contact].dct_end_time = HostsState[infector].dct_end_time;
 											}
 											else
 											{
 												//set testing time
-												Hosts[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestDCTContacts * P.TimeStepsPerDay);
+												HostsState[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestDCTContacts * P.TimeStepsPerDay);
 											}
 										}
 									}
@@ -1139,26 +1141,26 @@ void DigitalContactTracingSweep(double t)
 								}
 							}
 							//else if contact is already being contact traced
-							else if (Hosts[contact].digitalContactTraced == 1)
+							else if (HostsState[contact].digitalContactTraced == 1)
 							{
 								if (P.DoDCTTest)
 								{
 									//if case has been detected due to being symptomatic, then we will update their testing time if they would be tested earlier based on being an index case as opposed to being a contact of another case
 									//If they are already being contact traced and testing is on, they should have been set a test_time
-									if ((Hosts[contact].index_case_dct == 1) && (Hosts[contact].dct_test_time > (dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay))))
+									if ((HostsState[contact].index_case_dct == 1) && (HostsState[contact].dct_test_time > (dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay))))
 									{
-										Hosts[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay);
+										HostsState[contact].dct_test_time = dct_start_time + (unsigned short int)(P.DelayToTestIndexCase * P.TimeStepsPerDay);
 										//update end time (which is always at least equal to, but may be later that the current one)
-										Hosts[contact].dct_end_time = dct_end_time;
+										HostsState[contact].dct_end_time = dct_end_time;
 										//check to see if test will be negative, if so, tag them for early removal and update index_dct_flag
-										if ((Hosts[contact].dct_test_time >= Hosts[contact].latent_time) && (Hosts[contact].dct_test_time < Hosts[contact].recovery_or_death_time))
+										if ((HostsState[contact].dct_test_time >= HostsState[contact].latent_time) && (HostsState[contact].dct_test_time < HostsState[contact].recovery_or_death_time))
 										{
 											//if false negative, remove from
 											if ((P.SensitivityDCT == 0) || ((P.SensitivityDCT < 1) && (ranf_mt(tn) >= P.SensitivityDCT)))
 											{
-												Hosts[contact].dct_end_time = Hosts[contact].dct_test_time;
+												HostsState[contact].dct_end_time = HostsState[contact].dct_test_time;
 												//set index_dct_flag to 2 to indicate that contacts should be removed
-												if (P.RemoveContactsOfNegativeIndexCase) Hosts[contact].index_case_dct = 2;
+												if (P.RemoveContactsOfNegativeIndexCase) HostsState[contact].index_case_dct = 2;
 											}
 										}
 										//if host is non-infectious
@@ -1168,8 +1170,8 @@ void DigitalContactTracingSweep(double t)
 											if ((P.SpecificityDCT == 1) || ((P.SpecificityDCT > 0) && (ranf_mt(tn) < P.SpecificityDCT)))
 											{
 												//again mark them to be removed from list at test time rather than end_time, and change index_case_dct flag
-												Hosts[contact].dct_end_time = Hosts[contact].dct_test_time;
-												if (P.RemoveContactsOfNegativeIndexCase) Hosts[contact].index_case_dct = 2;
+												HostsState[contact].dct_end_time = HostsState[contact].dct_test_time;
+												if (P.RemoveContactsOfNegativeIndexCase) HostsState[contact].index_case_dct = 2;
 											}
 										}
 									}
@@ -1177,10 +1179,10 @@ void DigitalContactTracingSweep(double t)
 									{
 										//we don't want to remove this contact if they are also linked to another case - their testing time shouldn't change.
 										//but we'll only extend their end time if they wouldn't potentially be removed by having a negative contact
-										if ((!P.RemoveContactsOfNegativeIndexCase) || ((P.RemoveContactsOfNegativeIndexCase) && (Hosts[infector].index_case_dct == 1)))
+										if ((!P.RemoveContactsOfNegativeIndexCase) || ((P.RemoveContactsOfNegativeIndexCase) && (HostsState[infector].index_case_dct == 1)))
 										{
 											//extend end time
-											Hosts[contact].dct_end_time = dct_end_time;
+											HostsState[contact].dct_end_time = dct_end_time;
 										}
 										//otherwise if contact would have been removed if they didn't have another contact, we keep their original end time
 									}
@@ -1189,7 +1191,7 @@ void DigitalContactTracingSweep(double t)
 								else
 								{
 									//just extend the isolation end time, but we're not going to update testing time or as we still want the testing time to be dependent on the earlier contact.
-									Hosts[contact].dct_end_time = dct_end_time; //we could choose to not extend the time for cases who are index cases. If they are tested and are negative, they'd be removed earlier anyway. If positive, they will stay isolated for a bit longer
+									HostsState[contact].dct_end_time = dct_end_time; //we could choose to not extend the time for cases who are index cases. If they are tested and are negative, they'd be removed earlier anyway. If positive, they will stay isolated for a bit longer
 
 								}
 								//now remove this case from the queue
@@ -1218,7 +1220,7 @@ void DigitalContactTracingSweep(double t)
 	}
 
 #pragma omp parallel for schedule(static,1) default(none) \
-		shared(t, P, AdUnits, Hosts, TimeStepNow)
+		shared(t, P, AdUnits, Hosts, HostsState, TimeStepNow)
 	for (int tn = 0; tn < P.NumThreads; tn++)
 	{
 		for (int i = tn; i < P.NumAdunits; i += P.NumThreads)
@@ -1232,30 +1234,30 @@ void DigitalContactTracingSweep(double t)
 					//first do testing of index cases and their contacts
 					if (P.DoDCTTest)
 					{
-						if ((Hosts[contact].dct_test_time == TimeStepNow) && (Hosts[contact].index_case_dct == 0))
+						if ((HostsState[contact].dct_test_time == TimeStepNow) && (HostsState[contact].index_case_dct == 0))
 						{
 							//if host is positive
-							if (Hosts[contact].is_infectious_asymptomatic_not_case() ||
-								Hosts[contact].is_case() ||
-								Hosts[contact].is_infectious_almost_symptomatic())
+							if (HostsState[contact].is_infectious_asymptomatic_not_case() ||
+								HostsState[contact].is_case() ||
+								HostsState[contact].is_infectious_almost_symptomatic())
 							{
 								//if the test is a false negative
 								if ((P.SensitivityDCT == 0) || ((P.SensitivityDCT < 1) && (ranf_mt(tn) >= P.SensitivityDCT)))
 								{
-									Hosts[contact].dct_end_time = TimeStepNow;
+									HostsState[contact].dct_end_time = TimeStepNow;
 								}
 								//else if a true positive
 								else if (P.FindContactsOfDCTContacts)
 								{
 									//set them to be an index case
-									Hosts[contact].index_case_dct = 1;
+									HostsState[contact].index_case_dct = 1;
 									//set trigger time to pick up their contacts in the next time step
-									Hosts[contact].dct_trigger_time = TimeStepNow + 1; //added the +1 here so that if there are no delays, the contacts will still get picked up correctly
+									HostsState[contact].dct_trigger_time = TimeStepNow + 1; //added the +1 here so that if there are no delays, the contacts will still get picked up correctly
 									//if they are an infectious, asymptomatic non-case, call DoDetectedCase in order to trigger HQ and PC too.
-									if (Hosts[contact].is_infectious_asymptomatic_not_case())
+									if (HostsState[contact].is_infectious_asymptomatic_not_case())
 									{
 										DoDetectedCase(contact, t, TimeStepNow, tn);
-										Hosts[contact].detected = 1; Hosts[contact].detected_time = TimeStepNow;
+										HostsState[contact].detected = 1; HostsState[contact].detected_time = TimeStepNow;
 									}
 								}
 							}
@@ -1265,7 +1267,7 @@ void DigitalContactTracingSweep(double t)
 								//and is a true negative
 								if ((P.SpecificityDCT == 1) || ((P.SpecificityDCT > 0) && (ranf_mt(tn) < P.SpecificityDCT)))
 								{
-									Hosts[contact].dct_end_time = TimeStepNow;
+									HostsState[contact].dct_end_time = TimeStepNow;
 								}
 								//can't track contacts of false positives as they don't make any contacts in InfectSweep
 							}
@@ -1274,35 +1276,35 @@ void DigitalContactTracingSweep(double t)
 					else if (P.FindContactsOfDCTContacts)
 					{
 						//check every day to see if contacts become index cases - but they have to be infectious. Otherwise we could set the trigger time and cause their contacts to be traced when they are not being traced themselves.
-						if ((Hosts[contact].index_case_dct == 0) && (
-							Hosts[contact].is_infectious_almost_symptomatic() ||
-							Hosts[contact].is_case() ||
-							Hosts[contact].is_infectious_almost_symptomatic()))
-							//if ((Hosts[contact].dct_test_time == TimeStepNow) && (Hosts[contact].index_case_dct == 0) && ((abs(Hosts[contact].inf) == 2) || (Hosts[contact].inf == -1)))
+						if ((HostsState[contact].index_case_dct == 0) && (
+							HostsState[contact].is_infectious_almost_symptomatic() ||
+							HostsState[contact].is_case() ||
+							HostsState[contact].is_infectious_almost_symptomatic()))
+							//if ((HostsState[contact].dct_test_time == TimeStepNow) && (HostsState[contact].index_case_dct == 0) && ((abs(HostsState[contact].inf) == 2) || (HostsState[contact].inf == -1)))
 						{
 							//set them to be an index case
-							Hosts[contact].index_case_dct = 1;
+							HostsState[contact].index_case_dct = 1;
 							//set trigger time to pick up their contacts in the next time step
-							Hosts[contact].dct_trigger_time = TimeStepNow + 1; //added the +1 here so that if there are no delays, the contacts will still get picked up correctly
+							HostsState[contact].dct_trigger_time = TimeStepNow + 1; //added the +1 here so that if there are no delays, the contacts will still get picked up correctly
 							//if they are asymptomatic, i.e. specifically if they have inf flag 2, call DoDetectedCase in order to trigger HQ and PC too.
-							if (Hosts[contact].is_infectious_asymptomatic_not_case())
+							if (HostsState[contact].is_infectious_asymptomatic_not_case())
 							{
 								DoDetectedCase(contact, t, TimeStepNow, tn);
-								Hosts[contact].detected = 1; Hosts[contact].detected_time = TimeStepNow;
+								HostsState[contact].detected = 1; HostsState[contact].detected_time = TimeStepNow;
 							}
 						}
 					}
 
 					//now remove hosts who have reached the end of their isolation time
-					if (Hosts[contact].dct_end_time == TimeStepNow)
+					if (HostsState[contact].dct_end_time == TimeStepNow)
 					{
 						//stop contact tracing this host
-						Hosts[contact].digitalContactTraced = 0;
+						HostsState[contact].digitalContactTraced = 0;
 						//remove index_case_dct flag to 0;
-						if (Hosts[contact].index_case_dct)
+						if (HostsState[contact].index_case_dct)
 						{
-							Hosts[contact].index_case_dct = 0;
-							//Hosts[contact].dct_trigger_time = USHRT_MAX - 1;
+							HostsState[contact].index_case_dct = 0;
+							//HostsState[contact].dct_trigger_time = USHRT_MAX - 1;
 						}
 
 						//remove from list
@@ -1353,7 +1355,7 @@ int TreatSweep(double t)
 		t_TreatEnd = (unsigned short int) (P.TimeStepsPerDay * (t + P.TreatDelayMean + P.TreatProphCourseLength));
 
 #pragma omp parallel for private(TreatFlag) reduction(+:TreatFlag1) schedule(static,1) default(none) \
-			shared(P, StateT, Places, Hosts, TimeStepNow, t_TreatEnd)
+			shared(P, StateT, Places, Hosts, HostsState, TimeStepNow, t_TreatEnd)
 		for (int Thread = 0; Thread < P.NumThreads; Thread++)
 			for (int PlaceType = 0; PlaceType < P.NumPlaceTypes; PlaceType++)
 			{
@@ -1432,7 +1434,7 @@ int TreatSweep(double t)
 		nckwp = (int)ceil(P.KeyWorkerProphDuration / P.TreatProphCourseLength);
 
 #pragma omp parallel for private(radius) reduction(+:TreatFlag) schedule(static,1) default(none) \
-			shared(t, P, Hosts, Mcells, McellLookup, AdUnits, State, global_trig, TimeStepNow, t_TreatEnd, t_TreatStart, t_VacStart, t_PlaceClosure_End, t_MoveRestrict_End, t_MoveRestrict_Start, t_SocDist_End, t_KeyWorkerPlaceClosure_End, nckwp)
+			shared(t, P, Hosts, HostsState, Mcells, McellLookup, AdUnits, State, global_trig, TimeStepNow, t_TreatEnd, t_TreatStart, t_VacStart, t_PlaceClosure_End, t_MoveRestrict_End, t_MoveRestrict_Start, t_SocDist_End, t_KeyWorkerPlaceClosure_End, nckwp)
 		for (int ThreadNum = 0; ThreadNum < P.NumThreads; ThreadNum++)
 			for (int PopulatedMicroCellNum = ThreadNum; PopulatedMicroCellNum < P.NumPopulatedMicrocells; PopulatedMicroCellNum += P.NumThreads) //// loop over populated microcells
 			{
@@ -53,16 +53,17 @@ void DoImmune(int ai)
 	int c;
 
 	Person* a = Hosts + ai;
-	if (a->is_susceptible())
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->is_susceptible())
 	{
 		c = a->pcell;
-		a->set_immune_at_start();
+		a_state->set_immune_at_start();
 
 		SusceptibleToRecovered(c);
 
-		if (a->listpos < Cells[c].S)
+		if (a_state->listpos < Cells[c].S)
 		{
-			UpdateCell(Cells[c].susceptible, a->listpos, Cells[c].S);
+			UpdateCell(Cells[c].susceptible, a_state->listpos, Cells[c].S);
 		}
 		if (Cells[c].L > 0)
 		{
@@ -75,10 +76,10 @@ void DoImmune(int ai)
 
 		}
 
-		if (a->listpos < Cells[c].S + Cells[c].L + Cells[c].I)
+		if (a_state->listpos < Cells[c].S + Cells[c].L + Cells[c].I)
 		{
 			Cells[c].susceptible[Cells[c].S + Cells[c].L + Cells[c].I] = ai;
-			a->listpos = Cells[c].S + Cells[c].L + Cells[c].I;
+			a_state->listpos = Cells[c].S + Cells[c].L + Cells[c].I;
 		}
 
 
@@ -106,19 +107,20 @@ void DoInfect(int ai, double t, int tn, int run) // Change person from susceptib
 	double q; //// quantile of inverse CDF to choose latent period.
 
 	Person* a = Hosts + ai; //// pointer arithmetic. a = pointer to person. ai = int person index.
+	PersonState* a_state = &HostsState[ai];
 
-	if (a->is_susceptible()) //// Only change anything if person a/ai uninfected at start of this function.
+	if (a_state->is_susceptible()) //// Only change anything if person a/ai uninfected at start of this function.
 	{
 		TimeStepNow = (unsigned short int) (P.TimeStepsPerDay * t);
-		a->set_latent(); //// set person a to be infected
-		a->infection_time = (unsigned short int) TimeStepNow; //// record their infection time
+		a_state->set_latent(); //// set person a to be infected
+		a_state->infection_time = (unsigned short int) TimeStepNow; //// record their infection time
 
 		//// calculate radius squared, and increment sum of radii squared.
 		x = (Households[a->hh].loc.x - P.LocationInitialInfection[0][0]);
 		y = (Households[a->hh].loc.y - P.LocationInitialInfection[0][1]);
 		radiusSquared = x * x + y * y;
 
-		ToInfected(tn, a->infect_type, ai, radiusSquared);
+		ToInfected(tn, a_state->infect_type, ai, radiusSquared);
 
 		if (radiusSquared > StateT[tn].maxRad2)
 		{
@@ -127,11 +129,11 @@ void DoInfect(int ai, double t, int tn, int run) // Change person from susceptib
 		
 		SusceptibleToLatent(a->pcell);
 
-		if (a->listpos < Cells[a->pcell].S)
+		if (a_state->listpos < Cells[a->pcell].S)
 		{
-			UpdateCell(Cells[a->pcell].susceptible, a->listpos, Cells[a->pcell].S);
+			UpdateCell(Cells[a->pcell].susceptible, a_state->listpos, Cells[a->pcell].S);
 
-			a->listpos = Cells[a->pcell].S;	//// person a's position with cell.members now equal to number of susceptibles in cell.
+			a_state->listpos = Cells[a->pcell].S;	//// person a's position with cell.members now equal to number of susceptibles in cell.
 			Cells[a->pcell].latent[0] = ai; //// person ai joins front of latent queue.
 		}
 		StateT[tn].cumI_keyworker[a->keyworker]++;
@@ -140,19 +142,19 @@ void DoInfect(int ai, double t, int tn, int run) // Change person from susceptib
 		{
 			i = (int)floor((q = ranf_mt(tn) * CDF_RES));
 			q -= ((double)i);
-			a->latent_time = (unsigned short int) floor(0.5 + (t - P.LatentPeriod * log(q * P.latent_icdf[i + 1] + (1.0 - q) * P.latent_icdf[i])) * P.TimeStepsPerDay);
+			a_state->latent_time = (unsigned short int) floor(0.5 + (t - P.LatentPeriod * log(q * P.latent_icdf[i + 1] + (1.0 - q) * P.latent_icdf[i])) * P.TimeStepsPerDay);
 		}
 		else
-			a->latent_time = (unsigned short int) (t * P.TimeStepsPerDay);
-		if (a->infector >= 0) // record generation times and serial intervals
+			a_state->latent_time = (unsigned short int) (t * P.TimeStepsPerDay);
+		if (a_state->infector >= 0) // record generation times and serial intervals
 		{
-			StateT[tn].cumTG += (((int)a->infection_time) - ((int)Hosts[a->infector].infection_time));
-			StateT[tn].cumSI += (((int)a->latent_time) - ((int)Hosts[a->infector].latent_time));
+			StateT[tn].cumTG += (((int)a_state->infection_time) - ((int)HostsState[a_state->infector].infection_time));
+			StateT[tn].cumSI += (((int)a_state->latent_time) - ((int)HostsState[a_state->infector].latent_time));
 			StateT[tn].nTG++;
 		}
 
-		//if (P.DoLatent)	a->latent_time = a->infection_time + ChooseFromICDF(P.latent_icdf, P.LatentPeriod, tn);
-		//else			a->latent_time = (unsigned short int) (t * P.TimeStepsPerDay);
+		//if (P.DoLatent)	a_state->latent_time = a_state->infection_time + ChooseFromICDF(P.latent_icdf, P.LatentPeriod, tn);
+		//else			a_state->latent_time = (unsigned short int) (t * P.TimeStepsPerDay);
 
 		if (P.DoAdUnits)
 		{
@@ -166,7 +168,7 @@ void DoInfect(int ai, double t, int tn, int run) // Change person from susceptib
 		}
 		if (P.OutputBitmap)
 		{
-			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (Hosts[ai].detected == 1)))
+			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (HostsState[ai].detected == 1)))
 			{
 				Vector2i pixel((Households[a->hh].loc * P.scale) - P.bmin);
 				if (P.b.contains(pixel))
@@ -210,47 +212,51 @@ void RecordEvent(double t, int ai, int run, int type, int tn) //added int as arg
 	 //Declare int to store infector's index
 	int bi;
 
-	bi = Hosts[ai].infector;
+	bi = HostsState[ai].infector;
 
-	//Save information to event
-#pragma omp critical (inf_event)
-	if (nEvents < P.MaxInfEvents)
+	//Save information to event. Each thread appends to its own buffer, so no lock is needed; they are
+	//merged in time order by EventLog::collect. Only the text table is limited to MaxInfEvents, so
+	//keeping that many per thread is enough for it unless a binary stream is being written too.
+	std::vector<Events>& log = InfEventLogT[tn];
+	if ((P.OutputBinaryInfEvents) || ((int)log.size() < P.MaxInfEvents))
 	{
-		InfEventLog[nEvents].run = run;
-		InfEventLog[nEvents].type = type;
-		InfEventLog[nEvents].t = t;
-		InfEventLog[nEvents].infectee_ind = ai;
-		InfEventLog[nEvents].infectee_adunit = Mcells[Hosts[ai].mcell].adunit;
-		InfEventLog[nEvents].infectee_x = Households[Hosts[ai].hh].loc.x + P.SpatialBoundingBox.bottom_left().x;
-		InfEventLog[nEvents].infectee_y = Households[Hosts[ai].hh].loc.y + P.SpatialBoundingBox.bottom_left().y;
-		InfEventLog[nEvents].listpos = Hosts[ai].listpos;
-		InfEventLog[nEvents].infectee_cell = Hosts[ai].pcell;
-		InfEventLog[nEvents].thread = tn;
+		Events ev;
+		ev.run = run;
+		ev.type = type;
+		ev.t = t;
+		ev.infectee_ind = ai;
+		ev.infectee_adunit = Mcells[Hosts[ai].mcell].adunit;
+		ev.infectee_x = Households[Hosts[ai].hh].loc.x + P.SpatialBoundingBox.bottom_left().x;
+		ev.infectee_y = Households[Hosts[ai].hh].loc.y + P.SpatialBoundingBox.bottom_left().y;
+		ev.listpos = HostsState[ai].listpos;
+		ev.infectee_cell = Hosts[ai].pcell;
+		ev.thread = tn;
+		ev.infector_ind = 0;
+		ev.t_infector = 0.0;
+		ev.infector_cell = 0;
 		if (type == 0) //infection event - record time of onset of infector and infector
 		{
-			InfEventLog[nEvents].infector_ind = bi;
+			ev.infector_ind = bi;
 			if (bi < 0)
 			{
-				InfEventLog[nEvents].t_infector = -1;
-				InfEventLog[nEvents].infector_cell = -1;
+				ev.t_infector = -1;
+				ev.infector_cell = -1;
 			}
 			else
 			{
-				InfEventLog[nEvents].t_infector = (int)(Hosts[bi].infection_time / P.TimeStepsPerDay);
-				InfEventLog[nEvents].infector_cell = Hosts[bi].pcell;
+				ev.t_infector = (int)(HostsState[bi].infection_time / P.TimeStepsPerDay);
+				ev.infector_cell = Hosts[bi].pcell;
 			}
 		}
 		else if (type == 1) //onset event - record infectee's onset time
 		{
-			InfEventLog[nEvents].t_infector = (int)(Hosts[ai].infection_time / P.TimeStepsPerDay);
+			ev.t_infector = (int)(HostsState[ai].infection_time / P.TimeStepsPerDay);
 		}
 		else if ((type == 2) || (type == 3)) //recovery or death event - record infectee's onset time
 		{
-			InfEventLog[nEvents].t_infector = (int)(Hosts[ai].latent_time / P.TimeStepsPerDay);
+			ev.t_infector = (int)(HostsState[ai].latent_time / P.TimeStepsPerDay);
 		}
-
-		//increment the index of the infection event
-		nEvents++;
+		log.push_back(ev);
 	}
 
 }
@@ -258,9 +264,10 @@ void RecordEvent(double t, int ai, int run, int type, int tn) //added int as arg
 void DoMild(int ai, int tn)
 {
 	Person* a = Hosts + ai;
-	if (a->Severity_Current == Severity::Asymptomatic)
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->Severity_Current == Severity::Asymptomatic)
 	{
-		a->Severity_Current = Severity::Mild;
+		a_state->Severity_Current = Severity::Mild;
 
 		ToMild(tn, a->mcell, ai);
 	}
@@ -269,18 +276,20 @@ void DoMild(int ai, int tn)
 void DoILI(int ai, int tn)
 {
 	Person* a = Hosts + ai;
-	if (a->Severity_Current == Severity::Asymptomatic)
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->Severity_Current == Severity::Asymptomatic)
 	{
-		a->Severity_Current = Severity::ILI;
+		a_state->Severity_Current = Severity::ILI;
 		ToILI(tn, a->mcell, ai);
 	}
 }
 void DoSARI(int ai, int tn)
 {
 	Person* a = Hosts + ai;
-	if (a->Severity_Current == Severity::ILI)
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->Severity_Current == Severity::ILI)
 	{
-		a->Severity_Current = Severity::SARI;
+		a_state->Severity_Current = Severity::SARI;
 		FromILI(tn, a->mcell, ai);
 		ToSARI(tn, a->mcell, ai);
 	}
@@ -288,9 +297,10 @@ void DoSARI(int ai, int tn)
 void DoCritical(int ai, int tn)
 {
 	Person* a = Hosts + ai;
-	if (a->Severity_Current == Severity::SARI)
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->Severity_Current == Severity::SARI)
 	{
-		a->Severity_Current = Severity::Critical;
+		a_state->Severity_Current = Severity::Critical;
 		FromSARI(tn, a->mcell, ai);
 		ToCritical(tn, a->mcell, ai);
 	}
@@ -301,9 +311,10 @@ void DoRecoveringFromCritical(int ai, int tn)
 	//// DoRecover_FromSeverity assigns people to state Recovered (and bookkeeps accordingly).
 	//// DoRecoveringFromCritical assigns people to intermediate state "recovering from critical condition" (and bookkeeps accordingly).
 	Person* a = Hosts + ai;
-	if (a->Severity_Current == Severity::Critical && (!a->to_die)) //// second condition should be unnecessary but leave in for now.
+	PersonState* a_state = &HostsState[ai];
+	if (a_state->Severity_Current == Severity::Critical && (!a_state->to_die)) //// second condition should be unnecessary but leave in for now.
 	{
-		a->Severity_Current = Severity::Stepdown;
+		a_state->Severity_Current = Severity::Stepdown;
 		FromCritical(tn, a->mcell, ai);
 		ToCritRecov(tn, a->mcell, ai);
 	}
@@ -311,26 +322,27 @@ void DoRecoveringFromCritical(int ai, int tn)
 void DoDeath_FromCriticalorSARIorILI(int ai, int tn)
 {
 	Person* a = Hosts + ai;
-	// Note: only assign a->Severity_Current = Severity::Dead inside the switch cases.
+	PersonState* a_state = &HostsState[ai];
+	// Note: only assign a_state->Severity_Current = Severity::Dead inside the switch cases.
 	// In rare cases DoDeath_FromCriticalorSARIorILI can be called before a person has had their severity assigned.
-	switch(a->Severity_Current)
+	switch(a_state->Severity_Current)
 	{
 		case Severity::Critical:
 			FromCritical(tn, a->mcell, ai);
 			ToDeathCritical(tn, a->mcell, ai);
-			a->Severity_Current = Severity::Dead;
+			a_state->Severity_Current = Severity::Dead;
 			break;
 
 		case Severity::SARI:
 			FromSARI(tn, a->mcell, ai);
 			ToDeathSARI(tn, a->mcell, ai);
-			a->Severity_Current = Severity::Dead;
+			a_state->Severity_Current = Severity::Dead;
 			break;
 
 		case Severity::ILI:
 			FromILI(tn, a->mcell, ai);
 			ToDeathILI(tn, a->mcell, ai);
-			a->Severity_Current = Severity::Dead;
+			a_state->Severity_Current = Severity::Dead;
 			break;
 
 		case Severity::Asymptomatic:
@@ -349,31 +361,32 @@ void DoRecover_FromSeverity(int ai, int tn)
 
 	//// moved this from DoRecover
 	Person* a = Hosts + ai;
+	PersonState* a_state = &HostsState[ai];
 
-	// Note: only assign a->Severity_Current = Severity::Recovered inside the switch cases.
+	// Note: only assign a_state->Severity_Current = Severity::Recovered inside the switch cases.
 	// In rare cases DoRecover_FromSeverity can be called before a person has had their severity assigned.
-	if (a->is_infectious_asymptomatic_not_case() || a->is_case()) ///// i.e same condition in DoRecover (make sure you don't recover people twice).
+	if (a_state->is_infectious_asymptomatic_not_case() || a_state->is_case()) ///// i.e same condition in DoRecover (make sure you don't recover people twice).
 	{
-		switch (a->Severity_Current)
+		switch (a_state->Severity_Current)
 		{
 			case Severity::Mild:
 				FromMild(tn, a->mcell, ai);
-				a->Severity_Current = Severity::Recovered;
+				a_state->Severity_Current = Severity::Recovered;
 				break;
 
 			case Severity::ILI:
 				FromILI(tn, a->mcell, ai);
-				a->Severity_Current = Severity::Recovered;
+				a_state->Severity_Current = Severity::Recovered;
 				break;
 
 			case Severity::SARI:
 				FromSARI(tn, a->mcell, ai);
-				a->Severity_Current = Severity::Recovered;
+				a_state->Severity_Current = Severity::Recovered;
 				break;
 
 			case Severity::Stepdown:
 				FromCritRecov(tn, a->mcell, ai);
-				a->Severity_Current = Severity::Recovered;
+				a_state->Severity_Current = Severity::Recovered;
 				break;
 
 			case Severity::Asymptomatic:
@@ -387,7 +400,7 @@ void DoRecover_FromSeverity(int ai, int tn)
 
 void DecideIfPersonDies(int PersonNum, int PersonAgeGroup, int ThreadNum)
 {
-	Person* person = Hosts + PersonNum;
+	PersonState* person = &HostsState[PersonNum];
 
 	switch (person->Severity_Final)
 	{
@@ -408,104 +421,105 @@ void DecideIfPersonDies(int PersonNum, int PersonAgeGroup, int ThreadNum)
 void DoIncub(int ai, unsigned short int TimeStepNow, int tn)
 {
 	Person* a = Hosts + ai;;
+	PersonState* a_state = &HostsState[ai];
 	double ProbSymptomatic;
 	int age = HOST_AGE_GROUP(ai);
 	if (age >= NUM_AGE_GROUPS) age = NUM_AGE_GROUPS - 1;
 
-	if (a->is_latent())
+	if (a_state->is_latent())
 	{
-		a->infectiousness = (float)P.AgeInfectiousness[age];
-		if (P.InfectiousnessSD > 0) a->infectiousness *= (float) gen_gamma_mt(1 / (P.InfectiousnessSD * P.InfectiousnessSD), 1 / (P.InfectiousnessSD * P.InfectiousnessSD), tn);
+		a_state->infectiousness = (float)P.AgeInfectiousness[age];
+		if (P.InfectiousnessSD > 0) a_state->infectiousness *= (float) gen_gamma_mt(1 / (P.InfectiousnessSD * P.InfectiousnessSD), 1 / (P.InfectiousnessSD * P.InfectiousnessSD), tn);
 		ProbSymptomatic = P.ProportionSymptomatic[age]	* (HOST_TREATED(ai) ? (1 - P.TreatSympDrop) : 1)	* (HOST_VACCED(ai) ? (1 - P.VaccSympDrop) : 1);
 
 		if (ranf_mt(tn) < ProbSymptomatic)
 		{
-			a->set_infectious_almost_symptomatic();
-			a->infectiousness *= (float)(-P.SymptInfectiousness);
+			a_state->set_infectious_almost_symptomatic();
+			a_state->infectiousness *= (float)(-P.SymptInfectiousness);
 		}
 		else
 		{
-			a->set_infectious_asymptomatic_not_case();
-			a->infectiousness *= (float) P.AsymptInfectiousness;
+			a_state->set_infectious_asymptomatic_not_case();
+			a_state->infectiousness *= (float) P.AsymptInfectiousness;
 		}
-		if (!P.DoSeverity || a->is_infectious_asymptomatic_not_case()) //// if not doing severity or if person asymptomatic.
+		if (!P.DoSeverity || a_state->is_infectious_asymptomatic_not_case()) //// if not doing severity or if person asymptomatic.
 		{
-			if (P.DoInfectiousnessProfile)	a->recovery_or_death_time = a->latent_time + (unsigned short int) (P.InfectiousPeriod * P.TimeStepsPerDay);
-			else							a->recovery_or_death_time = a->latent_time + P.infectious_icdf.choose(P.InfectiousPeriod, tn, P.TimeStepsPerDay);
+			if (P.DoInfectiousnessProfile)	a_state->recovery_or_death_time = a_state->latent_time + (unsigned short int) (P.InfectiousPeriod * P.TimeStepsPerDay);
+			else							a_state->recovery_or_death_time = a_state->latent_time + P.infectious_icdf.choose(P.InfectiousPeriod, tn, P.TimeStepsPerDay);
 		}
 		else
 		{
-			int CaseTime = a->latent_time + ((int)(P.LatentToSymptDelay / P.ModelTimeStep)); //// base severity times on CaseTime, not latent time. Otherwise there are edge cases where recovery time is zero days after latent_time and therefore before DoCase called in IncubRecoverySweep (i.e. people can recover before they've become a case!).
+			int CaseTime = a_state->latent_time + ((int)(P.LatentToSymptDelay / P.ModelTimeStep)); //// base severity times on CaseTime, not latent time. Otherwise there are edge cases where recovery time is zero days after latent_time and therefore before DoCase called in IncubRecoverySweep (i.e. people can recover before they've become a case!).
 
 			//// choose final disease severity (either mild, ILI, SARI, Critical, not asymptomatic as covered above) by age
-			a->Severity_Final = ChooseFinalDiseaseSeverity(age, tn);
+			a_state->Severity_Final = ChooseFinalDiseaseSeverity(age, tn);
 
-			/// choose outcome recovery or death (i.e. changes a->to_die = 1 death flag).
+			/// choose outcome recovery or death (i.e. changes a_state->to_die = 1 death flag).
 			DecideIfPersonDies(ai, age, tn);
 
-			if ((a->care_home_resident) && ((a->Severity_Final == Severity::Critical) || (a->Severity_Final == Severity::SARI))&&(ranf_mt(tn)>P.CareHomeRelProbHosp))
+			if ((a->care_home_resident) && ((a_state->Severity_Final == Severity::Critical) || (a_state->Severity_Final == Severity::SARI))&&(ranf_mt(tn)>P.CareHomeRelProbHosp))
 			{
 				// care home residents who weren't hospitalised but would otherwise have needed critical care will all die
-				a->to_die = 1;
+				a_state->to_die = 1;
 				// change final severity to ILI (meaning not hospitalised), but leave to_die flag
-				a->Severity_Final = Severity::ILI;
+				a_state->Severity_Final = Severity::ILI;
 			}
 			//// choose events and event times
-			if (a->Severity_Final == Severity::Mild)
+			if (a_state->Severity_Final == Severity::Mild)
 			{
-				a->recovery_or_death_time = CaseTime + P.MildToRecovery_icdf.choose(P.Mean_MildToRecovery[age], tn, P.TimeStepsPerDay);
+				a_state->recovery_or_death_time = CaseTime + P.MildToRecovery_icdf.choose(P.Mean_MildToRecovery[age], tn, P.TimeStepsPerDay);
 			}
-			else if (a->Severity_Final == Severity::Critical)
+			else if (a_state->Severity_Final == Severity::Critical)
 			{
-				a->SARI_time		= CaseTime		+ P.ILIToSARI_icdf.		choose(P.Mean_ILIToSARI[age]		, tn, P.TimeStepsPerDay);
-				a->Critical_time	= a->SARI_time	+ P.SARIToCritical_icdf.choose(P.Mean_SARIToCritical[age]	, tn, P.TimeStepsPerDay);
-				if (a->to_die)
+				a_state->SARI_time		= CaseTime		+ P.ILIToSARI_icdf.		choose(P.Mean_ILIToSARI[age]		, tn, P.TimeStepsPerDay);
+				a_state->Critical_time	= a_state->SARI_time	+ P.SARIToCritical_icdf.choose(P.Mean_SARIToCritical[age]	, tn, P.TimeStepsPerDay);
+				if (a_state->to_die)
 				{
 					if (P.IncludeStepDownToDeath == 1)
 					{
-						a->Stepdown_time			= a->Critical_time + P.CriticalToCritRecov_icdf.choose(P.Mean_CriticalToCritRecov	[age], tn, P.TimeStepsPerDay);
-						a->recovery_or_death_time	= a->Stepdown_time + P.StepdownToDeath_icdf.	choose(P.Mean_StepdownToDeath		[age], tn, P.TimeStepsPerDay);
+						a_state->Stepdown_time			= a_state->Critical_time + P.CriticalToCritRecov_icdf.choose(P.Mean_CriticalToCritRecov	[age], tn, P.TimeStepsPerDay);
+						a_state->recovery_or_death_time	= a_state->Stepdown_time + P.StepdownToDeath_icdf.	choose(P.Mean_StepdownToDeath		[age], tn, P.TimeStepsPerDay);
 					}
 					else
 					{
-						a->recovery_or_death_time = a->Critical_time + P.CriticalToDeath_icdf.choose(P.Mean_CriticalToDeath[age], tn, P.TimeStepsPerDay);
+						a_state->recovery_or_death_time = a_state->Critical_time + P.CriticalToDeath_icdf.choose(P.Mean_CriticalToDeath[age], tn, P.TimeStepsPerDay);
 					}
 				}
 				else
 				{
-					a->Stepdown_time			= a->Critical_time + P.CriticalToCritRecov_icdf.choose(P.Mean_CriticalToCritRecov[age], tn, P.TimeStepsPerDay);
-					a->recovery_or_death_time	= a->Stepdown_time + P.CritRecovToRecov_icdf.choose(P.Mean_CritRecovToRecov[age], tn, P.TimeStepsPerDay);
+					a_state->Stepdown_time			= a_state->Critical_time + P.CriticalToCritRecov_icdf.choose(P.Mean_CriticalToCritRecov[age], tn, P.TimeStepsPerDay);
+					a_state->recovery_or_death_time	= a_state->Stepdown_time + P.CritRecovToRecov_icdf.choose(P.Mean_CritRecovToRecov[age], tn, P.TimeStepsPerDay);
 				}
 			}
-			else if (a->Severity_Final == Severity::SARI)
+			else if (a_state->Severity_Final == Severity::SARI)
 			{
-				a->SARI_time = CaseTime + P.ILIToSARI_icdf.choose(P.Mean_ILIToSARI[age], tn, P.TimeStepsPerDay);
-				if (a->to_die)
-					a->recovery_or_death_time = a->SARI_time + P.SARIToDeath_icdf.choose(P.Mean_SARIToDeath[age], tn, P.TimeStepsPerDay);
+				a_state->SARI_time = CaseTime + P.ILIToSARI_icdf.choose(P.Mean_ILIToSARI[age], tn, P.TimeStepsPerDay);
+				if (a_state->to_die)
+					a_state->recovery_or_death_time = a_state->SARI_time + P.SARIToDeath_icdf.choose(P.Mean_SARIToDeath[age], tn, P.TimeStepsPerDay);
 				else
-					a->recovery_or_death_time = a->SARI_time + P.SARIToRecovery_icdf.choose(P.Mean_SARIToRecovery[age], tn, P.TimeStepsPerDay);
+					a_state->recovery_or_death_time = a_state->SARI_time + P.SARIToRecovery_icdf.choose(P.Mean_SARIToRecovery[age], tn, P.TimeStepsPerDay);
 			}
 			else /*i.e. if Severity_Final == Severity::ILI*/
 			{
-				if (a->to_die)
-					a->recovery_or_death_time = CaseTime + P.ILIToDeath_icdf.choose(P.Mean_ILIToDeath[age], tn, P.TimeStepsPerDay);
+				if (a_state->to_die)
+					a_state->recovery_or_death_time = CaseTime + P.ILIToDeath_icdf.choose(P.Mean_ILIToDeath[age], tn, P.TimeStepsPerDay);
 				else
-					a->recovery_or_death_time = CaseTime + P.ILIToRecovery_icdf.choose(P.Mean_ILIToRecovery[age], tn, P.TimeStepsPerDay);
+					a_state->recovery_or_death_time = CaseTime + P.ILIToRecovery_icdf.choose(P.Mean_ILIToRecovery[age], tn, P.TimeStepsPerDay);
 			}
 		}
 
-		if (a->is_infectious_almost_symptomatic() && ((P.ControlPropCasesId == 1) || (ranf_mt(tn) < P.ControlPropCasesId)))
+		if (a_state->is_infectious_almost_symptomatic() && ((P.ControlPropCasesId == 1) || (ranf_mt(tn) < P.ControlPropCasesId)))
 		{
-			Hosts[ai].detected = 1;
-			Hosts[ai].detected_time = TimeStepNow + (unsigned short int)(P.LatentToSymptDelay * P.TimeStepsPerDay);
+			HostsState[ai].detected = 1;
+			HostsState[ai].detected_time = TimeStepNow + (unsigned short int)(P.LatentToSymptDelay * P.TimeStepsPerDay);
 
 
-			if ((P.DoDigitalContactTracing) && (Hosts[ai].detected_time >= (unsigned short int)(AdUnits[Mcells[Hosts[ai].mcell].adunit].DigitalContactTracingTimeStart * P.TimeStepsPerDay)) && (Hosts[ai].detected_time < (unsigned short int)((AdUnits[Mcells[Hosts[ai].mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration)*P.TimeStepsPerDay)) && (Hosts[ai].digitalContactTracingUser))
+			if ((P.DoDigitalContactTracing) && (HostsState[ai].detected_time >= (unsigned short int)(AdUnits[Mcells[Hosts[ai].mcell].adunit].DigitalContactTracingTimeStart * P.TimeStepsPerDay)) && (HostsState[ai].detected_time < (unsigned short int)((AdUnits[Mcells[Hosts[ai].mcell].adunit].DigitalContactTracingTimeStart + P.DigitalContactTracingPolicyDuration)*P.TimeStepsPerDay)) && (Hosts[ai].digitalContactTracingUser))
 			{
 				//set dct_trigger_time for index case
 			if (P.DoDigitalContactTracing)	//set dct_trigger_time for index case
-				if (Hosts[ai].dct_trigger_time == (USHRT_MAX - 1)) //if this hasn't been set in DigitalContactTracingSweep due to detection of contact of contacts, set it here
-					Hosts[ai].dct_trigger_time = Hosts[ai].detected_time + (unsigned short int) (P.DelayFromIndexCaseDetectionToDCTIsolation * P.TimeStepsPerDay);
+				if (HostsState[ai].dct_trigger_time == (USHRT_MAX - 1)) //if this hasn't been set in DigitalContactTracingSweep due to detection of contact of contacts, set it here
+					HostsState[ai].dct_trigger_time = HostsState[ai].detected_time + (unsigned short int) (P.DelayFromIndexCaseDetectionToDCTIsolation * P.TimeStepsPerDay);
 			}
 		}
 
@@ -514,9 +528,9 @@ void DoIncub(int ai, unsigned short int TimeStepNow, int tn)
 
 		if (Cells[a->pcell].L > 0)
 		{
-			UpdateCell(Cells[a->pcell].susceptible, Cells[a->pcell].latent, a->listpos, Cells[a->pcell].L);
+			UpdateCell(Cells[a->pcell].susceptible, Cells[a->pcell].latent, a_state->listpos, Cells[a->pcell].L);
 
-			a->listpos = Cells[a->pcell].S + Cells[a->pcell].L; //// change person a's listpos, which will now refer to their position among infectious people, not latent.
+			a_state->listpos = Cells[a->pcell].S + Cells[a->pcell].L; //// change person a's listpos, which will now refer to their position among infectious people, not latent.
 			Cells[a->pcell].infected[0] = ai; //// this person is now first infectious person in the array. Pointer was moved back one so now that memory address refers to person ai. Alternative would be to move everyone back one which would take longer.
 		}
 	}
@@ -530,6 +544,7 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 
 	int j, k, f, j1, j2, ad; // m, h, ad;
 	Person* a = Hosts + ai;
+	PersonState* a_state = &HostsState[ai];
 
 	//// Increment triggers (Based on numbers of detected cases) for interventions. Used in TreatSweep function when not doing Global or Admin triggers. And not when doing ICU triggers.
 	if (Mcells[a->mcell].treat_trig				< USHRT_MAX - 1) Mcells[a->mcell].treat_trig++;
@@ -655,16 +670,16 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 		(t >= AdUnits[Mcells[a->mcell].adunit].CaseIsolationTimeStart && (t < AdUnits[Mcells[a->mcell].adunit].CaseIsolationTimeStart + P.CaseIsolationPolicyDuration))								)
 		if ((P.CaseIsolationProp == 1) || (ranf_mt(tn) < P.CaseIsolationProp))
 		{
-			Hosts[ai].isolation_start_time = TimeStepNow; //// set isolation start time.
+			HostsState[ai].isolation_start_time = TimeStepNow; //// set isolation start time.
 			if (HOST_ABSENT(ai))
 			{
-				if (a->absent_stop_time < TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseIsolationDuration) //// ensure that absent_stop_time is at least now + CaseIsolationDuraton
-					a->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseIsolationDuration;
+				if (a_state->absent_stop_time < TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseIsolationDuration) //// ensure that absent_stop_time is at least now + CaseIsolationDuraton
+					a_state->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseIsolationDuration;
 			}
 			else if (P.DoRealSymptWithdrawal) /* This calculates adult absenteeism from work due to care of isolated children.  */
 			{
-				Hosts[ai].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
-				Hosts[ai].absent_stop_time	= TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
+				HostsState[ai].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
+				HostsState[ai].absent_stop_time	= TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
 				if (P.DoPlaces)
 				{
 					if ((!HOST_QUARANTINED(ai)) && (Hosts[ai].PlaceLinks[P.PlaceTypeNoAirNum - 1] >= 0) && (HOST_AGE_YEAR(ai) >= P.CaseAbsentChildAgeCutoff))
@@ -673,28 +688,28 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 				if ((P.DoHouseholds) && (P.DoPlaces) && (HOST_AGE_YEAR(ai) < P.CaseAbsentChildAgeCutoff)) //// if host is a child who requires adult to stay at home.
 				{
 					if (!HOST_QUARANTINED(ai)) StateT[tn].cumACS++;
-					if (Hosts[ai].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if adult needs to stay at home (i.e. if Proportion of children at home for whom one adult also stays at home = 1 or coinflip satisfied.)
+					if (HostsState[ai].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if adult needs to stay at home (i.e. if Proportion of children at home for whom one adult also stays at home = 1 or coinflip satisfied.)
 					{
 						j1 = Households[Hosts[ai].hh].FirstPerson; j2 = j1 + Households[Hosts[ai].hh].nh;
 						f = 0;
 
 						//// in loop below, f true if any household member a) alive AND b) not a child AND c) has no links to workplace (or is absent from work or quarantined).
 						for (j = j1; (j < j2) && (!f); j++)
-							f = (Hosts[j].is_alive() && (HOST_AGE_YEAR(j) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[j].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_ABSENT(j)) || (HOST_QUARANTINED(j))));
+							f = (HostsState[j].is_alive() && (HOST_AGE_YEAR(j) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[j].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_ABSENT(j)) || (HOST_QUARANTINED(j))));
 
 						//// so !f true if any household member EITHER: a) dead; b) a child; c) has a link to an office and not currently absent or quarantined.
 						if (!f) //// so if either a) a household member is dead; b) a household member is a child requiring adult to stay home; c) a household member has links to office.
 						{
 							for (j = j1; (j < j2) && (!f); j++) /// loop again, checking whether household members not children needing supervision and are alive.
-								if ((HOST_AGE_YEAR(j) >= P.CaseAbsentChildAgeCutoff) && Hosts[j].is_alive())
+								if ((HOST_AGE_YEAR(j) >= P.CaseAbsentChildAgeCutoff) && HostsState[j].is_alive())
 								{
 									k = j;
 									f = 1;
 								}
 							if (f) //// so finally, if at least one member of household is alive and does not need supervision by an adult, amend absent start and stop times
 							{
-								Hosts[k].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
-								Hosts[k].absent_stop_time = TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
+								HostsState[k].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
+								HostsState[k].absent_stop_time = TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
 								StateT[tn].cumAA++;
 							}
 						}
@@ -708,7 +723,7 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 	{
 
 		// allow for DCT to isolate index cases
-		if ((P.DCTIsolateIndexCases) && (Hosts[ai].index_case_dct==0))//(Hosts[ai].digitalContactTraced == 0)&& - currently removed this condition as it would mean that someone already under isolation wouldn't have their isolation extended
+		if ((P.DCTIsolateIndexCases) && (HostsState[ai].index_case_dct==0))//(HostsState[ai].digitalContactTraced == 0)&& - currently removed this condition as it would mean that someone already under isolation wouldn't have their isolation extended
 		{
 			ad = Mcells[Hosts[ai].mcell].adunit;
 			//if (AdUnits[j].ndct < AdUnits[j].n)
@@ -734,7 +749,7 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 		//	for (j = j1; j < j2; j++)
 		//	{
 		//		//if host is dead or the detected case, no need to add them to the list. They also need to be a user themselves
-		//		if ((abs(Hosts[j].inf) != 5) && (j != ai) && (Hosts[j].digitalContactTracingUser) && (ranf_mt(tn)<P.ProportionDigitalContactsIsolate))
+		//		if ((abs(HostsState[j].inf) != 5) && (j != ai) && (Hosts[j].digitalContactTracingUser) && (ranf_mt(tn)<P.ProportionDigitalContactsIsolate))
 		//		{
 		//			//add contact and detected infectious host to lists
 		//			ad = Mcells[Hosts[j].mcell].adunit;
@@ -766,7 +781,7 @@ void DoDetectedCase(int ai, double t, unsigned short int TimeStepNow, int tn)
 		//				h = Places[i][k].members[j];
 		//				ad = Mcells[Hosts[h].mcell].adunit;
 		//				//if host is dead or the detected case, no need to add them to the list. They also need to be a user themselves
-		//				if ((abs(Hosts[h].inf) != 5) && (h != ai) && (Hosts[h].digitalContactTracingUser))// && (ranf_mt(tn)<P.ProportionDigitalContactsIsolate))
+		//				if ((abs(HostsState[h].inf) != 5) && (h != ai) && (Hosts[h].digitalContactTracingUser))// && (ranf_mt(tn)<P.ProportionDigitalContactsIsolate))
 		//				{
 		//					ad = Mcells[Hosts[h].mcell].adunit;
 		//					if ((StateT[tn].ndct_queue[ad] < P.InfQueuePeakLength))
@@ -795,29 +810,31 @@ void DoCase(int ai, double t, unsigned short int TimeStepNow, int tn) //// makes
 {
 	int j, k, f, j1, j2;
 	Person* a;
+	PersonState* a_state;
 	int age;
 
 	age = HOST_AGE_GROUP(ai);
 	if (age >= NUM_AGE_GROUPS) age = NUM_AGE_GROUPS - 1;
 	a = Hosts + ai;
-	if (a->is_infectious_almost_symptomatic()) //// if person latent/asymptomatically infected, but infectious
+	a_state = &HostsState[ai];
+	if (a_state->is_infectious_almost_symptomatic()) //// if person latent/asymptomatically infected, but infectious
 	{
-		a->set_case(); //// make person symptomatic and infectious (i.e. a case)
+		a_state->set_case(); //// make person symptomatic and infectious (i.e. a case)
 		if (HOST_ABSENT(ai))
 		{
-			if (a->absent_stop_time < TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration)
-				a->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration;
+			if (a_state->absent_stop_time < TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration)
+				a_state->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration;
 		}
 		else if((P.DoRealSymptWithdrawal)&&(P.DoPlaces))
 		{
-			a->absent_start_time = USHRT_MAX - 1;
+			a_state->absent_start_time = USHRT_MAX - 1;
 			for (j = 0; j < P.NumPlaceTypes; j++)
 				if ((a->PlaceLinks[j] >= 0) && (j != P.HotelPlaceType) && (!HOST_ABSENT(ai)) && (P.SymptPlaceTypeWithdrawalProp[j] > 0))
 				{
 					if ((!Hosts[ai].care_home_resident) && ((P.SymptPlaceTypeWithdrawalProp[j] == 1) || (ranf_mt(tn) < P.SymptPlaceTypeWithdrawalProp[j])))
 					{
-						a->absent_start_time = TimeStepNow + P.usCaseAbsenteeismDelay;
-						a->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration;
+						a_state->absent_start_time = TimeStepNow + P.usCaseAbsenteeismDelay;
+						a_state->absent_stop_time = TimeStepNow + P.usCaseAbsenteeismDelay + P.usCaseAbsenteeismDuration;
 						if (P.AbsenteeismPlaceClosure)
 						{
 							if ((t >= P.PlaceCloseTimeStart) && (!P.DoAdminTriggers) && (!P.DoGlobalTriggers))
@@ -836,25 +853,25 @@ void DoCase(int ai, double t, unsigned short int TimeStepNow, int tn) //// makes
 						if ((P.DoHouseholds) && (HOST_AGE_YEAR(ai) < P.CaseAbsentChildAgeCutoff))
 						{
 							if (!HOST_QUARANTINED(ai)) StateT[tn].cumACS++;
-							if (Hosts[ai].ProbCare < P.CaseAbsentChildPropAdultCarers)
+							if (HostsState[ai].ProbCare < P.CaseAbsentChildPropAdultCarers)
 							{
 								j1 = Households[Hosts[ai].hh].FirstPerson; j2 = j1 + Households[Hosts[ai].hh].nh;
 								f = 0;
 								for (int j3 = j1; (j3 < j2) && (!f); j3++)
-									f = (Hosts[j3].is_alive() && (HOST_AGE_YEAR(j3) >= P.CaseAbsentChildAgeCutoff)
+									f = (HostsState[j3].is_alive() && (HOST_AGE_YEAR(j3) >= P.CaseAbsentChildAgeCutoff)
 										&& ((Hosts[j3].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0)|| (HOST_ABSENT(j3)) || (HOST_QUARANTINED(j3))));
 								if (!f)
 								{
 									for (int j3 = j1; (j3 < j2) && (!f); j3++)
-										if ((HOST_AGE_YEAR(j3) >= P.CaseAbsentChildAgeCutoff) && (Hosts[j3].is_alive()))
+										if ((HOST_AGE_YEAR(j3) >= P.CaseAbsentChildAgeCutoff) && (HostsState[j3].is_alive()))
 										{
 											k = j3;
 											f = 1;
 										}
 									if (f)
 									{
-										if (!HOST_ABSENT(k)) Hosts[k].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
-										Hosts[k].absent_stop_time = TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
+										if (!HOST_ABSENT(k)) HostsState[k].absent_start_time = TimeStepNow + P.usCaseIsolationDelay;
+										HostsState[k].absent_stop_time = TimeStepNow + P.usCaseIsolationDelay + P.usCaseIsolationDuration;
 										StateT[tn].cumAA++;
 									}
 								}
@@ -865,7 +882,7 @@ void DoCase(int ai, double t, unsigned short int TimeStepNow, int tn) //// makes
 		}
 
 		//added some case detection code here: ggilani - 03/02/15
-		if (Hosts[ai].detected == 1)
+		if (HostsState[ai].detected == 1)
 			//if ((P.ControlPropCasesId == 1) || (ranf_mt(tn) < P.ControlPropCasesId))
 		{
 			StateT[tn].cumDC++;
@@ -884,7 +901,7 @@ void DoCase(int ai, double t, unsigned short int TimeStepNow, int tn) //// makes
 
 		if (P.DoSeverity)
 		{
-			if (a->Severity_Final == Severity::Mild)
+			if (a_state->Severity_Final == Severity::Mild)
 				DoMild(ai, tn);
 			else
 				DoILI(ai, tn); //// symptomatic cases either mild or ILI at symptom onset. SARI and Critical cases still onset with ILI.
@@ -908,28 +925,30 @@ void DoRecover(int ai, int tn)
 {
 	int i, j;
 	Person* a;
+	PersonState* a_state;
 
 	a = Hosts + ai;
-	if (a->is_infectious_asymptomatic_not_case() || a->is_case())
+	a_state = &HostsState[ai];
+	if (a_state->is_infectious_asymptomatic_not_case() || a_state->is_case())
 	{
-		i = a->listpos;
+		i = a_state->listpos;
 		InfectiousToRecovered(a->pcell);
 		j = Cells[a->pcell].S + Cells[a->pcell].L + Cells[a->pcell].I;
 		if (i < Cells[a->pcell].S + Cells[a->pcell].L + Cells[a->pcell].I)
 		{
 			UpdateCell(Cells[a->pcell].susceptible, i, j);
-			a->listpos = j;
+			a_state->listpos = j;
 			Cells[a->pcell].susceptible[j] = ai;
 		}
 		
 		
-		a->set_recovered();
+		a_state->set_recovered();
 		if (P.DoAdUnits && P.OutputAdUnitAge)
 			StateT[tn].prevInf_age_adunit[HOST_AGE_GROUP(ai)][Mcells[a->mcell].adunit]--;
 
 		if (P.OutputBitmap)
 		{
-			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (Hosts[ai].detected == 1)))
+			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (HostsState[ai].detected == 1)))
 			{
 				Vector2i pixel((Households[a->hh].loc * P.scale) - P.bmin);
 				if (P.b.contains(pixel))
@@ -947,28 +966,29 @@ void DoRecover(int ai, int tn)
 		}
 	}
 	//else
-	//Files::xfprintf_stderr("\n ### %i %i  \n", ai, a->inf);
+	//Files::xfprintf_stderr("\n ### %i %i  \n", ai, a_state->inf);
 }
 
 void DoDeath(int ai, int tn)
 {
 	int i;
 	Person* a = Hosts + ai;
+	PersonState* a_state = &HostsState[ai];
 
-	if (a->is_infectious_asymptomatic_not_case() || a->is_case())
+	if (a_state->is_infectious_asymptomatic_not_case() || a_state->is_case())
 	{
 
-		a->set_dead();
+		a_state->set_dead();
 		InfectiousToDeath(a->pcell);
-		i = a->listpos;
+		i = a_state->listpos;
 		if (i < Cells[a->pcell].S + Cells[a->pcell].L + Cells[a->pcell].I)
 		{
-			UpdateCell(Cells[a->pcell].susceptible, Cells[a->pcell].infected, a->listpos, Cells[a->pcell].I);
-			a->listpos = Cells[a->pcell].S + Cells[a->pcell].L + Cells[a->pcell].I;
-			Cells[a->pcell].susceptible[a->listpos] = ai;
+			UpdateCell(Cells[a->pcell].susceptible, Cells[a->pcell].infected, a_state->listpos, Cells[a->pcell].I);
+			a_state->listpos = Cells[a->pcell].S + Cells[a->pcell].L + Cells[a->pcell].I;
+			Cells[a->pcell].susceptible[a_state->listpos] = ai;
 		}
 
-		/*		a->listpos=-1; */
+		/*		a_state->listpos=-1; */
 		StateT[tn].cumDa[HOST_AGE_GROUP(ai)]++;
 
 		if (P.DoAdUnits)
@@ -978,7 +998,7 @@ void DoDeath(int ai, int tn)
 		}
 		if (P.OutputBitmap)
 		{
-			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (Hosts[ai].detected == 1)))
+			if ((P.OutputBitmapDetected == 0) || ((P.OutputBitmapDetected == 1) && (HostsState[ai].detected == 1)))
 			{
 				Vector2i pixel((Households[a->hh].loc * P.scale) - P.bmin);
 				if (P.b.contains(pixel))
@@ -1005,16 +1025,16 @@ void DoTreatCase(int ai, unsigned short int TimeStepNow, int tn)
 		if (!HOST_TO_BE_TREATED(ai))
 #endif
 		{
-			Hosts[ai].treat_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatDelayMean));
-			Hosts[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * (P.TreatDelayMean + P.TreatCaseCourseLength)));
+			HostsState[ai].treat_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatDelayMean));
+			HostsState[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * (P.TreatDelayMean + P.TreatCaseCourseLength)));
 			StateT[tn].cumT++;
 
-			// Orig: if ((abs(Hosts[ai].inf) > InfStat::Susceptible) && (Hosts[ai].inf != InfStat::Dead_WasAsymp)) Cells[Hosts[ai].pcell].cumTC++;
+			// Orig: if ((abs(HostsState[ai].inf) > InfStat::Susceptible) && (HostsState[ai].inf != InfStat::Dead_WasAsymp)) Cells[Hosts[ai].pcell].cumTC++;
 			// Notd that susceptible enum val = 0
 
-			if (!(Hosts[ai].is_susceptible() || Hosts[ai].is_dead_was_asymp())) Cells[Hosts[ai].pcell].cumTC++;
+			if (!(HostsState[ai].is_susceptible() || HostsState[ai].is_dead_was_asymp())) Cells[Hosts[ai].pcell].cumTC++;
 			StateT[tn].cumT_keyworker[Hosts[ai].keyworker]++;
-			if ((++Hosts[ai].num_treats) < 2) StateT[tn].cumUT++;
+			if ((++HostsState[ai].num_treats) < 2) StateT[tn].cumUT++;
 			Cells[Hosts[ai].pcell].tot_treat++;
 			if (P.DoAdUnits) StateT[tn].cumT_adunit[Mcells[Hosts[ai].mcell].adunit]++;
 			if (P.OutputBitmap)
@@ -1040,11 +1060,11 @@ void DoProph(int ai, unsigned short int TimeStepNow, int tn)
 
 	if (State.cumT < P.TreatMaxCourses)
 	{
-		Hosts[ai].treat_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatDelayMean));
-		Hosts[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * (P.TreatDelayMean + P.TreatProphCourseLength)));
+		HostsState[ai].treat_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatDelayMean));
+		HostsState[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * (P.TreatDelayMean + P.TreatProphCourseLength)));
 		StateT[tn].cumT++;
 		StateT[tn].cumT_keyworker[Hosts[ai].keyworker]++;
-		if ((++Hosts[ai].num_treats) < 2) StateT[tn].cumUT++;
+		if ((++HostsState[ai].num_treats) < 2) StateT[tn].cumUT++;
 		if (P.DoAdUnits)	StateT[tn].cumT_adunit[Mcells[Hosts[ai].mcell].adunit]++;
 #pragma omp atomic
 		Cells[Hosts[ai].pcell].tot_treat++;
@@ -1068,11 +1088,11 @@ void DoProphNoDelay(int ai, unsigned short int TimeStepNow, int tn, int nc)
 {
 	if (State.cumT < P.TreatMaxCourses)
 	{
-		Hosts[ai].treat_start_time = TimeStepNow;
-		Hosts[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatProphCourseLength * nc));
+		HostsState[ai].treat_start_time = TimeStepNow;
+		HostsState[ai].treat_stop_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.TreatProphCourseLength * nc));
 		StateT[tn].cumT += nc;
 		StateT[tn].cumT_keyworker[Hosts[ai].keyworker] += nc;
-		if ((++Hosts[ai].num_treats) < 2) StateT[tn].cumUT++;
+		if ((++HostsState[ai].num_treats) < 2) StateT[tn].cumUT++;
 		if (P.DoAdUnits) StateT[tn].cumT_adunit[Mcells[Hosts[ai].mcell].adunit] += nc;
 #pragma omp atomic
 		Cells[Hosts[ai].pcell].tot_treat++;
@@ -1196,12 +1216,12 @@ void DoPlaceClose(int i, int j, unsigned short int TimeStepNow, int tn, int DoAn
 			for (int PlaceMember = 0; PlaceMember < Places[i][j].n; PlaceMember++) //// loop over all people in place.
 			{
 				WhichPerson = Places[i][j].members[PlaceMember];
-				if (((P.PlaceClosePropAttending[i] == 0) || (Hosts[WhichPerson].ProbAbsent >= P.PlaceClosePropAttending[i])))
+				if (((P.PlaceClosePropAttending[i] == 0) || (HostsState[WhichPerson].ProbAbsent >= P.PlaceClosePropAttending[i])))
 				{
 					if ((!HOST_ABSENT(WhichPerson)) && (!HOST_QUARANTINED(WhichPerson)) && (HOST_AGE_YEAR(WhichPerson) < P.CaseAbsentChildAgeCutoff)) //// if person is a child and neither absent nor quarantined
 					{
 						StateT[tn].cumAPCS++;
-						if (Hosts[WhichPerson].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if child needs adult supervision
+						if (HostsState[WhichPerson].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if child needs adult supervision
 						{
 							int FirstPerson_Household	= Households[Hosts[WhichPerson].hh].FirstPerson;
 							int LastPerson_Household	= FirstPerson_Household + Households[Hosts[WhichPerson].hh].nh;
@@ -1211,11 +1231,11 @@ void DoPlaceClose(int i, int j, unsigned short int TimeStepNow, int tn, int DoAn
 							//// in loop below, AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace true if any household member a) alive AND b) not a child AND c) has no links to workplace (or is absent from work or quarantined).
 							for (int HH_member = FirstPerson_Household; (HH_member < LastPerson_Household) && (!AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace); HH_member++)
 								AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace =
-								(Hosts[HH_member].is_alive() && (HOST_AGE_YEAR(HH_member) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[HH_member].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_QUARANTINED(HH_member))));
+								(HostsState[HH_member].is_alive() && (HOST_AGE_YEAR(HH_member) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[HH_member].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_QUARANTINED(HH_member))));
 							if (!AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace) //// so !AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace true if there's no living adult household member who is not quarantined already or isn't a home-worker.
 							{
 								for (int HH_member = FirstPerson_Household; (HH_member < LastPerson_Household) && (!AtLeastOneHouseMemberIsAlive_Adult_WithNoLinksToWorkplace); HH_member++) //// loop over all household members of child this place: find the adults and ensure they're not dead...
-									if ((HOST_AGE_YEAR(HH_member) >= P.CaseAbsentChildAgeCutoff) && Hosts[HH_member].is_alive())
+									if ((HOST_AGE_YEAR(HH_member) >= P.CaseAbsentChildAgeCutoff) && HostsState[HH_member].is_alive())
 									{
 										int index = StateT[tn].host_closure_queue_size;
 										if (index >= P.InfQueuePeakLength) ERR_CRITICAL("Out of space in host_closure_queue\n");
@@ -1232,8 +1252,8 @@ void DoPlaceClose(int i, int j, unsigned short int TimeStepNow, int tn, int DoAn
 					//#pragma omp critical (closeplace3)
 					{
 						///// finally amend absent start and stop times if they contradict place start and stop times.
-						if (Hosts[WhichPerson].absent_start_time > t_start_place_close	) Hosts[WhichPerson].absent_start_time	= t_start_place_close;
-						if (Hosts[WhichPerson].absent_stop_time	< t_stop_place_close	) Hosts[WhichPerson].absent_stop_time	= t_stop_place_close;
+						if (HostsState[WhichPerson].absent_start_time > t_start_place_close	) HostsState[WhichPerson].absent_start_time	= t_start_place_close;
+						if (HostsState[WhichPerson].absent_stop_time	< t_stop_place_close	) HostsState[WhichPerson].absent_stop_time	= t_stop_place_close;
 					}
 					if ((HOST_AGE_YEAR(WhichPerson) >= P.CaseAbsentChildAgeCutoff) && (Hosts[WhichPerson].PlaceLinks[P.PlaceTypeNoAirNum - 1] >= 0)) StateT[tn].cumAPC++;
 				}
@@ -1250,8 +1270,8 @@ void UpdateHostClosure()
 			int host_index = StateT[hcq_thread_no].host_closure_queue[host_closure].host_index;
 			unsigned short t_start = StateT[hcq_thread_no].host_closure_queue[host_closure].start_time;
 			unsigned short t_stop = StateT[hcq_thread_no].host_closure_queue[host_closure].stop_time;
-			if (Hosts[host_index].absent_start_time > t_start) Hosts[host_index].absent_start_time = t_start;
-			if (Hosts[host_index].absent_stop_time < t_stop) Hosts[host_index].absent_stop_time = t_stop;
+			if (HostsState[host_index].absent_start_time > t_start) HostsState[host_index].absent_start_time = t_start;
+			if (HostsState[host_index].absent_stop_time < t_stop) HostsState[host_index].absent_stop_time = t_stop;
 		}
 		StateT[hcq_thread_no].host_closure_queue_size = 0;
 	}
@@ -1269,21 +1289,21 @@ void DoPlaceOpen(int i, int j, unsigned short int TimeStepNow)
 				for (k = 0; k < Places[i][j].n; k++)
 				{
 					ai = Places[i][j].members[k];
-					if (Hosts[ai].absent_stop_time == Places[i][j].close_end_time) Hosts[ai].absent_stop_time = TimeStepNow;
-					if (Hosts[ai].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if child needs adult supervision
+					if (HostsState[ai].absent_stop_time == Places[i][j].close_end_time) HostsState[ai].absent_stop_time = TimeStepNow;
+					if (HostsState[ai].ProbCare < P.CaseAbsentChildPropAdultCarers) //// if child needs adult supervision
 					{
 						if ((HOST_AGE_YEAR(ai) < P.CaseAbsentChildAgeCutoff) && (!HOST_QUARANTINED(ai)))
 						{
 							j1 = Households[Hosts[ai].hh].FirstPerson; j2 = j1 + Households[Hosts[ai].hh].nh;
 							f = 0;
 							for (l = j1; (l < j2) && (!f); l++)
-								f = (Hosts[l].is_alive() && (HOST_AGE_YEAR(l) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[l].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_QUARANTINED(l))));
+								f = (HostsState[l].is_alive() && (HOST_AGE_YEAR(l) >= P.CaseAbsentChildAgeCutoff) && ((Hosts[l].PlaceLinks[P.PlaceTypeNoAirNum - 1] < 0) || (HOST_QUARANTINED(l))));
 							if (!f)
 							{
 								for (l = j1; (l < j2) && (!f); l++)
-									if ((HOST_AGE_YEAR(l) >= P.CaseAbsentChildAgeCutoff) && (Hosts[l].is_alive()) && (HOST_ABSENT(l)))
+									if ((HOST_AGE_YEAR(l) >= P.CaseAbsentChildAgeCutoff) && (HostsState[l].is_alive()) && (HOST_ABSENT(l)))
 									{
-										if (Hosts[l].absent_stop_time == Places[i][j].close_end_time) Hosts[l].absent_stop_time = TimeStepNow;
+										if (HostsState[l].absent_stop_time == Places[i][j].close_end_time) HostsState[l].absent_stop_time = TimeStepNow;
 									}
 							}
 						}
@@ -1297,10 +1317,10 @@ void DoPlaceOpen(int i, int j, unsigned short int TimeStepNow)
 void DoVacc(int ai, unsigned short int TimeStepNow)
 {
 	bool cumV_OK = false;
-	// Orig inf status: (Hosts[ai].inf < InfStat::InfectiousAlmostSymptomatic) || (Hosts[ai].inf >= InfStat::Dead_WasAsymp))
+	// Orig inf status: (HostsState[ai].inf < InfStat::InfectiousAlmostSymptomatic) || (HostsState[ai].inf >= InfStat::Dead_WasAsymp))
 	// < -1, or >= 5
 	// InfStat:: -2 = 
-	if (HOST_TO_BE_VACCED(ai) || Hosts[ai].do_not_vaccinate())
+	if (HOST_TO_BE_VACCED(ai) || HostsState[ai].do_not_vaccinate())
 		return;
 	if (State.cumV < P.VaccMaxCourses)
 	{
@@ -1310,7 +1330,7 @@ void DoVacc(int ai, unsigned short int TimeStepNow)
 	}
 	if (cumV_OK)
 	{
-		Hosts[ai].vacc_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.VaccDelayMean));
+		HostsState[ai].vacc_start_time = TimeStepNow + ((unsigned short int) (P.TimeStepsPerDay * P.VaccDelayMean));
 
 		if (P.VaccDosePerDay >= 0)
 		{
@@ -1339,7 +1359,7 @@ void DoVaccNoDelay(int ai, unsigned short int TimeStepNow)
 {
 	bool cumVG_OK = false;
 
-	if (HOST_TO_BE_VACCED(ai) || Hosts[ai].do_not_vaccinate()) 
+	if (HOST_TO_BE_VACCED(ai) || HostsState[ai].do_not_vaccinate()) 
 		return;
 	if (State.cumVG < P.VaccMaxCourses)
 	{
@@ -1349,7 +1369,7 @@ void DoVaccNoDelay(int ai, unsigned short int TimeStepNow)
 	}
 	if (cumVG_OK)
 	{
-		Hosts[ai].vacc_start_time = TimeStepNow;
+		HostsState[ai].vacc_start_time = TimeStepNow;
 		if (P.VaccDosePerDay >= 0)
 		{
 #pragma omp atomic
@@ -1574,6 +1594,6 @@ static void UpdateCell(int* cellPeople,
 	cellPeople[index] = srcCellPeople[srcIndex];
 
 	// update the listpos
-	Hosts[cellPeople[index]].listpos = index;
+	HostsState[cellPeople[index]].listpos = index;
 }
 
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+r"""Stand-in fitting driver for CovidSim.
+
+Invoke as:
+
+fit-driver.py --covidsim <exe> --params 1,2 --initial 2.0,0.14 \
+   --steps 0.1,0.01 [--iterations 20] [--seed 1] [--log <file>] \
+   -- <CovidSim arguments, including /DT, but not /F>
+
+Runs a random walk Metropolis sampler over the /CLP parameters given by
+--params (flat prior, positive values only), with CovidSim as a single
+long-lived worker started with /F:-. The population is set up once, and
+each iteration is a line written to the worker's stdin:
+
+    Iteration NumParams Index1 ... IndexN Value1 ... ValueN
+
+(the contents of a <fit>.f<Iteration>.txt file), to which the worker
+replies with a line on stdout:
+
+    Iteration<TAB>LogLikelihood
+
+(the contents of a <fit>.f<Iteration>.ll.txt file). Sending a line with
+NumParams <= 0, or closing stdin, stops the worker.
+
+The chain is printed to stdout, one line per iteration.
+"""
+
+import argparse
+import math
+import random
+import subprocess
+import sys
+
+
+def parse_args():
+    """Parse the arguments.
+
+    On exit: Returns the result of calling argparse.parse()
+    """
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+            "--covidsim",
+            help="Location of CovidSim binary",
+            required=True)
+    parser.add_argument(
+            "--params",
+            help="Comma separated indices of the /CLP parameters to fit",
+            required=True)
+    parser.add_argument(
+            "--initial",
+            help="Comma separated initial values of the parameters",
+            required=True)
+    parser.add_argument(
+            "--steps",
+            help="Comma separated standard deviations of the proposals",
+            required=True)
+    parser.add_argument(
+            "--iterations",
+            help="Number of iterations",
+            type=int,
+            default=20)
+    parser.add_argument(
+            "--seed",
+            help="Seed for the proposals",
+            type=int,
+            default=1)
+    parser.add_argument(
+            "--log",
+            help="File to write CovidSim's log to (default: stderr)")
+    parser.add_argument(
+            "covidsim_args",
+            nargs=argparse.REMAINDER,
+            help="Arguments to CovidSim, after --")
+    args = parser.parse_args()
+
+    args.params = [int(x) for x in args.params.split(",")]
+    args.initial = [float(x) for x in args.initial.split(",")]
+    args.steps = [float(x) for x in args.steps.split(",")]
+    if len(args.initial) != len(args.params) or len(args.steps) != len(args.params):
+        parser.error("--params, --initial and --steps must have the same length")
+    if args.covidsim_args and args.covidsim_args[0] == "--":
+        args.covidsim_args = args.covidsim_args[1:]
+    return args
+
+
+class Worker:
+    """A CovidSim process taking fitting iterations on stdin."""
+
+    def __init__(self, covidsim, covidsim_args, log):
+        self.proc = subprocess.Popen(
+                [covidsim, "/F:-"] + covidsim_args,
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=log,
+                universal_newlines=True)
+        self.iteration = 0
+
+    def log_likelihood(self, params, values):
+        """Run the next iteration, returning its log-likelihood."""
+        self.iteration += 1
+        iteration = self.iteration
+        fields = [iteration, len(params)] + params + ["{:.17g}".format(v) for v in values]
+        self.proc.stdin.write(" ".join(str(f) for f in fields) + "\n")
+        self.proc.stdin.flush()
+        reply = self.proc.stdout.readline()
+        if not reply:
+            sys.exit("CovidSim stopped during iteration {}".format(iteration))
+        reply_iteration, ll = reply.split()
+        if int(reply_iteration) != iteration:
+            print("Warning: reply for iteration {} to iteration {}".format(
+                    reply_iteration, iteration), file=sys.stderr)
+        return float(ll)
+
+    def stop(self):
+        self.proc.stdin.write("{} 0\n".format(self.iteration + 1))
+        self.proc.stdin.close()
+        return self.proc.wait()
+
+
+def main():
+    args = parse_args()
+    rng = random.Random(args.seed)
+    log = open(args.log, "w") if args.log else None
+    worker = Worker(args.covidsim, args.covidsim_args, log)
+
+    current = args.initial
+    current_ll = worker.log_likelihood(args.params, current)
+    accepted = 0
+    print("iteration\t" + "\t".join("CLP{}".format(p) for p in args.params) + "\tlog_likelihood\taccepted")
+    print("1\t" + "\t".join("{:.6g}".format(v) for v in current) + "\t{:.8g}\t1".format(current_ll))
+    for iteration in range(2, args.iterations + 1):
+        proposed = [v + rng.gauss(0, s) for v, s in zip(current, args.steps)]
+        accept = False
+        if min(proposed) > 0:
+            ll = worker.log_likelihood(args.params, proposed)
+            accept = math.log(1.0 - rng.random()) < ll - current_ll
+        if accept:
+            current, current_ll = proposed, ll
+            accepted += 1
+        print("{}\t".format(iteration) + "\t".join("{:.6g}".format(v) for v in current)
+              + "\t{:.8g}\t{}".format(current_ll, int(accept)))
+        sys.stdout.flush()
+
+    rc = worker.stop()
+    if log:
+        log.close()
+    print("Accepted {} of {} proposals".format(accepted, args.iterations - 1), file=sys.stderr)
+    sys.exit(rc)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,224 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include "DensityFile.h"
+#include "Files.h"
+#include "Memory.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char* density_text =
+  "-156.60834\t71.333336\t1\t56\t560100\n"
+  "-156.68333 71.325 28 56 560100\r\n"
+  "\n"
+  "  10.5\t-3.25\t7.5\t44\t440200\n"
+  "1e1 2E-1 0 0x10 010\n"
+  "-179.5 0 3 1 2";
+
+TEST(DensityFile, parse_text) {
+  uint64_t n;
+  BinFile* bf = DensityFile::parse_text(density_text, strlen(density_text), n, true, -170.0, 1);
+  ASSERT_EQ(5u, n);
+  EXPECT_DOUBLE_EQ(-156.60834, bf[0].x);
+  EXPECT_DOUBLE_EQ(71.333336, bf[0].y);
+  EXPECT_DOUBLE_EQ(1.0, bf[0].pop);
+  EXPECT_EQ(56, bf[0].cnt);
+  EXPECT_EQ(560100, bf[0].ad);
+  EXPECT_DOUBLE_EQ(28.0, bf[1].pop);
+  EXPECT_DOUBLE_EQ(10.5, bf[2].x);
+  EXPECT_DOUBLE_EQ(-3.25, bf[2].y);
+  EXPECT_EQ(440200, bf[2].ad);
+  // Integer columns follow "%i": hex and octal prefixes are honoured.
+  EXPECT_DOUBLE_EQ(10.0, bf[3].x);
+  EXPECT_EQ(16, bf[3].cnt);
+  EXPECT_EQ(8, bf[3].ad);
+  // Longitudes west of the cut line are wrapped; the last line has no newline.
+  EXPECT_DOUBLE_EQ(180.5, bf[4].x);
+  EXPECT_EQ(2, bf[4].ad);
+  Memory::xfree(bf);
+
+  bf = DensityFile::parse_text(density_text, strlen(density_text), n, false, -360.0, 1);
+  ASSERT_EQ(5u, n);
+  EXPECT_EQ(0, bf[0].ad);
+  EXPECT_DOUBLE_EQ(-179.5, bf[4].x);
+  Memory::xfree(bf);
+}
+
+TEST(DensityFile, parse_text_independent_of_threads) {
+  std::string text;
+  char line[128];
+  for (int i = 0; i < 5000; i++) {
+    snprintf(line, sizeof(line), "%.6f %.6f %d %d %d\n", -10.0 + i * 0.001, 50.0 - i * 0.002, i % 97, i % 7, 100 + i);
+    text += line;
+  }
+  uint64_t n1, n2;
+  BinFile* bf1 = DensityFile::parse_text(text.c_str(), text.size(), n1, true, -360.0, 1);
+  for (int threads = 2; threads <= 16; threads *= 2) {
+    BinFile* bf2 = DensityFile::parse_text(text.c_str(), text.size(), n2, true, -360.0, threads);
+    ASSERT_EQ(5000u, n2);
+    ASSERT_EQ(n1, n2);
+    EXPECT_EQ(0, memcmp(bf1, bf2, n1 * sizeof(BinFile)));
+    Memory::xfree(bf2);
+  }
+  Memory::xfree(bf1);
+}
+
+// Reading a file gives the same records for any number of threads and chunks,
+// whether the chunks' nominal starts fall at the start of a line or within one.
+TEST(DensityFile, read_text_independent_of_threads) {
+  // Fixed width lines, so that where the chunks start is known.
+  const int num_lines = 5000, line_length = 35;
+  std::string text;
+  char line[128];
+  for (int i = 0; i < num_lines; i++) {
+    snprintf(line, sizeof(line), "%10.5f %10.5f %3d %1d %6d\n", -10.0 + i * 0.001, 50.0 - i * 0.002, i % 97, i % 7, 100000 + i);
+    text += line;
+  }
+  ASSERT_EQ((size_t)num_lines * line_length, text.size());
+  FILE* dat = Files::xfopen("test_density_threads.txt", "wb");
+  Files::fwrite_big((void*)text.data(), 1, text.size(), dat);
+  Files::xfclose(dat);
+
+#ifdef _OPENMP
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  uint64_t n1, n2;
+  BinFile* bf1 = DensityFile::read_text("test_density_threads.txt", n1, true, -360.0, 1);
+  ASSERT_EQ((uint64_t)num_lines, n1);
+  for (int threads : { 2, 3, 5, 7, 16 }) {
+    // With 2 or 5 chunks every chunk starts a line; with 3, 7 or 16 chunks, starts fall mid-line.
+    std::size_t chunk = text.size() / threads;
+    EXPECT_EQ(threads == 5 || threads == 2, chunk % line_length == 0) << threads << " threads";
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    BinFile* bf2 = DensityFile::read_text("test_density_threads.txt", n2, true, -360.0, threads);
+    ASSERT_EQ(n1, n2);
+    EXPECT_EQ(0, memcmp(bf1, bf2, n1 * sizeof(BinFile))) << threads << " threads";
+    Memory::xfree(bf2);
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+  Memory::xfree(bf1);
+  Files::xremove("test_density_threads.txt");
+}
+
+TEST(DensityFile, binary_round_trip) {
+  uint64_t n, n2;
+  BinFile* bf = DensityFile::parse_text(density_text, strlen(density_text), n, true, -180.0, 2);
+  DensityFile::write_binary("test_density.bin", bf, n);
+  EXPECT_TRUE(DensityFile::is_binary("test_density.bin"));
+  BinFile* bf2 = DensityFile::read_binary("test_density.bin", n2);
+  ASSERT_EQ(n, n2);
+  EXPECT_EQ(0, memcmp(bf, bf2, n * sizeof(BinFile)));
+  Files::xremove("test_density.bin");
+  Memory::xfree(bf2);
+  Memory::xfree(bf);
+}
+
+TEST(DensityFileDeathTests, parse_text_short_line) {
+  const char* text = "1 2 3 4 5\n1 2 3\n";
+  uint64_t n;
+  ASSERT_DEATH({
+    DensityFile::parse_text(text, strlen(text), n, true, -360.0, 1);
+  }, "Error reading line 2 of density file.*");
+}
+
+TEST(DensityFile, binary_v2_round_trip) {
+  uint64_t n, n2;
+  uint32_t flags;
+  BinFile* bf = DensityFile::parse_text(density_text, strlen(density_text), n, true, -170.0, 1);
+  DensityFile::write_binary_v2("test_density_v2.bin", bf, n, false, 0);
+  EXPECT_TRUE(DensityFile::is_binary("test_density_v2.bin"));
+  BinFile* bf2 = DensityFile::read_binary("test_density_v2.bin", n2, &flags);
+  ASSERT_EQ(n, n2);
+  EXPECT_EQ(0u, flags);
+  // Lossless unless single precision coordinates are asked for.
+  EXPECT_EQ(0, memcmp(bf, bf2, n * sizeof(BinFile)));
+  Memory::xfree(bf2);
+
+  DensityFile::write_binary_v2("test_density_v2.bin", bf, n, true, DensityFile::V2_MORTON_ORDER);
+  bf2 = DensityFile::read_binary("test_density_v2.bin", n2, &flags);
+  ASSERT_EQ(n, n2);
+  EXPECT_EQ(DensityFile::V2_MORTON_ORDER, flags);
+  for (uint64_t i = 0; i < n; i++) {
+    EXPECT_EQ((double)(float)bf[i].x, bf2[i].x);
+    EXPECT_EQ((double)(float)bf[i].y, bf2[i].y);
+    EXPECT_EQ(bf[i].pop, bf2[i].pop);
+    EXPECT_EQ(bf[i].cnt, bf2[i].cnt);
+    EXPECT_EQ(bf[i].ad, bf2[i].ad);
+  }
+  Files::xremove("test_density_v2.bin");
+  Memory::xfree(bf2);
+  Memory::xfree(bf);
+}
+
+TEST(DensityFileDeathTests, binary_v2_truncated) {
+  // A header claiming more records than the file holds is rejected before allocating them.
+  uint64_t n;
+  BinFile* bf = DensityFile::parse_text(density_text, strlen(density_text), n, true, -180.0, 1);
+  DensityFile::write_binary_v2("test_density_v2_short.bin", bf, n, false, 0);
+  Memory::xfree(bf);
+  FILE* dat = Files::xfopen("test_density_v2_short.bin", "r+b");
+  uint64_t num_records = UINT64_C(1) << 60;
+  fseek(dat, 2 * sizeof(uint32_t), SEEK_SET);
+  Files::fwrite_big(&num_records, sizeof(uint64_t), 1, dat);
+  Files::xfclose(dat);
+  ASSERT_DEATH({
+    DensityFile::read_binary("test_density_v2_short.bin", n);
+  }, "Density file test_density_v2_short.bin is too short for its 1152921504606846976 records");
+  Files::xremove("test_density_v2_short.bin");
+}
+
+TEST(DensityFile, cache_matches_source) {
+  uint64_t n, n2;
+  BinFile* bf = DensityFile::parse_text(density_text, strlen(density_text), n, true, -170.0, 1);
+  DensityFile::TextSource source = { 1234, 1600000000, true, -170.0 };
+  DensityFile::write_cache("test_density_cache.bin", source, bf, n);
+  BinFile* bf2 = NULL;
+  ASSERT_TRUE(DensityFile::read_cache("test_density_cache.bin", source, bf2, n2));
+  ASSERT_EQ(n, n2);
+  EXPECT_EQ(0, memcmp(bf, bf2, n * sizeof(BinFile)));
+  Memory::xfree(bf2);
+
+  // A changed text file or different parse settings make the cache stale.
+  DensityFile::TextSource stale[4] = { source, source, source, source };
+  stale[0].size++;
+  stale[1].mtime++;
+  stale[2].do_ad_units = false;
+  stale[3].longitude_cut_line = -180.0;
+  for (DensityFile::TextSource const& other : stale) {
+    EXPECT_FALSE(DensityFile::read_cache("test_density_cache.bin", other, bf2, n2));
+  }
+
+  // Neither a missing file nor a plain binary density file is a cache.
+  Files::xremove("test_density_cache.bin");
+  EXPECT_FALSE(DensityFile::read_cache("test_density_cache.bin", source, bf2, n2));
+  DensityFile::write_binary_v2("test_density_cache.bin", bf, n, false, 0);
+  EXPECT_FALSE(DensityFile::read_cache("test_density_cache.bin", source, bf2, n2));
+  Files::xremove("test_density_cache.bin");
+  Memory::xfree(bf);
+}
+
+TEST(DensityFile, sort_morton) {
+  EXPECT_EQ(0u, DensityFile::morton_key(0, 0));
+  EXPECT_EQ(1u, DensityFile::morton_key(0, 1));
+  EXPECT_EQ(2u, DensityFile::morton_key(1, 0));
+  EXPECT_EQ(3u, DensityFile::morton_key(1, 1));
+  EXPECT_EQ(12u, DensityFile::morton_key(2, 2));
+
+  // Microcells of size 1 from the origin; the two records in (1,1) keep their order.
+  BinFile bf[5] = {
+    { 3.5, 3.5, 1, 0, 0 }, { 1.5, 1.2, 2, 0, 0 }, { 0.5, 0.5, 3, 0, 0 },
+    { 1.5, 1.8, 4, 0, 0 }, { 0.5, 1.5, 5, 0, 0 }
+  };
+  DensityFile::sort_morton(bf, 5, 0.0, 0.0, 1.0, 1.0);
+  EXPECT_DOUBLE_EQ(3, bf[0].pop);
+  EXPECT_DOUBLE_EQ(5, bf[1].pop);
+  EXPECT_DOUBLE_EQ(2, bf[2].pop);
+  EXPECT_DOUBLE_EQ(4, bf[3].pop);
+  EXPECT_DOUBLE_EQ(1, bf[4].pop);
+}
@@ -0,0 +1,83 @@
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+#include "EventLog.h"
+#include "Files.h"
+
+static Events make_event(int i, double t, int thread) {
+  Events ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.run = i / 4;
+  ev.type = i % 4;
+  ev.t = t;
+  ev.thread = thread;
+  ev.infectee_ind = 1000000 + i * 7919;
+  ev.infector_ind = (i % 5 == 0) ? -1 : i * 31;
+  ev.infectee_adunit = i % 3;
+  ev.listpos = i * 2;
+  ev.infectee_cell = 40000 + i;
+  ev.infector_cell = (i % 5 == 0) ? -1 : 40000 - i;
+  ev.infectee_x = -122.25 + i * 0.001;
+  ev.infectee_y = 37.75 - i * 0.002;
+  ev.t_infector = (i % 5 == 0) ? -1 : (double)(i / 2);
+  return ev;
+}
+
+static void expect_equal(Events const& a, Events const& b) {
+  EXPECT_EQ(a.run, b.run);
+  EXPECT_EQ(a.type, b.type);
+  EXPECT_EQ(a.t, b.t);
+  EXPECT_EQ(a.thread, b.thread);
+  EXPECT_EQ(a.infectee_ind, b.infectee_ind);
+  EXPECT_EQ(a.infector_ind, b.infector_ind);
+  EXPECT_EQ(a.infectee_adunit, b.infectee_adunit);
+  EXPECT_EQ(a.listpos, b.listpos);
+  EXPECT_EQ(a.infectee_cell, b.infectee_cell);
+  EXPECT_EQ(a.infector_cell, b.infector_cell);
+  EXPECT_EQ(a.infectee_x, b.infectee_x);
+  EXPECT_EQ(a.infectee_y, b.infectee_y);
+  EXPECT_EQ(a.t_infector, b.t_infector);
+}
+
+TEST(EventLog, collect_merges_threads_in_time_order) {
+  std::vector<Events> buffers[3];
+  buffers[0] = { make_event(0, 0.0, 0), make_event(1, 1.0, 0), make_event(2, 1.0, 0) };
+  buffers[2] = { make_event(3, 0.5, 2), make_event(4, 1.0, 2) };
+  std::vector<Events> events = { make_event(5, 7.0, 1) }; // collected earlier
+  EventLog::collect(buffers, 3, events);
+  for (auto const& buffer : buffers) EXPECT_TRUE(buffer.empty());
+  ASSERT_EQ(6u, events.size());
+  int expected[] = { 5, 0, 3, 1, 2, 4 };
+  for (int i = 0; i < 6; i++) EXPECT_EQ(make_event(expected[i], 0, 0).infectee_ind, events[i].infectee_ind);
+}
+
+TEST(EventLog, encode_round_trip) {
+  std::vector<Events> events;
+  for (int i = 0; i < 100; i++) events.push_back(make_event(i, (i / 10) * 0.25, i % 4));
+  std::vector<unsigned char> bytes = EventLog::encode(events.data(), events.size());
+  EXPECT_LT(bytes.size(), events.size() * sizeof(Events) / 2);
+
+  std::vector<Events> decoded;
+  ASSERT_TRUE(EventLog::decode(bytes.data(), bytes.size(), events.size(), decoded));
+  ASSERT_EQ(events.size(), decoded.size());
+  for (std::size_t i = 0; i < events.size(); i++) expect_equal(events[i], decoded[i]);
+
+  // Truncated input or the wrong count is rejected.
+  decoded.clear();
+  EXPECT_FALSE(EventLog::decode(bytes.data(), bytes.size() - 1, events.size(), decoded));
+  decoded.clear();
+  EXPECT_FALSE(EventLog::decode(bytes.data(), bytes.size(), events.size() - 1, decoded));
+}
+
+TEST(EventLog, stream_round_trip) {
+  std::vector<Events> events;
+  for (int i = 0; i < 30; i++) events.push_back(make_event(i, i * 0.5, 0));
+  EventLog::create("test_events.bin");
+  EventLog::append("test_events.bin", events.data(), 10);
+  EventLog::append("test_events.bin", events.data() + 10, 0);
+  EventLog::append("test_events.bin", events.data() + 10, 20);
+  std::vector<Events> read = EventLog::read("test_events.bin");
+  Files::xremove("test_events.bin");
+  ASSERT_EQ(events.size(), read.size());
+  for (std::size_t i = 0; i < events.size(); i++) expect_equal(events[i], read[i]);
+}
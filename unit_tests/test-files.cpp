@@ -113,6 +113,19 @@ TEST(FilesDeathTests, remove_fail) {
   }, "Error .* removing file .*");
 }
 
+TEST(Files, stat_file) {
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  EXPECT_FALSE(Files::stat_file("this_doesn_exist.txt", size, mtime));
+  FILE* f = Files::xfopen("test_stat_file.txt", "wb");
+  Files::xfprintf(f, "12345");
+  Files::xfclose(f);
+  EXPECT_TRUE(Files::stat_file("test_stat_file.txt", size, mtime));
+  EXPECT_EQ(5u, size);
+  EXPECT_GT(mtime, 0);
+  Files::xremove("test_stat_file.txt");
+}
+
 TEST(Files, sprintf) {
   char* buf = new char[10];
   Files::xsprintf(buf, "%d", 123);
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AliasTable.h"
+#include "Constants.h"
+#include "Country.h"
+#include "HouseholdAges.h"
+#include "Param.h"
+#include "Rand.h"
+
+static const int MAX_AGE = NUM_AGE_GROUPS * AGE_GROUP_WIDTH;
+
+// Upper tail critical value of the chi-square distribution with df degrees of
+// freedom at p = 1e-4, by the Wilson-Hilferty approximation.
+static double chi2_critical(int df) {
+  const double z = 3.719; // standard normal upper tail at 1e-4
+  double v = 2.0 / (9.0 * df);
+  return df * pow(1.0 - v + z * sqrt(v), 3);
+}
+
+// Two-sample chi-square test that two histograms with equal totals come from
+// the same distribution. Bins are merged until each has at least 20 counts
+// between the two. Returns the statistic divided by its critical value.
+static double chi2_ratio(std::vector<long> const& a, std::vector<long> const& b) {
+  double stat = 0;
+  long sa = 0, sb = 0;
+  int bins = 0;
+  for (std::size_t i = 0; i < a.size(); i++) {
+    sa += a[i];
+    sb += b[i];
+    if (sa + sb >= 20 || i == a.size() - 1) {
+      if (sa + sb > 0) {
+        stat += (double)(sa - sb) * (sa - sb) / (sa + sb);
+        bins++;
+      }
+      sa = sb = 0;
+    }
+  }
+  if (bins < 2) return 0;
+  return stat / chi2_critical(bins - 1);
+}
+
+class HouseholdAges : public ::testing::Test {
+protected:
+  std::unique_ptr<Param> params;
+  std::vector<int> inv_age_dist;
+
+  void SetUp() override {
+    Xcg1 = new int32_t[MAX_NUM_THREADS * CACHE_LINE_SIZE]();
+    Xcg2 = new int32_t[MAX_NUM_THREADS * CACHE_LINE_SIZE]();
+    int32_t seed1 = 1234567, seed2 = 7654321;
+    setall(&seed1, &seed2);
+
+    // The defaults in ReadParams.cpp.
+    params = std::unique_ptr<Param>(new Param());
+    Param& p = *params;
+    p.DoHouseholds = 1;
+    p.MeanChildAgeGap = 2;
+    p.MinAdultAge = 19;
+    p.MaxMFPartnerAgeGap = 5;
+    p.MaxFMPartnerAgeGap = 5;
+    p.MinParentAgeGap = 19;
+    p.MaxParentAgeGap = 44;
+    p.MaxChildAge = 20;
+    p.OneChildTwoPersProb = 0.08;
+    p.TwoChildThreePersProb = 0.11;
+    p.OnePersHouseProbOld = 0.5;
+    p.TwoPersHouseProbOld = 0.5;
+    p.OnePersHouseProbYoung = 0.23;
+    p.TwoPersHouseProbYoung = 0.23;
+    p.OneChildProbYoungestChildUnderFive = 0.5;
+    p.TwoChildrenProbYoungestUnderFive = 0.0;
+    p.ProbYoungestChildUnderFive = 0.0;
+    p.ZeroChildThreePersProb = 0.25;
+    p.OneChildFourPersProb = 0.2;
+    p.YoungAndSingleSlope = 0.7;
+    p.YoungAndSingle = 36;
+    p.NoChildPersAge = 44;
+    p.OldPersAge = 60;
+    p.ThreeChildFivePersProb = 0.5;
+    p.OlderGenGap = 19;
+
+    // An age distribution that thins out with age, as in ReadParams.
+    inv_age_dist.resize(1000);
+    for (int i = 0; i < 1000; i++) {
+      double u = i / 1000.0;
+      inv_age_dist[i] = (int)(MAX_AGE * (1.0 - sqrt(1.0 - 0.95 * u)) / (1.0 - sqrt(0.05)));
+      if (inv_age_dist[i] >= MAX_AGE) inv_age_dist[i] = MAX_AGE - 1;
+    }
+  }
+
+  void TearDown() override {
+    delete[] Xcg1;
+    delete[] Xcg2;
+  }
+};
+
+TEST_F(HouseholdAges, matches_rejection_sampler) {
+  const int num_households = 100000;
+  HouseholdAgeSampler sampler(*params, inv_age_dist.data());
+  int ages[MAX_HOUSEHOLD_SIZE + 2];
+  for (int n = 1; n <= MAX_HOUSEHOLD_SIZE; n++) {
+    // Ages by position in the household, and the household's total age.
+    std::vector<std::vector<long>> direct(n + 1, std::vector<long>(n * MAX_AGE)), rejection(direct);
+    for (int h = 0; h < num_households; h++) {
+      int total = 0;
+      sampler.sample(n, 0, ages);
+      for (int k = 0; k < n; k++) {
+        ASSERT_GE(ages[k], 0);
+        ASSERT_LT(ages[k], MAX_AGE);
+        direct[k][ages[k]]++;
+        total += ages[k];
+      }
+      direct[n][total]++;
+      total = 0;
+      HouseholdAgeSampler::sample_by_rejection(*params, inv_age_dist.data(), n, 0, ages);
+      for (int k = 0; k < n; k++) {
+        rejection[k][ages[k]]++;
+        total += ages[k];
+      }
+      rejection[n][total]++;
+    }
+    for (int k = 0; k <= n; k++)
+      EXPECT_LT(chi2_ratio(direct[k], rejection[k]), 1.0) << "household size " << n << ", member " << k;
+  }
+}
+
+TEST(AliasTable, frequencies) {
+  Xcg1 = new int32_t[MAX_NUM_THREADS * CACHE_LINE_SIZE]();
+  Xcg2 = new int32_t[MAX_NUM_THREADS * CACHE_LINE_SIZE]();
+  int32_t seed1 = 42, seed2 = 4242;
+  setall(&seed1, &seed2);
+
+  std::vector<double> weights = { 1, 0, 3, 0.5, 10, 0, 2.5, 3 };
+  AliasTable table(weights);
+  ASSERT_EQ((int)weights.size(), table.size());
+  double total = 0;
+  for (double w : weights) total += w;
+
+  const long draws = 1000000;
+  std::vector<long> counts(weights.size());
+  for (long i = 0; i < draws; i++) counts[table.choose(ranf_mt(0))]++;
+  double stat = 0;
+  for (std::size_t i = 0; i < weights.size(); i++) {
+    double expected = draws * weights[i] / total;
+    if (weights[i] == 0)
+      EXPECT_EQ(0, counts[i]);
+    else
+      stat += (counts[i] - expected) * (counts[i] - expected) / expected;
+  }
+  EXPECT_LT(stat, chi2_critical(5));
+
+  // The ends of [0, 1) choose outcomes that can occur.
+  EXPECT_NE(0, weights[table.choose(0.0)]);
+  EXPECT_NE(0, weights[table.choose(0.9999999999)]);
+
+  delete[] Xcg1;
+  delete[] Xcg2;
+}
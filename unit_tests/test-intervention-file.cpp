@@ -0,0 +1,158 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include "Files.h"
+#include "InterventionFile.h"
+
+static const char* intervention_text =
+  "\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"
+  "<InterventionSettings>\n"
+  "<!-- <intervention> in a comment is ignored -->\n"
+  "<description lang=\"en\">Not <b>read</b></description>\n"
+  "<intervention>\n"
+  " <parameters>\n"
+  "  <StartTime>10</StartTime><Type>Vaccination</Type>\n"
+  "  <AUThresh>0</AUThresh><StopTime>40</StopTime>\n"
+  "  <MinDuration>0.5</MinDuration><RepeatInterval>1</RepeatInterval>\n"
+  "  <MaxPrevAtStart>1</MaxPrevAtStart><MinPrevAtStart>0</MinPrevAtStart><MaxPrevAtStop>0.5</MaxPrevAtStop>\n"
+  "  <Level> 0.7 </Level><LevelAUVar>0.1</LevelAUVar>\n"
+  "  <MaxRounds>3</MaxRounds><MaxResource>1000</MaxResource>\n"
+  "  <NumSequentialReplicas>2</NumSequentialReplicas>\n"
+  "  <Unknown/>\n"
+  " </parameters>\n"
+  " <adunits>\n"
+  "  <A>Wyoming</A>\n"
+  "  <A> 560100 extra </A>\n"
+  "  <A>A&amp;B&#x20;C</A>\n"
+  " </adunits>\n"
+  "</intervention>\n"
+  "<intervention>\n"
+  " <parameters>\n"
+  "  <Type>3</Type><AUThresh>1</AUThresh><StartTime>5</StartTime><StopTime>6</StopTime>\n"
+  "  <MinDuration>0</MinDuration><RepeatInterval>0</RepeatInterval><MaxPrevAtStart>1</MaxPrevAtStart>\n"
+  "  <MinPrevAtStart>0</MinPrevAtStart><MaxPrevAtStop>0</MaxPrevAtStop><Level>0.3</Level>\n"
+  "  <MaxRounds>1</MaxRounds><MaxResource>5</MaxResource>\n"
+  " </parameters>\n"
+  " <countries><C>United_States</C></countries>\n"
+  "</intervention>\n"
+  "</InterventionSettings>\n";
+
+TEST(InterventionFile, parse) {
+  auto specs = InterventionFile::parse(intervention_text, strlen(intervention_text), "test.xml");
+  ASSERT_EQ(2u, specs.size());
+
+  Intervention const& first = specs[0].interv;
+  EXPECT_EQ(1, first.InterventionType);
+  EXPECT_EQ(0, first.DoAUThresh);
+  EXPECT_DOUBLE_EQ(10.0, first.StartTime);
+  EXPECT_DOUBLE_EQ(40.0, first.StopTime);
+  // Durations are given in years.
+  EXPECT_DOUBLE_EQ(0.5 * DAYS_PER_YEAR, first.MinDuration);
+  EXPECT_DOUBLE_EQ(DAYS_PER_YEAR, first.RepeatInterval);
+  EXPECT_DOUBLE_EQ(0.5, first.StopThreshold);
+  EXPECT_DOUBLE_EQ(0.7, first.Level);
+  EXPECT_DOUBLE_EQ(0.1, first.LevelAUVar);
+  EXPECT_DOUBLE_EQ(0.0, first.LevelCountryVar);
+  EXPECT_EQ(0, first.NoStartAfterMin);
+  EXPECT_EQ(3u, first.MaxRounds);
+  EXPECT_EQ(1000u, first.MaxResource);
+  EXPECT_EQ(2, specs[0].num_sequential_replicas);
+  EXPECT_FALSE(specs[0].by_country);
+  ASSERT_EQ(3u, specs[0].units.size());
+  EXPECT_EQ("Wyoming", specs[0].units[0]);
+  EXPECT_EQ("560100", specs[0].units[1]);
+  EXPECT_EQ("A&B", specs[0].units[2]);
+
+  EXPECT_EQ(3, specs[1].interv.InterventionType);
+  EXPECT_EQ(0, specs[1].num_sequential_replicas);
+  EXPECT_TRUE(specs[1].by_country);
+  ASSERT_EQ(1u, specs[1].units.size());
+  EXPECT_EQ("United_States", specs[1].units[0]);
+}
+
+TEST(InterventionFile, cache_round_trip) {
+  std::vector<InterventionFile::Contents> contents(2), cached;
+  contents[0].filename = "first.xml";
+  contents[0].size = 1234;
+  contents[0].mtime = 1600000000;
+  contents[0].specs = InterventionFile::parse(intervention_text, strlen(intervention_text), "first.xml");
+  contents[1].filename = "second.xml";
+  contents[1].size = 0;
+  contents[1].mtime = -1;
+  InterventionFile::write_cache("test_interventions.bin", contents);
+  ASSERT_TRUE(InterventionFile::read_cache("test_interventions.bin", cached));
+  ASSERT_EQ(2u, cached.size());
+  EXPECT_EQ("first.xml", cached[0].filename);
+  EXPECT_EQ("second.xml", cached[1].filename);
+  EXPECT_EQ(1234u, cached[0].size);
+  EXPECT_EQ(1600000000, cached[0].mtime);
+  EXPECT_EQ(0u, cached[1].size);
+  EXPECT_EQ(-1, cached[1].mtime);
+  EXPECT_TRUE(cached[1].specs.empty());
+  ASSERT_EQ(contents[0].specs.size(), cached[0].specs.size());
+  for (std::size_t i = 0; i < cached[0].specs.size(); i++) {
+    EXPECT_EQ(0, memcmp(&contents[0].specs[i].interv, &cached[0].specs[i].interv, sizeof(Intervention)));
+    EXPECT_EQ(contents[0].specs[i].num_sequential_replicas, cached[0].specs[i].num_sequential_replicas);
+    EXPECT_EQ(contents[0].specs[i].by_country, cached[0].specs[i].by_country);
+    EXPECT_EQ(contents[0].specs[i].units, cached[0].specs[i].units);
+  }
+  Files::xremove("test_interventions.bin");
+}
+
+TEST(InterventionFile, read_cache_other_file) {
+  FILE* dat = Files::xfopen("test_not_interventions.bin", "wb");
+  Files::xfprintf(dat, "<?xml version=\"1.0\"?>\n");
+  Files::xfclose(dat);
+  std::vector<InterventionFile::Contents> cached;
+  EXPECT_FALSE(InterventionFile::read_cache("test_not_interventions.bin", cached));
+  Files::xremove("test_not_interventions.bin");
+}
+
+TEST(InterventionFileDeathTests, missing_parameter) {
+  const char* text =
+    "<?xml version=\"1.0\"?>\n"
+    "<InterventionSettings>\n"
+    "<intervention>\n"
+    " <parameters>\n"
+    "  <Type>1</Type>\n"
+    " </parameters>\n"
+    "</intervention>\n"
+    "</InterventionSettings>\n";
+  ASSERT_DEATH({
+    InterventionFile::parse(text, strlen(text), "test.xml");
+  }, "test.xml:4: Incomplete intervention parameter specification: no <AUThresh>");
+}
+
+TEST(InterventionFileDeathTests, bad_value) {
+  const char* text =
+    "<?xml version=\"1.0\"?>\n"
+    "<InterventionSettings>\n"
+    "<intervention>\n"
+    " <parameters>\n"
+    "  <Type>1</Type>\n"
+    "  <AUThresh>yes</AUThresh>\n"
+    " </parameters>\n"
+    "</intervention>\n"
+    "</InterventionSettings>\n";
+  ASSERT_DEATH({
+    InterventionFile::parse(text, strlen(text), "test.xml");
+  }, "test.xml:6: Can't read <AUThresh> from \"yes\"");
+}
+
+TEST(InterventionFileDeathTests, mismatched_tag) {
+  const char* text =
+    "<?xml version=\"1.0\"?>\n"
+    "<InterventionSettings>\n"
+    "<intervention>\n"
+    " <parameters>\n"
+    "  <Type>1</Tipe>\n";
+  ASSERT_DEATH({
+    InterventionFile::parse(text, strlen(text), "test.xml");
+  }, "test.xml:5: </Tipe> found where </Type> was expected");
+}
+
+TEST(InterventionFileDeathTests, not_xml) {
+  const char* text = "[Type]\n1\n";
+  ASSERT_DEATH({
+    InterventionFile::parse(text, strlen(text), "test.txt");
+  }, "Intervention file test.txt not XML");
+}
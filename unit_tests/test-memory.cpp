@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Memory.h"
+
+TEST(Arena, contiguous_and_zeroed) {
+  Memory::Arena arena(1024);
+  int* a = arena.alloc<int>(10);
+  int* b = arena.alloc<int>(20);
+  EXPECT_EQ(a + 10, b);
+  for (int i = 0; i < 20; i++) EXPECT_EQ(0, b[i]);
+  EXPECT_EQ(30 * sizeof(int), arena.used());
+}
+
+TEST(Arena, alignment) {
+  Memory::Arena arena(1024);
+  arena.alloc<char>(3);
+  double* d = arena.alloc<double>(2);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(d) % alignof(double));
+  unsigned short* s = arena.alloc<unsigned short>(1);
+  EXPECT_EQ(reinterpret_cast<char*>(d + 2), reinterpret_cast<char*>(s));
+}
+
+TEST(Arena, large_and_new_blocks) {
+  Memory::Arena arena(1024);
+  char* small = arena.alloc<char>(200);
+  char* large = arena.alloc<char>(4096);
+  large[4095] = 1;
+  // A large allocation doesn't disturb the current block.
+  EXPECT_EQ(small + 200, arena.alloc<char>(1));
+  // Running out of the current block moves on to a new one.
+  char* next = arena.alloc<char>(900);
+  next[899] = 1;
+  EXPECT_EQ(200 + 4096 + 1 + 900u, arena.used());
+  arena.release();
+  EXPECT_EQ(0u, arena.used());
+  EXPECT_EQ(0, arena.alloc<char>(10)[9]);
+}
+
+TEST(Arena, threads) {
+  Memory::Arena arena(4096);
+  const int num_threads = 4, per_thread = 1000;
+  std::vector<std::vector<int*>> allocated(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++)
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < per_thread; i++) {
+        int* p = arena.alloc<int>(3);
+        p[0] = p[1] = p[2] = t;
+        allocated[t].push_back(p);
+      }
+    });
+  for (auto& thread : threads) thread.join();
+  for (int t = 0; t < num_threads; t++)
+    for (int* p : allocated[t]) {
+      EXPECT_EQ(t, p[0]);
+      EXPECT_EQ(t, p[2]);
+    }
+  EXPECT_EQ(num_threads * per_thread * 3 * sizeof(int), arena.used());
+}
@@ -0,0 +1,40 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "OutputQueue.h"
+
+TEST(OutputQueue, runs_jobs_in_order) {
+  std::vector<int> done;
+  {
+    OutputQueue queue(3);
+    for (int i = 0; i < 20; i++)
+      queue.push([&done, i]() { done.push_back(i); });
+    queue.flush();
+    EXPECT_EQ(20u, done.size());
+    queue.push([&done]() { done.push_back(20); });
+  } // the destructor runs jobs still queued
+  ASSERT_EQ(21u, done.size());
+  for (int i = 0; i < 21; i++) EXPECT_EQ(i, done[i]);
+}
+
+TEST(OutputQueue, bounds_pending_jobs) {
+  const int max_pending = 2;
+  std::atomic<int> pushed(0), finished(0), most_outstanding(0);
+  OutputQueue queue(max_pending);
+  for (int i = 0; i < 10; i++) {
+    queue.push([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      finished++;
+    });
+    pushed++;
+    int outstanding = pushed - finished;
+    if (outstanding > most_outstanding) most_outstanding = outstanding;
+  }
+  queue.flush();
+  EXPECT_EQ(10, finished);
+  // push returns only once there is room, so finished jobs aside at most
+  // max_pending (the one just pushed included) can be outstanding.
+  EXPECT_LE(most_outstanding, max_pending);
+}
@@ -1,10 +1,11 @@
+#include <climits>
 #include <gtest/gtest.h>
 
 #include "Models/Person.h"
 
 TEST(CovidSimPersonTests, Person_Susceptible)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   
   P->set_susceptible();
   ASSERT_FALSE(P->do_not_vaccinate());
@@ -27,7 +28,7 @@ TEST(CovidSimPersonTests, Person_Susceptible)
 
 TEST(CovidSimPersonTests, Person_Latent)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_latent();
   ASSERT_FALSE(P->do_not_vaccinate());
   ASSERT_FALSE(P->is_dead());
@@ -50,7 +51,7 @@ TEST(CovidSimPersonTests, Person_Latent)
 
 TEST(CovidSimPersonTests, Person_Inf_Alm_Sympt)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_infectious_almost_symptomatic();
   ASSERT_FALSE(P->do_not_vaccinate());
   ASSERT_FALSE(P->is_dead());
@@ -72,7 +73,7 @@ TEST(CovidSimPersonTests, Person_Inf_Alm_Sympt)
 
 TEST(CovidSimPersonTests, Person_Case)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_case();
   ASSERT_TRUE(P->do_not_vaccinate());
   ASSERT_FALSE(P->is_dead());
@@ -94,7 +95,7 @@ TEST(CovidSimPersonTests, Person_Case)
 
 TEST(CovidSimPersonTests, Person_Inf_Asymp_Not_Case)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_infectious_asymptomatic_not_case();
   ASSERT_FALSE(P->do_not_vaccinate());
   ASSERT_FALSE(P->is_dead());
@@ -116,7 +117,7 @@ TEST(CovidSimPersonTests, Person_Inf_Asymp_Not_Case)
 
 TEST(CovidSimPersonTests, Person_Death_Symp)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_case();
   P->set_dead();
   ASSERT_TRUE(P->do_not_vaccinate());
@@ -139,7 +140,7 @@ TEST(CovidSimPersonTests, Person_Death_Symp)
 
 TEST(CovidSimPersonTests, Person_Death_ASymp)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_susceptible();
   P->set_dead();
   ASSERT_TRUE(P->do_not_vaccinate());
@@ -162,7 +163,7 @@ TEST(CovidSimPersonTests, Person_Death_ASymp)
 
 TEST(CovidSimPersonTests, Person_Recover_Symp)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_case();
   P->set_recovered();
   ASSERT_TRUE(P->do_not_vaccinate());
@@ -185,7 +186,7 @@ TEST(CovidSimPersonTests, Person_Recover_Symp)
 
 TEST(CovidSimPersonTests, Person_Recover_ASymp)
 {
-  Person* P = new Person();
+  PersonState* P = new PersonState();
   P->set_susceptible();
   P->set_recovered();
   ASSERT_FALSE(P->do_not_vaccinate());
@@ -205,3 +206,31 @@ TEST(CovidSimPersonTests, Person_Recover_ASymp)
   ASSERT_FALSE(P->is_susceptible_or_infected());
   delete P;
 }
+
+TEST(CovidSimPersonTests, PersonState_Default)
+{
+  // What InitModel resets everybody to at the start of a realisation
+  PersonState S;
+  ASSERT_TRUE(S.is_susceptible());
+  ASSERT_EQ(-1, S.infector);
+  ASSERT_EQ(0, S.infect_type);
+  ASSERT_EQ(0u, S.to_die);
+  ASSERT_EQ(0u, S.detected);
+  ASSERT_EQ(0, S.Travelling);
+  ASSERT_EQ(0, S.ncontacts);
+  ASSERT_TRUE(S.Severity_Current == Severity::Asymptomatic);
+  ASSERT_TRUE(S.Severity_Final == Severity::Asymptomatic);
+  const unsigned short never = USHRT_MAX - 1;
+  ASSERT_EQ(never, S.absent_start_time);
+  ASSERT_EQ(never, S.isolation_start_time);
+  ASSERT_EQ(never, S.treat_start_time);
+  ASSERT_EQ(never, S.vacc_start_time);
+  ASSERT_EQ(never, S.dct_start_time);
+  ASSERT_EQ(never, S.dct_trigger_time);
+  ASSERT_EQ(never, S.SARI_time);
+  ASSERT_EQ(never, S.Critical_time);
+  ASSERT_EQ(never, S.Stepdown_time);
+  ASSERT_EQ(0, S.absent_stop_time);
+  ASSERT_EQ(0, S.treat_stop_time);
+  ASSERT_EQ(0, S.dct_end_time);
+}
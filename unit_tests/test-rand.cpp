@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Rand.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Upper tail critical value of the chi-square distribution with df degrees of
+// freedom at p = 1e-4, by the Wilson-Hilferty approximation.
+static double chi2_critical(int df) {
+  const double z = 3.719; // standard normal upper tail at 1e-4
+  double v = 2.0 / (9.0 * df);
+  return df * pow(1.0 - v + z * sqrt(v), 3);
+}
+
+static std::vector<int> iota_vector(int n) {
+  std::vector<int> v(n);
+  std::iota(v.begin(), v.end(), 0);
+  return v;
+}
+
+TEST(ParallelShuffle, permutes) {
+  for (int n : { 0, 1, 2, 1000, 200000 }) {
+    for (int chunk_size : { 7, 65536 }) {
+      std::vector<int> v = iota_vector(n);
+      parallel_shuffle(v.data(), n, 12345, chunk_size);
+      std::vector<int> sorted(v);
+      std::sort(sorted.begin(), sorted.end());
+      EXPECT_EQ(iota_vector(n), sorted) << "n = " << n << ", chunk size " << chunk_size;
+      if (n >= 1000) {
+        EXPECT_NE(iota_vector(n), v);
+      }
+    }
+  }
+}
+
+TEST(ParallelShuffle, depends_only_on_seed) {
+  std::vector<int> a = iota_vector(100000), b(a), c(a);
+  parallel_shuffle(a.data(), (int)a.size(), 99, 1000);
+  parallel_shuffle(b.data(), (int)b.size(), 99, 1000);
+  parallel_shuffle(c.data(), (int)c.size(), 100, 1000);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+}
+
+// The permutation is the same however many threads shuffle the chunks and buckets.
+TEST(ParallelShuffle, independent_of_threads) {
+#ifdef _OPENMP
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  std::vector<int> serial = iota_vector(100000);
+  parallel_shuffle(serial.data(), (int)serial.size(), 99, 1000);
+  for (int threads : { 2, 4, 7 }) {
+    omp_set_num_threads(threads);
+    std::vector<int> v = iota_vector(100000);
+    parallel_shuffle(v.data(), (int)v.size(), 99, 1000);
+    EXPECT_EQ(serial, v) << threads << " threads";
+  }
+  omp_set_num_threads(max_threads);
+#else
+  GTEST_SKIP() << "Built without OpenMP";
+#endif
+}
+
+// Every permutation of 6 values is equally likely, both when the values are
+// split into buckets and when they are shuffled in one piece.
+TEST(ParallelShuffle, uniform_over_permutations) {
+  const int n = 6, num_perms = 720, trials = 720 * 200;
+  for (int chunk_size : { 2, 65536 }) {
+    std::vector<long> counts(num_perms);
+    for (int t = 0; t < trials; t++) {
+      std::vector<int> v = iota_vector(n);
+      parallel_shuffle(v.data(), n, 1000 + t, chunk_size);
+      // Lehmer code of the permutation.
+      int code = 0;
+      for (int i = 0; i < n; i++) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; j++)
+          if (v[j] < v[i]) smaller++;
+        code = code * (n - i) + smaller;
+      }
+      counts[code]++;
+    }
+    double expected = (double)trials / num_perms, stat = 0;
+    for (long count : counts) stat += (count - expected) * (count - expected) / expected;
+    EXPECT_LT(stat, chi2_critical(num_perms - 1)) << "chunk size " << chunk_size;
+  }
+}
+
+// Each value is equally likely to end up in each position.
+TEST(ParallelShuffle, uniform_positions) {
+  const int n = 100, trials = 20000;
+  std::vector<long> counts(n * n);
+  std::vector<int> v = iota_vector(n);
+  for (int t = 0; t < trials; t++) {
+    parallel_shuffle(v.data(), n, 7 * t + 1, 8);
+    for (int i = 0; i < n; i++) counts[v[i] * n + i]++;
+  }
+  double expected = (double)trials / n, stat = 0;
+  for (long count : counts) stat += (count - expected) * (count - expected) / expected;
+  EXPECT_LT(stat, chi2_critical((n - 1) * (n - 1)));
+}
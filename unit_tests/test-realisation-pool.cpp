@@ -0,0 +1,71 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "RealisationPool.h"
+
+#ifndef _WIN32
+
+namespace {
+  void put_int(std::vector<char>& result, int value) {
+    result.resize(sizeof(value));
+    memcpy(result.data(), &value, sizeof(value));
+  }
+
+  int get_int(std::vector<char> const& result) {
+    int value;
+    EXPECT_EQ(sizeof(value), result.size());
+    memcpy(&value, result.data(), sizeof(value));
+    return value;
+  }
+}
+
+TEST(RealisationPool, merges_results_in_order) {
+  int base = 1000; // set before the workers are forked, so they see it too
+  std::vector<int> merged, values;
+  int num_merged = RealisationPool::run(3, 10,
+    [&](int realisation, std::vector<char>& result) {
+      put_int(result, base + realisation * realisation);
+    },
+    [&](int realisation, std::vector<char> const& result) {
+      merged.push_back(realisation);
+      values.push_back(get_int(result));
+      return true;
+    });
+  EXPECT_EQ(10, num_merged);
+  ASSERT_EQ(10u, merged.size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(i, merged[i]);
+    EXPECT_EQ(base + i * i, values[i]);
+  }
+}
+
+TEST(RealisationPool, stops_when_merge_says_so) {
+  std::vector<int> merged;
+  int num_merged = RealisationPool::run(2, 50,
+    [](int realisation, std::vector<char>& result) { put_int(result, realisation); },
+    [&](int realisation, std::vector<char> const& result) {
+      merged.push_back(get_int(result));
+      return realisation < 4;
+    });
+  EXPECT_EQ(5, num_merged);
+  ASSERT_EQ(5u, merged.size());
+  for (int i = 0; i < 5; i++) EXPECT_EQ(i, merged[i]);
+}
+
+TEST(RealisationPool, passes_large_results) {
+  const std::size_t size = 1 << 20; // bigger than a pipe's buffer
+  std::string merged;
+  RealisationPool::run(2, 3,
+    [&](int realisation, std::vector<char>& result) { result.assign(size, (char)('a' + realisation)); },
+    [&](int, std::vector<char> const& result) {
+      merged.append(result.begin(), result.end());
+      return true;
+    });
+  ASSERT_EQ(3 * size, merged.size());
+  EXPECT_EQ('a', merged[0]);
+  EXPECT_EQ('b', merged[size]);
+  EXPECT_EQ('c', merged[3 * size - 1]);
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "Files.h"
+#include "ResultsFile.h"
+
+// Number of doubles in Results covered by Fields, excluding the age by admin unit fields.
+static std::size_t num_field_doubles() {
+  std::size_t n = 0;
+  for (std::size_t f = 0; f < ResultsFile::NumFields; f++)
+    if (ResultsFile::Fields[f].extent != ResultsFile::Extent::AgeAdUnit)
+      n += ResultsFile::width(ResultsFile::Fields[f].extent, MAX_ADUNITS);
+  return n;
+}
+
+TEST(ResultsFile, fields_cover_results) {
+  // t plus every double from S onwards.
+  EXPECT_EQ(1 + sizeof(Results) / sizeof(double) - ResultsDoubleOffsetStart, num_field_doubles());
+  for (std::size_t f = 0; f < ResultsFile::NumFields; f++)
+    for (std::size_t g = f + 1; g < ResultsFile::NumFields; g++)
+      EXPECT_STRNE(ResultsFile::Fields[f].name, ResultsFile::Fields[g].name);
+}
+
+TEST(ResultsFile, xor_pack) {
+  double values[] = { 0.0, 0.0, 1.0, 2.0, 2.0, -3.5, 1e300, 0.1, 0.30000000000000004, NAN, 0.0 };
+  std::size_t n = sizeof(values) / sizeof(values[0]);
+  std::vector<double> unpacked(n);
+  for (std::size_t stride = 1; stride <= 3; stride++) {
+    std::vector<unsigned char> packed = ResultsFile::xor_pack(values, n, stride);
+    EXPECT_LT(packed.size(), n * sizeof(double));
+    ASSERT_TRUE(ResultsFile::xor_unpack(packed.data(), packed.size(), unpacked.data(), n, stride));
+    EXPECT_EQ(0, memcmp(values, unpacked.data(), sizeof(values)));
+    // Truncated or overlong input is rejected.
+    EXPECT_FALSE(ResultsFile::xor_unpack(packed.data(), packed.size() - 1, unpacked.data(), n, stride));
+    EXPECT_FALSE(ResultsFile::xor_unpack(packed.data(), packed.size(), unpacked.data(), n - 1, stride));
+  }
+}
+
+class ResultsFileRoundTrip : public ::testing::TestWithParam<bool> {};
+
+TEST_P(ResultsFileRoundTrip, round_trip) {
+  const int num_rows = 4, num_adunits = 3;
+  std::unique_ptr<Results[]> rows(new Results[num_rows]());
+  std::vector<double> age_adunit(num_rows * 3 * NUM_AGE_GROUPS * num_adunits);
+  std::vector<double*> age_rows(num_rows * 3 * NUM_AGE_GROUPS);
+  for (int i = 0; i < num_rows; i++) {
+    Results& r = rows[i];
+    r.t = i * 0.5;
+    r.S = 1000 - i;
+    r.incC = i * i;
+    r.incC_country[7] = 1.0 / (i + 1);
+    r.incDa[NUM_AGE_GROUPS - 1] = i;
+    r.incI_adunit[num_adunits - 1] = 10 + i;
+    r.incI_adunit[num_adunits] = 999; // beyond the admin units written
+    r.cumT_keyworker[1] = i;
+    r.prevQuarNotSymptomatic = 42;
+    double*** fields[3] = { &r.prevInf_age_adunit, &r.incInf_age_adunit, &r.cumInf_age_adunit };
+    for (int k = 0; k < 3; k++) {
+      *fields[k] = &age_rows[(i * 3 + k) * NUM_AGE_GROUPS];
+      for (int age = 0; age < NUM_AGE_GROUPS; age++) {
+        double* p = &age_adunit[((i * 3 + k) * NUM_AGE_GROUPS + age) * num_adunits];
+        (*fields[k])[age] = p;
+        for (int ad = 0; ad < num_adunits; ad++) p[ad] = k * 10000 + i * 100 + age * 10 + ad;
+      }
+    }
+  }
+
+  std::vector<std::string> names = { "North", "South", "East" };
+  // Each instance has its own file, as ctest may run them at the same time.
+  std::string filename = GetParam() ? "test_results_compressed.bin" : "test_results.bin";
+  ResultsFile::write(filename, names, { { "NRactual", 3 }, { "OutputSeverity", 1 } },
+                     { { "timeseries", rows.get(), num_rows, true }, { "sum_sq", rows.get(), 2, false } }, GetParam());
+  ResultsFile::Contents contents = ResultsFile::read(filename);
+  Files::xremove(filename.c_str());
+
+  EXPECT_EQ(names, contents.adunit_names);
+  EXPECT_EQ(3, contents.attribute("NRactual", 0));
+  EXPECT_EQ(-1, contents.attribute("Missing", -1));
+  ASSERT_EQ(2u, contents.tables.size());
+  EXPECT_EQ(NULL, contents.find("sum"));
+
+  ResultsFile::Table const* ts = contents.find("timeseries");
+  ASSERT_NE(nullptr, ts);
+  EXPECT_EQ((uint32_t)num_rows, ts->num_rows);
+  EXPECT_EQ(ResultsFile::NumFields, ts->columns.size());
+  EXPECT_EQ(ResultsFile::NumFields - 3, contents.find("sum_sq")->columns.size());
+  EXPECT_EQ(2u, contents.find("sum_sq")->num_rows);
+
+  ResultsFile::Column const* incI_adunit = ts->find("incI_adunit");
+  ASSERT_NE(nullptr, incI_adunit);
+  EXPECT_EQ((uint32_t)num_adunits, incI_adunit->width);
+  ResultsFile::Column const* cumInf = ts->find("cumInf_age_adunit");
+  ASSERT_NE(nullptr, cumInf);
+  EXPECT_EQ((uint32_t)(NUM_AGE_GROUPS * num_adunits), cumInf->width);
+  for (int i = 0; i < num_rows; i++) {
+    EXPECT_EQ(i * 0.5, ts->find("t")->at(i));
+    EXPECT_EQ(1000 - i, ts->find("S")->at(i));
+    EXPECT_EQ(i * i, ts->find("incC")->at(i));
+    EXPECT_EQ(1.0 / (i + 1), ts->find("incC_country")->at(i, 7));
+    EXPECT_EQ(i, ts->find("incDa")->at(i, NUM_AGE_GROUPS - 1));
+    EXPECT_EQ(10 + i, incI_adunit->at(i, num_adunits - 1));
+    EXPECT_EQ(0, incI_adunit->at(i, 0));
+    EXPECT_EQ(i, ts->find("cumT_keyworker")->at(i, 1));
+    EXPECT_EQ(42, ts->find("prevQuarNotSymptomatic")->at(i));
+    EXPECT_EQ(2 * 10000 + i * 100 + 5 * 10 + 1, cumInf->at(i, 5 * num_adunits + 1));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ResultsFile, ResultsFileRoundTrip, ::testing::Values(false, true));
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include "RunningStats.h"
+
+TEST(RunningStats, matches_two_pass_variance) {
+  // A large mean and small spread, where sums of squares lose the variance.
+  std::vector<double> x = { 1e9 + 4, 1e9 + 7, 1e9 + 13, 1e9 + 16 };
+  double sum = 0, m2 = 0;
+  for (std::size_t i = 0; i < x.size(); i++) RunningStats::add(&x[i], &sum, &m2, 1, (int)i);
+  EXPECT_DOUBLE_EQ(4e9 + 40, sum);
+  EXPECT_DOUBLE_EQ(90.0, m2); // deviations from 1e9 + 10 are -6, -3, 3, 6
+}
+
+TEST(RunningStats, null_adds_zeros) {
+  double values[2] = { 2, 4 }, sum[2] = { 0, 0 }, m2[2] = { 0, 0 };
+  RunningStats::add(values, sum, m2, 2, 0);
+  RunningStats::add(NULL, sum, m2, 2, 1);
+  EXPECT_DOUBLE_EQ(2.0, sum[0]);
+  EXPECT_DOUBLE_EQ(4.0, sum[1]);
+  EXPECT_DOUBLE_EQ(2.0, m2[0]);
+  EXPECT_DOUBLE_EQ(8.0, m2[1]);
+}
+
+TEST(RunningStats, merge_matches_adding_in_turn) {
+  std::vector<double> x = { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3 };
+  double sum = 0, m2 = 0, sum_a = 0, m2_a = 0, sum_b = 0, m2_b = 0;
+  for (std::size_t i = 0; i < x.size(); i++) RunningStats::add(&x[i], &sum, &m2, 1, (int)i);
+  for (std::size_t i = 0; i < 4; i++) RunningStats::add(&x[i], &sum_a, &m2_a, 1, (int)i);
+  for (std::size_t i = 4; i < x.size(); i++) RunningStats::add(&x[i], &sum_b, &m2_b, 1, (int)i - 4);
+  RunningStats::merge(&sum_b, &m2_b, 6, &sum_a, &m2_a, 1, 4);
+  EXPECT_DOUBLE_EQ(sum, sum_a);
+  EXPECT_NEAR(m2, m2_a, 1e-12);
+
+  double sum_c = 0, m2_c = 0;
+  RunningStats::merge(&sum, &m2, 10, &sum_c, &m2_c, 1, 0);
+  EXPECT_DOUBLE_EQ(sum, sum_c);
+  EXPECT_DOUBLE_EQ(m2, m2_c);
+}
+
+TEST(QuantileSketch, is_exact_for_few_values) {
+  QuantileSketch sketch(64);
+  EXPECT_EQ(0.0, sketch.quantile(0.5));
+  for (double x : { 5.0, 1.0, 4.0, 2.0, 3.0 }) sketch.add(x);
+  EXPECT_EQ(5, sketch.count());
+  EXPECT_EQ(1.0, sketch.quantile(0.0));
+  EXPECT_EQ(3.0, sketch.quantile(0.5));
+  EXPECT_EQ(5.0, sketch.quantile(1.0));
+}
+
+TEST(QuantileSketch, approximates_many_values) {
+  QuantileSketch sketch(64);
+  const int n = 100000;
+  for (int i = 0; i < n; i++) sketch.add((double)((i * 7919) % n)); // 0 to n - 1 out of order
+  EXPECT_EQ(n, sketch.count());
+  for (double q : { 0.025, 0.25, 0.5, 0.75, 0.975 })
+    EXPECT_NEAR(q * n, sketch.quantile(q), 0.02 * n) << "q = " << q;
+}
+
+TEST(QuantileSketch, merge_matches_adding_in_turn) {
+  QuantileSketch all(32), a(32), b(32);
+  for (int i = 0; i < 1000; i++) {
+    all.add(i);
+    (i % 3 ? a : b).add(i);
+  }
+  a.merge(b);
+  EXPECT_EQ(all.count(), a.count());
+  for (double q : { 0.1, 0.5, 0.9 })
+    EXPECT_NEAR(all.quantile(q), a.quantile(q), 0.03 * 1000) << "q = " << q;
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "ScenarioMatrix.h"
+
+TEST(ScenarioMatrix, parse) {
+  auto scenarios = ScenarioMatrix::parse(
+    "# sensitivity sweep\r\n"
+    "CLP1, CLP05, R, I\r\n"
+    "0.5, 2, 1.2, \r\n"
+    "\n"
+    ", , , a.xml; b.xml\n"
+    "1e-1,,,-", "test.csv");
+  ASSERT_EQ(3u, scenarios.size());
+
+  EXPECT_EQ(3, scenarios[0].line);
+  ASSERT_EQ(2u, scenarios[0].clp.size());
+  EXPECT_EQ(1, scenarios[0].clp[0].first);
+  EXPECT_DOUBLE_EQ(0.5, scenarios[0].clp[0].second);
+  EXPECT_EQ(5, scenarios[0].clp[1].first);
+  EXPECT_DOUBLE_EQ(2.0, scenarios[0].clp[1].second);
+  EXPECT_TRUE(scenarios[0].has_r0_scale);
+  EXPECT_DOUBLE_EQ(1.2, scenarios[0].r0_scale);
+  EXPECT_FALSE(scenarios[0].has_interventions);
+
+  // Empty cells keep the command-line values.
+  EXPECT_EQ(5, scenarios[1].line);
+  EXPECT_TRUE(scenarios[1].clp.empty());
+  EXPECT_FALSE(scenarios[1].has_r0_scale);
+  EXPECT_TRUE(scenarios[1].has_interventions);
+  ASSERT_EQ(2u, scenarios[1].intervention_files.size());
+  EXPECT_EQ("a.xml", scenarios[1].intervention_files[0]);
+  EXPECT_EQ("b.xml", scenarios[1].intervention_files[1]);
+
+  ASSERT_EQ(1u, scenarios[2].clp.size());
+  EXPECT_DOUBLE_EQ(0.1, scenarios[2].clp[0].second);
+  EXPECT_TRUE(scenarios[2].has_interventions);
+  EXPECT_TRUE(scenarios[2].intervention_files.empty());
+}
+
+TEST(ScenarioMatrixDeathTests, unknown_column) {
+  ASSERT_DEATH({
+    ScenarioMatrix::parse("CLP1,KO\n1,2\n", "test.csv");
+  }, "test.csv:1: Unknown scenario column \"KO\"");
+  ASSERT_DEATH({
+    ScenarioMatrix::parse("CLP100\n1\n", "test.csv");
+  }, "test.csv:1: Unknown scenario column \"CLP100\"");
+}
+
+TEST(ScenarioMatrixDeathTests, bad_value) {
+  ASSERT_DEATH({
+    ScenarioMatrix::parse("CLP1,R\n1,2\n3,1.5x\n", "test.csv");
+  }, "test.csv:3: Can't read R from \"1.5x\"");
+}
+
+TEST(ScenarioMatrixDeathTests, wrong_number_of_cells) {
+  ASSERT_DEATH({
+    ScenarioMatrix::parse("CLP1,R\n1\n", "test.csv");
+  }, "test.csv:2: Scenario has 1 cells but there are 2 columns");
+}
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <string>
+#include <gtest/gtest.h>
+#include "Files.h"
+#include "SetupStages.h"
+
+TEST(SetupStages, fingerprint) {
+  FILE* dat = Files::xfopen("test_setup_stages.txt", "w");
+  Files::xfprintf(dat, "[Population size]\n1000\n");
+  Files::xfclose(dat);
+  dat = Files::xfopen("test_setup_stages.bin", "wb");
+  Files::xfprintf(dat, "1234");
+  Files::xfclose(dat);
+  std::string a = SetupStages::fingerprint({ "/P:p.txt", "/R:1.5" }, { "test_setup_stages.txt", "missing.txt" }, { "test_setup_stages.bin", "missing.bin" });
+  EXPECT_EQ(16u, a.size());
+  EXPECT_EQ(a, SetupStages::fingerprint({ "/P:p.txt", "/R:1.5" }, { "test_setup_stages.txt" }, { "test_setup_stages.bin" }));
+  EXPECT_NE(a, SetupStages::fingerprint({ "/P:p.txt", "/R:1.6" }, { "test_setup_stages.txt" }, { "test_setup_stages.bin" }));
+  EXPECT_NE(a, SetupStages::fingerprint({ "/P:p.txt/R:1.5" }, { "test_setup_stages.txt" }, { "test_setup_stages.bin" }));
+  EXPECT_NE(a, SetupStages::fingerprint({ "/P:p.txt", "/R:1.5" }, { "test_setup_stages.txt" }, {}));
+  // Large files are compared by size (and modification time), not contents.
+  dat = Files::xfopen("test_setup_stages.bin", "wb");
+  Files::xfprintf(dat, "12345");
+  Files::xfclose(dat);
+  std::string b = SetupStages::fingerprint({ "/P:p.txt", "/R:1.5" }, { "test_setup_stages.txt" }, { "test_setup_stages.bin" });
+  EXPECT_NE(a, b);
+  dat = Files::xfopen("test_setup_stages.txt", "w");
+  Files::xfprintf(dat, "[Population size]\n2000\n");
+  Files::xfclose(dat);
+  EXPECT_NE(b, SetupStages::fingerprint({ "/P:p.txt", "/R:1.5" }, { "test_setup_stages.txt" }, { "test_setup_stages.bin" }));
+  Files::xremove("test_setup_stages.txt");
+  Files::xremove("test_setup_stages.bin");
+}
+
+TEST(SetupStages, resume) {
+  std::remove("test_setup.stages");
+  {
+    SetupStages stages;
+    EXPECT_FALSE(stages.checkpointing());
+    stages.mark_completed("density"); // ignored without a checkpoint
+    stages.set_checkpoint("test_setup", "abc");
+    EXPECT_TRUE(stages.checkpointing());
+    EXPECT_EQ("test_setup.places.bin", stages.checkpoint_file("places"));
+    EXPECT_FALSE(stages.completed("density"));
+    stages.mark_completed("density");
+    stages.mark_completed("places");
+    EXPECT_TRUE(stages.completed("places"));
+  }
+  {
+    SetupStages stages;
+    stages.set_checkpoint("test_setup", "abc");
+    EXPECT_TRUE(stages.completed("density"));
+    EXPECT_TRUE(stages.completed("places"));
+    EXPECT_FALSE(stages.completed("airports"));
+  }
+  {
+    // A different setup starts again, and replaces the list once it completes a stage.
+    SetupStages stages;
+    stages.set_checkpoint("test_setup", "abd");
+    EXPECT_FALSE(stages.completed("density"));
+    stages.mark_completed("places");
+  }
+  {
+    SetupStages stages;
+    stages.set_checkpoint("test_setup", "abc");
+    EXPECT_FALSE(stages.completed("places"));
+    stages.set_checkpoint("test_setup", "abd");
+    EXPECT_TRUE(stages.completed("places"));
+    EXPECT_FALSE(stages.completed("density"));
+  }
+  Files::xremove("test_setup.stages");
+}
+
+TEST(SetupStages, timing) {
+  SetupStages stages;
+  stages.begin("first");
+  stages.begin("second"); // ends the first
+  stages.end(1000, true);
+  stages.end(); // nothing being timed
+  ASSERT_EQ(2u, stages.stages().size());
+  EXPECT_EQ("first", stages.stages()[0].name);
+  EXPECT_EQ(0, stages.stages()[0].items);
+  EXPECT_FALSE(stages.stages()[0].resumed);
+  EXPECT_EQ("second", stages.stages()[1].name);
+  EXPECT_EQ(1000, stages.stages()[1].items);
+  EXPECT_TRUE(stages.stages()[1].resumed);
+  for (auto const& stage : stages.stages()) {
+    EXPECT_GE(stage.seconds, 0);
+    EXPECT_GE(stage.peak_memory_growth, 0);
+  }
+  EXPECT_GE(stages.elapsed(), stages.stages()[0].seconds + stages.stages()[1].seconds);
+}
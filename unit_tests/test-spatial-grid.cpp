@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+#include "SpatialGrid.h"
+
+// A small deterministic generator for test points.
+static double next_uniform(uint64_t& state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (double)(state >> 11) / 9007199254740992.0;
+}
+
+static std::vector<SpatialGrid::Neighbour> brute_force(std::vector<double> const& x, std::vector<double> const& y,
+                                                       double qx, double qy, int k, int modulus) {
+  std::vector<SpatialGrid::Neighbour> all;
+  for (int i = 0; i < (int)x.size(); i++)
+    if (i % modulus == 0) all.push_back({ (x[i] - qx) * (x[i] - qx) + (y[i] - qy) * (y[i] - qy), i });
+  std::sort(all.begin(), all.end(), [](SpatialGrid::Neighbour const& a, SpatialGrid::Neighbour const& b) {
+    return (a.dist2 < b.dist2) || ((a.dist2 == b.dist2) && (a.index < b.index));
+  });
+  if ((int)all.size() > k) all.resize(k);
+  return all;
+}
+
+TEST(SpatialGrid, matches_brute_force) {
+  uint64_t state = 42;
+  std::vector<double> x, y;
+  // Clustered points, some duplicated, so that buckets are uneven and distances tie.
+  for (int i = 0; i < 3000; i++) {
+    double cx = (i % 3) * 40.0, cy = (i % 5) * 10.0;
+    x.push_back(cx + 5 * next_uniform(state));
+    y.push_back(cy + 5 * next_uniform(state));
+  }
+  for (int i = 0; i < 50; i++) { x.push_back(x[i]); y.push_back(y[i]); }
+  SpatialGrid grid(x, y);
+  EXPECT_EQ((int)x.size(), grid.size());
+
+  std::vector<SpatialGrid::Neighbour> found;
+  for (int q = 0; q < 200; q++) {
+    // Include locations outside the points' bounding box.
+    double qx = 140 * next_uniform(state) - 10, qy = 70 * next_uniform(state) - 10;
+    for (int k : { 1, 3, 10 })
+      for (int modulus : { 1, 7, 5000 }) {
+        grid.nearest(qx, qy, k, [modulus](int i) { return i % modulus == 0; }, found);
+        auto expected = brute_force(x, y, qx, qy, k, modulus);
+        ASSERT_EQ(expected.size(), found.size());
+        for (size_t i = 0; i < found.size(); i++) {
+          EXPECT_EQ(expected[i].index, found[i].index);
+          EXPECT_EQ(expected[i].dist2, found[i].dist2);
+        }
+      }
+  }
+}
+
+TEST(SpatialGrid, degenerate_points) {
+  std::vector<SpatialGrid::Neighbour> found;
+  SpatialGrid empty;
+  empty.nearest(0, 0, 3, [](int) { return true; }, found);
+  EXPECT_TRUE(found.empty());
+
+  // All on a line, and all at one point.
+  std::vector<double> x = { 0, 1, 2, 3, 4 }, y(5, 7.0);
+  SpatialGrid line(x, y);
+  line.nearest(2.2, 7, 2, [](int) { return true; }, found);
+  ASSERT_EQ(2u, found.size());
+  EXPECT_EQ(2, found[0].index);
+  EXPECT_EQ(3, found[1].index);
+
+  SpatialGrid point(std::vector<double>(4, 1.0), std::vector<double>(4, 1.0));
+  point.nearest(0, 0, 10, [](int i) { return i != 2; }, found);
+  ASSERT_EQ(3u, found.size());
+  EXPECT_EQ(0, found[0].index);
+  EXPECT_EQ(3, found[2].index);
+}
+
+TEST(SpatialGrid, other_metrics) {
+  uint64_t state = 7;
+  std::vector<double> x, y, weight;
+  for (int i = 0; i < 2000; i++) {
+    x.push_back(100 * next_uniform(state));
+    y.push_back(50 * next_uniform(state));
+    weight.push_back((i % 10 == 0) ? 0.0 : 1 + 99 * next_uniform(state));
+  }
+  SpatialGrid grid(x, y);
+  // Distances with x shrunk by up to a third, as longitude is on the sphere.
+  auto stretched = [&x, &y](double qx, double qy, int i) {
+    double c = 1 - (y[i] + qy) / 400, dx = c * (x[i] - qx), dy = y[i] - qy;
+    return dx * dx + dy * dy;
+  };
+  auto min_stretched = [](double separation) { return separation * separation * 4 / 9; };
+
+  std::vector<SpatialGrid::Neighbour> found;
+  std::vector<SpatialGrid::Scored> best;
+  for (int q = 0; q < 100; q++) {
+    double qx = 120 * next_uniform(state) - 10, qy = 70 * next_uniform(state) - 10;
+    std::vector<SpatialGrid::Neighbour> all;
+    std::vector<SpatialGrid::Scored> all_scored;
+    for (int i = 0; i < (int)x.size(); i++) {
+      all.push_back({ stretched(qx, qy, i), i });
+      all_scored.push_back({ weight[i] / (1 + stretched(qx, qy, i)), i });
+    }
+    std::sort(all.begin(), all.end(), [](SpatialGrid::Neighbour const& a, SpatialGrid::Neighbour const& b) {
+      return (a.dist2 < b.dist2) || ((a.dist2 == b.dist2) && (a.index < b.index));
+    });
+    std::sort(all_scored.begin(), all_scored.end(), [](SpatialGrid::Scored const& a, SpatialGrid::Scored const& b) {
+      return (a.score > b.score) || ((a.score == b.score) && (a.index < b.index));
+    });
+
+    for (int k : { 1, 10 }) {
+      grid.nearest(qx, qy, k, [&](int i) { return stretched(qx, qy, i); }, min_stretched, [](int) { return true; }, found);
+      ASSERT_EQ((size_t)k, found.size());
+      for (int i = 0; i < k; i++) EXPECT_EQ(all[i].index, found[i].index);
+
+      grid.best(qx, qy, k, [&](int i) { return weight[i] / (1 + stretched(qx, qy, i)); },
+                [&](double separation) { return 100 / (1 + min_stretched(separation)); }, best);
+      ASSERT_EQ((size_t)k, best.size());
+      for (int i = 0; i < k; i++) {
+        EXPECT_EQ(all_scored[i].index, best[i].index);
+        EXPECT_EQ(all_scored[i].score, best[i].score);
+      }
+    }
+
+    // Every point within a distance, and only those, is visited.
+    double r2 = all[25].dist2;
+    int visited = 0, within = 0;
+    grid.search(qx, qy, [&](double separation) { return min_stretched(separation) >= r2; },
+                [&](int i) { visited++; if (stretched(qx, qy, i) < r2) within++; });
+    EXPECT_EQ(25, within);
+    EXPECT_LT(visited, (int)x.size());
+  }
+}